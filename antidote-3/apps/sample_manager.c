@@ -35,6 +35,10 @@
 
 #include <ieee11073.h>
 #include "communication/plugin/plugin_tcp.h"
+#ifdef __linux__
+#include "communication/plugin/plugin_tcp_epoll.h"
+#include "communication/plugin/plugin_pthread.h"
+#endif
 #include "communication/common/service.h"
 #include "util/log.h"
 
@@ -59,6 +63,11 @@ static CommunicationPlugin comm_plugin = COMMUNICATION_PLUGIN_NULL;
  */
 int port = 6024;
 
+/**
+ * Whether all agents share one port (epoll plugin)
+ */
+static int epoll_mode = 0;
+
 /**
  * Callback function that is called whenever a new data
  * has been received.
@@ -69,22 +78,18 @@ int port = 6024;
 void new_data_received(Context *ctx, DataList *list)
 {
 	fprintf(stderr, "Medical Device Data Updated:\n");
+	fflush(stderr);
 
-	char *data = json_encode_data_list(list);
-
-	if (data != NULL) {
-		fprintf(stderr, "%s", data);
+	if (json_encode_data_list_fd(list, STDERR_FILENO)) {
 		fprintf(stderr, "\n");
-
 		fflush(stderr);
-		free(data);
 	}
 
 	// uncomment for manager-initiated disassociation testing
 	// manager_request_association_release(CONTEXT_ID);
 }
 
-void device_reqmdsattr();
+void device_reqmdsattr(ContextId id);
 
 /**
  * Callback function that is called whenever a new device
@@ -96,18 +101,14 @@ void device_reqmdsattr();
 void device_associated(Context *ctx, DataList *list)
 {
 	fprintf(stderr, " Medical Device System Associated:\n");
+	fflush(stderr);
 
-	char *data = json_encode_data_list(list);
-
-	if (data != NULL) {
-		fprintf(stderr, "%s", data);
+	if (json_encode_data_list_fd(list, STDERR_FILENO)) {
 		fprintf(stderr, "\n");
-
 		fflush(stderr);
-		free(data);
 	}
 
-	device_reqmdsattr();
+	device_reqmdsattr(ctx->id);
 }
 
 /**
@@ -115,7 +116,7 @@ void device_associated(Context *ctx, DataList *list)
  */
 void print_device_attributes(Context *ctx, Request *r, DATA_apdu *response_apdu)
 {
-	DataList *list = manager_get_mds_attributes(CONTEXT_ID);
+	DataList *list = manager_get_mds_attributes(ctx->id);
 	char *data = json_encode_data_list(list);
 
 	fprintf(stderr, "print_device_attributes\n");
@@ -135,10 +136,10 @@ void print_device_attributes(Context *ctx, Request *r, DATA_apdu *response_apdu)
  * Request all MDS attributes
  *
  */
-void device_reqmdsattr()
+void device_reqmdsattr(ContextId id)
 {
 	fprintf(stderr, "device_reqmdsattr\n");
-	manager_request_get_all_mds_attributes(CONTEXT_ID, print_device_attributes);
+	manager_request_get_all_mds_attributes(id, print_device_attributes);
 }
 
 /**
@@ -151,7 +152,12 @@ static void print_help()
 		"Usage: ieee_manager [OPTION]\n"
 		"Options:\n"
 		"        --help                Print this help\n"
-		"        --tcp                 Run TCP mode on default port\n");
+		"        --tcp                 Run TCP mode on default port\n"
+#ifdef __linux__
+		"        --tcp-epoll           Run TCP mode accepting many agents on default port,\n"
+		"                              processing them on one worker thread per CPU\n"
+#endif
+		);
 }
 
 /**
@@ -185,6 +191,19 @@ static void tcp_mode()
 	plugin_network_tcp_setup(&comm_plugin, 1, port);
 }
 
+#ifdef __linux__
+/**
+ * Configure application to use epoll-based tcp plugin
+ */
+static void tcp_epoll_mode()
+{
+	epoll_mode = 1;
+	plugin_network_tcp_epoll_setup(&comm_plugin, port);
+	// workers need real context locking
+	plugin_pthread_setup(&comm_plugin);
+}
+#endif
+
 /**
  * Main function
  */
@@ -198,6 +217,10 @@ int main(int argc, char **argv)
 			exit(0);
 		} else if (strcmp(argv[1], "--tcp") == 0) {
 			tcp_mode();
+#ifdef __linux__
+		} else if (strcmp(argv[1], "--tcp-epoll") == 0) {
+			tcp_epoll_mode();
+#endif
 		} else {
 			fprintf(stderr, "ERROR: invalid option: %s\n", argv[1]);
 			fprintf(stderr, "Try `ieee_manager --help'"
@@ -231,6 +254,17 @@ int main(int argc, char **argv)
 
 	manager_start();
 
+#ifdef __linux__
+	if (epoll_mode) {
+		manager_start_workers(0);
+
+		while (plugin_network_tcp_epoll_poll(-1) == NETWORK_ERROR_NONE);
+
+		manager_finalize();
+		return 0;
+	}
+#endif
+
     // AB: Limit changed from 3 to 1000 to avoid the disconnection after three test sequences
 	int x = 0;
 	while (x++ < 1000) {
@@ -68,6 +68,26 @@ typedef struct SimpleDataEntry {
 	char *value;
 } SimpleDataEntry;
 
+/**
+ * Represents an array of values kept in binary form, such as the
+ * samples of a waveform
+ */
+typedef struct ArrayDataEntry {
+	/**
+	 * Entry Name
+	 */
+	char *name;
+	/**
+	 * Type of each value
+	 */
+	APIDEF_type type;
+	/**
+	 * Number of values
+	 */
+	int count;
+	float *values;
+} ArrayDataEntry;
+
 /**
  * Represents a compound text data entry
  */
@@ -104,7 +124,8 @@ typedef struct MetaData {
 
 typedef enum {
 	SIMPLE_DATA_ENTRY = 0, // !<  If entry is simple
-	COMPOUND_DATA_ENTRY    // !<  If entry is composite by other entries
+	COMPOUND_DATA_ENTRY,   // !<  If entry is composite by other entries
+	ARRAY_DATA_ENTRY       // !<  If entry is an array of values
 } DataEntry_choice;
 
 
@@ -117,6 +138,7 @@ typedef struct DataEntry {
 	union {
 		SimpleDataEntry simple;
 		CompoundDataEntry compound;
+		ArrayDataEntry array;
 	} u;
 } DataEntry;
 
@@ -128,6 +150,90 @@ typedef struct DataList {
 	DataEntry *values;
 } DataList;
 
+typedef enum {
+	OBSERVATION_VALUE_FLOAT = 0, // !<  Value is in float_value
+	OBSERVATION_VALUE_INT        // !<  Value is in int_value (OID or bit string)
+} ObservationValue_type;
+
+/**
+ * Absolute-Time-Stamp was reported with the observation
+ */
+#define OBSERVATION_FLAG_ABSOLUTE_TIME 0x0001
+/**
+ * Relative-Time-Stamp was reported with the observation
+ */
+#define OBSERVATION_FLAG_RELATIVE_TIME 0x0002
+/**
+ * Observation came from a multiple-person report
+ */
+#define OBSERVATION_FLAG_PERSON_ID 0x0004
+
+/**
+ * Absolute time stamp with BCD fields already converted
+ */
+typedef struct ObservationTime {
+	unsigned short year;
+	unsigned char month;
+	unsigned char day;
+	unsigned char hour;
+	unsigned char minute;
+	unsigned char second;
+	unsigned char sec_fractions;
+} ObservationTime;
+
+/**
+ * One observed value in binary form, as an alternative to the
+ * DataEntry tree
+ */
+typedef struct ObservationRecord {
+	/**
+	 * Handle of the reporting object
+	 */
+	unsigned short handle;
+	/**
+	 * Nomenclature code of the observed value
+	 */
+	unsigned short metric_id;
+	/**
+	 * Nomenclature code of the unit, 0 if not applicable
+	 */
+	unsigned short unit_code;
+	/**
+	 * Measurement-Status bits
+	 */
+	unsigned short measurement_status;
+	/**
+	 * Person id, if OBSERVATION_FLAG_PERSON_ID is set
+	 */
+	unsigned short person_id;
+	/**
+	 * OBSERVATION_FLAG_* bits
+	 */
+	unsigned short flags;
+	ObservationValue_type type;
+	union {
+		double float_value;
+		long long int_value;
+	} u;
+	/**
+	 * Valid if OBSERVATION_FLAG_ABSOLUTE_TIME is set
+	 */
+	ObservationTime absolute_time;
+	/**
+	 * Valid if OBSERVATION_FLAG_RELATIVE_TIME is set, 1/8 ms units
+	 */
+	unsigned int relative_time;
+} ObservationRecord;
+
+/**
+ * Contiguous array of observation records
+ */
+typedef struct ObservationList {
+	int count;
+	int capacity;
+	ObservationRecord *records;
+} ObservationList;
+
 /** @} */
 
 #endif /* API_DEFINITIONS_H_ */
@@ -756,6 +756,28 @@ void data_set_simple_sa_observed_value(DataEntry *data, char *att_name,
 		   octet_string2str(simple_sa_observed_value));
 }
 
+/**
+ * Sets data entry as an array of float values.
+ *
+ * @param data entry
+ * @param att_name the name of DIM attribute
+ * @param values the values, deallocated on data-entry destruction
+ * @param count number of values
+ */
+void data_set_float_array(DataEntry *data, char *att_name, float *values, int count)
+{
+	if (data == NULL) {
+		free(values);
+		return;
+	}
+
+	data->choice = ARRAY_DATA_ENTRY;
+	data->u.array.name = data_strcp(att_name);
+	data->u.array.type = APIDEF_TYPE_FLOAT;
+	data->u.array.count = count;
+	data->u.array.values = values;
+}
+
 /**
  * Sets data entry with passed type.
  *
@@ -1192,6 +1214,22 @@ void data_entry_del_compound(CompoundDataEntry *pointer)
 	pointer->entries = NULL;
 }
 
+/**
+ * Deletes an array data entry.
+ *
+ * @param pointer the array data entry to be deleted.
+ */
+void data_entry_del_array(ArrayDataEntry *pointer)
+{
+	if (pointer == NULL)
+		return;
+
+	free(pointer->name);
+	pointer->name = NULL;
+	free(pointer->values);
+	pointer->values = NULL;
+}
+
 /**
  * Deletes the data entry.
  *
@@ -1221,6 +1259,8 @@ void data_entry_del(DataEntry *pointer)
 		data_entry_del_simple(&pointer->u.simple);
 	} else if (pointer->choice == COMPOUND_DATA_ENTRY) {
 		data_entry_del_compound(&pointer->u.compound);
+	} else if (pointer->choice == ARRAY_DATA_ENTRY) {
+		data_entry_del_array(&pointer->u.array);
 	}
 }
 
@@ -1261,4 +1301,45 @@ void data_list_del(DataList *pointer)
 	}
 }
 
+/**
+ * Appends a zeroed record to the observation list. Storage grows by
+ * doubling, so a report costs a handful of allocations regardless of
+ * the number of values.
+ *
+ * @param list the observation list.
+ * @return the new record, or NULL if storage cannot grow.
+ */
+ObservationRecord *observation_list_add(ObservationList *list)
+{
+	if (list->count == list->capacity) {
+		int capacity = list->capacity > 0 ? list->capacity * 2 : 8;
+		ObservationRecord *records = realloc(list->records,
+						     capacity * sizeof(ObservationRecord));
+
+		if (records == NULL) {
+			return NULL;
+		}
+
+		list->records = records;
+		list->capacity = capacity;
+	}
+
+	ObservationRecord *record = &list->records[list->count++];
+	memset(record, 0, sizeof(ObservationRecord));
+	return record;
+}
+
+/**
+ * Releases the records of the observation list, leaving it empty.
+ *
+ * @param list the observation list.
+ */
+void observation_list_clear(ObservationList *list)
+{
+	free(list->records);
+	list->records = NULL;
+	list->count = 0;
+	list->capacity = 0;
+}
+
 /** @} */
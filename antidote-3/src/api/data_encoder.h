@@ -96,6 +96,7 @@ void data_set_sample_period(DataEntry *data, char *att_name,
 			    RelativeTime sample_period);
 void data_set_simple_sa_observed_value(DataEntry *data, char *att_name,
 				       octet_string *simple_sa_observed_value);
+void data_set_float_array(DataEntry *data, char *att_name, float *values, int count);
 void data_set_scale_and_range_specification_8(DataEntry *data, char *att_name,
 		ScaleRangeSpec8 *scale_and_range_specification_8);
 void data_set_scale_and_range_specification_16(DataEntry *data, char *att_name,
@@ -35,5 +35,7 @@
 void data_entry_del(DataEntry *pointer);
 DataList *data_list_new(int size);
 void data_list_del(DataList *pointer);
+ObservationRecord *observation_list_add(ObservationList *list);
+void observation_list_clear(ObservationList *list);
 
 #endif /* DATA_LIST_H_ */
@@ -36,6 +36,12 @@
 #include <strings.h>
 #include <stdio.h>
 
+/**
+ * Room for a float formatted with %f, the largest (-FLT_MAX)
+ * takes 47 characters
+ */
+#define MAX_FLOAT_STR 100
+
 /**
  * \addtogroup JsonEncoder JSON Encoder
  * \brief Json encoder parses types of IEEE layer into data entries for high
@@ -74,6 +80,42 @@ static void describe_simple_entry(SimpleDataEntry *simple, StringBuffer *sb)
 	strbuff_cat(sb, "}");
 }
 
+/**
+ * Converts the array data entry to JSON format and saves the value into a string buffer.
+ *
+ * @param array the data to be converted into JSON format.
+ * @param sb the string buffer to save the data.
+ */
+static void describe_array_entry(ArrayDataEntry *array, StringBuffer *sb)
+{
+	char value[MAX_FLOAT_STR];
+	int i;
+
+	if (!array->name || !array->type || (array->count > 0 && !array->values)) {
+		// A malformed message might generate empty Data Entries
+		strbuff_cat(sb, "\"array\": {}");
+		return;
+	}
+
+	strbuff_cat(sb, "\"array\": {");
+	strbuff_cat(sb, "\"name\": \"");
+	strbuff_cat(sb, array->name);
+	strbuff_cat(sb, "\", ");
+	strbuff_cat(sb, "\"type\": \"");
+	strbuff_cat(sb, array->type);
+	strbuff_cat(sb, "\", ");
+	strbuff_cat(sb, "\"values\": [");
+
+	for (i = 0; i < array->count; i++) {
+		snprintf(value, sizeof(value), i > 0 ? ", %f" : "%f",
+			 array->values[i]);
+		strbuff_cat(sb, value);
+	}
+
+	strbuff_cat(sb, "]");
+	strbuff_cat(sb, "}");
+}
+
 /**
  * Converts the compound data entry to JSON format and saves the value into a string buffer.
  *
@@ -150,6 +192,8 @@ static void describe_data_entry(DataEntry *data, StringBuffer *sb)
 			describe_simple_entry(&data->u.simple, sb);
 		} else if (data->choice == COMPOUND_DATA_ENTRY) {
 			describe_cmp_entry(&data->u.compound, sb);
+		} else if (data->choice == ARRAY_DATA_ENTRY) {
+			describe_array_entry(&data->u.array, sb);
 		}
 
 		strbuff_cat(sb, "}");
@@ -181,6 +225,19 @@ static void read_entries(DataEntry *values, int size, StringBuffer *sb)
 }
 
 
+/**
+ * Describes the JSON document of a data list in string buffer
+ *
+ * @param list of text data.
+ * @param sb string buffer
+ */
+static void describe_data_list(DataList *list, StringBuffer *sb)
+{
+	if (list != NULL && list->values != NULL) {
+		read_entries(list->values, list->size, sb);
+	}
+}
+
 /**
  * Converts data list elements into JSON notation.
  *
@@ -191,9 +248,7 @@ char *json_encode_data_list(DataList *list)
 {
 	StringBuffer *sb = strbuff_new(100);
 
-	if (list != NULL && list->values != NULL) {
-		read_entries(list->values, list->size, sb);
-	}
+	describe_data_list(list, sb);
 
 	char *json = sb->str;
 
@@ -203,4 +258,42 @@ char *json_encode_data_list(DataList *list)
 	return json;
 }
 
+/**
+ * Converts data list elements into JSON notation, handing the
+ * document to a sink piece by piece instead of building it in memory.
+ *
+ * @param list of text data.
+ * @param sink function that receives the document.
+ * @param sink_data data passed to sink.
+ * @return 1 if succeeds, 0 if sink fails.
+ */
+int json_encode_data_list_sink(DataList *list, strbuff_sink sink, void *sink_data)
+{
+	StringBuffer *sb = strbuff_new_sink(STRBUFF_SINK_SIZE, sink, sink_data);
+	int ret;
+
+	if (sb == NULL) {
+		return 0;
+	}
+
+	describe_data_list(list, sb);
+	ret = strbuff_flush(sb);
+	strbuff_del(sb);
+
+	return ret;
+}
+
+/**
+ * Converts data list elements into JSON notation, writing the
+ * document to a file descriptor.
+ *
+ * @param list of text data.
+ * @param fd file descriptor.
+ * @return 1 if succeeds, 0 if write fails.
+ */
+int json_encode_data_list_fd(DataList *list, int fd)
+{
+	return json_encode_data_list_sink(list, &strbuff_fd_sink, &fd);
+}
+
 /** @} */
@@ -31,8 +31,13 @@
 #define JSON_ENCODER_H_
 
 #include <api/api_definitions.h>
+#include <util/strbuff.h>
 
 char *json_encode_data_list(DataList *list);
 
+int json_encode_data_list_sink(DataList *list, strbuff_sink sink, void *sink_data);
+
+int json_encode_data_list_fd(DataList *list, int fd);
+
 
 #endif /* JSON_ENCODER_H_ */
@@ -32,8 +32,13 @@
 #define XML_ENCODER_H_
 
 #include <api/api_definitions.h>
+#include <util/strbuff.h>
 
 char *xml_encode_data_list(DataList *list);
 
+int xml_encode_data_list_sink(DataList *list, strbuff_sink sink, void *sink_data);
+
+int xml_encode_data_list_fd(DataList *list, int fd);
+
 
 #endif /* XML_ENCODER_H_ */
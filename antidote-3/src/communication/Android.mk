@@ -16,6 +16,7 @@ LOCAL_SRC_FILES = \
                    service.c \
                    operating.c \
                    stdconfigurations.c \
+                   event_report_template.c \
                    context_manager.c
 
 LOCAL_MODULE:= libantidotecomm
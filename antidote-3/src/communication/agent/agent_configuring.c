@@ -237,7 +237,7 @@ void configuring_send_config_tx(Context *ctx, fsm_events evt,
 	DEBUG("Sending configuration since manager does not know it");
 
 	ConfigObjectList *cfg =
-		std_configurations_get_configuration_attributes(
+		std_configurations_get_shared_configuration(
 				      		agent_configuration()->config);
 
 	data->invoke_id = 0; // filled by service_* call
@@ -275,9 +275,6 @@ void configuring_send_config_tx(Context *ctx, fsm_events evt,
 
 	// takes ownership of apdu and prst.value
 	service_send_remote_operation_request(ctx, apdu, tm, NULL);
-
-	del_configobjectlist(cfg);
-	free(cfg);
 }
 
 /** @} */
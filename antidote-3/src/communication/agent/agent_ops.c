@@ -173,7 +173,7 @@ void communication_agent_send_event_tx(FSMContext *ctx, fsm_events evt, FSMEvent
 	}
 
 	void *evtreport = agent_configuration()->event_report_cb();
-	data = cfg->event_report(evtreport);
+	data = cfg->event_report(cfg, evtreport);
 	free(evtreport);
 
 	// prst = length + DATA_apdu
@@ -211,7 +211,7 @@ void association_agent_mds(FSMContext *ctx, fsm_events evt, FSMEventData *data)
 	}
 
 	ConfigId spec = agent_configuration()->config;
-	ConfigObjectList *cfg = std_configurations_get_configuration_attributes(spec);
+	ConfigObjectList *cfg = std_configurations_get_shared_configuration(spec);
 
 	MDS *mds = mds_create();
 	ctx->mds = mds;
@@ -227,10 +227,9 @@ void association_agent_mds(FSMContext *ctx, fsm_events evt, FSMEventData *data)
 	mds->system_id.value = (intu8*) malloc(mds->system_id.length);
 	memcpy(mds->system_id.value, &mds_data->system_id, mds->system_id.length);
 
-	mds_configure_operating(ctx, cfg, 0);
+	mds_configure_operating_shared(ctx, cfg, 0);
 
 	free(mds_data);
-	free(cfg);
 }
 
 /**
@@ -36,10 +36,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "src/manager_p.h"
 #include "src/agent_p.h"
 #include "src/trans/trans.h"
 #include "src/communication/common/context_manager.h"
+#include "src/communication/common/scheduler.h"
 #include "src/communication/common/communication.h"
 
 #include "src/communication/agent/agent_association.h"
@@ -54,6 +56,7 @@
 #include "src/communication/plugin/plugin.h"
 #include "src/communication/common/service.h"
 #include "src/util/bytelib.h"
+#include "src/util/txpool.h"
 #include "src/communication/parser/encoder_ASN1.h"
 #include "src/communication/parser/decoder_ASN1.h"
 #include "src/communication/parser/struct_cleaner.h"
@@ -268,6 +271,7 @@ void communication_finalize()
 	// Reset all timeouts
 
 	// Finalizes all threads in execution
+	scheduler_stop();
 
 	if (communication_is_network_started()) {
 		for (i = 1; i <= plugin_count; ++i) {
@@ -433,6 +437,9 @@ int communication_network_stop()
 
 	unsigned int i;
 
+	// no context may be running in a worker while plug-ins go down
+	scheduler_stop();
+
 	for (i = 1; i <= plugin_count; ++i) {
 		CommunicationPlugin *comm_plugin = comm_plugins[i];
 		if (comm_plugin->network_finalize() != NETWORK_ERROR_NONE) {
@@ -543,34 +550,6 @@ void communication_unlock(Context *ctx)
 	comm_plugin->thread_unlock(ctx);
 }
 
-/**
- * Locks global mutex
- */
-void gil_lock()
-{
-	if (plugin_count > 0) {
-		// gets the first plug-in (in a multithreaded
-		// environment, all plugins must implement 
-		// thread locking)
-		CommunicationPlugin *comm_plugin = comm_plugins[1];
-		comm_plugin->thread_lock(0);
-	}
-}
-
-/**
- * Unlocks global mutex
- */
-void gil_unlock()
-{
-	if (plugin_count > 0) {
-		// gets the first plug-in (in a multithreaded
-		// environment, all plugins must implement 
-		// thread locking)
-		CommunicationPlugin *comm_plugin = comm_plugins[1];
-		comm_plugin->thread_unlock(0);
-	}
-}
-
 /**
  * Wait for data input from network.
  */
@@ -589,14 +568,38 @@ int communication_wait_for_data_input(Context *ctx)
  * Reads APDU from transport layer stream
  *
  * @param id connection context
+ * @return 1 if an APDU was read and processed, 0 if not
  */
-void communication_read_input_stream(ContextId id)
+int communication_read_input_stream(ContextId id)
 {
+	int ret = 0;
 	Context *ctx = context_get_and_lock(id);
 	if (ctx != NULL) {
-		communication_process_input_data(ctx, communication_get_apdu_stream(ctx));
+		ByteStreamReader *stream = communication_get_apdu_stream(ctx);
+		ret = (stream != NULL);
+		communication_process_input_data(ctx, stream);
 		context_unlock(ctx);
 	}
+	return ret;
+}
+
+/**
+ * Gives a processed stream back to the plug-in that produced it,
+ * or frees it if the plug-in does not recycle streams.
+ *
+ * @param ctx connection context
+ * @param stream processed stream
+ */
+static void communication_release_apdu_stream(Context *ctx, ByteStreamReader *stream)
+{
+	CommunicationPlugin *comm_plugin =
+		communication_get_plugin(ctx->id.plugin);
+
+	if (comm_plugin && comm_plugin->network_release_apdu_stream) {
+		comm_plugin->network_release_apdu_stream(ctx, stream);
+	} else {
+		del_byte_stream_reader(stream, 1);
+	}
 }
 
 /**
@@ -667,29 +670,81 @@ void communication_process_input_data(Context *ctx, ByteStreamReader *stream)
 		        // Decode the APDU
 		        APDU apdu;
 		        DEBUG("\n[Standard Msg]\n");
-		        decode_apdu(stream, &apdu, &error);
+
+		        if (ctx->apdu_arena == NULL) {
+			        ctx->apdu_arena = arena_new();
+
+			        if (ctx->apdu_arena == NULL) {
+				        ERROR("cannot allocate APDU arena");
+				        communication_release_apdu_stream(ctx, stream);
+				        return;
+			        }
+		        }
+
+		        decode_apdu_arena(stream, &apdu, ctx->apdu_arena, &error);
 		        if (error) {
 			        DEBUG("Invalid APDU, firing abort");
+			        arena_reset(ctx->apdu_arena);
 			        communication_fire_evt(ctx, fsm_evt_req_assoc_abort, NULL);
+			        communication_release_apdu_stream(ctx, stream);
 			        return;
 		        }
 
 		        // Process APDU
 		        communication_process_apdu(ctx, &apdu);
 
-		        // Delete APDU
-				// AB: Do not delete the PDU
-				//del_apdu(&apdu);
+		        // Delete APDU, the whole decoded tree at once
+		        arena_reset(ctx->apdu_arena);
 #ifdef USE_REQ_MSG
 			}
 #endif
 
 
-		del_byte_stream_reader(stream, 1);
+		communication_release_apdu_stream(ctx, stream);
 	}
 }
 
 
+/**
+ * Keeps a copy of the APDU being processed as last_apdu. The received
+ * APDU borrows the reception buffer, so it is encoded again and the
+ * copy is decoded into an arena of its own; the previously kept APDU
+ * is released.
+ *
+ * @param ctx connection context
+ * @param apdu APDU decoded by communication_process_input_data()
+ */
+void communication_keep_last_apdu(Context *ctx, APDU *apdu)
+{
+	static Arena *last_apdu_arena = NULL;
+	int error = 0;
+
+	arena_del(last_apdu_arena);
+	last_apdu_arena = arena_new();
+
+	ByteStreamWriter *writer = byte_stream_writer_instance(apdu->length + 4);
+
+	if (last_apdu_arena == NULL || writer == NULL) {
+		ERROR("cannot keep APDU");
+		del_byte_stream_writer(writer, 1);
+		return;
+	}
+
+	encode_apdu(writer, apdu);
+
+	intu8 *buffer = arena_alloc(last_apdu_arena, writer->size);
+
+	if (buffer != NULL) {
+		ByteStreamReader reader;
+
+		memcpy(buffer, writer->buffer, writer->size);
+		byte_stream_reader_init(&reader, buffer, writer->size);
+		decode_apdu_arena(&reader, &last_apdu, last_apdu_arena, &error);
+	}
+
+	del_byte_stream_writer(writer, 1);
+}
+
 /**
  * Get received APDU stream.
  */
@@ -851,8 +906,23 @@ int communication_send_apdu(Context *ctx, APDU *apdu)
 
 	DEBUG(" communication: sending APDU ");
 
+	if (ctx->tx_pool == NULL) {
+		ctx->tx_pool = txpool_new();
+	}
+
+	// size first, so the pooled writer never grows while encoding
+	intu32 size = encoded_size_apdu(apdu);
 	ByteStreamWriter *encoded_apdu = NULL;
-	encoded_apdu = byte_stream_writer_instance(apdu->length + 4/*apdu header*/);
+
+	if (size > 0 && ctx->tx_pool != NULL) {
+		encoded_apdu = txpool_get(ctx->tx_pool, size);
+	}
+
+	if (encoded_apdu == NULL) {
+		ERROR(" communication: cannot encode APDU");
+		communication_unlock(ctx);
+		return 0;
+	}
 
 	encode_apdu(encoded_apdu, apdu);
 
@@ -865,7 +935,7 @@ int communication_send_apdu(Context *ctx, APDU *apdu)
 	// send encoded_apdu bytes
 	int return_val = comm_plugin->network_send_apdu_stream(ctx, encoded_apdu);
 
-	del_byte_stream_writer(encoded_apdu, 1);
+	txpool_release(ctx->tx_pool, encoded_apdu);
 
 	DEBUG(" communication: APDU sent ");
 	communication_unlock(ctx);
@@ -89,15 +89,14 @@ Context *communication_transport_connect_indication(ContextId id, const char *ad
 
 void communication_transport_disconnect_indication(ContextId id, const char *addr);
 
-void gil_lock();
-void gil_unlock();
-
 int communication_wait_for_data_input(Context *ctx);
 
-void communication_read_input_stream(ContextId id);
+int communication_read_input_stream(ContextId id);
 
 void communication_process_input_data(Context *ctx, ByteStreamReader *stream);
 
+void communication_keep_last_apdu(Context *ctx, APDU *apdu);
+
 void communication_timeout(Context *ctx);
 
 ByteStreamReader *communication_get_apdu_stream(Context *ctx);
@@ -129,10 +129,25 @@ typedef struct Context {
 	timeout_callback timeout_action;
 
 	/**
-	 * Reference count
+	 * Reference count, only changed atomically by context manager
 	 */
 	int ref;
 
+	/**
+	 * Input scheduling state, only changed atomically by scheduler
+	 */
+	int input_state;
+
+	/**
+	 * Owns the structures decoded from the APDU being processed
+	 */
+	struct Arena *apdu_arena;
+
+	/**
+	 * Output writers reused by outgoing APDUs
+	 */
+	struct TxPool *tx_pool;
+
 } Context;
 
 #define MANAGER_CONTEXT 1
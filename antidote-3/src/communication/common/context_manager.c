@@ -37,6 +37,12 @@
  * Multiple contexts are necessary to execute multiple connections to various
  *  devices.
  *
+ * Contexts are kept in a hash table keyed by ContextId. Every bucket
+ * has its own read-write lock, held only while the bucket list is
+ * searched or changed; lookups never wait for each other nor for a
+ * context lock held by another connection. Context lifetime is
+ * controlled by an atomic reference count.
+ *
  * @{
  */
 
@@ -46,13 +52,98 @@
 #include "context_manager.h"
 #include "src/util/log.h"
 #include "src/util/linkedlist.h"
+#include "src/util/arena.h"
+#include "src/util/txpool.h"
 #include <stdlib.h>
+#include <pthread.h>
+
+/**
+ * Number of buckets of context table (must be a power of 2).
+ * Each bucket has its own lock, so changes to contexts in
+ * different buckets do not contend.
+ */
+#define CONTEXT_BUCKETS 256
+
+/**
+ * Context table bucket
+ */
+typedef struct ContextBucket {
+	/**
+	 * Protects list; lookups take it shared
+	 */
+	pthread_rwlock_t lock;
+
+	/**
+	 * Contexts whose id hashes to this bucket
+	 */
+	LinkedList *list;
+} ContextBucket;
+
+/**
+ * Context table, indexed by hash of ContextId.
+ */
+static ContextBucket context_table[CONTEXT_BUCKETS];
+
+/**
+ * Guards one-time initialization of context table
+ */
+static pthread_once_t context_table_once = PTHREAD_ONCE_INIT;
 
 /**
- * List of the context.
+ * Initializes bucket locks and lists
  */
-static LinkedList *context_list = NULL;
+static void context_table_init()
+{
+	int i;
 
+	for (i = 0; i < CONTEXT_BUCKETS; ++i) {
+		pthread_rwlock_init(&context_table[i].lock, NULL);
+		context_table[i].list = llist_new();
+	}
+}
+
+/**
+ * @brief Gets the bucket where given context id lives.
+ *
+ * @param id context id
+ * @return bucket pointer
+ */
+static ContextBucket *context_bucket(ContextId id)
+{
+	unsigned long long key = id.connid ^ ((unsigned long long) id.plugin << 56);
+
+	pthread_once(&context_table_once, &context_table_init);
+
+	// mix high and low bits, so both sequential connids and
+	// connids carrying a generation in upper bits spread well
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+
+	return &context_table[key & (CONTEXT_BUCKETS - 1)];
+}
+
+/**
+ * @brief Takes a reference to context.
+ *
+ * @param ctx context
+ * @return new reference count
+ */
+static int context_ref(Context *ctx)
+{
+	return __sync_add_and_fetch(&ctx->ref, 1);
+}
+
+/**
+ * @brief Drops a reference to context.
+ *
+ * @param ctx context
+ * @return new reference count
+ */
+static int context_unref(Context *ctx)
+{
+	return __sync_sub_and_fetch(&ctx->ref, 1);
+}
 
 /**
  * @brief Destroys the given context.
@@ -87,6 +178,12 @@ static int destroy_context(Context *context)
 			communication_finalize_thread_context(context);
 		}
 
+		arena_del(context->apdu_arena);
+		context->apdu_arena = NULL;
+
+		txpool_del(context->tx_pool);
+		context->tx_pool = NULL;
+
 		free(context);
 	}
 
@@ -125,9 +222,7 @@ static int context_search_by_id(void *arg, void *element)
  */
 Context *context_create(ContextId id, int type)
 {
-	if (context_list == NULL) {
-		context_list = llist_new();
-	}
+	ContextBucket *bucket = context_bucket(id);
 
 	// Remove from list if exists any previous
 	context_remove(id);
@@ -151,9 +246,9 @@ Context *context_create(ContextId id, int type)
 	context->id = id;
 	context->ref = 1; // reference from list
 
-	gil_lock();
-	llist_add(context_list, context);
-	gil_unlock();
+	pthread_rwlock_wrlock(&bucket->lock);
+	llist_add(bucket->list, context);
+	pthread_rwlock_unlock(&bucket->lock);
 
 	DEBUG("Created context id %u:%llu", context->id.plugin, context->id.connid);
 
@@ -167,24 +262,27 @@ Context *context_create(ContextId id, int type)
  */
 void context_remove(ContextId id)
 {
+	ContextBucket *bucket = context_bucket(id);
+
 	DEBUG("Removing context %u:%llu", id.plugin, id.connid);
 
-	// grab context and remove from list atomically
-	gil_lock();
+	pthread_rwlock_wrlock(&bucket->lock);
 
-	Context *context = context_get_and_lock(id);
+	Context *context = (Context *) llist_search_first(bucket->list, &id,
+			   &context_search_by_id);
 	if (!context) {
-		gil_unlock();
+		pthread_rwlock_unlock(&bucket->lock);
 		return;
 	}
 
-	llist_remove(context_list, context);
-
-	gil_unlock();
+	llist_remove(bucket->list, context);
 
-	--context->ref; // remove reference from list
+	pthread_rwlock_unlock(&bucket->lock);
 
-	context_unlock(context);
+	// remove reference from list; other holders keep it alive
+	if (context_unref(context) <= 0) {
+		destroy_context(context);
+	}
 }
 
 /**
@@ -192,28 +290,32 @@ void context_remove(ContextId id)
  */
 void context_remove_all()
 {
-	while (1) {
-		// make sure no one will mess the table while we
-		// get one context id to be destroyed
-		gil_lock();
-
-		if ((!context_list) || (context_list->size <= 0)) {
-			gil_unlock();
-			break;
-		}
-		Context *c = llist_get(context_list, 0);
-		ContextId id = c->id;
+	int i;
 
-		gil_unlock();
+	pthread_once(&context_table_once, &context_table_init);
 
-		// safely remove
-		context_remove(id);
-	}
+	for (i = 0; i < CONTEXT_BUCKETS; ++i) {
+		ContextBucket *bucket = &context_table[i];
+
+		while (1) {
+			// make sure no one will mess the bucket while we
+			// get one context id to be destroyed
+			pthread_rwlock_rdlock(&bucket->lock);
+
+			if (bucket->list->size <= 0) {
+				pthread_rwlock_unlock(&bucket->lock);
+				break;
+			}
 
-	gil_lock();
-	free(context_list);
-	context_list = NULL;
-	gil_unlock();
+			Context *c = llist_get(bucket->list, 0);
+			ContextId id = c->id;
+
+			pthread_rwlock_unlock(&bucket->lock);
+
+			// safely remove
+			context_remove(id);
+		}
+	}
 }
 
 /**
@@ -224,25 +326,28 @@ void context_remove_all()
  */
 Context *context_get_and_lock(ContextId id)
 {
-	gil_lock();
+	ContextBucket *bucket = context_bucket(id);
+
+	pthread_rwlock_rdlock(&bucket->lock);
 
-	Context *ctx = (Context *) llist_search_first(context_list, &id,
+	Context *ctx = (Context *) llist_search_first(bucket->list, &id,
 			&context_search_by_id);
 
 	if (ctx == NULL) {
 		WARNING("Cannot find context id %u:%llu", id.plugin, id.connid);
-		gil_unlock();
+		pthread_rwlock_unlock(&bucket->lock);
 		return ctx;
 	}
 
-	if (ctx) {
-		communication_lock(ctx);
-		++ctx->ref;
-		DEBUG("Context @%p %u:%llu addref to %d", ctx,
-			ctx->id.plugin, ctx->id.connid, ctx->ref);
-	}
+	// the reference keeps context alive after leaving the bucket,
+	// so the context lock is not awaited with the bucket locked
+	int ref = context_ref(ctx);
+
+	pthread_rwlock_unlock(&bucket->lock);
 
-	gil_unlock();
+	communication_lock(ctx);
+	DEBUG("Context @%p %u:%llu addref to %d", ctx,
+		ctx->id.plugin, ctx->id.connid, ref);
 
 	return ctx;
 }
@@ -255,19 +360,56 @@ Context *context_get_and_lock(ContextId id)
 void context_unlock(Context *ctx)
 {
 	if (ctx) {
-		--ctx->ref;
+		DEBUG("Context @%p %u:%llu unref", ctx,
+			ctx->id.plugin, ctx->id.connid);
 		communication_unlock(ctx);
-		DEBUG("Context @%p %u:%llu unref to %d", ctx,
-			ctx->id.plugin, ctx->id.connid, ctx->ref);
-		// if ref=0, it is not on the list, so
-		// nobody has ownership and nobody will find it
-		// between unlocking and destruction
-		if (ctx->ref <= 0) {
+		// references are dropped without the context lock held,
+		// so whoever drops the last one can destroy it right away
+		if (context_unref(ctx) <= 0) {
 			destroy_context(ctx);
 		}
 	}
 }
 
+/**
+ * @brief Get execution context without locking it.
+ *
+ * The context stays valid until context_release() is called,
+ * but it must be locked before its state is touched.
+ *
+ * @param id Context ID
+ * @return pointer to context struct or NULL if cannot find.
+ */
+Context *context_get(ContextId id)
+{
+	ContextBucket *bucket = context_bucket(id);
+
+	pthread_rwlock_rdlock(&bucket->lock);
+
+	Context *ctx = (Context *) llist_search_first(bucket->list, &id,
+			&context_search_by_id);
+
+	if (ctx != NULL) {
+		context_ref(ctx);
+	}
+
+	pthread_rwlock_unlock(&bucket->lock);
+
+	return ctx;
+}
+
+/**
+ * @brief Drops reference taken by context_get()
+ *
+ * @param ctx Context pointer
+ */
+void context_release(Context *ctx)
+{
+	if (ctx && context_unref(ctx) <= 0) {
+		destroy_context(ctx);
+	}
+}
+
 /**
  * @brief Iterate over all contexts and call context_handle for each one.
  *
@@ -275,7 +417,46 @@ void context_unlock(Context *ctx)
  */
 void context_iterate(context_handle function)
 {
-	llist_iterate(context_list, (llist_handle_element) function);
+	int i;
+	int proceed = 1;
+
+	pthread_once(&context_table_once, &context_table_init);
+
+	for (i = 0; i < CONTEXT_BUCKETS && proceed; ++i) {
+		ContextBucket *bucket = &context_table[i];
+		Context **snapshot = NULL;
+		int count = 0;
+		int j;
+
+		// function may lock contexts or change the table,
+		// so it is called on a referenced copy of the bucket
+		pthread_rwlock_rdlock(&bucket->lock);
+
+		if (bucket->list->size > 0) {
+			snapshot = malloc(bucket->list->size * sizeof(Context *));
+		}
+
+		if (snapshot != NULL) {
+			LinkedNode *node;
+
+			for (node = bucket->list->first; node; node = node->next) {
+				snapshot[count] = node->element;
+				context_ref(snapshot[count++]);
+			}
+		}
+
+		pthread_rwlock_unlock(&bucket->lock);
+
+		for (j = 0; j < count; ++j) {
+			if (proceed) {
+				proceed = (function)(snapshot[j]);
+			}
+
+			context_release(snapshot[j]);
+		}
+
+		free(snapshot);
+	}
 }
 
 /** @} */
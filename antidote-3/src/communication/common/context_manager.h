@@ -44,6 +44,8 @@ void context_remove(ContextId id);
 void context_remove_all();
 Context *context_get_and_lock(ContextId id);
 void context_unlock(Context *ctx);
+Context *context_get(ContextId id);
+void context_release(Context *ctx);
 void context_iterate(context_handle function);
 
 #endif /* CONTEXT_MANAGER_H_ */
@@ -0,0 +1,261 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file event_report_template.c
+ * \brief Pre-encoded agent event report implementation.
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ *
+ */
+
+/**
+ * \addtogroup EventReportTemplate
+ *
+ * @{
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "src/communication/common/event_report_template.h"
+#include "src/communication/parser/encoder_ASN1.h"
+#include "src/dim/mds.h"
+#include "src/dim/nomenclature.h"
+#include "src/util/log.h"
+
+/**
+ * Octets of EventReportArgumentSimple that precede the event info:
+ * obj_handle, event_time, event_type and event_info length
+ */
+#define EVENT_REPORT_HEADER_SIZE 10
+
+/**
+ * Creates an empty fixed format scan report template. Add observations
+ * and their values in the order they are encoded, then call
+ * event_report_template_finish().
+ *
+ * @param choice ROIV_CMIP_EVENT_REPORT_CHOSEN or ROIV_CMIP_CONFIRMED_EVENT_REPORT_CHOSEN
+ * @return the template
+ */
+EventReportTemplate *event_report_template_new(DATA_apdu_choice choice)
+{
+	EventReportTemplate *tmpl = calloc(1, sizeof(EventReportTemplate));
+
+	tmpl->choice = choice;
+	tmpl->event_info = open_stream_writer(64);
+	tmpl->observation_length = -1;
+
+	// ScanReportInfoFixed
+	write_intu16(tmpl->event_info, 0xF000); // data_req_id
+	write_intu16(tmpl->event_info, 0); // scan_report_no
+	reserve_intu16(tmpl->event_info, &tmpl->list_count);
+	reserve_intu16(tmpl->event_info, &tmpl->list_length);
+
+	return tmpl;
+}
+
+/**
+ * Closes the observation being added, if any, filling its length
+ *
+ * @param tmpl the template
+ */
+static void close_observation(EventReportTemplate *tmpl)
+{
+	if (tmpl->observation_length < 0) {
+		return;
+	}
+
+	commit_intu16(tmpl->event_info, tmpl->observation_length,
+		      tmpl->event_info->size - tmpl->observation_length - 2);
+	tmpl->observation_length = -1;
+}
+
+/**
+ * Records a patch point at the current end of the event info
+ *
+ * @param tmpl the template
+ * @param type how the value is encoded
+ * @param value index of the value given to event_report_template_fill()
+ */
+static void add_field(EventReportTemplate *tmpl, EventReportFieldType type, int value)
+{
+	tmpl->fields = realloc(tmpl->fields,
+			       (tmpl->fields_count + 1) * sizeof(EventReportField));
+
+	EventReportField *field = &tmpl->fields[tmpl->fields_count++];
+	field->type = type;
+	field->offset = tmpl->event_info->size;
+	field->value = value;
+}
+
+/**
+ * Starts a new ObservationScanFixed in the template
+ *
+ * @param tmpl the template
+ * @param obj_handle handle of the observed object
+ */
+void event_report_template_add_observation(EventReportTemplate *tmpl, ASN1_HANDLE obj_handle)
+{
+	close_observation(tmpl);
+
+	write_intu16(tmpl->event_info, obj_handle);
+	reserve_intu16(tmpl->event_info, &tmpl->observation_length);
+	tmpl->observations++;
+}
+
+/**
+ * Adds a BasicNuObsValue to the current observation
+ *
+ * @param tmpl the template
+ * @param value index of the value given to event_report_template_fill()
+ */
+void event_report_template_add_sfloat(EventReportTemplate *tmpl, int value)
+{
+	add_field(tmpl, EVENT_REPORT_FIELD_SFLOAT, value);
+	write_intu16(tmpl->event_info, 0);
+}
+
+/**
+ * Adds a BasicNuObsValueCmp to the current observation
+ *
+ * @param tmpl the template
+ * @param first_value index of the first value given to event_report_template_fill()
+ * @param count number of compound values
+ */
+void event_report_template_add_sfloat_cmp(EventReportTemplate *tmpl, int first_value, int count)
+{
+	int i;
+
+	write_intu16(tmpl->event_info, count);
+	write_intu16(tmpl->event_info, count * 2);
+
+	for (i = 0; i < count; ++i) {
+		event_report_template_add_sfloat(tmpl, first_value + i);
+	}
+}
+
+/**
+ * Adds a SimpleNuObsValue to the current observation
+ *
+ * @param tmpl the template
+ * @param value index of the value given to event_report_template_fill()
+ */
+void event_report_template_add_float(EventReportTemplate *tmpl, int value)
+{
+	add_field(tmpl, EVENT_REPORT_FIELD_FLOAT, value);
+	write_intu32(tmpl->event_info, 0);
+}
+
+/**
+ * Adds an AbsoluteTime time stamp to the current observation
+ *
+ * @param tmpl the template
+ */
+void event_report_template_add_absolute_time(EventReportTemplate *tmpl)
+{
+	add_field(tmpl, EVENT_REPORT_FIELD_ABSOLUTE_TIME, -1);
+	write_intu32(tmpl->event_info, 0);
+	write_intu32(tmpl->event_info, 0);
+}
+
+/**
+ * Fills the observation count and lengths. The template must not be
+ * changed afterwards.
+ *
+ * @param tmpl the template
+ */
+void event_report_template_finish(EventReportTemplate *tmpl)
+{
+	close_observation(tmpl);
+
+	commit_intu16(tmpl->event_info, tmpl->list_count, tmpl->observations);
+	commit_intu16(tmpl->event_info, tmpl->list_length,
+		      tmpl->event_info->size - tmpl->list_length - 2);
+}
+
+/**
+ * Builds an event report from the template. The encoded event info is
+ * copied and the values stored at the patch points, nothing else is
+ * encoded. Templates are read-only here, so any thread may fill them.
+ *
+ * @param tmpl the template
+ * @param values measurement values, indexed as given to the add functions
+ * @param time time stamp of all observations
+ * @return DATA_apdu to be sent, invoke id is set by service layer
+ */
+DATA_apdu *event_report_template_fill(EventReportTemplate *tmpl, FLOAT_Type *values,
+				      AbsoluteTime *time)
+{
+	DATA_apdu *data = calloc(1, sizeof(DATA_apdu));
+	EventReportArgumentSimple *evt = &data->message.u.roiv_cmipEventReport;
+	intu16 length = tmpl->event_info->size;
+	int i;
+
+	// will be filled afterwards by service_* function
+	data->invoke_id = 0xffff;
+	data->message.choice = tmpl->choice;
+	data->message.length = length + EVENT_REPORT_HEADER_SIZE;
+
+	evt->obj_handle = MDS_HANDLE;
+	evt->event_time = 0xFFFFFFFF;
+	evt->event_type = MDC_NOTI_SCAN_REPORT_FIXED;
+	evt->event_info.length = length;
+	evt->event_info.value = malloc(length);
+	memcpy(evt->event_info.value, tmpl->event_info->buffer, length);
+
+	for (i = 0; i < tmpl->fields_count; ++i) {
+		EventReportField *field = &tmpl->fields[i];
+		ByteStreamWriter patch;
+
+		byte_stream_writer_init(&patch, evt->event_info.value + field->offset,
+					length - field->offset);
+
+		switch (field->type) {
+		case EVENT_REPORT_FIELD_SFLOAT:
+			write_sfloat(&patch, values[field->value]);
+			break;
+		case EVENT_REPORT_FIELD_FLOAT:
+			write_float(&patch, values[field->value]);
+			break;
+		case EVENT_REPORT_FIELD_ABSOLUTE_TIME:
+			encode_absolutetime(&patch, time);
+			break;
+		}
+	}
+
+	return data;
+}
+
+/**
+ * Releases the template
+ *
+ * @param tmpl the template
+ */
+void event_report_template_destroy(EventReportTemplate *tmpl)
+{
+	if (tmpl == NULL) {
+		return;
+	}
+
+	del_byte_stream_writer(tmpl->event_info, 1);
+	free(tmpl->fields);
+	free(tmpl);
+}
+
+/** @} */
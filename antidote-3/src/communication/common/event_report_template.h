@@ -0,0 +1,136 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file event_report_template.h
+ * \brief Pre-encoded agent event report header.
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ *
+ */
+
+/**
+ * \defgroup EventReportTemplate Event Report Template
+ * \ingroup Standard Configurations
+ *
+ * @{
+ */
+
+#ifndef EVENT_REPORT_TEMPLATE_H_
+#define EVENT_REPORT_TEMPLATE_H_
+
+#include <asn1/phd_types.h>
+#include <util/bytelib.h>
+
+/**
+ * Kind of value patched into an event report template
+ */
+typedef enum {
+	EVENT_REPORT_FIELD_SFLOAT,
+	EVENT_REPORT_FIELD_FLOAT,
+	EVENT_REPORT_FIELD_ABSOLUTE_TIME
+} EventReportFieldType;
+
+/**
+ * Patch point of an event report template
+ */
+typedef struct EventReportField {
+	/**
+	 * How the value is encoded
+	 */
+	EventReportFieldType type;
+
+	/**
+	 * Octet offset of the value inside the encoded event info
+	 */
+	intu16 offset;
+
+	/**
+	 * Index of the value in the array given to event_report_template_fill(),
+	 * unused for timestamps
+	 */
+	int value;
+} EventReportField;
+
+/**
+ * Fixed format scan report of a standard configuration, encoded once.
+ * Layout and lengths never change for a given configuration, so each
+ * report only copies the encoded event info and stores the values at
+ * the patch points.
+ */
+typedef struct EventReportTemplate {
+	/**
+	 * ROIV_CMIP_EVENT_REPORT_CHOSEN or ROIV_CMIP_CONFIRMED_EVENT_REPORT_CHOSEN
+	 */
+	DATA_apdu_choice choice;
+
+	/**
+	 * Encoded ScanReportInfoFixed, values zeroed
+	 */
+	ByteStreamWriter *event_info;
+
+	/**
+	 * Patch points, in encoding order
+	 */
+	EventReportField *fields;
+
+	/**
+	 * Number of patch points
+	 */
+	int fields_count;
+
+	/**
+	 * Number of observations added so far
+	 */
+	int observations;
+
+	/**
+	 * Reserved positions of the observation list count and length
+	 */
+	int list_count;
+	int list_length;
+
+	/**
+	 * Reserved position of the current observation length
+	 */
+	int observation_length;
+} EventReportTemplate;
+
+EventReportTemplate *event_report_template_new(DATA_apdu_choice choice);
+
+void event_report_template_add_observation(EventReportTemplate *tmpl, ASN1_HANDLE obj_handle);
+
+void event_report_template_add_sfloat(EventReportTemplate *tmpl, int value);
+
+void event_report_template_add_sfloat_cmp(EventReportTemplate *tmpl, int first_value, int count);
+
+void event_report_template_add_float(EventReportTemplate *tmpl, int value);
+
+void event_report_template_add_absolute_time(EventReportTemplate *tmpl);
+
+void event_report_template_finish(EventReportTemplate *tmpl);
+
+DATA_apdu *event_report_template_fill(EventReportTemplate *tmpl, FLOAT_Type *values,
+				      AbsoluteTime *time);
+
+void event_report_template_destroy(EventReportTemplate *tmpl);
+
+/** @} */
+
+#endif /* EVENT_REPORT_TEMPLATE_H_ */
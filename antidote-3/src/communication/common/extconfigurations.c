@@ -37,12 +37,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <pthread.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include "src/util/bytelib.h"
 #include "src/communication/parser/encoder_ASN1.h"
 #include "src/communication/parser/decoder_ASN1.h"
-#include "src/util/bytelib.h"
 #include "src/communication/parser/struct_cleaner.h"
 #include "src/communication/common/communication.h"
 #include "src/util/ioutil.h"
@@ -54,6 +54,16 @@
  */
 #define EXT_CONFIG_FILE "config_list.bin"
 
+/**
+ * Initial number of buckets of the configuration index
+ */
+#define EXT_CONFIG_BUCKETS 64
+
+/**
+ * Maximum number of decoded configurations kept in memory
+ */
+#define EXT_CONFIG_LRU_SIZE 64
+
 /**
  * Extended configuration structure.
  * The index file is an encoded array of this struct.
@@ -73,21 +83,140 @@ struct ExtConfig {
 	 * The index only knows (and checks) the size.
 	 */
 	intu16 obj_size;
+	/**
+	 * Hash of system id and config id
+	 */
+	unsigned int hash;
+	/**
+	 * Next configuration in the same index bucket
+	 */
+	struct ExtConfig *next;
+	/**
+	 * Decoded configuration, NULL if not cached
+	 */
+	ConfigObjectList *decoded;
+	/**
+	 * Encoded configuration not written to disk yet, owned by
+	 * the write queue
+	 */
+	ByteStreamWriter *pending;
+	/**
+	 * More recently used cached configuration
+	 */
+	struct ExtConfig *lru_prev;
+	/**
+	 * Less recently used cached configuration
+	 */
+	struct ExtConfig *lru_next;
 };
 
 /**
- * List of extended configurations in memory
+ * Pending write of a configuration file
+ */
+struct ExtConfigWrite {
+	/**
+	 * System ID of device (copy)
+	 */
+	octet_string system_id;
+	/**
+	 * Configuration ID
+	 */
+	ConfigId config_id;
+	/**
+	 * Encoded configuration
+	 */
+	ByteStreamWriter *stream;
+	/**
+	 * Configuration must also be appended to index file
+	 */
+	int new;
+	/**
+	 * Next write in queue
+	 */
+	struct ExtConfigWrite *next;
+};
+
+/**
+ * Hash index of extended configurations in memory.
  * Loaded from index file at startup
  */
-static struct ExtConfig *ext_configuration_list = NULL;
+static struct ExtConfig **ext_configuration_index = NULL;
 
-// TODO use a LinkedList
+/**
+ * Number of buckets of extended configuration index
+ */
+static int ext_configuration_buckets = 0;
 
 /**
- * Size of extended configuration list in memory
+ * Number of extended configurations in memory
  */
 static int ext_configuration_size = 0;
 
+/**
+ * Tells whether index file was loaded
+ */
+static int ext_configuration_loaded = 0;
+
+/**
+ * Most recently used decoded configuration
+ */
+static struct ExtConfig *ext_lru_head = NULL;
+
+/**
+ * Least recently used decoded configuration
+ */
+static struct ExtConfig *ext_lru_tail = NULL;
+
+/**
+ * Number of decoded configurations in memory
+ */
+static int ext_lru_count = 0;
+
+/**
+ * First pending file write
+ */
+static struct ExtConfigWrite *ext_write_head = NULL;
+
+/**
+ * Last pending file write
+ */
+static struct ExtConfigWrite *ext_write_tail = NULL;
+
+/**
+ * Tells whether writer thread is writing a file
+ */
+static int ext_write_busy = 0;
+
+/**
+ * Tells whether writer thread was started
+ */
+static int ext_writer_started = 0;
+
+/**
+ * Tells writer thread to keep waiting for writes
+ */
+static int ext_writer_running = 0;
+
+/**
+ * Writer thread
+ */
+static pthread_t ext_writer_thread;
+
+/**
+ * Protects extended configuration index, cache and write queue
+ */
+static pthread_mutex_t ext_configuration_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Wakes up writer thread
+ */
+static pthread_cond_t ext_write_cond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * Signals that a queued write has finished
+ */
+static pthread_cond_t ext_write_done_cond = PTHREAD_COND_INITIALIZER;
+
 static char *ext_configurations_get_file_name(octet_string *system_id,
 		ConfigId config_id);
 
@@ -183,25 +312,461 @@ static char *ext_configurations_get_file_name(octet_string *system_id,
 }
 
 /**
- * This method destroys the list of available settings but maintains
- * persistent data for later use.
+ * Copies a system id to the heap
+ *
+ * @param dest copy
+ * @param src system id
  */
-void ext_configurations_destroy()
+static void ext_configurations_copy_system_id(octet_string *dest,
+					      octet_string *src)
+{
+	dest->length = src->length;
+	dest->value = NULL;
+
+	if (src->length > 0) {
+		dest->value = malloc(src->length);
+		memcpy(dest->value, src->value, src->length);
+	}
+}
+
+/**
+ * Makes a deep copy of a configuration object list, so the
+ * caller may take ownership of it
+ *
+ * @param list configuration object list
+ * @return heap-allocated copy
+ */
+static ConfigObjectList *ext_configurations_copy_list(ConfigObjectList *list)
+{
+	ConfigObjectList *copy = calloc(1, sizeof(ConfigObjectList));
+	int i;
+	int j;
+
+	copy->count = list->count;
+	copy->length = list->length;
+
+	if (list->count == 0) {
+		return copy;
+	}
+
+	copy->value = calloc(list->count, sizeof(ConfigObject));
+
+	for (i = 0; i < list->count; ++i) {
+		ConfigObject *obj = &list->value[i];
+		ConfigObject *obj_copy = &copy->value[i];
+
+		*obj_copy = *obj;
+
+		if (obj->attributes.count == 0) {
+			obj_copy->attributes.value = NULL;
+			continue;
+		}
+
+		obj_copy->attributes.value = calloc(obj->attributes.count,
+						    sizeof(AVA_Type));
+
+		for (j = 0; j < obj->attributes.count; ++j) {
+			AVA_Type *ava = &obj->attributes.value[j];
+			AVA_Type *ava_copy = &obj_copy->attributes.value[j];
+
+			ava_copy->attribute_id = ava->attribute_id;
+			ava_copy->attribute_value.length = ava->attribute_value.length;
+			ava_copy->attribute_value.value =
+				malloc(ava->attribute_value.length);
+			memcpy(ava_copy->attribute_value.value,
+			       ava->attribute_value.value,
+			       ava->attribute_value.length);
+		}
+	}
+
+	return copy;
+}
+
+/**
+ * Decodes an encoded configuration object list
+ *
+ * @param buffer encoded configuration
+ * @param size size of encoded configuration
+ * @return heap-allocated list, NULL if data is bad
+ */
+static ConfigObjectList *ext_configurations_decode_list(intu8 *buffer,
+							unsigned long size)
+{
+	ConfigObjectList *result = calloc(1, sizeof(ConfigObjectList));
+	ByteStreamReader stream;
+	int error = 0;
+
+	byte_stream_reader_init(&stream, buffer, size);
+	decode_configobjectlist(&stream, result, &error);
+
+	if (error) {
+		ERROR("ext_config_get: bad configuration data");
+		del_configobjectlist(result);
+		free(result);
+		result = NULL;
+	}
+
+	return result;
+}
+
+/**
+ * Hashes a system id/config id tuple
+ *
+ * @param system_id system id of device
+ * @param config_id id of extended configuration
+ * @return hash
+ */
+static unsigned int ext_configurations_hash(octet_string *system_id,
+					    ConfigId config_id)
+{
+	unsigned int hash = 2166136261u;
+	int i;
+
+	for (i = 0; i < system_id->length; ++i) {
+		hash = (hash ^ system_id->value[i]) * 16777619u;
+	}
+
+	hash = (hash ^ (config_id >> 8)) * 16777619u;
+	hash = (hash ^ (config_id & 0xff)) * 16777619u;
+
+	return hash;
+}
+
+/**
+ * Removes configuration from decoded cache, keeping its decoded list
+ * Must be called with ext_configuration_mutex held.
+ *
+ * @param cfg cached configuration
+ */
+static void ext_lru_unlink(struct ExtConfig *cfg)
+{
+	if (cfg->lru_prev) {
+		cfg->lru_prev->lru_next = cfg->lru_next;
+	} else {
+		ext_lru_head = cfg->lru_next;
+	}
+
+	if (cfg->lru_next) {
+		cfg->lru_next->lru_prev = cfg->lru_prev;
+	} else {
+		ext_lru_tail = cfg->lru_prev;
+	}
+
+	cfg->lru_prev = NULL;
+	cfg->lru_next = NULL;
+	--ext_lru_count;
+}
+
+/**
+ * Drops decoded list of configuration from cache.
+ * Must be called with ext_configuration_mutex held.
+ *
+ * @param cfg configuration
+ */
+static void ext_lru_drop(struct ExtConfig *cfg)
+{
+	if (cfg->decoded == NULL) {
+		return;
+	}
+
+	ext_lru_unlink(cfg);
+	del_configobjectlist(cfg->decoded);
+	free(cfg->decoded);
+	cfg->decoded = NULL;
+}
+
+/**
+ * Marks configuration as most recently used, caching the decoded
+ * list when given. The least recently used list is dropped when
+ * the cache is full.
+ * Must be called with ext_configuration_mutex held.
+ *
+ * @param cfg configuration
+ * @param decoded decoded list to be owned by cache, or NULL if
+ *        configuration is already cached
+ */
+static void ext_lru_touch(struct ExtConfig *cfg, ConfigObjectList *decoded)
+{
+	if (decoded != NULL) {
+		ext_lru_drop(cfg);
+		cfg->decoded = decoded;
+	} else {
+		ext_lru_unlink(cfg);
+	}
+
+	cfg->lru_next = ext_lru_head;
+
+	if (ext_lru_head) {
+		ext_lru_head->lru_prev = cfg;
+	} else {
+		ext_lru_tail = cfg;
+	}
+
+	ext_lru_head = cfg;
+	++ext_lru_count;
+
+	if (ext_lru_count > EXT_CONFIG_LRU_SIZE) {
+		ext_lru_drop(ext_lru_tail);
+	}
+}
+
+/**
+ * Finds configuration in index.
+ * Must be called with ext_configuration_mutex held.
+ *
+ * @param system_id System ID (device identification)
+ * @param config_id Extended configuration ID
+ * @return Extended configuration structure or NULL if not found
+ */
+static struct ExtConfig *ext_configurations_find(octet_string *system_id,
+						 ConfigId config_id)
+{
+	struct ExtConfig *cfg;
+	unsigned int hash;
+
+	if (ext_configuration_buckets == 0) {
+		return NULL;
+	}
+
+	hash = ext_configurations_hash(system_id, config_id);
+	cfg = ext_configuration_index[hash % ext_configuration_buckets];
+
+	for (; cfg != NULL; cfg = cfg->next) {
+		if (cfg->hash == hash && cfg->config_id == config_id
+		    && cfg->system_id.length == system_id->length
+		    && memcmp(cfg->system_id.value, system_id->value,
+			      system_id->length) == 0) {
+			return cfg;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Adds configuration to index, growing it if needed.
+ * Must be called with ext_configuration_mutex held.
+ *
+ * @param system_id System ID (device identification), copied
+ * @param config_id Extended configuration ID
+ * @param obj_size size of encoded configuration
+ * @return new configuration structure
+ */
+static struct ExtConfig *ext_configurations_insert(octet_string *system_id,
+		ConfigId config_id, intu16 obj_size)
+{
+	struct ExtConfig *cfg = calloc(1, sizeof(struct ExtConfig));
+	int bucket;
+
+	if (ext_configuration_size >= ext_configuration_buckets * 2) {
+		int buckets = ext_configuration_buckets * 2;
+		struct ExtConfig **index;
+		int i;
+
+		if (buckets == 0) {
+			buckets = EXT_CONFIG_BUCKETS;
+		}
+
+		index = calloc(buckets, sizeof(struct ExtConfig *));
+
+		for (i = 0; i < ext_configuration_buckets; ++i) {
+			struct ExtConfig *entry = ext_configuration_index[i];
+
+			while (entry != NULL) {
+				struct ExtConfig *next = entry->next;
+
+				entry->next = index[entry->hash % buckets];
+				index[entry->hash % buckets] = entry;
+				entry = next;
+			}
+		}
+
+		free(ext_configuration_index);
+		ext_configuration_index = index;
+		ext_configuration_buckets = buckets;
+	}
+
+	ext_configurations_copy_system_id(&cfg->system_id, system_id);
+	cfg->config_id = config_id;
+	cfg->obj_size = obj_size;
+	cfg->hash = ext_configurations_hash(system_id, config_id);
+
+	bucket = cfg->hash % ext_configuration_buckets;
+	cfg->next = ext_configuration_index[bucket];
+	ext_configuration_index[bucket] = cfg;
+	++ext_configuration_size;
+
+	return cfg;
+}
+
+/**
+ * Frees all configurations of index and decoded cache.
+ * Must be called with ext_configuration_mutex held.
+ */
+static void ext_configurations_clear()
+{
+	int i;
+
+	for (i = 0; i < ext_configuration_buckets; ++i) {
+		struct ExtConfig *cfg = ext_configuration_index[i];
+
+		while (cfg != NULL) {
+			struct ExtConfig *next = cfg->next;
+
+			ext_lru_drop(cfg);
+			del_octet_string(&cfg->system_id);
+			free(cfg);
+			cfg = next;
+		}
+	}
+
+	free(ext_configuration_index);
+	ext_configuration_index = NULL;
+	ext_configuration_buckets = 0;
+	ext_configuration_size = 0;
+}
+
+/**
+ * Writer thread main loop. Writes queued configurations to disk,
+ * so registering a configuration never waits for the filesystem.
+ *
+ * @param arg unused
+ * @return NULL
+ */
+static void *ext_configurations_writer(void *arg)
 {
-	gil_lock();
-	if (ext_configuration_list != NULL) {
-		int index;
+	pthread_mutex_lock(&ext_configuration_mutex);
+
+	while (1) {
+		while (ext_writer_running && ext_write_head == NULL) {
+			pthread_cond_wait(&ext_write_cond, &ext_configuration_mutex);
+		}
+
+		struct ExtConfigWrite *job = ext_write_head;
+
+		if (job == NULL) {
+			break;
+		}
+
+		ext_write_head = job->next;
+
+		if (ext_write_head == NULL) {
+			ext_write_tail = NULL;
+		}
+
+		ext_write_busy = 1;
+		pthread_mutex_unlock(&ext_configuration_mutex);
 
-		for (index = 0; index < ext_configuration_size; index++) {
-			del_octet_string(&ext_configuration_list[index].system_id);
+		ext_configurations_write_file(&job->system_id, job->config_id,
+					      job->stream, job->new);
+
+		pthread_mutex_lock(&ext_configuration_mutex);
+
+		struct ExtConfig *cfg = ext_configurations_find(&job->system_id,
+							job->config_id);
+
+		if (cfg != NULL && cfg->pending == job->stream) {
+			cfg->pending = NULL;
 		}
 
-		free(ext_configuration_list);
-		ext_configuration_list = NULL;
+		ext_write_busy = 0;
+		pthread_cond_broadcast(&ext_write_done_cond);
 
-		ext_configuration_size = 0;
+		del_octet_string(&job->system_id);
+		del_byte_stream_writer(job->stream, 1);
+		free(job);
 	}
-	gil_unlock();
+
+	pthread_mutex_unlock(&ext_configuration_mutex);
+
+	return NULL;
+}
+
+/**
+ * Queues configuration to be written to disk. Writes synchronously if
+ * writer thread cannot be started.
+ * Must be called with ext_configuration_mutex held.
+ *
+ * @param cfg configuration
+ * @param stream encoded configuration, owned by queue
+ * @param new If not 0, configuration is also appended to index file
+ */
+static void ext_configurations_queue_write(struct ExtConfig *cfg,
+		ByteStreamWriter *stream, int new)
+{
+	if (!ext_writer_started) {
+		ext_writer_running = 1;
+
+		if (pthread_create(&ext_writer_thread, NULL,
+				   ext_configurations_writer, NULL)) {
+			ERROR("ext config: cannot create writer thread");
+			ext_writer_running = 0;
+			ext_configurations_write_file(&cfg->system_id,
+						      cfg->config_id, stream, new);
+			del_byte_stream_writer(stream, 1);
+			return;
+		}
+
+		ext_writer_started = 1;
+	}
+
+	struct ExtConfigWrite *job = calloc(1, sizeof(struct ExtConfigWrite));
+
+	ext_configurations_copy_system_id(&job->system_id, &cfg->system_id);
+	job->config_id = cfg->config_id;
+	job->stream = stream;
+	job->new = new;
+
+	if (ext_write_tail) {
+		ext_write_tail->next = job;
+	} else {
+		ext_write_head = job;
+	}
+
+	ext_write_tail = job;
+	cfg->pending = stream;
+
+	pthread_cond_signal(&ext_write_cond);
+}
+
+/**
+ * Waits until all queued configurations are written to disk
+ */
+static void ext_configurations_flush()
+{
+	pthread_mutex_lock(&ext_configuration_mutex);
+
+	while (ext_write_head != NULL || ext_write_busy) {
+		pthread_cond_wait(&ext_write_done_cond, &ext_configuration_mutex);
+	}
+
+	pthread_mutex_unlock(&ext_configuration_mutex);
+}
+
+/**
+ * This method destroys the list of available settings but maintains
+ * persistent data for later use. Pending writes are completed first.
+ */
+void ext_configurations_destroy()
+{
+	int started;
+
+	pthread_mutex_lock(&ext_configuration_mutex);
+	started = ext_writer_started;
+	ext_writer_running = 0;
+	pthread_cond_broadcast(&ext_write_cond);
+	pthread_mutex_unlock(&ext_configuration_mutex);
+
+	// writer drains the queue before leaving
+	if (started) {
+		pthread_join(ext_writer_thread, NULL);
+	}
+
+	pthread_mutex_lock(&ext_configuration_mutex);
+	ext_writer_started = 0;
+	ext_configurations_clear();
+	ext_configuration_loaded = 0;
+	pthread_mutex_unlock(&ext_configuration_mutex);
 }
 
 /**
@@ -211,22 +776,25 @@ void ext_configurations_remove_all_configs()
 {
 	int index;
 
-	gil_lock();
-	for (index = 0; index < ext_configuration_size; index++) {
-		octet_string system_id =
-			ext_configuration_list[index].system_id;
-		ConfigId config_id = ext_configuration_list[index].config_id;
-		char *file_path = ext_configurations_get_file_name(&system_id,
-				  config_id);
+	ext_configurations_flush();
 
-		if (remove(file_path) != 0) {
-			ERROR("\n[Error] Unable to remove file %s", file_path);
-		}
+	pthread_mutex_lock(&ext_configuration_mutex);
+	for (index = 0; index < ext_configuration_buckets; index++) {
+		struct ExtConfig *cfg = ext_configuration_index[index];
 
-		free(file_path);
-		file_path = NULL;
+		for (; cfg != NULL; cfg = cfg->next) {
+			char *file_path = ext_configurations_get_file_name(
+						  &cfg->system_id, cfg->config_id);
+
+			if (remove(file_path) != 0) {
+				ERROR("\n[Error] Unable to remove file %s", file_path);
+			}
+
+			free(file_path);
+			file_path = NULL;
+		}
 	}
-	gil_unlock();
+	pthread_mutex_unlock(&ext_configuration_mutex);
 
 	char *concat = ext_concat_path_file();
 
@@ -257,44 +825,35 @@ static void ext_configurations_wipe()
 
 /**
  * This method loads the list of available configurations.
+ * Configuration files are read on demand.
  */
 void ext_configurations_load_configurations()
 {
+	ext_configurations_flush();
 	ext_configurations_create_environment();
 
 	unsigned long buffer_size = 0;
-	ByteStreamReader *stream = 0;
+	ByteStreamReader stream;
 	char *concat = ext_concat_path_file();
-	unsigned char *buffer = ioutil_buffer_from_file(concat, &buffer_size);
+	intu8 *buffer = ioutil_map_file(concat, &buffer_size);
 	free(concat);
 
+	pthread_mutex_lock(&ext_configuration_mutex);
+	ext_configurations_clear();
+	ext_configuration_loaded = 1;
+
 	if (!buffer) {
 		DEBUG("No ext config buffer to read");
 		goto exit;
 	}
 
-	stream = byte_stream_reader_instance(buffer, buffer_size);
-	if (!stream) {
-		DEBUG("Zero-sized ext config buffer");
-		goto exit;
-	}
-
-	gil_lock();
-	if (ext_configuration_list != NULL) {
-		free(ext_configuration_list);
-		ext_configuration_list = NULL;
-		ext_configuration_size = 0;
-	}
-
-	ext_configuration_list = calloc(0, sizeof(struct ExtConfig));
-	ext_configuration_size = 0;
-	gil_unlock();
+	byte_stream_reader_init(&stream, buffer, buffer_size);
 
-	while (stream->unread_bytes > 0) {
+	while (stream.unread_bytes > 0) {
 		int i = ext_configuration_size;
 		int error = 0;
 
-		int config_id = read_intu16(stream, &error);
+		int config_id = read_intu16(&stream, &error);
 		if (error) {
 			DEBUG("ext config: err reading config_id %d", i);
 			ext_configurations_wipe();
@@ -304,14 +863,14 @@ void ext_configurations_load_configurations()
 		DEBUG("Decoding ext config id %x", config_id);
 
 		octet_string system_id = {0, 0};
-		decode_octet_string(stream, &system_id, &error);
+		decode_octet_string(&stream, &system_id, &error);
 		if (error) {
 			DEBUG("ext config: err reading system_id %d %d", i, error);
-				ext_configurations_wipe();
-				break;
-			}
+			ext_configurations_wipe();
+			break;
+		}
 
-		int obj_size = read_intu16(stream, &error);
+		int obj_size = read_intu16(&stream, &error);
 		if (error) {
 			DEBUG("ext config: err reading obj_size %d", i);
 			del_octet_string(&system_id);
@@ -319,23 +878,26 @@ void ext_configurations_load_configurations()
 			break;
 		}
 
-		gil_lock();
-		ext_configuration_list = realloc(ext_configuration_list,
-			++ext_configuration_size * sizeof(struct ExtConfig));
+		struct ExtConfig *cfg = ext_configurations_find(&system_id,
+							config_id);
 
-		ext_configuration_list[i].config_id = config_id;
-		ext_configuration_list[i].system_id = system_id;
-		ext_configuration_list[i].obj_size = obj_size;
-		gil_unlock();
+		if (cfg != NULL) {
+			cfg->obj_size = obj_size;
+		} else {
+			ext_configurations_insert(&system_id, config_id, obj_size);
+		}
+
+		del_octet_string(&system_id);
 	}
 
 exit:
-	free(buffer);
-	free(stream);
+	pthread_mutex_unlock(&ext_configuration_mutex);
+	ioutil_unmap_file(buffer, buffer_size);
 }
 
 /**
- * Write extended configuration to disk
+ * Write extended configuration to disk. The configuration file is
+ * replaced atomically, so it can be mapped while being rewritten.
  *
  * @param system_id System ID (device identification)
  * @param config_id Extended configuration ID
@@ -374,8 +936,17 @@ static void ext_configurations_write_file(octet_string *system_id,
 	// writes particular config+device file
 	char *file_path =
 		ext_configurations_get_file_name(system_id, config_id);
-	int err = ioutil_buffer_to_file(file_path, stream->size,
+	char *tmp_path = calloc(strlen(file_path) + 5, sizeof(char));
+	sprintf(tmp_path, "%s.tmp", file_path);
+
+	int err = ioutil_buffer_to_file(tmp_path, stream->size,
 					     stream->buffer, 0);
+
+	if (!err && rename(tmp_path, file_path) != 0) {
+		err = 1;
+	}
+
+	free(tmp_path);
 	free(file_path);
 	file_path = NULL;
 
@@ -386,7 +957,8 @@ static void ext_configurations_write_file(octet_string *system_id,
 
 /**
  * This method adds a new configuration. The handle configuration is
- * composed of system_id and config_id.
+ * composed of system_id and config_id. The configuration is
+ * available immediately; it is written to disk in background.
  *
  * @param system_id Identify the agent;
  * @param config_id Identify the configuration described in the
@@ -397,13 +969,13 @@ void ext_configurations_register_conf(octet_string *system_id,
 				      ConfigId config_id, ConfigObjectList *object_list)
 {
 	int new;
-	int empty;
+	int loaded;
 
-	gil_lock();
-	empty = (ext_configuration_list == NULL);
-	gil_unlock();
+	pthread_mutex_lock(&ext_configuration_mutex);
+	loaded = ext_configuration_loaded;
+	pthread_mutex_unlock(&ext_configuration_mutex);
 
-	if (empty) {
+	if (!loaded) {
 		ext_configurations_load_configurations();
 	}
 
@@ -412,44 +984,23 @@ void ext_configurations_register_conf(octet_string *system_id,
 	DEBUG("Encoding %x to index", config_id);
 	encode_configobjectlist(stream, object_list);
 
-	struct ExtConfig *cfg = ext_configurations_get_config(system_id, config_id);
+	pthread_mutex_lock(&ext_configuration_mutex);
+
+	struct ExtConfig *cfg = ext_configurations_find(system_id, config_id);
 	if (!cfg) {
-		int error = 0;
 		DEBUG("Adding new ext config %x to index", config_id);
 		new = 1;
-		gil_lock();
-		ext_configuration_size++;
-		ext_configuration_list = realloc(ext_configuration_list,
-					 ext_configuration_size * sizeof(struct ExtConfig));
-		cfg = &(ext_configuration_list[ext_configuration_size - 1]);
-
-		cfg->config_id = config_id;
-
-		size = system_id->length * sizeof(intu8) + sizeof(intu16);
-		ByteStreamWriter *w_stream = byte_stream_writer_instance(size);
-		encode_octet_string(w_stream, system_id);
-
-		ByteStreamReader *r_stream = byte_stream_reader_instance(w_stream->buffer, size);
-		// used just to alloc system_id into cfg; won't fail.
-		decode_octet_string(r_stream, &cfg->system_id, &error);
-
-		del_byte_stream_writer(w_stream, 1);
-		free(r_stream);
-		gil_unlock();
+		cfg = ext_configurations_insert(system_id, config_id, stream->size);
 	} else {
 		DEBUG("Updating ext config");
 		new = 0;
+		cfg->obj_size = stream->size;
 	}
 
-	ext_configurations_write_file(system_id, config_id, stream, new);
-
-	cfg->obj_size = stream->size;
+	ext_lru_touch(cfg, ext_configurations_copy_list(object_list));
+	ext_configurations_queue_write(cfg, stream, new);
 
-	if (ext_configuration_list == NULL) {
-		ERROR("ext configuration list is null");
-	}
-
-	del_byte_stream_writer(stream, 1);
+	pthread_mutex_unlock(&ext_configuration_mutex);
 }
 
 /**
@@ -461,37 +1012,13 @@ void ext_configurations_register_conf(octet_string *system_id,
  */
 static struct ExtConfig *ext_configurations_get_config(octet_string *system_id,
 		ConfigId config_id) {
-	int index;
-	
-	gil_lock();
-
-	for (index = 0; index < ext_configuration_size; index++) {
-		ConfigId selected_conf_id =
-			ext_configuration_list[index].config_id;
-		octet_string selected_sys_id =
-			ext_configuration_list[index].system_id;
-
-		if (selected_conf_id == config_id && selected_sys_id.length
-		    == system_id->length) {
-			int i = 0;
-			int is_different = 0;
-
-			while (i < selected_sys_id.length && is_different == 0) {
-				is_different |= selected_sys_id.value[i]
-						!= system_id->value[i];
-				i++;
-			}
+	struct ExtConfig *cfg;
 
-			if (is_different == 0) {
-				gil_unlock();
-				return &ext_configuration_list[index];
-			}
-		}
-	}
+	pthread_mutex_lock(&ext_configuration_mutex);
+	cfg = ext_configurations_find(system_id, config_id);
+	pthread_mutex_unlock(&ext_configuration_mutex);
 
-	gil_unlock();
-
-	return NULL;
+	return cfg;
 }
 
 /**
@@ -510,58 +1037,116 @@ int ext_configurations_is_supported_standard(octet_string *system_id,
 	return ext_configurations_get_config(system_id, config_id) != NULL;
 }
 
+/**
+ * Reads and decodes a configuration file
+ *
+ * @param system_id System ID (device identification)
+ * @param config_id Extended configuration ID
+ * @param obj_size expected size of encoded configuration
+ * @return heap-allocated list, NULL if file cannot be read
+ */
+static ConfigObjectList *ext_configurations_read_file(octet_string *system_id,
+		ConfigId config_id, unsigned long obj_size)
+{
+	ConfigObjectList *result = NULL;
+	unsigned long size = 0;
+
+	char *file_path = ext_configurations_get_file_name(system_id, config_id);
+	intu8 *buffer = ioutil_map_file(file_path, &size);
+
+	free(file_path);
+	file_path = NULL;
+
+	if (buffer == NULL) {
+		ERROR("ext_config_get could not read from file");
+	} else if (size != obj_size) {
+		ERROR("ext_config_get: bad obj size");
+	} else {
+		result = ext_configurations_decode_list(buffer, size);
+	}
+
+	ioutil_unmap_file(buffer, size);
+
+	return result;
+}
+
 /**
  * This method return the Extended Configuration that was recorded.
+ * Recently used configurations are served from memory; others are
+ * mapped from disk and decoded outside the lock.
  *
  * @param system_id Identify the agent;
  * @param config_id Identify the configuration described in the
  *					specialization document;
  *
- * @return The Extended Configuration that was recorded
+ * @return The Extended Configuration that was recorded, owned by caller
  */
 ConfigObjectList *ext_configurations_get_configuration_attributes(
 	octet_string *system_id, ConfigId config_id)
 {
+	ConfigObjectList *result = NULL;
+	ConfigObjectList *decoded;
+	struct ExtConfig *config;
+	unsigned long obj_size;
+
+	pthread_mutex_lock(&ext_configuration_mutex);
 
-	struct ExtConfig *config = ext_configurations_get_config(system_id,
-				   config_id);
+	config = ext_configurations_find(system_id, config_id);
 
-	if (config != NULL) {
-		ConfigId selected_cfg_id = config->config_id;
-		octet_string selected_sys_id = config->system_id;
-		unsigned long size = config->obj_size;
+	if (config == NULL) {
+		pthread_mutex_unlock(&ext_configuration_mutex);
+		return NULL;
+	}
 
-		char *file_path = ext_configurations_get_file_name(
-					  &selected_sys_id, selected_cfg_id);
-		intu8 *buffer = ioutil_buffer_from_file(file_path, &size);
+	if (config->decoded == NULL && config->pending != NULL) {
+		// not on disk yet
+		decoded = ext_configurations_decode_list(config->pending->buffer,
+							 config->pending->size);
+
+		if (decoded != NULL) {
+			ext_lru_touch(config, decoded);
+		}
+	} else if (config->decoded != NULL) {
+		ext_lru_touch(config, NULL);
+	}
+
+	if (config->decoded != NULL) {
+		result = ext_configurations_copy_list(config->decoded);
+		pthread_mutex_unlock(&ext_configuration_mutex);
+		return result;
+	}
 
-		free(file_path);
-		file_path = NULL;
+	obj_size = config->obj_size;
+	pthread_mutex_unlock(&ext_configuration_mutex);
 
-		if (buffer == NULL) {
-			ERROR("ext_config_get could not read from file");
-			return NULL;
-		} else if (size != config->obj_size) {
-			ERROR("ext_config_get: bad obj size");
-			free(buffer);
-			return NULL;
+	decoded = ext_configurations_read_file(system_id, config_id, obj_size);
+
+	if (decoded == NULL) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&ext_configuration_mutex);
+
+	config = ext_configurations_find(system_id, config_id);
+
+	if (config == NULL) {
+		// configurations were destroyed meanwhile
+		result = decoded;
+	} else {
+		if (config->decoded == NULL) {
+			ext_lru_touch(config, decoded);
 		} else {
-			ConfigObjectList *result = malloc(sizeof(ConfigObjectList));
-			ByteStreamReader *stream = byte_stream_reader_instance(buffer, size);
-			int error = 0;
-			decode_configobjectlist(stream, result, &error);
-			if (error) {
-				ERROR("ext_config_get: bad configuration data");
-				free(result);
-				result = NULL;
-			}
-			free(stream);
-			free(buffer);
-			return result;
+			ext_lru_touch(config, NULL);
+			del_configobjectlist(decoded);
+			free(decoded);
 		}
+
+		result = ext_configurations_copy_list(config->decoded);
 	}
 
-	return NULL;
+	pthread_mutex_unlock(&ext_configuration_mutex);
+
+	return result;
 }
 
 /** @} */
@@ -40,6 +40,8 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <pthread.h>
 
 #include "src/communication/common/fsm.h"
 #include "src/communication/agent/agent_association.h"
@@ -111,13 +113,134 @@ static char *fsm_event_strings[] = {
 	"fsm_evt_rx_rorj"
 };
 
+/**
+ * Rule tables compiled so far
+ */
+static FsmDispatchTable *dispatch_tables = NULL;
+
+/**
+ * Protects dispatch_tables list
+ */
+static pthread_mutex_t dispatch_tables_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Compiles transition rules into a jump table. When more than one
+ * rule matches a state and event, the first one wins, as it did
+ * when the rules were scanned in order.
+ *
+ * @param transition_table the transition rules table
+ * @param table_size size of transition table array
+ * @return compiled table, NULL if cannot allocate it
+ */
+static FsmDispatchTable *fsm_compile(FsmTransitionRule *transition_table, int table_size)
+{
+	FsmDispatchTable *dispatch = calloc(1, sizeof(FsmDispatchTable));
+
+	if (dispatch == NULL) {
+		return NULL;
+	}
+
+	dispatch->rules = malloc(table_size * sizeof(FsmTransitionRule));
+
+	if (dispatch->rules == NULL && table_size > 0) {
+		free(dispatch);
+		return NULL;
+	}
+
+	memcpy(dispatch->rules, transition_table, table_size * sizeof(FsmTransitionRule));
+	dispatch->size = table_size;
+
+	int i;
+
+	for (i = 0; i < table_size; i++) {
+		FsmTransitionRule *rule = &dispatch->rules[i];
+
+		if ((int) rule->currentState < 0 || rule->currentState >= fsm_state_size
+		    || (int) rule->inputEvent < 0 || rule->inputEvent >= fsm_evt_size) {
+			ERROR("fsm: ignoring rule with invalid state %d or event %d",
+			      rule->currentState, rule->inputEvent);
+			continue;
+		}
+
+		if (dispatch->rule[rule->currentState][rule->inputEvent] == NULL) {
+			dispatch->rule[rule->currentState][rule->inputEvent] = rule;
+		}
+	}
+
+	return dispatch;
+}
+
+/**
+ * Checks whether a compiled table was built from the given rules
+ *
+ * @param dispatch compiled table
+ * @param transition_table the transition rules table
+ * @param table_size size of transition table array
+ * @return 1 if rules are the same, 0 otherwise
+ */
+static int fsm_dispatch_matches(FsmDispatchTable *dispatch, FsmTransitionRule *transition_table, int table_size)
+{
+	int i;
+
+	if (dispatch->size != table_size) {
+		return 0;
+	}
+
+	for (i = 0; i < table_size; i++) {
+		FsmTransitionRule *a = &dispatch->rules[i];
+		FsmTransitionRule *b = &transition_table[i];
+
+		if (a->currentState != b->currentState || a->inputEvent != b->inputEvent
+		    || a->nextState != b->nextState || a->post_action != b->post_action) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Finds the compiled form of a rule table, compiling it on first use.
+ * Tables are matched by contents, so rules kept in temporary storage
+ * are safe to pass.
+ *
+ * @param transition_table the transition rules table
+ * @param table_size size of transition table array
+ * @return compiled table, NULL if cannot allocate it
+ */
+static const FsmDispatchTable *fsm_dispatch_table(FsmTransitionRule *transition_table, int table_size)
+{
+	FsmDispatchTable *dispatch;
+
+	pthread_mutex_lock(&dispatch_tables_mutex);
+
+	for (dispatch = dispatch_tables; dispatch != NULL; dispatch = dispatch->next) {
+		if (fsm_dispatch_matches(dispatch, transition_table, table_size)) {
+			break;
+		}
+	}
+
+	if (dispatch == NULL) {
+		dispatch = fsm_compile(transition_table, table_size);
+
+		if (dispatch != NULL) {
+			dispatch->next = dispatch_tables;
+			dispatch_tables = dispatch;
+		}
+	}
+
+	pthread_mutex_unlock(&dispatch_tables_mutex);
+
+	return dispatch;
+}
+
 /**
  * Construct the state machine
  * @return finite state machine
  */
 FSM *fsm_instance()
 {
-	FSM *fsm = malloc(sizeof(struct FSM));
+	FSM *fsm = calloc(1, sizeof(struct FSM));
 	return fsm;
 }
 
@@ -132,7 +255,9 @@ void fsm_destroy(FSM *fsm)
 }
 
 /**
- * Initialize the state machine before process the inputs
+ * Initialize the state machine before process the inputs. The rules
+ * are compiled into a jump table the first time a given table is seen,
+ * later calls with the same rules share that compiled table.
  *
  * @param fsm state machine
  * @param entry_point_state the initial state of FSM
@@ -146,6 +271,11 @@ void fsm_init(FSM *fsm, fsm_states entry_point_state, FsmTransitionRule *transit
 	/* Initialize Transition Rules */
 	fsm->transition_table = transition_table;
 	fsm->transition_table_size = table_size;
+	fsm->dispatch = fsm_dispatch_table(transition_table, table_size);
+
+	if (fsm->dispatch == NULL) {
+		ERROR("fsm: cannot compile transition table");
+	}
 }
 
 /**
@@ -164,45 +294,38 @@ FSM_PROCESS_EVT_STATUS fsm_process_evt(FSMContext *ctx, fsm_events evt, FSMEvent
 {
 	FSM *fsm = ctx->fsm;
 
-	DEBUG(" state machine(<%s>): process event <%s> ", fsm_state_to_string(fsm->state), fsm_event_to_string(evt));
-
-	int i;
-	FsmTransitionRule *rule = NULL;
-
-	for (i = 0; i < fsm->transition_table_size; i++) {
-		rule = &fsm->transition_table[i];
-
-		if (fsm->state == rule->currentState && evt == rule->inputEvent) {
-			int state_changed = fsm->state != rule->nextState;
-
-			// pre-action
-
+	if (fsm->dispatch == NULL
+	    || (int) fsm->state < 0 || fsm->state >= fsm_state_size
+	    || (int) evt < 0 || evt >= fsm_evt_size) {
+		return FSM_PROCESS_EVT_RESULT_NOT_PROCESSED;
+	}
 
-			// Make transition
-			DEBUG(" state machine(<%s>): transition to <%s> ",
-				fsm_state_to_string(fsm->state), fsm_state_to_string(rule->nextState));
+	const FsmTransitionRule *rule = fsm->dispatch->rule[fsm->state][evt];
 
+	if (rule == NULL) {
+		return FSM_PROCESS_EVT_RESULT_NOT_PROCESSED;
+	}
 
-			fsm->state = rule->nextState;
+	int state_changed = fsm->state != rule->nextState;
 
-			if (rule->post_action != NULL) {
-				// pos-action
-				(rule->post_action)(ctx, evt, data);
-			}
+	if (state_changed) {
+		DEBUG(" state machine(<%s>): transition to <%s> ",
+			fsm_state_to_string(fsm->state), fsm_state_to_string(rule->nextState));
+	}
 
-			if (state_changed) {
-				return FSM_PROCESS_EVT_RESULT_STATE_CHANGED;
-			} else {
-				return FSM_PROCESS_EVT_RESULT_STATE_UNCHANGED;
-			}
+	// Make transition
+	fsm->state = rule->nextState;
 
-			break;
-		}
+	if (rule->post_action != NULL) {
+		// pos-action
+		(rule->post_action)(ctx, evt, data);
 	}
 
-	fflush(stdout);
+	if (state_changed) {
+		return FSM_PROCESS_EVT_RESULT_STATE_CHANGED;
+	}
 
-	return FSM_PROCESS_EVT_RESULT_NOT_PROCESSED;
+	return FSM_PROCESS_EVT_RESULT_STATE_UNCHANGED;
 }
 
 /**
@@ -195,6 +195,12 @@ typedef struct FSM {
 	 * State table size
 	 */
 	int32 transition_table_size;
+
+	/**
+	 * Transition rules compiled into a [state][event] jump table,
+	 * shared by all state machines that use the same rules
+	 */
+	const struct FsmDispatchTable *dispatch;
 } FSM;
 
 
@@ -222,6 +228,32 @@ typedef struct FsmTransitionRule {
 	fsm_action post_action;
 } FsmTransitionRule;
 
+/**
+ * Transition rules compiled for constant time dispatch. Built once
+ * per distinct rule table by fsm_init() and never modified afterwards.
+ */
+typedef struct FsmDispatchTable {
+	/**
+	 * Private copy of the rules the table was compiled from
+	 */
+	FsmTransitionRule *rules;
+
+	/**
+	 * Number of rules
+	 */
+	int size;
+
+	/**
+	 * Rule to apply for each state and event, NULL if none
+	 */
+	const FsmTransitionRule *rule[fsm_state_size][fsm_evt_size];
+
+	/**
+	 * Next compiled table
+	 */
+	struct FsmDispatchTable *next;
+} FsmDispatchTable;
+
 FSM *fsm_instance();
 
 void fsm_destroy(FSM *fsm);
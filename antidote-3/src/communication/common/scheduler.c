@@ -0,0 +1,512 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file scheduler.c
+ * \brief Context input scheduler.
+ *
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ */
+
+/**
+ * \defgroup Scheduler Input Scheduler
+ * \ingroup FSM
+ * \brief Runs input processing of many contexts on a few threads.
+ *
+ * Reactor-style plug-ins notify the scheduler when a context has
+ * input; a pool of worker threads then drains it through
+ * communication_read_input_stream(). A context is queued at most once
+ * and runs on one worker at a time (actor-style), so it stays
+ * serialized while different contexts run in parallel. Each worker
+ * has its own queue and idle workers steal from the others.
+ *
+ * @{
+ */
+
+#include "src/communication/common/communication.h"
+#include "src/communication/common/context_manager.h"
+#include "scheduler.h"
+#include "src/util/log.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/**
+ * Context has no pending input
+ */
+#define INPUT_IDLE 0
+
+/**
+ * Context is queued or running
+ */
+#define INPUT_QUEUED 1
+
+/**
+ * Context got input while queued or running
+ */
+#define INPUT_NOTIFIED 2
+
+/**
+ * Maximum APDUs processed for one context before it yields
+ * to other contexts
+ */
+#define SCHEDULER_BATCH 16
+
+/**
+ * Initial capacity of a worker queue
+ */
+#define SCHEDULER_QUEUE_SIZE 64
+
+/**
+ * Worker thread and its queue of ready contexts
+ */
+typedef struct SchedWorker {
+	/**
+	 * Worker thread
+	 */
+	pthread_t thread;
+
+	/**
+	 * Protects queue
+	 */
+	pthread_mutex_t mutex;
+
+	/**
+	 * Ring buffer of ready contexts, each holding a reference
+	 */
+	Context **queue;
+
+	/**
+	 * Allocated size of queue
+	 */
+	int capacity;
+
+	/**
+	 * Index of first queued context
+	 */
+	int head;
+
+	/**
+	 * Number of queued contexts
+	 */
+	int count;
+} SchedWorker;
+
+/**
+ * Worker pool
+ */
+static SchedWorker *workers = NULL;
+
+/**
+ * Number of workers
+ */
+static int worker_count = 0;
+
+/**
+ * Non-zero while workers must run. Written with state_lock held
+ * for writing, always read atomically.
+ */
+static int running = 0;
+
+/**
+ * Keeps workers allocated while non-worker threads queue contexts
+ */
+static pthread_rwlock_t state_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/**
+ * Number of contexts queued in all workers
+ */
+static int queued = 0;
+
+/**
+ * Round-robin index for notifications from non-worker threads
+ */
+static unsigned int next_worker = 0;
+
+/**
+ * Protects sleeping of idle workers
+ */
+static pthread_mutex_t idle_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Wakes up idle workers
+ */
+static pthread_cond_t idle_cond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * Worker owning the current thread, NULL if not a worker
+ */
+static __thread SchedWorker *current_worker = NULL;
+
+/**
+ * Reads running flag
+ *
+ * @return non-zero while workers must run
+ */
+static int scheduler_running()
+{
+	return __sync_fetch_and_add(&running, 0);
+}
+
+/**
+ * Drains all input of a context in the calling thread, used when
+ * it cannot be queued
+ *
+ * @param ctx context with its queue reference
+ */
+static void scheduler_drain(Context *ctx)
+{
+	ContextId id = ctx->id;
+
+	do {
+		__sync_lock_test_and_set(&ctx->input_state, INPUT_QUEUED);
+
+		while (communication_read_input_stream(id)) {
+		}
+	} while (!__sync_bool_compare_and_swap(&ctx->input_state, INPUT_QUEUED,
+					       INPUT_IDLE));
+
+	context_release(ctx);
+}
+
+/**
+ * Appends context to worker queue. If the queue cannot grow, the
+ * context input is processed right away instead.
+ *
+ * @param worker worker
+ * @param ctx context, its reference is handed to queue
+ */
+static void scheduler_push(SchedWorker *worker, Context *ctx)
+{
+	pthread_mutex_lock(&worker->mutex);
+
+	if (worker->count == worker->capacity) {
+		int capacity = worker->capacity * 2;
+		Context **queue = malloc(capacity * sizeof(Context *));
+		int i;
+
+		if (queue == NULL) {
+			pthread_mutex_unlock(&worker->mutex);
+			ERROR("scheduler: cannot grow queue, draining context inline");
+			scheduler_drain(ctx);
+			return;
+		}
+
+		for (i = 0; i < worker->count; ++i) {
+			queue[i] = worker->queue[(worker->head + i) % worker->capacity];
+		}
+
+		free(worker->queue);
+		worker->queue = queue;
+		worker->capacity = capacity;
+		worker->head = 0;
+	}
+
+	worker->queue[(worker->head + worker->count) % worker->capacity] = ctx;
+	++worker->count;
+
+	pthread_mutex_unlock(&worker->mutex);
+
+	__sync_add_and_fetch(&queued, 1);
+
+	pthread_mutex_lock(&idle_mutex);
+	pthread_cond_signal(&idle_cond);
+	pthread_mutex_unlock(&idle_mutex);
+}
+
+/**
+ * Takes a context from worker queue
+ *
+ * @param worker worker
+ * @param oldest take the oldest (own queue) or newest (stealing) context
+ * @return context with its queue reference, or NULL if queue is empty
+ */
+static Context *scheduler_pop(SchedWorker *worker, int oldest)
+{
+	Context *ctx = NULL;
+
+	pthread_mutex_lock(&worker->mutex);
+
+	if (worker->count > 0) {
+		if (oldest) {
+			ctx = worker->queue[worker->head];
+			worker->head = (worker->head + 1) % worker->capacity;
+		} else {
+			ctx = worker->queue[(worker->head + worker->count - 1)
+					    % worker->capacity];
+		}
+
+		--worker->count;
+	}
+
+	pthread_mutex_unlock(&worker->mutex);
+
+	if (ctx != NULL) {
+		__sync_sub_and_fetch(&queued, 1);
+	}
+
+	return ctx;
+}
+
+/**
+ * Gets next context to run: from own queue, or stolen from another
+ * worker, or waits until one is queued.
+ *
+ * @param self current worker
+ * @return context, or NULL if scheduler is stopping
+ */
+static Context *scheduler_take(SchedWorker *self)
+{
+	int index = self - workers;
+
+	while (scheduler_running()) {
+		Context *ctx = scheduler_pop(self, 1);
+		int i;
+
+		for (i = 1; ctx == NULL && i < worker_count; ++i) {
+			ctx = scheduler_pop(&workers[(index + i) % worker_count], 0);
+		}
+
+		if (ctx != NULL) {
+			return ctx;
+		}
+
+		pthread_mutex_lock(&idle_mutex);
+
+		if (scheduler_running() && __sync_fetch_and_add(&queued, 0) == 0) {
+			pthread_cond_wait(&idle_cond, &idle_mutex);
+		}
+
+		pthread_mutex_unlock(&idle_mutex);
+	}
+
+	return NULL;
+}
+
+/**
+ * Drains input of a context, at most SCHEDULER_BATCH APDUs, and
+ * queues it again if there may be more.
+ *
+ * @param self current worker
+ * @param ctx context with its queue reference
+ */
+static void scheduler_run(SchedWorker *self, Context *ctx)
+{
+	ContextId id = ctx->id;
+	int processed = 0;
+
+	// notifications from now on are seen by the reads below
+	__sync_lock_test_and_set(&ctx->input_state, INPUT_QUEUED);
+
+	while (processed < SCHEDULER_BATCH && communication_read_input_stream(id)) {
+		++processed;
+	}
+
+	if (processed < SCHEDULER_BATCH &&
+	    __sync_bool_compare_and_swap(&ctx->input_state, INPUT_QUEUED,
+					 INPUT_IDLE)) {
+		context_release(ctx);
+		return;
+	}
+
+	scheduler_push(self, ctx);
+}
+
+/**
+ * Worker thread main loop
+ *
+ * @param arg worker
+ */
+static void *scheduler_worker_run(void *arg)
+{
+	SchedWorker *self = (SchedWorker *) arg;
+	Context *ctx;
+
+	current_worker = self;
+
+	while ((ctx = scheduler_take(self)) != NULL) {
+		scheduler_run(self, ctx);
+	}
+
+	current_worker = NULL;
+
+	return NULL;
+}
+
+/**
+ * Starts worker threads
+ *
+ * @param count number of workers, 0 for one per online processor
+ * @return 1 if operation succeeds, 0 otherwise
+ */
+int scheduler_start(int count)
+{
+	int i;
+
+	if (scheduler_running()) {
+		return 1;
+	}
+
+	if (count <= 0) {
+		count = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+
+	if (count <= 0) {
+		count = 1;
+	}
+
+	workers = calloc(count, sizeof(SchedWorker));
+
+	if (workers == NULL) {
+		return 0;
+	}
+
+	for (i = 0; i < count; ++i) {
+		pthread_mutex_init(&workers[i].mutex, NULL);
+		workers[i].capacity = SCHEDULER_QUEUE_SIZE;
+		workers[i].queue = malloc(SCHEDULER_QUEUE_SIZE * sizeof(Context *));
+	}
+
+	pthread_rwlock_wrlock(&state_lock);
+	worker_count = count;
+	__sync_lock_test_and_set(&running, 1);
+	pthread_rwlock_unlock(&state_lock);
+
+	for (i = 0; i < count; ++i) {
+		if (pthread_create(&workers[i].thread, NULL,
+				   scheduler_worker_run, &workers[i])) {
+			ERROR("scheduler: cannot create worker %d", i);
+			worker_count = i;
+			scheduler_stop();
+			return 0;
+		}
+	}
+
+	DEBUG("scheduler: started %d workers", count);
+
+	return 1;
+}
+
+/**
+ * Stops and joins worker threads. Contexts still queued are dropped.
+ * Must not be called from a worker.
+ */
+void scheduler_stop()
+{
+	int i;
+
+	if (workers == NULL) {
+		return;
+	}
+
+	// waits for notifiers that are queueing contexts;
+	// later ones see the scheduler stopped
+	pthread_rwlock_wrlock(&state_lock);
+	pthread_mutex_lock(&idle_mutex);
+	__sync_lock_test_and_set(&running, 0);
+	pthread_cond_broadcast(&idle_cond);
+	pthread_mutex_unlock(&idle_mutex);
+	pthread_rwlock_unlock(&state_lock);
+
+	for (i = 0; i < worker_count; ++i) {
+		pthread_join(workers[i].thread, NULL);
+	}
+
+	for (i = 0; i < worker_count; ++i) {
+		Context *ctx;
+
+		while ((ctx = scheduler_pop(&workers[i], 1)) != NULL) {
+			__sync_lock_test_and_set(&ctx->input_state, INPUT_IDLE);
+			context_release(ctx);
+		}
+
+		free(workers[i].queue);
+		pthread_mutex_destroy(&workers[i].mutex);
+	}
+
+	free(workers);
+	workers = NULL;
+	worker_count = 0;
+
+	DEBUG("scheduler: stopped");
+}
+
+/**
+ * Checks whether workers are running
+ *
+ * @return 1 if input must be notified with scheduler_notify_input()
+ */
+int scheduler_is_running()
+{
+	return scheduler_running();
+}
+
+/**
+ * Tells scheduler that a context has input to be read by
+ * communication_read_input_stream(). Never blocks on the context lock.
+ *
+ * @param id context id
+ */
+void scheduler_notify_input(ContextId id)
+{
+	Context *ctx = context_get(id);
+
+	if (ctx == NULL) {
+		return;
+	}
+
+	pthread_rwlock_rdlock(&state_lock);
+
+	while (scheduler_running()) {
+		int state = ctx->input_state;
+
+		if (state == INPUT_IDLE) {
+			if (__sync_bool_compare_and_swap(&ctx->input_state,
+							 INPUT_IDLE,
+							 INPUT_QUEUED)) {
+				SchedWorker *worker = current_worker;
+
+				if (worker == NULL) {
+					unsigned int n = __sync_fetch_and_add(&next_worker, 1);
+					worker = &workers[n % worker_count];
+				}
+
+				// queue keeps the reference
+				scheduler_push(worker, ctx);
+				pthread_rwlock_unlock(&state_lock);
+				return;
+			}
+		} else if (state == INPUT_QUEUED) {
+			if (__sync_bool_compare_and_swap(&ctx->input_state,
+							 INPUT_QUEUED,
+							 INPUT_NOTIFIED)) {
+				break;
+			}
+		} else {
+			break;
+		}
+	}
+
+	pthread_rwlock_unlock(&state_lock);
+
+	context_release(ctx);
+}
+
+/** @} */
@@ -37,6 +37,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "src/communication/common/service.h"
 #include "src/communication/common/communication.h"
 #include "src/communication/parser/decoder_ASN1.h"
@@ -46,9 +47,16 @@
 #include "src/util/log.h"
 
 static void service_change_state(Context *ctx, ServiceState new_state);
-static void service_send_apdu_now(Context *ctx, APDU *apdu, timeout_callback timeout);
+static void service_send_apdu_now(Context *ctx, Request *req);
+static void service_send_pending(Context *ctx);
+static void service_arm_timeout(Context *ctx);
 static void service_release_resources(Context *ctx);
 
+/**
+ * Maximum number of requests on the wire given to new services
+ */
+static int default_max_outstanding = 1;
+
 
 /**
  * Construct service structure
@@ -73,6 +81,8 @@ void clean_request(Request *req)
 	req->timeout.timeout = 0;
 	req->timeout.id = 0;
 	req->request_callback = NULL;
+	req->sent = 0;
+	req->deadline = 0;
 	if (req->context) {
 		free(req->context);
 		req->context = NULL;
@@ -103,14 +113,58 @@ void service_init(Context *ctx)
 	ctx->service->last_invoke_id = 0xF;
 	ctx->service->current_invoke_id = 0;
 	ctx->service->requests_count = 0;
+	ctx->service->max_outstanding = default_max_outstanding;
+	ctx->service->outstanding = 0;
 
 	// Make sure unused requests are clean
-	for (i = 0; i < 15; ++i) {
+	for (i = 0; i < 16; ++i) {
 		clean_request(&ctx->service->requests_list[i]);
 	}
 
 }
 
+/**
+ * Sets how many requests services created from now on keep on the wire.
+ *
+ * @param max_outstanding maximum number of requests waiting for response,
+ * from 1 (one at a time, the default) to 16
+ */
+void service_set_default_max_outstanding(int max_outstanding)
+{
+	if (max_outstanding < 1) {
+		max_outstanding = 1;
+	} else if (max_outstanding > 16) {
+		max_outstanding = 16;
+	}
+
+	default_max_outstanding = max_outstanding;
+}
+
+/**
+ * Sets how many requests this service keeps on the wire. Queued requests
+ * are sent right away if the new limit allows.
+ *
+ * @param ctx Current context.
+ * @param max_outstanding maximum number of requests waiting for response,
+ * from 1 (one at a time) to 16
+ */
+void service_set_max_outstanding(Context *ctx, int max_outstanding)
+{
+	Service *service = ctx->service;
+
+	if (max_outstanding < 1) {
+		max_outstanding = 1;
+	} else if (max_outstanding > 16) {
+		max_outstanding = 16;
+	}
+
+	service->max_outstanding = max_outstanding;
+
+	if (service->state != FINALIZING) {
+		service_send_pending(ctx);
+	}
+}
+
 /**
  * Destroys Service.
  *
@@ -121,7 +175,7 @@ void service_destroy(Service *service)
 	if (service != NULL) {
 		int i = 0;
 
-		for (i = 0; i < 15; ++i) {
+		for (i = 0; i < 16; ++i) {
 			service_del_request(&service->requests_list[i]);
 		}
 
@@ -153,6 +207,7 @@ static void service_release_resources(Context *ctx)
 	service->last_invoke_id = 0xF;
 	service->current_invoke_id = 0;
 	service->requests_count = 0;
+	service->outstanding = 0;
 }
 
 /**
@@ -173,8 +228,8 @@ InvokeIDType service_get_new_invoke_id(Context *ctx)
 }
 
 /**
- * Tries to send the Remote Operation Invoke apdu through communication layer. If processing another request,
- * it queues this request and send it later.
+ * Tries to send the Remote Operation Invoke apdu through communication layer. If as many requests
+ * as allowed are already waiting for response, it queues this request and send it later.
  *
  * @param apdu Pointer to an APDU to be sent through communication.
  * All structures inside APDU must have been created on heap.
@@ -189,7 +244,12 @@ Request *service_send_remote_operation_request(Context *ctx, APDU *apdu, timeout
 	Service *service = ctx->service;
 
 	if (apdu->choice == PRST_CHOSEN) {
-		if (service->requests_count < 16) {
+		InvokeIDType next_invoke_id = (service->last_invoke_id + 1) & 0xF;
+
+		// invoke ids are given in sequence, the next one may still be
+		// waiting for response if requests were retired out of order
+		if (service->requests_count < 16 &&
+		    service->requests_list[next_invoke_id].is_valid != REQUEST_VALID) {
 			DATA_apdu *data_apdu = encode_get_data_apdu(&apdu->u.prst);
 			data_apdu->invoke_id = service_get_new_invoke_id(ctx);
 			Request *req = &service->requests_list[service->last_invoke_id];
@@ -203,8 +263,8 @@ Request *service_send_remote_operation_request(Context *ctx, APDU *apdu, timeout
 
 			service->requests_count++;
 
-			if (service->state == READY) {
-				service_send_apdu_now(ctx, apdu, timeout);
+			if (service->state != FINALIZING) {
+				service_send_pending(ctx);
 			}
 
 			return req;
@@ -413,9 +473,26 @@ void service_del_request(Request *req)
 	}
 }
 
+/**
+ * Moves current invoke id to the oldest request not retired yet
+ *
+ * @param ctx Current context.
+ */
+static void service_advance_current_invoke_id(Context *ctx)
+{
+	Service *service = ctx->service;
+	InvokeIDType next_invoke_id = (service->last_invoke_id + 1) & 0xF;
+
+	do {
+		service->current_invoke_id = (service->current_invoke_id + 1) & 0xF;
+	} while (service->current_invoke_id != next_invoke_id &&
+		 service->requests_list[service->current_invoke_id].is_valid != REQUEST_VALID);
+}
+
 /**
  * Request to be retired from requests queue. After removing, if the request queue still have
- * pending requests, this function starts sending the next request.
+ * pending requests, this function starts sending the next request. Any request on the wire
+ * may be retired, not only the oldest one.
  *
  * @param ctx Current context.
  * @param response_apdu Response APDU
@@ -429,44 +506,43 @@ void service_request_retired(Context *ctx, DATA_apdu *response_apdu)
 		return;
 	}
 
-	Request *req = &(service->requests_list[response_apdu->invoke_id]);
+	InvokeIDType retired_invoke_id = response_apdu->invoke_id;
+	Request *req = &(service->requests_list[retired_invoke_id]);
 
-	if (response_apdu->invoke_id != service->current_invoke_id) {
+	if (req->is_valid != REQUEST_VALID || !req->sent) {
 		return;
 	}
 
-	if (req != NULL && req->is_valid == REQUEST_VALID) {
-
-		communication_reset_timeout(ctx);
+	req->is_valid = REQUEST_INVALID;
+	req->deadline = 0;
+	service->outstanding--;
 
-		InvokeIDType retiredInvokeID = response_apdu->invoke_id;
-		req->is_valid = REQUEST_INVALID;
+	if (req->request_callback != NULL) {
+		(req->request_callback)(ctx, req, response_apdu);
+	}
 
-		if (req->request_callback != NULL) {
-			(req->request_callback)(ctx, req, response_apdu);
-		}
+	service_del_request(req);
+	service->requests_count--;
 
-		service_del_request(req);
-		service->requests_count--;
+	if (retired_invoke_id == service->current_invoke_id) {
+		service_advance_current_invoke_id(ctx);
+	}
 
+	if (service->state == FINALIZING) {
+		if (service->outstanding == 0) {
+			service_release_resources(ctx);
+		}
 
-		if (service->state == PROCESSING) {
-			service_change_state(ctx, READY);
-			InvokeIDType next_id_to_process = (retiredInvokeID + 1) & 0xF;
-			service->current_invoke_id = next_id_to_process;
+		service_arm_timeout(ctx);
+		return;
+	}
 
-			// FIXME conflict with transcoding?
-			if (service->requests_count > 0) {
-				if (service->requests_list[next_id_to_process].is_valid == REQUEST_VALID) {
-					service_send_apdu_now(ctx, service->requests_list[next_id_to_process].apdu,
-							      service->requests_list[next_id_to_process].timeout);
-				}
-			}
-		}
+	// FIXME conflict with transcoding?
+	service_send_pending(ctx);
+	service_arm_timeout(ctx);
 
-		if (service->state == FINALIZING) {
-			service_release_resources(ctx);
-		}
+	if (service->outstanding == 0 && service->state == PROCESSING) {
+		service_change_state(ctx, READY);
 	}
 }
 
@@ -498,17 +574,147 @@ void service_finalize(Context *ctx, service_state_callback_function state_change
 }
 
 /**
- * Send an APDU. If the APDU is not sent, a callback function is called.
+ * Current monotonic time
+ *
+ * @return time in ms
+ */
+static long long service_now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Finds the request on the wire that times out first
+ *
+ * @param ctx Current context.
+ * @return the request, NULL if no request has a timeout
+ */
+static Request *service_next_deadline(Context *ctx)
+{
+	Service *service = ctx->service;
+	Request *next = NULL;
+	int i;
+
+	for (i = 0; i < 16; ++i) {
+		Request *req = &service->requests_list[i];
+
+		if (req->is_valid == REQUEST_VALID && req->sent && req->deadline > 0) {
+			if (next == NULL || req->deadline < next->deadline) {
+				next = req;
+			}
+		}
+	}
+
+	return next;
+}
+
+/**
+ * Context timeout callback, calls the timeout function of the expired request
  *
  * @param ctx Current context.
- * @param apdu The APDU sent
- * @param timeout The timeout callback
  */
-static void service_send_apdu_now(Context *ctx, APDU *apdu, timeout_callback timeout)
+static void service_timeout(Context *ctx)
 {
-	communication_send_apdu(ctx, apdu);
-	communication_count_timeout(ctx, timeout.func, timeout.timeout);
-	service_change_state(ctx, PROCESSING);
+	Request *req = service_next_deadline(ctx);
+
+	if (req == NULL) {
+		return;
+	}
+
+	if (req->deadline > service_now()) {
+		service_arm_timeout(ctx);
+		return;
+	}
+
+	timer_callback_function func = req->timeout.func;
+	req->deadline = 0;
+
+	DEBUG("service: request %d timed out", (int) (req - ctx->service->requests_list));
+
+	func(ctx);
+
+	// keep watching the other requests, unless callback armed its own timeout
+	if (ctx->timeout_action.func == NULL) {
+		service_arm_timeout(ctx);
+	}
+}
+
+/**
+ * Arms the context timeout for the request on the wire that times out first,
+ * or cancels it if none.
+ *
+ * @param ctx Current context.
+ */
+static void service_arm_timeout(Context *ctx)
+{
+	Request *req = service_next_deadline(ctx);
+
+	if (req == NULL) {
+		communication_reset_timeout(ctx);
+		return;
+	}
+
+	long long remaining = req->deadline - service_now();
+	intu32 timeout = remaining > 0 ? (remaining + 999) / 1000 : 0;
+
+	communication_count_timeout(ctx, &service_timeout, timeout);
+}
+
+/**
+ * Send the APDU of a request and starts counting its timeout.
+ *
+ * @param ctx Current context.
+ * @param req The request sent
+ */
+static void service_send_apdu_now(Context *ctx, Request *req)
+{
+	Service *service = ctx->service;
+
+	communication_send_apdu(ctx, req->apdu);
+
+	req->sent = 1;
+	req->deadline = 0;
+
+	if (req->timeout.func != NULL) {
+		req->deadline = service_now() + req->timeout.timeout * 1000LL;
+	}
+
+	service->outstanding++;
+	service_arm_timeout(ctx);
+
+	if (service->state == READY) {
+		service_change_state(ctx, PROCESSING);
+	}
+}
+
+/**
+ * Sends queued requests, in invoke id order, while there is room on the wire.
+ *
+ * @param ctx Current context.
+ */
+static void service_send_pending(Context *ctx)
+{
+	Service *service = ctx->service;
+	InvokeIDType invoke_id = service->current_invoke_id;
+	int i;
+
+	for (i = 0; i < 16 && service->outstanding < service->max_outstanding; ++i) {
+		Request *req = &service->requests_list[invoke_id];
+
+		if (req->is_valid == REQUEST_VALID && !req->sent && req->apdu != NULL) {
+			service_send_apdu_now(ctx, req);
+		}
+
+		if (invoke_id == service->last_invoke_id) {
+			break;
+		}
+
+		invoke_id = (invoke_id + 1) & 0xF;
+	}
 }
 
 /**
@@ -562,6 +768,8 @@ static void service_change_state(Context *ctx, ServiceState new_state)
 {
 	Service *service = ctx->service;
 
+	service->state = new_state;
+
 	if (service->state_changed_callback != NULL) {
 		DEBUG("Changing state...")
 		service->state_changed_callback(ctx, new_state);
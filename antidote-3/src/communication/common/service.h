@@ -37,6 +37,9 @@
  * requests, queuing them until service is on READY state again. If its clients tries to make other
  * requests, these ones are dropped.
  *
+ * Optionally, up to service_set_max_outstanding() requests are kept on the wire at once. Each one
+ * has its own timeout and responses may retire them in any order.
+ *
  * It is responsible to delete APDU's structures after sending them. On doing so, all pointers
  * inside this structure must have been created on heap.
 
@@ -55,7 +58,7 @@
  */
 typedef enum {
 	READY = 0,  // !< Service is able to send an apdu
-	PROCESSING, // !< Service waiting for a request to be retired
+	PROCESSING, // !< Service waiting for requests to be retired
 	FINALIZING, // !< Service being finalized
 	FINALIZED   // !< Service finalized
 } ServiceState;
@@ -112,6 +115,14 @@ typedef struct Request {
 	service_request_callback request_callback;
 	void *context;
 	struct RequestRet *return_data;
+	/**
+	 * Set when the request is on the wire, waiting for response
+	 */
+	int sent;
+	/**
+	 * Monotonic time in ms when the request times out, 0 if never
+	 */
+	long long deadline;
 } Request;
 
 /**
@@ -125,6 +136,16 @@ typedef struct Service {
 	int requests_count;
 	Request requests_list[16];
 
+	/**
+	 * Maximum number of requests on the wire, 1 sends one at a time
+	 */
+	int max_outstanding;
+
+	/**
+	 * Number of requests on the wire
+	 */
+	int outstanding;
+
 	service_state_callback_function state_changed_callback;
 } Service;
 
@@ -134,6 +155,10 @@ void service_destroy(Service *serive);
 
 void service_init(Context *ctx);
 
+void service_set_default_max_outstanding(int max_outstanding);
+
+void service_set_max_outstanding(Context *ctx, int max_outstanding);
+
 void service_del_request(Request *req);
 
 Request  *service_send_remote_operation_request(Context *ctx, APDU *apdu, timeout_callback timeout,  service_request_callback request_callback);
@@ -36,6 +36,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "src/communication/common/stdconfigurations.h"
+#include "src/communication/parser/struct_cleaner.h"
 #include "src/util/log.h"
 
 /**
@@ -51,12 +52,15 @@ static struct StdConfiguration **std_configuration_list = NULL;
 // TODO use a LinkedList
 
 /**
- * This method adds a new configuration.
+ * This method adds a new configuration. The configuration object list
+ * is built once here and shared by every context that uses it.
  *
  * @param config Configuration described in the specialization document
  */
 void std_configurations_register_conf(struct StdConfiguration *config)
 {
+	config->config_obj_list = config->configure_action();
+
 	std_configurations_count++;
 	int last_index = std_configurations_count-1;
 
@@ -122,7 +126,8 @@ int std_configurations_is_supported_standard(ConfigId config_id)
 
 /**
  * This method return the Extended Configuration described in the specialization
- * document and identified by config_report parameter
+ * document and identified by config_report parameter. The list is built
+ * anew and belongs to the caller.
  *
  * @param config_id Identify the configuration described in the specialization
  *                      document;
@@ -143,6 +148,29 @@ ConfigObjectList *std_configurations_get_configuration_attributes(
 	return NULL;
 }
 
+/**
+ * Returns the Extended Configuration described in the specialization
+ * document, shared by all contexts. Unlike
+ * std_configurations_get_configuration_attributes() nothing is built;
+ * the list must not be modified nor freed.
+ *
+ * @param config_id Identify the configuration described in the specialization
+ *                      document;
+ *
+ * @return The shared configuration, NULL if not supported
+ */
+ConfigObjectList *std_configurations_get_shared_configuration(ConfigId config_id)
+{
+	struct StdConfiguration *standard =
+		std_configurations_get_supported_standard(config_id);
+
+	if (standard != NULL) {
+		return standard->config_obj_list;
+	}
+
+	return NULL;
+}
+
 /**
  * Deallocate all structures of standard configuration
  */
@@ -154,6 +182,14 @@ void std_configurations_destroy()
 
 		for (i = 0; i < std_configurations_count; i++) {
 			std_conf = std_configuration_list[i];
+
+			if (std_conf->config_obj_list != NULL) {
+				del_configobjectlist(std_conf->config_obj_list);
+				free(std_conf->config_obj_list);
+			}
+
+			event_report_template_destroy(std_conf->event_report_template);
+
 			free(std_conf);
 			std_conf = NULL;
 		}
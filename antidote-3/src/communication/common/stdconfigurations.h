@@ -39,6 +39,9 @@
 #include <stdlib.h>
 #include <asn1/phd_types.h>
 #include <dim/mds.h>
+#include <communication/common/event_report_template.h>
+
+struct StdConfiguration;
 
 /**
  * This Function Pointer return the Extended Configuration described
@@ -52,9 +55,10 @@ typedef ConfigObjectList *(*configure_action)();
 typedef char *(*mds_to_string)(MDS *mds);
 
 /**
- * Populates an event report (agent)
+ * Populates an event report (agent), usually by filling the
+ * configuration's event report template
  */
-typedef DATA_apdu *(*agent_event_report)(void *data);
+typedef DATA_apdu *(*agent_event_report)(struct StdConfiguration *config, void *data);
 
 /**
  * Represent the standard configuration described in the
@@ -75,6 +79,17 @@ struct StdConfiguration {
 	 * This function pointer fills a DATA_apdu with data event report
 	 */
 	agent_event_report event_report;
+
+	/**
+	 * Pre-encoded event report, owned by the configuration (may be NULL)
+	 */
+	EventReportTemplate *event_report_template;
+
+	/**
+	 * Configuration built by configure_action when registered,
+	 * shared read-only by all contexts
+	 */
+	ConfigObjectList *config_obj_list;
 };
 
 void std_configurations_register_conf(struct StdConfiguration *config);
@@ -83,6 +98,8 @@ int std_configurations_is_supported_standard(ConfigId config_id);
 
 ConfigObjectList *std_configurations_get_configuration_attributes(ConfigId config_id);
 
+ConfigObjectList *std_configurations_get_shared_configuration(ConfigId config_id);
+
 void std_configurations_destroy();
 
 int std_configurations_is_system_id_supported(octet_string system_id);
@@ -232,9 +232,10 @@ int association_accept_data_protocol_20601_in(Context *ctx,
 		// Configuration known
 		ConfigId id = agent_assoc_information.dev_config_id;
 		ConfigObjectList *config;
+		int shared = std_configurations_is_supported_standard(id);
 
-		if (std_configurations_is_supported_standard(id)) {
-			config = std_configurations_get_configuration_attributes(id);
+		if (shared) {
+			config = std_configurations_get_shared_configuration(id);
 		} else {
 			config = ext_configurations_get_configuration_attributes(
 					 &agent_assoc_information.system_id, id);
@@ -250,8 +251,12 @@ int association_accept_data_protocol_20601_in(Context *ctx,
 			// because the manager may do something like request
 			// MDS attributes and the request must go after
 			// "configuration accepted" packet.
-			mds_configure_operating(ctx, config, 1);
-			free(config);
+			if (shared) {
+				mds_configure_operating_shared(ctx, config, 1);
+			} else {
+				mds_configure_operating(ctx, config, 1);
+				free(config);
+			}
 
 			return 2;
 		}
@@ -270,18 +270,20 @@ ConfigResult configuring_perform_configuration_in(Context *ctx,
 		DEBUG(" configuring: accepting... ");
 		event = fsm_evt_req_agent_supplied_known_configuration;
 
+		// objects are shared with other agents by configuration id
+		ctx->mds->dev_configuration_id = config_report.config_report_id;
+
 		ConfigObjectList *object_list;
 
 		if (std_configurations_is_supported_standard(
 				    config_report.config_report_id)) {
 			DEBUG(" configuring: using standard configuration ");
-			object_list = std_configurations_get_configuration_attributes(
+			object_list = std_configurations_get_shared_configuration(
 					      config_report.config_report_id);
 
-			mds_configure_operating(ctx, object_list, 1);
+			mds_configure_operating_shared(ctx, object_list, 1);
 
 			del_configreport(&config_report);
-			free(object_list);
 
 		} else if (ext_configurations_is_supported_standard(system_id,
 					config_report.config_report_id) &&
@@ -300,6 +302,7 @@ ConfigResult configuring_perform_configuration_in(Context *ctx,
 
 			ext_configurations_register_conf(system_id,
 				config_report.config_report_id, object_list);
+			mds_template_invalidate(config_report.config_report_id, system_id);
 			mds_configure_operating(ctx, object_list, 1);
 			// do not free config_report, object_list
 		}
@@ -318,7 +321,9 @@ ConfigResult configuring_perform_configuration_in(Context *ctx,
 
 #ifdef USE_REQ_MSG
 	// AB: Added to make possible the communication with ProTest
-	last_apdu = *apdu;
+	if (apdu != NULL) {
+		communication_keep_last_apdu(ctx, apdu);
+	}
 #else
 	communication_fire_evt(ctx, event, datap);
 #endif
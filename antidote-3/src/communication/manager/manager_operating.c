@@ -57,6 +57,28 @@
 #include "src/util/log.h"
 #include "src/communication/common/communication.h"
 
+/**
+ * Decodes a report carried by the APDU being processed. When the context
+ * decodes APDUs into an arena, the report goes there too and its values
+ * borrow the APDU instead of being copied.
+ */
+#define DECODE_REPORT(ctx, type, stream, report, error)			\
+	do {								\
+		Arena *previous = decoder_set_arena((ctx)->apdu_arena);	\
+		decode_##type(stream, report, error);			\
+		decoder_set_arena(previous);				\
+	} while (0)
+
+/**
+ * Deletes a report decoded by DECODE_REPORT(), unless it is released
+ * together with the APDU arena.
+ */
+#define DEL_REPORT(ctx, type, report)					\
+	do {								\
+		if ((ctx)->apdu_arena == NULL)				\
+			del_##type(report);				\
+	} while (0)
+
 static void communication_process_roiv(Context *ctx, APDU *apdu);
 
 static void communication_process_roer(Context *ctx, APDU *apdu);
@@ -1028,56 +1050,55 @@ void operating_decode_peri_scan_event(Context *ctx, struct PeriCfgScanner *scann
 	ScanReportInfoMPVar info_mp_var;
 	ScanReportInfoMPGrouped info_mp_grouped;
 
-	ByteStreamReader *event_info_stream = byte_stream_reader_instance(event->value, event->length);
+	ByteStreamReader event_info_stream;
+	byte_stream_reader_init(&event_info_stream, event->value, event->length);
 
 	DEBUG(" operating: Event Type: %d", event_type);
 
 	switch (event_type) {
 	case MDC_NOTI_BUF_SCAN_REPORT_VAR:
-		decode_scanreportinfovar(event_info_stream, &info_var, &error);
+		DECODE_REPORT(ctx, scanreportinfovar, &event_info_stream, &info_var, &error);
 		if (error)
 			break;
 		peri_cfg_scanner_event_report_buf_scan_report_var(ctx, scanner, &info_var);
-		del_scanreportinfovar(&info_var);
+		DEL_REPORT(ctx, scanreportinfovar, &info_var);
 		break;
 	case MDC_NOTI_BUF_SCAN_REPORT_FIXED:
-		decode_scanreportinfofixed(event_info_stream, &info_fixed, &error);
+		DECODE_REPORT(ctx, scanreportinfofixed, &event_info_stream, &info_fixed, &error);
 		if (error)
 			break;
 		peri_cfg_scanner_event_report_buf_scan_report_fixed(ctx, scanner, &info_fixed);
-		del_scanreportinfofixed(&info_fixed);
+		DEL_REPORT(ctx, scanreportinfofixed, &info_fixed);
 		break;
 	case MDC_NOTI_BUF_SCAN_REPORT_GROUPED:
-		decode_scanreportinfogrouped(event_info_stream, &info_grouped, &error);
+		DECODE_REPORT(ctx, scanreportinfogrouped, &event_info_stream, &info_grouped, &error);
 		if (error)
 			break;
 		peri_cfg_scanner_event_report_buf_scan_report_grouped(ctx, scanner, &info_grouped);
-		del_scanreportinfogrouped(&info_grouped);
+		DEL_REPORT(ctx, scanreportinfogrouped, &info_grouped);
 		break;
 	case MDC_NOTI_BUF_SCAN_REPORT_MP_VAR:
-		decode_scanreportinfompvar(event_info_stream, &info_mp_var, &error);
+		DECODE_REPORT(ctx, scanreportinfompvar, &event_info_stream, &info_mp_var, &error);
 		if (error)
 			break;
 		peri_cfg_scanner_event_report_buf_scan_report_mp_var(ctx, scanner, &info_mp_var);
-		del_scanreportinfompvar(&info_mp_var);
+		DEL_REPORT(ctx, scanreportinfompvar, &info_mp_var);
 		break;
 	case MDC_NOTI_BUF_SCAN_REPORT_MP_FIXED:
-		decode_scanreportinfompfixed(event_info_stream, &info_mp_fixed, &error);
+		DECODE_REPORT(ctx, scanreportinfompfixed, &event_info_stream, &info_mp_fixed, &error);
 		if (error)
 			break;
 		peri_cfg_scanner_event_report_buf_scan_report_mp_fixed(ctx, scanner, &info_mp_fixed);
-		del_scanreportinfompfixed(&info_mp_fixed);
+		DEL_REPORT(ctx, scanreportinfompfixed, &info_mp_fixed);
 		break;
 	case MDC_NOTI_BUF_SCAN_REPORT_MP_GROUPED:
-		decode_scanreportinfompgrouped(event_info_stream, &info_mp_grouped, &error);
+		DECODE_REPORT(ctx, scanreportinfompgrouped, &event_info_stream, &info_mp_grouped, &error);
 		if (error)
 			break;
 		peri_cfg_scanner_event_report_buf_scan_report_mp_grouped(ctx, scanner, &info_mp_grouped);
-		del_scanreportinfompgrouped(&info_mp_grouped);
+		DEL_REPORT(ctx, scanreportinfompgrouped, &info_mp_grouped);
 		break;
 	}
-
-	free(event_info_stream);
 }
 
 /**
@@ -1099,56 +1120,55 @@ void operating_decode_epi_scan_event(Context *ctx, struct EpiCfgScanner *scanner
 	ScanReportInfoMPVar info_mp_var;
 	ScanReportInfoMPGrouped info_mp_grouped;
 
-	ByteStreamReader *event_info_stream = byte_stream_reader_instance(event->value, event->length);
+	ByteStreamReader event_info_stream;
+	byte_stream_reader_init(&event_info_stream, event->value, event->length);
 
 	DEBUG(" operating: Event Type: %d", event_type);
 
 	switch (event_type) {
 	case MDC_NOTI_UNBUF_SCAN_REPORT_VAR:
-		decode_scanreportinfovar(event_info_stream, &info_var, &error);
+		DECODE_REPORT(ctx, scanreportinfovar, &event_info_stream, &info_var, &error);
 		if (error)
 			break;
 		epi_cfg_scanner_event_report_unbuf_scan_report_var(ctx, scanner, &info_var);
-		del_scanreportinfovar(&info_var);
+		DEL_REPORT(ctx, scanreportinfovar, &info_var);
 		break;
 	case MDC_NOTI_UNBUF_SCAN_REPORT_FIXED:
-		decode_scanreportinfofixed(event_info_stream, &info_fixed, &error);
+		DECODE_REPORT(ctx, scanreportinfofixed, &event_info_stream, &info_fixed, &error);
 		if (error)
 			break;
 		epi_cfg_scanner_event_report_unbuf_scan_report_fixed(ctx, scanner, &info_fixed);
-		del_scanreportinfofixed(&info_fixed);
+		DEL_REPORT(ctx, scanreportinfofixed, &info_fixed);
 		break;
 	case MDC_NOTI_UNBUF_SCAN_REPORT_GROUPED:
-		decode_scanreportinfogrouped(event_info_stream, &info_grouped, &error);
+		DECODE_REPORT(ctx, scanreportinfogrouped, &event_info_stream, &info_grouped, &error);
 		if (error)
 			break;
 		epi_cfg_scanner_event_report_unbuf_scan_report_grouped(ctx, scanner, &info_grouped);
-		del_scanreportinfogrouped(&info_grouped);
+		DEL_REPORT(ctx, scanreportinfogrouped, &info_grouped);
 		break;
 	case MDC_NOTI_UNBUF_SCAN_REPORT_MP_VAR:
-		decode_scanreportinfompvar(event_info_stream, &info_mp_var, &error);
+		DECODE_REPORT(ctx, scanreportinfompvar, &event_info_stream, &info_mp_var, &error);
 		if (error)
 			break;
 		epi_cfg_scanner_event_report_unbuf_scan_report_mp_var(ctx, scanner, &info_mp_var);
-		del_scanreportinfompvar(&info_mp_var);
+		DEL_REPORT(ctx, scanreportinfompvar, &info_mp_var);
 		break;
 	case MDC_NOTI_UNBUF_SCAN_REPORT_MP_FIXED:
-		decode_scanreportinfompfixed(event_info_stream, &info_mp_fixed, &error);
+		DECODE_REPORT(ctx, scanreportinfompfixed, &event_info_stream, &info_mp_fixed, &error);
 		if (error)
 			break;
 		epi_cfg_scanner_event_report_unbuf_scan_report_mp_fixed(ctx, scanner, &info_mp_fixed);
-		del_scanreportinfompfixed(&info_mp_fixed);
+		DEL_REPORT(ctx, scanreportinfompfixed, &info_mp_fixed);
 		break;
 	case MDC_NOTI_UNBUF_SCAN_REPORT_MP_GROUPED:
-		decode_scanreportinfompgrouped(event_info_stream, &info_mp_grouped, &error);
+		DECODE_REPORT(ctx, scanreportinfompgrouped, &event_info_stream, &info_mp_grouped, &error);
 		if (error)
 			break;
 		epi_cfg_scanner_event_report_unbuf_scan_report_mp_grouped(ctx, scanner, &info_mp_grouped);
-		del_scanreportinfompgrouped(&info_mp_grouped);
+		DEL_REPORT(ctx, scanreportinfompgrouped, &info_mp_grouped);
 		break;
 	}
-
-	free(event_info_stream);
 }
 
 /**
@@ -1169,46 +1189,45 @@ int operating_decode_mds_event(Context *ctx, OID_Type event_type, Any *event)
 	ScanReportInfoMPFixed info_mp_fixed;
 	ScanReportInfoMPVar info_mp_var;
 
-	ByteStreamReader *event_info_stream = byte_stream_reader_instance(event->value, event->length);
+	ByteStreamReader event_info_stream;
+	byte_stream_reader_init(&event_info_stream, event->value, event->length);
 
 	DEBUG(" operating: Event Type: %d", event_type);
 
 	switch (event_type) {
 	case MDC_NOTI_SCAN_REPORT_FIXED:
-		decode_scanreportinfofixed(event_info_stream, &info_fixed, &error);
+		DECODE_REPORT(ctx, scanreportinfofixed, &event_info_stream, &info_fixed, &error);
 		if (! error) {
 			mds_event_report_dynamic_data_update_fixed(ctx, &info_fixed);
 		}
-		del_scanreportinfofixed(&info_fixed);
+		DEL_REPORT(ctx, scanreportinfofixed, &info_fixed);
 		break;
 	case MDC_NOTI_SCAN_REPORT_VAR:
-		decode_scanreportinfovar(event_info_stream, &info_var, &error);
+		DECODE_REPORT(ctx, scanreportinfovar, &event_info_stream, &info_var, &error);
 		if (! error) {
 			mds_event_report_dynamic_data_update_var(ctx, &info_var);
 		}
-		del_scanreportinfovar(&info_var);
+		DEL_REPORT(ctx, scanreportinfovar, &info_var);
 		break;
 	case MDC_NOTI_SCAN_REPORT_MP_FIXED:
-		decode_scanreportinfompfixed(event_info_stream, &info_mp_fixed, &error);
+		DECODE_REPORT(ctx, scanreportinfompfixed, &event_info_stream, &info_mp_fixed, &error);
 		if (! error) {
 			mds_event_report_dynamic_data_update_mp_fixed(ctx, &info_mp_fixed);
 		}
-		del_scanreportinfompfixed(&info_mp_fixed);
+		DEL_REPORT(ctx, scanreportinfompfixed, &info_mp_fixed);
 		break;
 	case MDC_NOTI_SCAN_REPORT_MP_VAR:
-		decode_scanreportinfompvar(event_info_stream, &info_mp_var, &error);
+		DECODE_REPORT(ctx, scanreportinfompvar, &event_info_stream, &info_mp_var, &error);
 		if (! error) {
 			mds_event_report_dynamic_data_update_mp_var(ctx, &info_mp_var);
 		}
-		del_scanreportinfompvar(&info_mp_var);
+		DEL_REPORT(ctx, scanreportinfompvar, &info_mp_var);
 		break;
 	default:
 		ret = 0;
 		break;
 	}
 
-	free(event_info_stream);
-
 	return ret;
 }
 
@@ -1254,9 +1273,9 @@ void operating_decode_segment_info(struct MDS *mds, Any *event, ASN1_HANDLE obj_
 	if (err)
 		goto finally;
 
-	ByteStreamReader *event_info_stream = byte_stream_reader_instance(event->value, event->length);
-	decode_segmentinfolist(event_info_stream, &info_list, &error);
-	free(event_info_stream);
+	ByteStreamReader event_info_stream;
+	byte_stream_reader_init(&event_info_stream, event->value, event->length);
+	decode_segmentinfolist(&event_info_stream, &info_list, &error);
 
 	if (error) {
 		DEBUG("Error decoding segment info");
@@ -1346,10 +1365,25 @@ int operating_decode_segment_data_event(Context *ctx, InvokeIDType invoke_id, AS
 	if (!(segm_data_event.segm_data_event_descr.segm_evt_status & SEVTSTA_AGENT_ABORT) &&
 			mds_obj && mds_obj->choice == MDS_OBJ_PMSTORE) {
 
-		int ok = pmstore_segment_data_event(ctx, &(mds_obj->u.pmstore), segm_data_event);
+		struct PMStore *pmstore = &(mds_obj->u.pmstore);
+
+		int ok = pmstore_segment_data_event(ctx, pmstore, segm_data_event);
 		if (ok) {
 			result.segm_data_event_descr.segm_evt_status = SEVTSTA_MANAGER_CONFIRM;
 		}
+
+		if (ok && pmstore->segment_data_behind) {
+			// backpressure: agent waits for this confirmation
+			DEBUG("Holding segment data event confirmation");
+			pmstore->held_confirm.pending = 1;
+			pmstore->held_confirm.invoke_id = invoke_id;
+			pmstore->held_confirm.current_time = currentTime;
+			pmstore->held_confirm.event_type = event_type;
+			pmstore->held_confirm.result = result;
+
+			del_segmentdataevent(&segm_data_event);
+			return 1;
+		}
 	}
 
 	del_segmentdataevent(&segm_data_event);
@@ -1359,4 +1393,45 @@ int operating_decode_segment_data_event(Context *ctx, InvokeIDType invoke_id, AS
 
 	return 1;
 }
+
+/**
+ * Sends the Segment Data Event confirmation held back while the
+ * application was behind on streamed segment data.
+ *
+ * \param ctx
+ * \param obj_handle PM-Store handle
+ */
+void operating_resume_segment_data(Context *ctx, ASN1_HANDLE obj_handle)
+{
+	struct MDS_object *mds_obj;
+
+	if (ctx->mds == NULL) {
+		return;
+	}
+
+	mds_obj = mds_get_object_by_handle(ctx->mds, obj_handle);
+
+	if (mds_obj == NULL || mds_obj->choice != MDS_OBJ_PMSTORE) {
+		return;
+	}
+
+	struct PMStore *pmstore = &(mds_obj->u.pmstore);
+
+	pmstore->segment_data_behind = 0;
+	pmstore->segment_data_resumed = 1;
+
+	if (pmstore->held_confirm.pending && ctx->fsm->state != fsm_state_operating) {
+		// association is gone, nobody waits for it
+		pmstore->held_confirm.pending = 0;
+	}
+
+	if (pmstore->held_confirm.pending) {
+		pmstore->held_confirm.pending = 0;
+		operating_segment_data_event_response_tx(ctx,
+				pmstore->held_confirm.invoke_id, obj_handle,
+				pmstore->held_confirm.current_time,
+				pmstore->held_confirm.event_type,
+				pmstore->held_confirm.result);
+	}
+}
 /** @} */
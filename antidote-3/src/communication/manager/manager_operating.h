@@ -91,6 +91,8 @@ void operating_decode_segment_info(struct MDS *mds, Any *event, ASN1_HANDLE obj_
 int operating_decode_segment_data_event(Context *ctx, InvokeIDType invoke_id, ASN1_HANDLE obj_handle,
 		RelativeTime currentTime, OID_Type event_type, Any *event);
 
+void operating_resume_segment_data(Context *ctx, ASN1_HANDLE obj_handle);
+
 void operating_rors_confirmed_action_tx(Context *ctx, fsm_events evt, FSMEventData *data);
 void operating_roer_confirmed_action_tx(Context *ctx, fsm_events evt, FSMEventData *data);
 void operating_rorj_confirmed_action_tx(Context *ctx, fsm_events evt, FSMEventData *data);
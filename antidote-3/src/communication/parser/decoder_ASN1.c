@@ -46,6 +46,29 @@
 
 #define QUOTE(x) #x
 
+/**
+ * Arena that receives decoded structures in the calling thread,
+ * NULL when they are allocated from heap. With an arena, octet
+ * strings and Any values also borrow the stream buffer.
+ */
+static __thread Arena *decoder_arena = NULL;
+
+/**
+ * Allocates zero-filled memory for decoded structures
+ *
+ * @param count number of elements
+ * @param size size of each element
+ * @return memory, NULL if cannot allocate it
+ */
+static void *decoder_alloc(size_t count, size_t size)
+{
+	if (decoder_arena != NULL) {
+		return arena_alloc(decoder_arena, count * size);
+	}
+
+	return calloc(count, size);
+}
+
 #define CHK(f)			\
 	(f);			\
 	if (*error)		\
@@ -72,7 +95,7 @@
 
 #define CHILDREN_GENERIC(typeU, decodefunction)									\
 	if (pointer->count > 0) {								\
-		pointer->value = (typeU *) calloc(pointer->count, sizeof(typeU));				\
+		pointer->value = (typeU *) decoder_alloc(pointer->count, sizeof(typeU));			\
 												\
 		if (pointer->value == NULL) {							\
 			ERROR("memory full");							\
@@ -86,19 +109,32 @@
 		}										\
 	}											
 
+#define CHILDREN_MANY(typeU, readmany)							\
+	if (pointer->count > 0) {								\
+		pointer->value = (typeU *) decoder_alloc(pointer->count, sizeof(typeU));	\
+												\
+		if (pointer->value == NULL) {							\
+			ERROR("memory full");							\
+			goto fail;								\
+		}										\
+												\
+		CHK(readmany(stream, pointer->value, pointer->count, error));			\
+	}
+
 #define DECODE_FUNCTION(type) (decode_##type(stream, pointer->value + i, error))
 #define PRIM_FUNCTION(f) (*(pointer->value + i) = f(stream, error))
 
 #define CHILDREN(typeU, type) CHILDREN_GENERIC(typeU, DECODE_FUNCTION(type))
 #define CHILDREN16(typeU) CHILDREN_GENERIC(typeU, PRIM_FUNCTION(read_intu16))
-#define CHILDREN_FLOAT(typeU) CHILDREN_GENERIC(typeU, PRIM_FUNCTION(read_float))
-#define CHILDREN_SFLOAT(typeU) CHILDREN_GENERIC(typeU, PRIM_FUNCTION(read_sfloat))
+#define CHILDREN_FLOAT(typeU) CHILDREN_MANY(typeU, read_float_many)
+#define CHILDREN_SFLOAT(typeU) CHILDREN_MANY(typeU, read_sfloat_many)
 
 #define EPILOGUE(name) 			\
 	return; 			\
 fail:					\
 	ERROR("err dec " QUOTE(name));	\
-	del_##name(pointer);		\
+	if (decoder_arena == NULL)	\
+		del_##name(pointer);	\
 	*error = 1;			\
 	return;
 
@@ -385,6 +421,7 @@ void decode_enumobsvalue(ByteStreamReader *stream, EnumObsValue *pointer, int *e
 
 /**
  * Decodes octet_string. In case of error, does not leak.
+ * When decoding into an arena, value points into stream buffer.
  *
  * @param stream the octet_string content decoded as ByteStreamReader.
  * @param pointer the octet_string to be decoded.
@@ -394,7 +431,10 @@ void decode_octet_string(ByteStreamReader *stream, octet_string *pointer, int *e
 {
 	LV();
 
-	if (pointer->length > 0) {
+	if (pointer->length > 0 && decoder_arena != NULL) {
+		// slice of stream buffer, lives as long as the APDU
+		CHK(pointer->value = read_intu8_slice(stream, pointer->length, error));
+	} else if (pointer->length > 0) {
 		pointer->value = (intu8 *) calloc(pointer->length, sizeof(intu8));
 
 		if (pointer->value == NULL) {
@@ -920,6 +960,45 @@ void decode_apdu(ByteStreamReader *stream, APDU *pointer, int *error)
 	EPILOGUE(apdu);
 }
 
+/**
+ * Selects where the calling thread puts decoded structures. With an
+ * arena, every structure is allocated from it and octet strings and
+ * Any values are not copied: they point into the stream buffer. Such
+ * results must not be deleted with del_*() and are only valid while
+ * both the arena contents and the stream buffer are. Data that must
+ * live longer has to be decoded without arena or copied.
+ *
+ * @param arena arena, or NULL to allocate from heap and copy values
+ * @return arena previously selected
+ */
+Arena *decoder_set_arena(Arena *arena)
+{
+	Arena *previous = decoder_arena;
+
+	decoder_arena = arena;
+
+	return previous;
+}
+
+/**
+ * Decode APDU allocating every decoded structure from an arena.
+ * The APDU must not be deleted with del_apdu(); it is released
+ * with the arena, e.g. by arena_reset(), and its values point into
+ * the stream buffer (see decoder_set_arena()).
+ *
+ * @param *stream
+ * @param *pointer
+ * @param arena arena that owns the decoded structures
+ * @param error Error feedback
+ */
+void decode_apdu_arena(ByteStreamReader *stream, APDU *pointer, Arena *arena, int *error)
+{
+	Arena *previous = decoder_set_arena(arena);
+
+	decode_apdu(stream, pointer, error);
+	decoder_set_arena(previous);
+}
+
 /**
  * Decode PRST_apdu
  *
@@ -932,7 +1011,7 @@ void decode_prst_apdu(ByteStreamReader *stream, PRST_apdu *pointer, int *error)
 	LV();
 
 	if (pointer->length > 0) {
-		DATA_apdu *data = (DATA_apdu *) calloc(1, sizeof(DATA_apdu));
+		DATA_apdu *data = (DATA_apdu *) decoder_alloc(1, sizeof(DATA_apdu));
 
 		if (data == NULL) {
 			ERROR("memory full");
@@ -963,7 +1042,8 @@ void decode_pmsegmententrymap(ByteStreamReader *stream, PmSegmentEntryMap *point
 }
 
 /**
- * Decode Any
+ * Decode Any. When decoding into an arena, value points into
+ * stream buffer.
  *
  * @param *stream
  * @param *pointer
@@ -973,7 +1053,10 @@ void decode_any(ByteStreamReader *stream, Any *pointer, int *error)
 {
 	LV();
 
-	if (pointer->length > 0) {
+	if (pointer->length > 0 && decoder_arena != NULL) {
+		// slice of stream buffer, lives as long as the APDU
+		CHK(pointer->value = read_intu8_slice(stream, pointer->length, error));
+	} else if (pointer->length > 0) {
 		pointer->value = (intu8 *) calloc(pointer->length, sizeof(intu8));
 
 		if (pointer->value == NULL) {
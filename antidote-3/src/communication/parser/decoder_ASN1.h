@@ -43,6 +43,7 @@
 #define DECODER_ASN1_H_
 
 #include "src/util/bytelib.h"
+#include "src/util/arena.h"
 
 void decode_segmentdataresult(ByteStreamReader *stream, SegmentDataResult *pointer, int *error);
 void decode_scanreportpervar(ByteStreamReader *stream, ScanReportPerVar *pointer, int *error);
@@ -95,6 +96,8 @@ extern "C" {
 #else
 void decode_apdu(ByteStreamReader *stream, APDU *pointer, int *error);
 #endif
+Arena *decoder_set_arena(Arena *arena);
+void decode_apdu_arena(ByteStreamReader *stream, APDU *pointer, Arena *arena, int *error);
 void decode_prst_apdu(ByteStreamReader *stream, PRST_apdu *pointer, int *error);
 void decode_pmsegmententrymap(ByteStreamReader *stream, PmSegmentEntryMap *pointer, int *error);
 void decode_any(ByteStreamReader *stream, Any *pointer, int *error);
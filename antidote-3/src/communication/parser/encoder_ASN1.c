@@ -956,6 +956,27 @@ int encode_apdu(ByteStreamWriter *stream, APDU *pointer)
 	L_EPILOGUE();
 }
 
+/**
+ * Calculates the encoded size of APDU, running encode_apdu() over a
+ * writer that only counts octets. Length fields of pointer are
+ * refreshed, exactly as encode_apdu() does.
+ *
+ * @param *pointer
+ * @return encoded byte count if ok, 0 if error
+ */
+intu32 encoded_size_apdu(APDU *pointer)
+{
+	ByteStreamWriter counter;
+
+	byte_stream_counter_init(&counter);
+
+	if (!encode_apdu(&counter, pointer)) {
+		return 0;
+	}
+
+	return counter.size;
+}
+
 /**
  * Encode PRST_apdu
  *
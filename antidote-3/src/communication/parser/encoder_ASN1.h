@@ -89,6 +89,7 @@ int encode_observationscanlist(ByteStreamWriter *stream, ObservationScanList *po
 int encode_set_data_apdu(PRST_apdu *prst, DATA_apdu *data_apdu);
 DATA_apdu *encode_get_data_apdu(PRST_apdu *prst);
 int encode_apdu(ByteStreamWriter *stream, APDU *pointer);
+intu32 encoded_size_apdu(APDU *pointer);
 int encode_prst_apdu(ByteStreamWriter *stream, PRST_apdu *pointer);
 int encode_pmsegmententrymap(ByteStreamWriter *stream, PmSegmentEntryMap *pointer);
 int encode_any(ByteStreamWriter *stream, Any *pointer);
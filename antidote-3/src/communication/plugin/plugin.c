@@ -163,6 +163,7 @@ void communication_plugin_clear(CommunicationPlugin *plugin)
 	plugin->network_init = NULL;
 	plugin->network_wait_for_data = NULL;
 	plugin->network_get_apdu_stream = NULL;
+	plugin->network_release_apdu_stream = NULL;
 	plugin->network_send_apdu_stream = NULL;
 	plugin->network_finalize = NULL;
 	plugin->thread_lock = NULL;
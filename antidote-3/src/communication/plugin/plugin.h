@@ -54,6 +54,7 @@
 			.network_init = NULL,\
 			.network_wait_for_data = NULL,\
 			.network_get_apdu_stream = NULL,\
+			.network_release_apdu_stream = NULL,\
 			.network_send_apdu_stream = NULL,\
 			.network_disconnect = NULL,\
 			.network_finalize = NULL,\
@@ -101,6 +102,10 @@ typedef int (*network_finalize_ptr)();
  * Function prototype for Network support
  */
 typedef ByteStreamReader* (*network_get_apdu_stream_ptr)(PluginContext *ctx);
+/**
+ * Function prototype for Network support
+ */
+typedef void (*network_release_apdu_stream_ptr)(PluginContext *ctx, ByteStreamReader *stream);
 /**
  * Function prototype for Network support
  */
@@ -158,6 +163,15 @@ typedef struct CommunicationPlugin {
 	 */
 	network_get_apdu_stream_ptr network_get_apdu_stream;
 
+	/**
+	 * Gives back a received APDU stream once the stack has processed
+	 * it. Plug-ins that hand out streams pointing into their own
+	 * reception buffers implement this to recycle buffer space.
+	 *
+	 * If NULL, the stack frees the stream and its buffer.
+	 */
+	network_release_apdu_stream_ptr network_release_apdu_stream;
+
 	/**
 	 * Blocks to wait data to be available
 	 *
@@ -41,6 +41,8 @@
 #include <pthread.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
 
 #if defined(__APPLE__) && defined(__MACH__)
 #define MUTEX_TYPE PTHREAD_MUTEX_RECURSIVE
@@ -49,16 +51,44 @@
 #endif
 
 /**
- * Global stack lock, named "GIL" after Python :)
- * GIL is used when the stack needs a global protection
- * like when doing some global list manipulation
+ * Timer wheel shared by all contexts, 1 tick = 1 ms
  */
-static pthread_mutex_t gil;
+static TimerWheel timer_wheel;
 
 /**
- * GIL pattributes
+ * Protects timer wheel and timer state below
  */
-static pthread_mutexattr_t gil_attr;
+static pthread_mutex_t timer_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Wakes up timer thread when a nearer timer is armed
+ */
+static pthread_cond_t timer_cond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * Signaled when a timer callback finishes
+ */
+static pthread_cond_t timer_done_cond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * Id of timer whose callback is being dispatched, 0 if none
+ */
+static unsigned int timer_firing_id = 0;
+
+/**
+ * Last given timer id
+ */
+static unsigned int timer_last_id = 0;
+
+/**
+ * Guards timer thread creation
+ */
+static pthread_once_t timer_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Timer thread
+ */
+static pthread_t timer_thread;
 
 /*
  * Get multithreading control structure of a context
@@ -118,81 +148,169 @@ static void plugin_pthread_ctx_finalize(Context *ctx)
 /**
  * Lock the context received.
  *
- * @param ctx the context that will be locked. NULL = lock GIL
+ * @param ctx the context that will be locked.
  */
 static void plugin_pthread_ctx_lock(Context *ctx)
 {
 	if (ctx) {
 		ThreadContext *thread_ctx = get_thread_ctx(ctx);
 		pthread_mutex_lock(&thread_ctx->mutex);
-	} else {
-		pthread_mutex_lock(&gil);
 	}
 }
 
 /**
  * Unlock the context received.
  *
- * @param ctx the context that will be unlocked. NULL = GIL
+ * @param ctx the context that will be unlocked.
  */
 static void plugin_pthread_ctx_unlock(Context *ctx)
 {
 	if (ctx) {
 		ThreadContext *thread_ctx = (ThreadContext *) ctx->multithread;
 		pthread_mutex_unlock(&thread_ctx->mutex);
-	} else {
-		pthread_mutex_unlock(&gil);
 	}
 }
 
 /**
- * Pthread-based implementation for timeout function
- * Runnable part
+ * Current time in timer ticks (ms)
+ *
+ * @return monotonic time in ms
+ */
+static unsigned long long timer_now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (unsigned long long) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Calls timeout callback of a context whose timer expired.
+ * The context may have been reset or destroyed meanwhile,
+ * so it is looked up again and the timer id is checked.
+ *
+ * @param id context id
+ * @param timer_id expired timer id
+ */
+static void timer_dispatch(ContextId id, unsigned int timer_id)
+{
+	Context *ctx = context_get_and_lock(id);
+
+	if (ctx == NULL) {
+		return;
+	}
+
+	ThreadContext *thread_ctx = get_thread_ctx(ctx);
+
+	if (thread_ctx != NULL && thread_ctx->timer_id == timer_id) {
+		DEBUG(" timer: timeout id %d fired", timer_id);
+
+		pthread_mutex_lock(&timer_mutex);
+		thread_ctx->timer_id = 0;
+		pthread_mutex_unlock(&timer_mutex);
+
+		// cleared before the call, so the callback may arm a new timeout
+		timer_callback_function func = ctx->timeout_action.func;
+		ctx->timeout_action.func = NULL;
+		ctx->timeout_action.timeout = 0;
+
+		if (func != NULL) {
+			func(ctx);
+		}
+	}
+
+	context_unlock(ctx);
+}
+
+/**
+ * Timer thread: sleeps until next timer is due and dispatches
+ * expired timers. Context locks are only taken with timer_mutex
+ * released.
  */
 static void *timer_run(void *arg)
 {
-	pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-	pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, NULL);
+	pthread_mutex_lock(&timer_mutex);
 
-	DEBUG(" timer: running timeout thread ");
+	while (1) {
+		TimerWheelEntry *entry;
 
-	Context *ctx = (Context *) arg;
+		while ((entry = twheel_expire(&timer_wheel, timer_now()))) {
+			Context *ctx = (Context *) entry->data;
+			ThreadContext *thread_ctx = get_thread_ctx(ctx);
+			ContextId id = ctx->id;
+			unsigned int timer_id = thread_ctx->timer_id;
 
-	timeout_callback *callback = &ctx->timeout_action;
+			timer_firing_id = timer_id;
+			pthread_mutex_unlock(&timer_mutex);
 
-	DEBUG(" timer: sleeping %d\n", callback->timeout);
-	sleep(callback->timeout);
-	DEBUG(" timer: wake up!\n");
+			timer_dispatch(id, timer_id);
 
-	plugin_pthread_ctx_lock(ctx);
+			pthread_mutex_lock(&timer_mutex);
+			timer_firing_id = 0;
+			pthread_cond_broadcast(&timer_done_cond);
+		}
+
+		long long ticks = twheel_next(&timer_wheel);
 
-	if (callback->func != NULL) {
-		(callback->func)(ctx);
+		if (ticks < 0) {
+			pthread_cond_wait(&timer_cond, &timer_mutex);
+		} else {
+			struct timeval tv;
+			struct timespec deadline;
+
+			gettimeofday(&tv, NULL);
+			ticks += tv.tv_usec / 1000;
+			deadline.tv_sec = tv.tv_sec + ticks / 1000;
+			deadline.tv_nsec = (ticks % 1000) * 1000000 +
+					   (tv.tv_usec % 1000) * 1000;
+
+			pthread_cond_timedwait(&timer_cond, &timer_mutex, &deadline);
+		}
 	}
 
-	DEBUG(" timer: finishing timeout thread.");
-	ctx->timeout_action.func = NULL;
-	ctx->timeout_action.timeout = 0;
+	return NULL;
+}
+
+/**
+ * Starts timer thread
+ */
+static void timer_start()
+{
+	twheel_init(&timer_wheel, timer_now());
 
-	plugin_pthread_ctx_unlock(ctx);
-	pthread_exit(NULL);
+	int return_code = pthread_create(&timer_thread, NULL, timer_run, NULL);
+
+	if (return_code) {
+		ERROR("timer: return code from pthread_create() is %d",
+		      return_code);
+		return;
+	}
+
+	pthread_detach(timer_thread);
 }
 
 /**
- * Blocks current thread and waits for timeout thread termination.
+ * Blocks current thread until the armed timeout fires or is reset.
  * This plug-in feature is actually used by unit-testing only.
  *
  * @param context
- * @return thread termination value
  */
 static void timer_wait_for_timeout(Context *ctx)
 {
-	DEBUG(" timer: Waiting for timeout thread termination.");
+	DEBUG(" timer: Waiting for timeout.");
 	ThreadContext *thread_ctx = get_thread_ctx(ctx);
-	pthread_join(*thread_ctx->timeout_thread, NULL);
 
-	free(thread_ctx->timeout_thread);
-	thread_ctx->timeout_thread = NULL;
+	pthread_mutex_lock(&timer_mutex);
+
+	unsigned int timer_id = thread_ctx->timer_id;
+
+	while (timer_id != 0 && (thread_ctx->timer_id == timer_id ||
+				 timer_firing_id == timer_id)) {
+		pthread_cond_wait(&timer_done_cond, &timer_mutex);
+	}
+
+	pthread_mutex_unlock(&timer_mutex);
 }
 
 /**
@@ -205,51 +323,49 @@ static void timer_reset_timeout(Context *ctx)
 	plugin_pthread_ctx_lock(ctx);
 	ThreadContext *thread_ctx = get_thread_ctx(ctx);
 
-	if (thread_ctx != NULL && thread_ctx->timeout_thread != NULL) {
-		DEBUG(" timer: Reseting timeout thread ");
+	if (thread_ctx != NULL && thread_ctx->timer_id != 0) {
+		DEBUG(" timer: Reseting timeout id %d", thread_ctx->timer_id);
 
-		pthread_cancel(*thread_ctx->timeout_thread);
-		pthread_join(*thread_ctx->timeout_thread, NULL);
-	
-		free(thread_ctx->timeout_thread);
-		thread_ctx->timeout_thread = NULL;
+		pthread_mutex_lock(&timer_mutex);
+		twheel_remove(&timer_wheel, &thread_ctx->timer);
+		thread_ctx->timer_id = 0;
+		pthread_cond_broadcast(&timer_done_cond);
+		pthread_mutex_unlock(&timer_mutex);
 	}
 
 	plugin_pthread_ctx_unlock(ctx);
 }
 
 /**
- * Pthread-based implementation for timeout function
+ * Arms timeout of context in the shared timer wheel
  *
  * @param context
  * @return timer id
  */
 static int timer_count_timeout(Context *ctx)
 {
-	static int last_id = 0;
+	pthread_once(&timer_once, &timer_start);
 
 	plugin_pthread_ctx_lock(ctx);
 
 	timer_reset_timeout(ctx);
 	ThreadContext *thread_ctx = get_thread_ctx(ctx);
 
-	if (thread_ctx->timeout_thread == NULL) {
-		thread_ctx->timeout_thread = malloc(sizeof(pthread_t));
-		ctx->timeout_action.id = ++last_id;
+	pthread_mutex_lock(&timer_mutex);
 
-		DEBUG("timer: Creating timeout counter thread id %d, time: %d",
-		      ctx->timeout_action.id,
-		      ctx->timeout_action.timeout);
+	ctx->timeout_action.id = ++timer_last_id;
+	thread_ctx->timer_id = ctx->timeout_action.id;
+	thread_ctx->timer.data = ctx;
 
-		int return_code = pthread_create(thread_ctx->timeout_thread,
-						 NULL, timer_run, (void *) ctx);
+	DEBUG("timer: Arming timeout id %d, time: %d",
+	      ctx->timeout_action.id,
+	      ctx->timeout_action.timeout);
 
-		if (return_code) {
-			DEBUG("ERROR timer: return code from "
-			      "pthread_create() is %d", return_code);
-			return 0;
-		}
-	}
+	twheel_add(&timer_wheel, &thread_ctx->timer,
+		   timer_now() + ctx->timeout_action.timeout * 1000ULL);
+	pthread_cond_signal(&timer_cond);
+
+	pthread_mutex_unlock(&timer_mutex);
 
 	plugin_pthread_ctx_unlock(ctx);
 	return ctx->timeout_action.id;
@@ -275,11 +391,6 @@ void plugin_pthread_setup(CommunicationPlugin *plugin)
 	plugin->timer_count_timeout = timer_count_timeout;
 	plugin->timer_reset_timeout = timer_reset_timeout;
 	plugin->timer_wait_for_timeout = timer_wait_for_timeout;
-
-	// Initialize GIL
-	pthread_mutexattr_init(&gil_attr);
-	pthread_mutexattr_settype(&gil_attr, MUTEX_TYPE);
-	pthread_mutex_init(&gil, &gil_attr);
 }
 
 /** @} */
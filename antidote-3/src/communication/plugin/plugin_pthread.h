@@ -39,6 +39,7 @@
 #include <pthread.h>
 #include "src/communication/plugin/plugin.h"
 #include "src/communication/common/communication.h"
+#include "src/util/timerwheel.h"
 
 void plugin_pthread_setup(CommunicationPlugin *plugin);
 
@@ -49,8 +50,15 @@ typedef struct ThreadContext {
 	pthread_mutex_t mutex;
 	pthread_mutexattr_t mutex_attr;
 
-	// Timer Thread
-	pthread_t *timeout_thread;
+	/**
+	 * Timeout armed in shared timer wheel
+	 */
+	TimerWheelEntry timer;
+
+	/**
+	 * Id of armed timeout, 0 if none
+	 */
+	unsigned int timer_id;
 
 	/**
 	 * Used by unit-testing
@@ -41,6 +41,7 @@
 #include "src/util/log.h"
 #include "src/util/ioutil.h"
 #include "src/util/linkedlist.h"
+#include "src/util/rxbuff.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -102,17 +103,7 @@ typedef struct NetworkSocket {
 	/**
 	 * Reception buffer
 	 */
-	intu8 *buffer;
-
-	/**
-	 * Reception buffer length
-	 */
-	int buffer_size;
-
-	/**
-	 * Signals that buffer may have another APDU
-	 */
-	int buffer_retry;
+	RxBuffer *rx;
 } NetworkSocket;
 
 /**
@@ -295,79 +286,55 @@ static int network_tcp_wait_for_data(Context *ctx)
 static ByteStreamReader *network_get_apdu_stream(Context *ctx)
 {
 	NetworkSocket *sk = get_socket(ctx->id.connid);
-	ContextId cid = {plugin_id, sk->tcp_port};
 
 	if (sk == NULL) {
 		ERROR("network tcp: network_get_apdu_stream cannot found a valid sokcet");
 		return NULL;
 	}
 
-	if (sk->buffer_retry) {
-		// see if there is another complete APDU in buffer
-		sk->buffer_retry = 0;
-	} else {
-		intu8 localbuf[65535];
-		int bytes_read = read(sk->client_sk, localbuf, 65535);
+	ContextId cid = {plugin_id, sk->tcp_port};
 
-		if (bytes_read < 0) {
-			sk->connected = 0;
-			free(sk->buffer);
-			sk->buffer = 0;
-			sk->buffer_size = 0;
-			communication_transport_disconnect_indication(cid, "tcp");
-			return NULL;
-		} else if (bytes_read == 0) {
+	// see if there is another complete APDU in buffer
+	ByteStreamReader *stream = rxbuff_get_apdu(sk->rx);
+
+	if (stream == NULL) {
+		int bytes_read = rxbuff_read(sk->rx, sk->client_sk);
+
+		if (bytes_read <= 0) {
 			sk->connected = 0;
-			free(sk->buffer);
-			sk->buffer = 0;
-			sk->buffer_size = 0;
+			rxbuff_clear(sk->rx);
 			communication_transport_disconnect_indication(cid, "tcp");
 			return NULL;
 		}
 
-		sk->buffer = realloc(sk->buffer, sk->buffer_size + bytes_read);
-		memcpy(sk->buffer + sk->buffer_size, localbuf, bytes_read);
-		sk->buffer_size += bytes_read;
+		stream = rxbuff_get_apdu(sk->rx);
 	}
 
-	if (sk->buffer_size < 4) {
+	if (stream == NULL) {
 		DEBUG(" network:tcp incomplete APDU (received %d)",
-						sk->buffer_size);
+		      sk->rx->end - sk->rx->start);
 		return NULL;
 	}
 
-	int apdu_size = (sk->buffer[2] << 8 | sk->buffer[3]) + 4;
-
-	if (sk->buffer_size < apdu_size) {
-		DEBUG(" network:tcp incomplete APDU (expect %d received %d)",
-						apdu_size, sk->buffer_size);
-		return NULL;
-	}
+	DEBUG(" network:tcp APDU received ");
+	ioutil_print_buffer(stream->buffer_cur, stream->unread_bytes);
 
-	// Create bytestream
-	ByteStreamReader *stream = byte_stream_reader_instance(sk->buffer, apdu_size);
+	return stream;
+}
 
-	if (stream == NULL) {
-		DEBUG(" network:tcp Error creating bytelib");
-		free(sk->buffer);
-		sk->buffer = NULL;
-		sk->buffer_size = 0;
-		return NULL;
-	}
+/**
+ * Recycles reception buffer space of a processed APDU
+ *
+ * @param ctx
+ * @param stream stream returned by network_get_apdu_stream
+ */
+static void network_release_apdu_stream(Context *ctx, ByteStreamReader *stream)
+{
+	NetworkSocket *sk = get_socket(ctx->id.connid);
 
-	sk->buffer = 0;
-	sk->buffer_size -= apdu_size;
-	if (sk->buffer_size > 0) {
-		// leave next APDU in place
-		sk->buffer_retry = 1;
-		sk->buffer = malloc(sk->buffer_size);
-		memcpy(sk->buffer, stream->buffer_cur + apdu_size, sk->buffer_size);
+	if (sk != NULL) {
+		rxbuff_release_apdu(sk->rx, stream);
 	}
-
-	DEBUG(" network:tcp APDU received ");
-	ioutil_print_buffer(stream->buffer_cur, apdu_size);
-
-	return stream;
 }
 
 /**
@@ -434,9 +401,7 @@ static int fin_socket(void *element)
 		socket->connected = 0;
 		DEBUG(" network tcp: socket %d closed ", socket->tcp_port);
 
-		free(socket->buffer);
-		socket->buffer = 0;
-		socket->buffer_size = 0;
+		rxbuff_clear(socket->rx);
 	}
 
 	return 1;
@@ -459,10 +424,7 @@ static int network_disconnect(Context *ctx)
 	close(sk->client_sk);
 	sk->client_sk = -1;
 
-	free(sk->buffer);
-	sk->buffer = 0;
-	sk->buffer_size = 0;
-	sk->buffer_retry = 0;
+	rxbuff_clear(sk->rx);
 
 	return TCP_ERROR_NONE;
 }
@@ -500,12 +462,31 @@ static int create_socket(int port)
 		return TCP_ERROR;
 	}
 
+	socket->rx = rxbuff_new();
+
 	socket->tcp_port = port;
 	socket->server_sk = -1;
 	socket->client_sk = -1;
 	return TCP_ERROR_NONE;
 }
 
+/**
+ * Destroys a NetworkSocket struct
+ *
+ * @param element contains a NetworkSocket struct pointer
+ */
+static int destroy_socket(void *element)
+{
+	NetworkSocket *socket = (NetworkSocket *) element;
+
+	if (socket != NULL) {
+		rxbuff_del(socket->rx);
+		free(socket);
+	}
+
+	return 1;
+}
+
 /**
  * Initiate a CommunicationPlugin struct to use tcp connection.
  *
@@ -524,7 +505,7 @@ int plugin_network_tcp_setup(CommunicationPlugin *plugin, int numberOfPorts,
 
 	if (sockets) {
 		// plugin was already initialized once
-		llist_destroy(sockets, (llist_handle_element) free);
+		llist_destroy(sockets, &destroy_socket);
 		sockets = NULL;
 	}
 
@@ -544,6 +525,7 @@ int plugin_network_tcp_setup(CommunicationPlugin *plugin, int numberOfPorts,
 	plugin->network_init = network_init;
 	plugin->network_wait_for_data = network_tcp_wait_for_data;
 	plugin->network_get_apdu_stream = network_get_apdu_stream;
+	plugin->network_release_apdu_stream = network_release_apdu_stream;
 	plugin->network_send_apdu_stream = network_send_apdu_stream;
 	plugin->network_disconnect = network_disconnect;
 	plugin->network_finalize = network_finalize;
@@ -42,6 +42,7 @@
 #include "src/communication/plugin/plugin_tcp_agent.h"
 #include "src/util/log.h"
 #include "src/util/ioutil.h"
+#include "src/util/rxbuff.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -64,9 +65,7 @@ static const int TCP_ERROR_NONE = NETWORK_ERROR_NONE;
 
 static int sk = -1;
 static int port = 0;
-static intu8 *buffer = NULL;
-static int buffer_size = 0;
-static int buffer_retry = 0;
+static RxBuffer *rx = NULL;
 
 /**
  * Initialize network layer.
@@ -147,8 +146,8 @@ static int network_tcp_wait_for_data(Context *ctx)
 		return TCP_ERROR;
 	}
 
-	if (buffer_retry) {
-		// there may be another APDU in buffer already
+	if (rxbuff_has_apdu(rx)) {
+		// there is another APDU in buffer already
 		return TCP_ERROR_NONE;
 	}
 
@@ -198,77 +197,47 @@ static ByteStreamReader *network_get_apdu_stream(Context *ctx)
 		return NULL;
 	}
 
-	if (buffer_retry) {
-		// handling letover data in buffer
-		buffer_retry = 0;
-	} else {
-		intu8 localbuf[65535];
-		int bytes_read = read(sk, localbuf, 65535);
+	// handling leftover data in buffer
+	ByteStreamReader *stream = rxbuff_get_apdu(rx);
 
-		if (bytes_read < 0) {
-			close(sk);
-			free(buffer);
-			buffer = 0;
-			buffer_size = 0;
-			communication_transport_disconnect_indication(cid, "tcp");
-			DEBUG(" network:tcp error");
-			sk = -1;
-			return NULL;
-		} else if (bytes_read == 0) {
+	if (stream == NULL) {
+		int bytes_read = rxbuff_read(rx, sk);
+
+		if (bytes_read <= 0) {
 			close(sk);
-			free(buffer);
-			buffer = 0;
-			buffer_size = 0;
+			rxbuff_clear(rx);
 			communication_transport_disconnect_indication(cid, "tcp");
-			DEBUG(" network:tcp closed");
+			DEBUG(" network:tcp %s", bytes_read < 0 ? "error" : "closed");
 			sk = -1;
 			return NULL;
 		}
 
-		buffer = realloc(buffer, buffer_size + bytes_read);
-		memcpy(buffer + buffer_size, localbuf, bytes_read);
-		buffer_size += bytes_read;
-	}
-
-	if (buffer_size < 4) {
-		DEBUG(" network:tcp incomplete APDU (received %d)", buffer_size);
-		return NULL;
+		stream = rxbuff_get_apdu(rx);
 	}
 
-	int apdu_size = (buffer[2] << 8 | buffer[3]) + 4;
-
-	if (buffer_size < apdu_size) {
-		DEBUG(" network:tcp incomplete APDU (expected %d received %d",
-		      					apdu_size, buffer_size);
-		return NULL;
-	}
-
-	// Create bytestream
-	ByteStreamReader *stream = byte_stream_reader_instance(buffer, apdu_size);
-
 	if (stream == NULL) {
-		DEBUG(" network:tcp Error creating bytelib");
-		free(buffer);
-		buffer = NULL;
-		buffer_size = 0;
+		DEBUG(" network:tcp incomplete APDU (received %d)",
+		      rx->end - rx->start);
 		return NULL;
 	}
 
-	buffer = 0;
-	buffer_size -= apdu_size;
-	if (buffer_size > 0) {
-		// leave next APDU in buffer
-		buffer_retry = 1;
-		buffer = malloc(buffer_size);
-		memcpy(buffer, stream->buffer_cur + apdu_size, buffer_size);
-	}
-
 	DEBUG(" network:tcp APDU received ");
-	ioutil_print_buffer(stream->buffer_cur, apdu_size);
+	ioutil_print_buffer(stream->buffer_cur, stream->unread_bytes);
 
 	return stream;
 }
 
+/**
+ * Recycles reception buffer space of a processed APDU
+ *
+ * @param ctx
+ * @param stream stream returned by network_get_apdu_stream
+ */
+static void network_release_apdu_stream(Context *ctx, ByteStreamReader *stream)
+{
+	rxbuff_release_apdu(rx, stream);
+}
+
 /**
  * Sends an encoded apdu
  *
@@ -315,10 +284,7 @@ static int network_disconnect(Context *ctx)
 	close(sk);
 	sk = -1;
 
-	free(buffer);
-	buffer = 0;
-	buffer_size = 0;
-	buffer_retry = 0;
+	rxbuff_clear(rx);
 
 	return TCP_ERROR_NONE;
 }
@@ -333,9 +299,7 @@ static int network_finalize()
 	close(sk);
 	sk = -1;
 
-	free(buffer);
-	buffer = 0;
-	buffer_size = 0;
+	rxbuff_clear(rx);
 
 	return TCP_ERROR_NONE;
 }
@@ -344,7 +308,12 @@ static int create_socket(int pport)
 {
 	DEBUG("network tcp: creating socket configuration on port %d", pport);
 	port = pport;
-	return TCP_ERROR_NONE;
+
+	if (rx == NULL) {
+		rx = rxbuff_new();
+	}
+
+	return rx != NULL ? TCP_ERROR_NONE : TCP_ERROR;
 }
 
 /**
@@ -366,6 +335,7 @@ int plugin_network_tcp_agent_setup(CommunicationPlugin *plugin, int pport)
 	plugin->network_init = network_init;
 	plugin->network_wait_for_data = network_tcp_wait_for_data;
 	plugin->network_get_apdu_stream = network_get_apdu_stream;
+	plugin->network_release_apdu_stream = network_release_apdu_stream;
 	plugin->network_send_apdu_stream = network_send_apdu_stream;
 	plugin->network_disconnect = network_disconnect;
 	plugin->network_finalize = network_finalize;
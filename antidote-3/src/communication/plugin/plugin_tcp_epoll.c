@@ -0,0 +1,842 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file plugin_tcp_epoll.c
+ * \brief Single-port, multi-agent TCP manager plugin source.
+ *
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ */
+
+/**
+ * @addtogroup EpollTcpPlugin
+ *
+ * \brief Manager TCP plugin that serves many agents on a single port.
+ *
+ * Unlike the plain TCP plugin, which creates one context per listening
+ * port and blocks in accept(), this plugin listens on one non-blocking
+ * socket and gives every accepted connection its own context (and
+ * connid). All sockets are watched by a single epoll instance; the
+ * application drives it by calling plugin_network_tcp_epoll_poll()
+ * from its main loop, so network_wait_for_data() is not used.
+ *
+ * APDUs are processed right in the polling thread, unless scheduler
+ * workers are running (see manager_start_workers()); then the polling
+ * thread only fills reception buffers and notifies the scheduler, and
+ * workers take the APDUs through network_get_apdu_stream().
+ *
+ * The connection ID carries the socket descriptor in its lower 32 bits
+ * and a generation counter in the upper 32 bits, so connection lookup
+ * is a direct table index and a recycled descriptor never matches a
+ * stale context.
+ *
+ * @{
+ */
+
+#include "src/communication/common/communication.h"
+#include "src/communication/common/context_manager.h"
+#include "src/communication/common/scheduler.h"
+#include "src/communication/plugin/plugin_tcp_epoll.h"
+#include "src/util/log.h"
+#include "src/util/rxbuff.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+
+/**
+ * Plugin ID attributed by stack
+ */
+static unsigned int plugin_id = 0;
+
+/**
+ * \cond Undocumented
+ */
+static const int TCP_ERROR = NETWORK_ERROR;
+static const int TCP_ERROR_NONE = NETWORK_ERROR_NONE;
+static const int BACKLOG = SOMAXCONN;
+
+#define MAX_EVENTS 64
+#define SEND_TIMEOUT_MS 5000
+#define CONNID_FD_MASK 0xFFFFFFFFULL
+#define LISTENER_EVENT_ID 0
+/**
+ * \endcond
+ */
+
+/**
+ * Struct which contains connection context
+ */
+typedef struct Connection {
+	/**
+	 * Connected socket
+	 */
+	int fd;
+
+	/**
+	 * Connection ID given to the stack
+	 */
+	unsigned long long connid;
+
+	/**
+	 * Peer address (informative)
+	 */
+	char addr[INET_ADDRSTRLEN + 8];
+
+	/**
+	 * Reception buffer
+	 */
+	RxBuffer *rx;
+
+	/**
+	 * Protects rx, which workers read while poll thread fills it
+	 */
+	pthread_mutex_t rx_mutex;
+
+	/**
+	 * Serializes senders of this connection
+	 */
+	pthread_mutex_t send_mutex;
+
+	/**
+	 * Non-zero while socket is not polled for input because rx is
+	 * full; protected by rx_mutex
+	 */
+	int rx_paused;
+
+	/**
+	 * References held by the connections table and by senders.
+	 * Socket is closed and memory freed when the last one is dropped.
+	 */
+	int ref;
+} Connection;
+
+/**
+ * TCP port to listen
+ */
+static int tcp_port = 0;
+
+/**
+ * Listener socket
+ */
+static int server_sk = -1;
+
+/**
+ * Reactor
+ */
+static int epoll_fd = -1;
+
+/**
+ * Connection ID generation counter
+ */
+static unsigned int generation = 0;
+
+/**
+ * Connections indexed by socket descriptor
+ */
+static Connection **connections = NULL;
+
+/**
+ * Number of slots in connections table
+ */
+static int connections_size = 0;
+
+/**
+ * Guards the connections table against senders in other threads.
+ * Connections only enter and leave the table in the polling thread;
+ * senders hold a reference instead of this lock while writing.
+ */
+static pthread_mutex_t connections_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Gets a connection given its ID. Must be called with
+ * connections_mutex held.
+ *
+ * @param connid Connection ID
+ * @return Connection or NULL if not found
+ */
+static Connection *get_connection(unsigned long long connid)
+{
+	int fd = (int) (connid & CONNID_FD_MASK);
+
+	if (fd < 0 || fd >= connections_size) {
+		return NULL;
+	}
+
+	Connection *conn = connections[fd];
+
+	if (conn == NULL || conn->connid != connid) {
+		return NULL;
+	}
+
+	return conn;
+}
+
+/**
+ * Gets a connection given its ID, with its reception buffer locked
+ *
+ * @param connid Connection ID
+ * @return Connection or NULL if not found
+ */
+static Connection *lock_connection_rx(unsigned long long connid)
+{
+	pthread_mutex_lock(&connections_mutex);
+
+	Connection *conn = get_connection(connid);
+
+	if (conn) {
+		pthread_mutex_lock(&conn->rx_mutex);
+	}
+
+	pthread_mutex_unlock(&connections_mutex);
+
+	return conn;
+}
+
+/**
+ * Gets a connection given its ID and takes a reference to it, so it
+ * can be used without connections_mutex held
+ *
+ * @param connid Connection ID
+ * @return Connection or NULL if not found
+ */
+static Connection *ref_connection(unsigned long long connid)
+{
+	pthread_mutex_lock(&connections_mutex);
+
+	Connection *conn = get_connection(connid);
+
+	if (conn) {
+		__sync_add_and_fetch(&conn->ref, 1);
+	}
+
+	pthread_mutex_unlock(&connections_mutex);
+
+	return conn;
+}
+
+/**
+ * Drops a connection reference, freeing it if it was the last one.
+ * The descriptor stays open until then, so it cannot be recycled
+ * while a sender still uses it.
+ *
+ * @param conn Connection
+ */
+static void unref_connection(Connection *conn)
+{
+	if (__sync_sub_and_fetch(&conn->ref, 1) > 0) {
+		return;
+	}
+
+	close(conn->fd);
+
+	pthread_mutex_destroy(&conn->rx_mutex);
+	pthread_mutex_destroy(&conn->send_mutex);
+	rxbuff_del(conn->rx);
+	free(conn);
+}
+
+/**
+ * Stores a connection in the table, growing it if needed
+ *
+ * @param conn Connection
+ * @return TCP_ERROR_NONE if ok
+ */
+static int add_connection(Connection *conn)
+{
+	pthread_mutex_lock(&connections_mutex);
+
+	if (conn->fd >= connections_size) {
+		int new_size = connections_size ? connections_size : 64;
+
+		while (new_size <= conn->fd) {
+			new_size *= 2;
+		}
+
+		Connection **table = realloc(connections,
+					     new_size * sizeof(Connection *));
+
+		if (table == NULL) {
+			pthread_mutex_unlock(&connections_mutex);
+			return TCP_ERROR;
+		}
+
+		memset(table + connections_size, 0,
+		       (new_size - connections_size) * sizeof(Connection *));
+		connections = table;
+		connections_size = new_size;
+	}
+
+	connections[conn->fd] = conn;
+
+	pthread_mutex_unlock(&connections_mutex);
+
+	return TCP_ERROR_NONE;
+}
+
+/**
+ * Sets the events the reactor watches for a connection
+ *
+ * @param conn Connection
+ * @param op EPOLL_CTL_ADD or EPOLL_CTL_MOD
+ * @param readable whether input is polled
+ * @return epoll_ctl() result
+ */
+static int watch_connection(Connection *conn, int op, int readable)
+{
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = readable ? EPOLLIN | EPOLLRDHUP : 0;
+	ev.data.u64 = conn->connid;
+
+	return epoll_ctl(epoll_fd, op, conn->fd, &ev);
+}
+
+/**
+ * Gives back an APDU stream to the reception buffer, and polls the
+ * socket again if reading was paused for lack of room.
+ * Must be called with rx_mutex held.
+ *
+ * @param conn Connection
+ * @param stream stream taken from rxbuff_get_apdu()
+ */
+static void release_connection_apdu(Connection *conn, ByteStreamReader *stream)
+{
+	rxbuff_release_apdu(conn->rx, stream);
+
+	if (conn->rx_paused) {
+		conn->rx_paused = 0;
+		watch_connection(conn, EPOLL_CTL_MOD, 1);
+	}
+}
+
+/**
+ * Puts a socket in non-blocking mode
+ *
+ * @param fd socket
+ * @return TCP_ERROR_NONE if ok
+ */
+static int set_nonblocking(int fd)
+{
+	int flags = fcntl(fd, F_GETFL, 0);
+
+	if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+		return TCP_ERROR;
+	}
+
+	return TCP_ERROR_NONE;
+}
+
+/**
+ * Closes a connection and removes it from table
+ *
+ * @param conn Connection
+ * @param notify whether the stack must receive a disconnect indication
+ */
+static void close_connection(Connection *conn, int notify)
+{
+	ContextId cid = {plugin_id, conn->connid};
+
+	DEBUG(" network:tcp epoll closing connection %s", conn->addr);
+
+	// no sender nor worker finds the connection once it leaves
+	// the table; wait for whoever is inside rx critical section
+	pthread_mutex_lock(&connections_mutex);
+	connections[conn->fd] = NULL;
+	pthread_mutex_unlock(&connections_mutex);
+
+	pthread_mutex_lock(&conn->rx_mutex);
+	pthread_mutex_unlock(&conn->rx_mutex);
+
+	// APDUs lent to workers are processed with context locked,
+	// so they are done when disconnection gets the context
+	if (notify) {
+		communication_transport_disconnect_indication(cid, conn->addr);
+	}
+
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+
+	// wakes up senders blocked on this connection
+	shutdown(conn->fd, SHUT_RDWR);
+
+	// drop table reference
+	unref_connection(conn);
+}
+
+/**
+ * Accepts all pending connections, creating one context for each
+ */
+static void accept_connections()
+{
+	while (1) {
+		struct sockaddr_in client;
+		socklen_t client_addr_size = sizeof(struct sockaddr_in);
+
+		int fd = accept(server_sk, (struct sockaddr *) &client,
+				&client_addr_size);
+
+		if (fd < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				DEBUG(" network:tcp epoll Error in accept %d", errno);
+			}
+
+			return;
+		}
+
+		int opt = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (char *) &opt, sizeof(opt));
+
+		Connection *conn = calloc(1, sizeof(Connection));
+
+		if (conn == NULL || set_nonblocking(fd) == TCP_ERROR) {
+			ERROR("network:tcp epoll cannot set up connection");
+			free(conn);
+			close(fd);
+			continue;
+		}
+
+		if (++generation == 0) {
+			// zero is reserved for the listener event
+			++generation;
+		}
+
+		conn->fd = fd;
+		conn->connid = ((unsigned long long) generation << 32) | (unsigned int) fd;
+		conn->ref = 1; // reference from table
+		pthread_mutex_init(&conn->rx_mutex, NULL);
+		pthread_mutex_init(&conn->send_mutex, NULL);
+
+		char ip[INET_ADDRSTRLEN] = "";
+		inet_ntop(AF_INET, &client.sin_addr, ip, sizeof(ip));
+		snprintf(conn->addr, sizeof(conn->addr), "%s:%d", ip,
+			 ntohs(client.sin_port));
+
+		conn->rx = rxbuff_new();
+
+		if (conn->rx == NULL || add_connection(conn) == TCP_ERROR) {
+			ERROR("network:tcp epoll cannot store connection");
+			unref_connection(conn);
+			continue;
+		}
+
+		if (watch_connection(conn, EPOLL_CTL_ADD, 1) < 0) {
+			ERROR("network:tcp epoll cannot watch connection");
+			close_connection(conn, 0);
+			continue;
+		}
+
+		DEBUG(" network:tcp epoll new connection %s", conn->addr);
+
+		ContextId cid = {plugin_id, conn->connid};
+		communication_transport_connect_indication(cid, conn->addr);
+	}
+}
+
+/**
+ * Hands every complete APDU in the connection buffer to the stack.
+ * Streams point into the reception buffer and come back through
+ * network_release_apdu_stream().
+ *
+ * @param conn Connection
+ */
+static void process_buffered_apdus(Connection *conn)
+{
+	ByteStreamReader *stream;
+	ContextId cid = {plugin_id, conn->connid};
+
+	while (1) {
+		pthread_mutex_lock(&conn->rx_mutex);
+		stream = rxbuff_get_apdu(conn->rx);
+		pthread_mutex_unlock(&conn->rx_mutex);
+
+		if (stream == NULL) {
+			break;
+		}
+
+		Context *ctx = context_get_and_lock(cid);
+
+		if (ctx) {
+			communication_process_input_data(ctx, stream);
+			context_unlock(ctx);
+		} else {
+			pthread_mutex_lock(&conn->rx_mutex);
+			release_connection_apdu(conn, stream);
+			pthread_mutex_unlock(&conn->rx_mutex);
+		}
+	}
+}
+
+/**
+ * Drains a readable connection
+ *
+ * @param conn Connection
+ * @param events events reported by the reactor
+ * @return TCP_ERROR if the connection was closed by peer or failed
+ */
+static int read_connection(Connection *conn, unsigned int events)
+{
+	ContextId cid = {plugin_id, conn->connid};
+
+	while (1) {
+		pthread_mutex_lock(&conn->rx_mutex);
+		int bytes_read = rxbuff_read(conn->rx, conn->fd);
+		int read_errno = errno;
+
+		if (bytes_read < 0 && read_errno == ENOBUFS && conn->rx->lent
+		    && !(events & (EPOLLERR | EPOLLHUP))) {
+			// buffer is full while a worker holds an APDU; stop
+			// polling input until release_connection_apdu()
+			conn->rx_paused = 1;
+			watch_connection(conn, EPOLL_CTL_MOD, 0);
+			pthread_mutex_unlock(&conn->rx_mutex);
+			return TCP_ERROR_NONE;
+		}
+
+		pthread_mutex_unlock(&conn->rx_mutex);
+
+		if (bytes_read < 0) {
+			if (read_errno == EINTR) {
+				continue;
+			}
+
+			if (read_errno == EAGAIN || read_errno == EWOULDBLOCK) {
+				return TCP_ERROR_NONE;
+			}
+
+			return TCP_ERROR;
+		} else if (bytes_read == 0) {
+			return TCP_ERROR;
+		}
+
+		if (scheduler_is_running()) {
+			scheduler_notify_input(cid);
+		} else {
+			process_buffered_apdus(conn);
+		}
+	}
+}
+
+/**
+ * Waits for network events and dispatches them to the stack.
+ * Must be called repeatedly, always from the same thread, after
+ * manager_start().
+ *
+ * @param timeout_ms maximum time to block, -1 means forever
+ * @return TCP_ERROR_NONE if ok, TCP_ERROR if the plugin is not running
+ */
+int plugin_network_tcp_epoll_poll(int timeout_ms)
+{
+	struct epoll_event events[MAX_EVENTS];
+
+	if (epoll_fd < 0) {
+		return TCP_ERROR;
+	}
+
+	int count = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+
+	if (count < 0) {
+		return errno == EINTR ? TCP_ERROR_NONE : TCP_ERROR;
+	}
+
+	int i;
+
+	for (i = 0; i < count; ++i) {
+		if (events[i].data.u64 == LISTENER_EVENT_ID) {
+			accept_connections();
+			continue;
+		}
+
+		pthread_mutex_lock(&connections_mutex);
+		Connection *conn = get_connection(events[i].data.u64);
+		pthread_mutex_unlock(&connections_mutex);
+
+		if (conn != NULL && read_connection(conn, events[i].events) == TCP_ERROR) {
+			close_connection(conn, 1);
+		}
+	}
+
+	return TCP_ERROR_NONE;
+}
+
+/**
+ * Initialize network layer, in this case opens the listener
+ * socket and the reactor
+ *
+ * @param plugin_label the Plugin ID or label attributed by stack to this plugin
+ * @return TCP_ERROR_NONE if operation succeeds
+ */
+static int network_init(unsigned int plugin_label)
+{
+	struct sockaddr_in server;
+
+	plugin_id = plugin_label;
+
+	if (tcp_port == 0) {
+		DEBUG(" network:tcp epoll Error: TCP port not set");
+		return TCP_ERROR;
+	}
+
+	DEBUG("network tcp epoll: starting socket %d", tcp_port);
+
+	memset(&server, 0x00, sizeof(server));
+	server.sin_family = AF_INET;
+	server.sin_addr.s_addr = INADDR_ANY;
+	server.sin_port = htons(tcp_port);
+
+	server_sk = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+	if (server_sk < 0) {
+		DEBUG(" network:tcp epoll Error opening the tcp socket");
+		return TCP_ERROR;
+	}
+
+	int opt = 1;
+	setsockopt(server_sk, SOL_SOCKET, SO_REUSEADDR, (char *) &opt,
+		   sizeof(opt));
+
+	if (set_nonblocking(server_sk) == TCP_ERROR
+	    || bind(server_sk, (struct sockaddr *) &server, sizeof(server)) < 0
+	    || listen(server_sk, BACKLOG) < 0) {
+		DEBUG(" network:tcp epoll Error in bind/listen: %d", errno);
+		close(server_sk);
+		server_sk = -1;
+		return TCP_ERROR;
+	}
+
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u64 = LISTENER_EVENT_ID;
+
+	if (epoll_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server_sk, &ev) < 0) {
+		DEBUG(" network:tcp epoll Error creating reactor: %d", errno);
+		if (epoll_fd >= 0) {
+			close(epoll_fd);
+		}
+		close(server_sk);
+		epoll_fd = -1;
+		server_sk = -1;
+		return TCP_ERROR;
+	}
+
+	return TCP_ERROR_NONE;
+}
+
+/**
+ * Not used: reception is driven by plugin_network_tcp_epoll_poll().
+ *
+ * @param ctx Context
+ * @return TCP_ERROR
+ */
+static int network_wait_for_data(Context *ctx)
+{
+	DEBUG("network tcp epoll: network_wait_for_data function does nothing");
+	return TCP_ERROR;
+}
+
+/**
+ * Takes next complete APDU of connection. Called by scheduler
+ * workers; reception itself is driven by plugin_network_tcp_epoll_poll().
+ *
+ * @param ctx Context
+ * @return APDU stream or NULL if there is no complete APDU
+ */
+static ByteStreamReader *network_get_apdu_stream(Context *ctx)
+{
+	Connection *conn = lock_connection_rx(ctx->id.connid);
+
+	if (conn == NULL) {
+		return NULL;
+	}
+
+	ByteStreamReader *stream = rxbuff_get_apdu(conn->rx);
+
+	pthread_mutex_unlock(&conn->rx_mutex);
+
+	return stream;
+}
+
+/**
+ * Recycles reception buffer space of a processed APDU
+ *
+ * @param ctx
+ * @param stream stream handed to communication_process_input_data
+ */
+static void network_release_apdu_stream(Context *ctx, ByteStreamReader *stream)
+{
+	Connection *conn = lock_connection_rx(ctx->id.connid);
+
+	if (conn) {
+		release_connection_apdu(conn, stream);
+		pthread_mutex_unlock(&conn->rx_mutex);
+	}
+}
+
+/**
+ * Sends an encoded apdu
+ *
+ * @param ctx Context
+ * @param stream the apdu to be sent
+ * @return TCP_ERROR_NONE if data sent successfully and TCP_ERROR otherwise
+ */
+static int network_send_apdu_stream(Context *ctx, ByteStreamWriter *stream)
+{
+	int ret_val = TCP_ERROR_NONE;
+	unsigned int written = 0;
+
+	Connection *conn = ref_connection(ctx->id.connid);
+
+	if (conn == NULL) {
+		return TCP_ERROR;
+	}
+
+	// a slow peer only holds back senders of its own connection
+	pthread_mutex_lock(&conn->send_mutex);
+
+	while (written < stream->size) {
+		int ret = send(conn->fd, stream->buffer + written,
+			       stream->size - written, MSG_NOSIGNAL);
+
+		if (ret < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			// socket buffer full, wait until peer drains it
+			struct pollfd pfd = {conn->fd, POLLOUT, 0};
+
+			if (poll(&pfd, 1, SEND_TIMEOUT_MS) > 0) {
+				continue;
+			}
+		}
+
+		if (ret <= 0) {
+			DEBUG(" network:tcp epoll Error sending APDU.");
+			ret_val = TCP_ERROR;
+			break;
+		}
+
+		written += ret;
+	}
+
+	pthread_mutex_unlock(&conn->send_mutex);
+
+	unref_connection(conn);
+
+	return ret_val;
+}
+
+/**
+ * Network disconnect. The socket is shut down here and closed by the
+ * polling thread, which also notifies the stack.
+ *
+ * @param ctx Context
+ * @return TCP_ERROR_NONE
+ */
+static int network_disconnect(Context *ctx)
+{
+	pthread_mutex_lock(&connections_mutex);
+
+	Connection *conn = get_connection(ctx->id.connid);
+
+	if (conn != NULL) {
+		shutdown(conn->fd, SHUT_RDWR);
+	}
+
+	pthread_mutex_unlock(&connections_mutex);
+
+	return conn != NULL ? TCP_ERROR_NONE : TCP_ERROR;
+}
+
+/**
+ * Finalizes network layer and deallocated data
+ *
+ * @return TCP_ERROR_NONE if operation succeeds
+ */
+static int network_finalize()
+{
+	int fd;
+
+	for (fd = 0; fd < connections_size; ++fd) {
+		if (connections[fd] != NULL) {
+			close_connection(connections[fd], 0);
+		}
+	}
+
+	free(connections);
+	connections = NULL;
+	connections_size = 0;
+
+	if (epoll_fd >= 0) {
+		close(epoll_fd);
+		epoll_fd = -1;
+	}
+
+	if (server_sk >= 0) {
+		DEBUG(" network:tcp epoll Closing socket %d", server_sk);
+		close(server_sk);
+		server_sk = -1;
+	}
+
+	return TCP_ERROR_NONE;
+}
+
+/**
+ * Initiate a CommunicationPlugin struct to use the epoll-based
+ * tcp manager transport.
+ *
+ * @param plugin CommunicationPlugin pointer
+ * @param port TCP port shared by all agents
+ *
+ * @return TCP_ERROR if error
+ */
+int plugin_network_tcp_epoll_setup(CommunicationPlugin *plugin, int port)
+{
+	DEBUG("network:tcp epoll Initializing socket on port %d", port);
+
+	tcp_port = port;
+
+	plugin->network_init = network_init;
+	plugin->network_wait_for_data = network_wait_for_data;
+	plugin->network_get_apdu_stream = network_get_apdu_stream;
+	plugin->network_release_apdu_stream = network_release_apdu_stream;
+	plugin->network_send_apdu_stream = network_send_apdu_stream;
+	plugin->network_disconnect = network_disconnect;
+	plugin->network_finalize = network_finalize;
+
+	return TCP_ERROR_NONE;
+}
+
+/** @} */
@@ -154,24 +154,36 @@ void cfg_scanner_event_report_scan_report_grouped(Context *ctx, struct CfgScanne
 		ScanReportInfoGrouped *report_info)
 {
 	HandleAttrValMap *attr_map = &self->scanner.scan_handle_attr_val_map;
+	DataList *data_list = data_list_new(report_info->obs_scan_grouped.count *
+					    attr_map->count);
+	ObservationList observations = {0, 0, NULL};
+	int wants_observations = manager_wants_observations();
+	int k = 0;
 	int i;
 
 	for (i = 0; i < report_info->obs_scan_grouped.count; i++) {
 		ObservationScanGrouped *data = &report_info->obs_scan_grouped.value[i];
 		ByteStreamReader *stream = byte_stream_reader_instance(data->value, data->length);
-		DataList *data_list = data_list_new(attr_map->count);
 
 		if (data_list != NULL) {
 			int j;
 
 			for (j = 0; j < attr_map->count; j++) {
-				dimutil_update_mds_from_grouped_observations(ctx->mds, stream, &attr_map->value[j], &data_list->values[j]);
+				dimutil_update_mds_from_grouped_observations(ctx->mds, stream, &attr_map->value[j], &data_list->values[k++]);
+
+				if (wants_observations) {
+					dimutil_add_grouped_observations(ctx->mds, &attr_map->value[j],
+									 &observations);
+				}
 			}
 		}
 
-		manager_notify_evt_measurement_data_updated(ctx, data_list);
 		free(stream);
 	}
+
+	manager_notify_evt_measurement_data_updated(ctx, data_list);
+	manager_notify_evt_observations_received(ctx, &observations);
+	observation_list_clear(&observations);
 }
 
 /**
@@ -188,28 +200,44 @@ void cfg_scanner_event_report_scan_report_mp_grouped(Context *ctx, struct CfgSca
 {
 	HandleAttrValMap *attr_map = &self->scanner.scan_handle_attr_val_map;
 	int info_grouped_list_size = report_info->scan_per_grouped.count;
+	DataList *data_list = data_list_new(info_grouped_list_size * attr_map->count);
+	ObservationList observations = {0, 0, NULL};
+	int wants_observations = manager_wants_observations();
+	int k = 0;
 	int i;
 
 	for (i = 0; i < info_grouped_list_size; ++i) {
 		ObservationScanGrouped *data = &report_info->scan_per_grouped.value[i].obs_scan_grouped;
 		ByteStreamReader *stream = byte_stream_reader_instance(data->value, data->length);
-		DataList *data_list = data_list_new(attr_map->count);
+		int first = observations.count;
 
 		if (data_list != NULL) {
 			int j;
 
 			for (j = 0; j < attr_map->count; j++) {
-				data_meta_set_personal_id(&data_list->values[j],
+				DataEntry *entry = &data_list->values[k++];
+
+				data_meta_set_personal_id(entry,
 							  report_info->scan_per_grouped.value[i].person_id);
 
-				dimutil_update_mds_from_grouped_observations(ctx->mds, stream, &attr_map->value[j], &data_list->values[j]);
+				dimutil_update_mds_from_grouped_observations(ctx->mds, stream, &attr_map->value[j], entry);
+
+				if (wants_observations) {
+					dimutil_add_grouped_observations(ctx->mds, &attr_map->value[j],
+									 &observations);
+				}
 			}
 
-			manager_notify_evt_measurement_data_updated(ctx, data_list);
+			dimutil_set_observations_person_id(&observations, first,
+							   report_info->scan_per_grouped.value[i].person_id);
 		}
 
 		free(stream);
 	}
+
+	manager_notify_evt_measurement_data_updated(ctx, data_list);
+	manager_notify_evt_observations_received(ctx, &observations);
+	observation_list_clear(&observations);
 }
 
 /** @} */
@@ -36,7 +36,9 @@
 #include "src/api/oid_string.h"
 #include "src/communication/parser/decoder_ASN1.h"
 #include "src/communication/parser/struct_cleaner.h"
+#include "src/util/dateutil.h"
 #include "src/util/log.h"
+#include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -172,6 +174,7 @@ int dimutil_fill_metric_attr(struct Metric *metric, OID_Type attr_id,
 		data_set_type(data_entry, "Type", &metric->type);
 		break;
 	case MDC_ATTR_SUPPLEMENTAL_TYPES:
+		metric_unshare(metric);
 		del_supplementaltypelist(&metric->supplemental_types);
 		decode_supplementaltypelist(stream,
 					    &(metric->supplemental_types),
@@ -226,6 +229,7 @@ int dimutil_fill_metric_attr(struct Metric *metric, OID_Type attr_id,
 		data_set_oid_type(data_entry, "Metric-Id", &metric->metric_id);
 		break;
 	case MDC_ATTR_ID_PHYSIO_LIST:
+		metric_unshare(metric);
 		del_metricidlist(&metric->metric_id_list);
 		decode_metricidlist(stream, &metric->metric_id_list, &error);
 		if (error) {
@@ -252,7 +256,11 @@ int dimutil_fill_metric_attr(struct Metric *metric, OID_Type attr_id,
 		data_set_oid_type(data_entry, "Unit-Code", &metric->unit_code);
 		break;
 	case MDC_ATTR_ATTRIBUTE_VAL_MAP:
+		metric_unshare(metric);
 		del_attrvalmap(&metric->attribute_value_map);
+		// plan of the previous map, compiled again on next use
+		free(metric->decode_plan);
+		metric->decode_plan = NULL;
 		decode_attrvalmap(stream, &(metric->attribute_value_map), &error);
 		if (error) {
 			result = 0;
@@ -270,6 +278,7 @@ int dimutil_fill_metric_attr(struct Metric *metric, OID_Type attr_id,
 		data_set_handle(data_entry, "Source-Handle-Reference", &metric->source_handle_reference);
 		break;
 	case MDC_ATTR_ID_LABEL_STRING:
+		metric_unshare(metric);
 		del_octet_string(&metric->label_string);
 		decode_octet_string(stream, &(metric->label_string), &error);
 		if (error) {
@@ -279,6 +288,7 @@ int dimutil_fill_metric_attr(struct Metric *metric, OID_Type attr_id,
 		data_set_label_string(data_entry, "Label-String", &metric->label_string);
 		break;
 	case MDC_ATTR_UNIT_LABEL_STRING:
+		metric_unshare(metric);
 		del_octet_string(&metric->unit_label_string);
 		decode_octet_string(stream, &(metric->unit_label_string), &error);
 		if (error) {
@@ -332,6 +342,30 @@ int dimutil_fill_metric_attr(struct Metric *metric, OID_Type attr_id,
 	return result;
 }
 
+/**
+ * Fill a DataEntry's partition, metric-id and unit information from the
+ * given Numeric.
+ *
+ * \param data_entry DataEntry to be filled.
+ * \param numeric Data source.
+ * \param metric_id metric-id of the reported value.
+ */
+static void dimutil_set_numeric_meta(DataEntry *data_entry, struct Numeric *numeric,
+				     int metric_id)
+{
+	data_set_meta_att(data_entry, data_strcp("partition"),
+			  intu16_2str(dimutil_get_metric_partition(&(numeric->metric))));
+
+	data_set_meta_att(data_entry, data_strcp("metric-id"),
+			  intu16_2str(metric_id));
+
+	data_set_meta_att(data_entry, data_strcp("unit-code"),
+			  intu16_2str(dimutil_get_unit_code(&(numeric->metric))));
+
+	data_set_meta_att(data_entry, data_strcp("unit"),
+			  dimutil_get_unit(&(numeric->metric)));
+}
+
 /**
  * Initializes a given Numeric attribute from stream content.
  *
@@ -366,17 +400,8 @@ int dimutil_fill_numeric_attr(struct Numeric *numeric, OID_Type attr_id,
 					     &(numeric->simple_nu_observed_value));
 
 		if (data_entry) {
-			data_set_meta_att(data_entry, data_strcp("partition"),
-					  intu16_2str(dimutil_get_metric_partition(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("metric-id"),
-					  intu16_2str(dimutil_get_metric_ids(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("unit-code"),
-					  intu16_2str(dimutil_get_unit_code(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("unit"),
-					  dimutil_get_unit(&(numeric->metric)));
+			dimutil_set_numeric_meta(data_entry, numeric,
+						  dimutil_get_metric_ids(&(numeric->metric)));
 		}
 
 		break;
@@ -398,17 +423,8 @@ int dimutil_fill_numeric_attr(struct Numeric *numeric, OID_Type attr_id,
 					       numeric->metric.metric_id_list.value);
 
 		if (data_entry) {
-			data_set_meta_att(data_entry, data_strcp("partition"),
-					  intu16_2str(dimutil_get_metric_partition(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("metric-id"),
-					  intu16_2str(dimutil_get_metric_ids(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("unit-code"),
-					  intu16_2str(dimutil_get_unit_code(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("unit"),
-					  dimutil_get_unit(&(numeric->metric)));
+			dimutil_set_numeric_meta(data_entry, numeric,
+						  dimutil_get_metric_ids(&(numeric->metric)));
 		}
 
 		break;
@@ -424,17 +440,8 @@ int dimutil_fill_numeric_attr(struct Numeric *numeric, OID_Type attr_id,
 					  "Basic-Nu-Observed-Value",
 					  &(numeric->basic_nu_observed_value));
 
-			data_set_meta_att(data_entry, data_strcp("partition"),
-				  intu16_2str(dimutil_get_metric_partition(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("metric-id"),
-				  intu16_2str(dimutil_get_metric_ids(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("unit-code"),
-				  intu16_2str(dimutil_get_unit_code(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("unit"),
-				  dimutil_get_unit(&(numeric->metric)));
+			dimutil_set_numeric_meta(data_entry, numeric,
+						  dimutil_get_metric_ids(&(numeric->metric)));
 		}
 		break;
 	case MDC_ATTR_NU_CMPD_VAL_OBS_BASIC:
@@ -454,17 +461,8 @@ int dimutil_fill_numeric_attr(struct Numeric *numeric, OID_Type attr_id,
 					      numeric->metric.metric_id_list.value);
 
 		if (data_entry) {
-			data_set_meta_att(data_entry, data_strcp("partition"),
-					  intu16_2str(dimutil_get_metric_partition(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("metric-id"),
-					  intu16_2str(dimutil_get_metric_ids(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("unit-code"),
-					  intu16_2str(dimutil_get_unit_code(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("unit"),
-					  dimutil_get_unit(&(numeric->metric)));
+			dimutil_set_numeric_meta(data_entry, numeric,
+						  dimutil_get_metric_ids(&(numeric->metric)));
 		}
 
 		break;
@@ -479,17 +477,8 @@ int dimutil_fill_numeric_attr(struct Numeric *numeric, OID_Type attr_id,
 				    &numeric->nu_observed_value);
 
 		if (data_entry) {
-			data_set_meta_att(data_entry, data_strcp("partition"),
-					  intu16_2str(dimutil_get_metric_partition(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("metric-id"),
-					  intu16_2str(numeric->nu_observed_value.metric_id));
-
-			data_set_meta_att(data_entry, data_strcp("unit-code"),
-					  intu16_2str(dimutil_get_unit_code(&(numeric->metric))));
-
-			data_set_meta_att(data_entry, data_strcp("unit"),
-					  dimutil_get_unit(&(numeric->metric)));
+			dimutil_set_numeric_meta(data_entry, numeric,
+						  numeric->nu_observed_value.metric_id);
 		}
 
 		break;
@@ -565,6 +554,17 @@ int dimutil_fill_rtsa_attr(struct RTSA *rtsa, OID_Type attr_id,
 			result = 0;
 			break;
 		}
+		if (data_entry) {
+			int count;
+			float *samples = rtsa_get_samples(rtsa, &count);
+
+			if (samples) {
+				data_set_float_array(data_entry,
+						     "Simple-Sa-Observed-Value",
+						     samples, count);
+				break;
+			}
+		}
 		data_set_simple_sa_observed_value(data_entry,
 						  "Simple-Sa-Observed-Value",
 						  &(rtsa->simple_sa_observed_value));
@@ -1098,16 +1098,14 @@ static void dimutil_fill_metric_object(struct MDS *mds, DataEntry *data_entry,
 			val.length = attr_list->value[j].attribute_value.length;
 			val.value = attr_list->value[j].attribute_value.value;
 
-			ByteStreamReader *stream = byte_stream_reader_instance(val.value,
-						   val.length);
+			ByteStreamReader stream;
+			byte_stream_reader_init(&stream, val.value, val.length);
 
-			int result = dimutil_fill_numeric_attr(&(metric_obj->u.numeric), attr_id, stream, &(cmp_entry->entries[j]));
+			int result = dimutil_fill_numeric_attr(&(metric_obj->u.numeric), attr_id, &stream, &(cmp_entry->entries[j]));
 
 			if (result == 0) {
 				ERROR("ERROR filling numeric attribute");
 			}
-
-			free(stream);
 		}
 
 		break;
@@ -1119,17 +1117,15 @@ static void dimutil_fill_metric_object(struct MDS *mds, DataEntry *data_entry,
 			val.length = attr_list->value[j].attribute_value.length;
 			val.value = attr_list->value[j].attribute_value.value;
 
-			ByteStreamReader *stream = byte_stream_reader_instance(val.value,
-						   val.length);
+			ByteStreamReader stream;
+			byte_stream_reader_init(&stream, val.value, val.length);
 
 			int result = dimutil_fill_enumeration_attr(&(metric_obj->u.enumeration), attr_id,
-					stream, &(cmp_entry->entries[j]));
+					&stream, &(cmp_entry->entries[j]));
 
 			if (result == 0) {
 				ERROR("ERROR filling enumeration attr");
 			}
-
-			free(stream);
 		}
 
 		break;
@@ -1141,17 +1137,15 @@ static void dimutil_fill_metric_object(struct MDS *mds, DataEntry *data_entry,
 			val.length = attr_list->value[j].attribute_value.length;
 			val.value = attr_list->value[j].attribute_value.value;
 
-			ByteStreamReader *stream = byte_stream_reader_instance(val.value,
-						   val.length);
+			ByteStreamReader stream;
+			byte_stream_reader_init(&stream, val.value, val.length);
 
 			int result = dimutil_fill_rtsa_attr(&(metric_obj->u.rtsa), attr_id,
-							    stream, &(cmp_entry->entries[j]));
+							    &stream, &(cmp_entry->entries[j]));
 
 			if (result == 0) {
 				ERROR("ERROR filling stsa attr");
 			}
-
-			free(stream);
 		}
 
 		break;
@@ -1210,9 +1204,367 @@ void dimutil_update_mds_from_obs_scan(struct MDS *mds, ObservationScan *var_obs,
 			intu16 length = attr_list.value[j].attribute_value.length;
 			intu8 *value = attr_list.value[j].attribute_value.value;
 
-			ByteStreamReader *stream = byte_stream_reader_instance(value, length);
-			pmstore_set_attribute(pmstore, attr_id, stream);
-			free(stream);
+			ByteStreamReader stream;
+			byte_stream_reader_init(&stream, value, length);
+			pmstore_set_attribute(pmstore, attr_id, &stream);
+		}
+	}
+}
+
+/**
+ * Returns the Metric part of a metric-derived object.
+ *
+ * \param metric_obj the metric object.
+ *
+ * \return the Metric, NULL if choice is unknown.
+ */
+static struct Metric *dimutil_get_metric(struct Metric_object *metric_obj)
+{
+	switch (metric_obj->choice) {
+	case METRIC_NUMERIC:
+		return &metric_obj->u.numeric.metric;
+	case METRIC_ENUM:
+		return &metric_obj->u.enumeration.metric;
+	case METRIC_RTSA:
+		return &metric_obj->u.rtsa.metric;
+	}
+
+	return NULL;
+}
+
+/**
+ * Initializes an attribute of a metric-derived object from stream content.
+ *
+ * \param metric_obj the metric object.
+ * \param attr_id the attribute ID.
+ * \param stream the value of the attribute.
+ * \param data_entry output parameter to describe data value
+ *
+ * \return \b 1, if the attribute is properly modified; \b 0 otherwise.
+ */
+static int dimutil_fill_metric_object_attr(struct Metric_object *metric_obj, OID_Type attr_id,
+		ByteStreamReader *stream, DataEntry *data_entry)
+{
+	switch (metric_obj->choice) {
+	case METRIC_NUMERIC:
+		return dimutil_fill_numeric_attr(&metric_obj->u.numeric, attr_id,
+						 stream, data_entry);
+	case METRIC_ENUM:
+		return dimutil_fill_enumeration_attr(&metric_obj->u.enumeration, attr_id,
+						     stream, data_entry);
+	case METRIC_RTSA:
+		return dimutil_fill_rtsa_attr(&metric_obj->u.rtsa, attr_id,
+					      stream, data_entry);
+	}
+
+	return 0;
+}
+
+/**
+ * Name of the compound DataEntry of a metric-derived object.
+ *
+ * \param metric_obj the metric object.
+ *
+ * \return static name.
+ */
+static char *dimutil_get_metric_object_name(struct Metric_object *metric_obj)
+{
+	if (metric_obj->choice == METRIC_NUMERIC) {
+		return "Numeric";
+	} else if (metric_obj->choice == METRIC_ENUM) {
+		return "Enumeration";
+	}
+
+	return "RT-SA";
+}
+
+/*
+ * Describers of values decoded in place by a DimDecodeOp. Each one fills
+ * the DataEntry as the matching case of dimutil_fill_*_attr() does.
+ */
+
+static void dimutil_describe_msmt_status(struct Metric_object *metric_obj, void *field,
+		DataEntry *data_entry)
+{
+	data_set_intu16(data_entry, "Measurement-Status", field);
+}
+
+static void dimutil_describe_abs_time(struct Metric_object *metric_obj, void *field,
+				      DataEntry *data_entry)
+{
+	data_set_absolute_time(data_entry, "Absolute-Time-Stamp", field);
+}
+
+static void dimutil_describe_rel_time(struct Metric_object *metric_obj, void *field,
+				      DataEntry *data_entry)
+{
+	data_set_intu32(data_entry, "Relative-Time-Stamp", field);
+}
+
+static void dimutil_describe_basic_nu(struct Metric_object *metric_obj, void *field,
+				      DataEntry *data_entry)
+{
+	struct Numeric *numeric = &metric_obj->u.numeric;
+
+	data_set_basic_nu_obs_val(data_entry, "Basic-Nu-Observed-Value", field);
+	dimutil_set_numeric_meta(data_entry, numeric,
+				 dimutil_get_metric_ids(&(numeric->metric)));
+}
+
+static void dimutil_describe_simple_nu(struct Metric_object *metric_obj, void *field,
+				       DataEntry *data_entry)
+{
+	struct Numeric *numeric = &metric_obj->u.numeric;
+
+	data_set_simple_nu_obs_value(data_entry, "Simple-Nu-Observed-Value", field);
+	dimutil_set_numeric_meta(data_entry, numeric,
+				 dimutil_get_metric_ids(&(numeric->metric)));
+}
+
+static void dimutil_describe_enum_oid(struct Metric_object *metric_obj, void *field,
+				      DataEntry *data_entry)
+{
+	data_set_observed_value_simple_OID(data_entry, "Enum-Observed-Value-Simple-OID",
+					   *(OID_Type *) field);
+	dimutil_fill_data_entry_partition_ids(data_entry, &metric_obj->u.enumeration);
+}
+
+static void dimutil_describe_enum_simple_bits(struct Metric_object *metric_obj, void *field,
+		DataEntry *data_entry)
+{
+	data_set_observed_value_simple_bit_str(data_entry, "Enum-Observed-Value-Simple-Bit-Str",
+					       *(BITS_32 *) field);
+	dimutil_fill_data_entry_partition_ids(data_entry, &metric_obj->u.enumeration);
+}
+
+static void dimutil_describe_enum_basic_bits(struct Metric_object *metric_obj, void *field,
+		DataEntry *data_entry)
+{
+	data_set_observed_value_basic_bit_str(data_entry, "Enum-Observed-Value-Basic-Bit-Str",
+					      *(BITS_16 *) field);
+	dimutil_fill_data_entry_partition_ids(data_entry, &metric_obj->u.enumeration);
+}
+
+/**
+ * Sets how an op decodes its value. Frequently reported attributes with
+ * the expected width are decoded in place; everything else goes through
+ * dimutil_fill_*_attr(), exactly as without a plan.
+ *
+ * \param metric_obj the metric object.
+ * \param op op with attr_id and width set.
+ */
+static void dimutil_plan_op(struct Metric_object *metric_obj, DimDecodeOp *op)
+{
+	size_t metric = (intu8 *) dimutil_get_metric(metric_obj) - (intu8 *) metric_obj;
+	Metric_choice choice = metric_obj->choice;
+
+	op->type = DIM_OP_GENERIC;
+	op->field = 0;
+	op->describe = NULL;
+
+#define DIM_OP(t, f, d) do { op->type = t; op->field = f; op->describe = d; } while (0)
+
+	switch (op->attr_id) {
+	case MDC_ATTR_MSMT_STAT:
+		if (op->width == 2)
+			DIM_OP(DIM_OP_INTU16, metric + offsetof(struct Metric, measurement_status),
+			       dimutil_describe_msmt_status);
+		break;
+	case MDC_ATTR_TIME_STAMP_ABS:
+		if (op->width == 8)
+			DIM_OP(DIM_OP_ABSOLUTE_TIME, metric + offsetof(struct Metric, absolute_time_stamp),
+			       dimutil_describe_abs_time);
+		break;
+	case MDC_ATTR_TIME_STAMP_REL:
+		if (op->width == 4)
+			DIM_OP(DIM_OP_INTU32, metric + offsetof(struct Metric, relative_time_stamp),
+			       dimutil_describe_rel_time);
+		break;
+	case MDC_ATTR_NU_VAL_OBS_BASIC:
+		if (choice == METRIC_NUMERIC && op->width == 2)
+			DIM_OP(DIM_OP_SFLOAT,
+			       offsetof(struct Metric_object, u.numeric.basic_nu_observed_value),
+			       dimutil_describe_basic_nu);
+		break;
+	case MDC_ATTR_NU_VAL_OBS_SIMP:
+		if (choice == METRIC_NUMERIC && op->width == 4)
+			DIM_OP(DIM_OP_FLOAT,
+			       offsetof(struct Metric_object, u.numeric.simple_nu_observed_value),
+			       dimutil_describe_simple_nu);
+		break;
+	case MDC_ATTR_ENUM_OBS_VAL_SIMP_OID:
+		if (choice == METRIC_ENUM && op->width == 2)
+			DIM_OP(DIM_OP_INTU16,
+			       offsetof(struct Metric_object, u.enumeration.enum_observed_value_simple_OID),
+			       dimutil_describe_enum_oid);
+		break;
+	case MDC_ATTR_ENUM_OBS_VAL_SIMP_BIT_STR:
+		if (choice == METRIC_ENUM && op->width == 4)
+			DIM_OP(DIM_OP_INTU32,
+			       offsetof(struct Metric_object, u.enumeration.enum_observed_value_simple_bit_str),
+			       dimutil_describe_enum_simple_bits);
+		break;
+	case MDC_ATTR_ENUM_OBS_VAL_BASIC_BIT_STR:
+		if (choice == METRIC_ENUM && op->width == 2)
+			DIM_OP(DIM_OP_INTU16,
+			       offsetof(struct Metric_object, u.enumeration.enum_observed_value_basic_bit_str),
+			       dimutil_describe_enum_basic_bits);
+		break;
+	}
+
+#undef DIM_OP
+}
+
+/**
+ * Compiles the Attribute-Value-Map of a metric object into a decode
+ * plan, replacing the previous one. The plan lists where each attribute
+ * lies in a fixed-format observation and how it is stored, so reports
+ * are decoded without looking attributes up again.
+ *
+ * \param metric_obj the metric object.
+ */
+void dimutil_compile_decode_plan(struct Metric_object *metric_obj)
+{
+	struct Metric *metric = dimutil_get_metric(metric_obj);
+
+	if (metric == NULL) {
+		return;
+	}
+
+	AttrValMap *val_map = &metric->attribute_value_map;
+	int offset = 0;
+	int j;
+
+	metric_unshare(metric);
+	free(metric->decode_plan);
+	metric->decode_plan = calloc(1, sizeof(DimDecodePlan)
+				     + val_map->count * sizeof(DimDecodeOp));
+
+	if (metric->decode_plan == NULL) {
+		ERROR("dimutil: cannot compile decode plan");
+		return;
+	}
+
+	DimDecodePlan *plan = metric->decode_plan;
+	plan->ops = (DimDecodeOp *) (plan + 1);
+	plan->count = val_map->count;
+
+	for (j = 0; j < val_map->count; ++j) {
+		DimDecodeOp *op = &plan->ops[j];
+
+		op->attr_id = val_map->value[j].attribute_id;
+		op->offset = offset;
+		op->width = val_map->value[j].attribute_len;
+		dimutil_plan_op(metric_obj, op);
+
+		offset += op->width;
+	}
+
+	plan->size = offset;
+}
+
+/**
+ * Returns the decode plan of a metric object, compiling it if needed.
+ *
+ * \param metric_obj the metric object.
+ *
+ * \return the plan, NULL if it cannot be compiled.
+ */
+static DimDecodePlan *dimutil_get_decode_plan(struct Metric_object *metric_obj)
+{
+	struct Metric *metric = dimutil_get_metric(metric_obj);
+
+	if (metric == NULL) {
+		return NULL;
+	}
+
+	if (metric->decode_plan == NULL) {
+		dimutil_compile_decode_plan(metric_obj);
+	}
+
+	return metric->decode_plan;
+}
+
+/**
+ * Checks whether a plan was compiled from the given Attribute-Value-Map.
+ *
+ * \param plan the plan.
+ * \param val_map the Attribute-Value-Map.
+ *
+ * \return \b 1 if attributes and their lengths match; \b 0 otherwise.
+ */
+static int dimutil_decode_plan_matches(DimDecodePlan *plan, AttrValMap *val_map)
+{
+	int j;
+
+	if (plan->count != val_map->count) {
+		return 0;
+	}
+
+	for (j = 0; j < plan->count; ++j) {
+		if (plan->ops[j].attr_id != val_map->value[j].attribute_id ||
+		    plan->ops[j].width != val_map->value[j].attribute_len) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Updates a metric object from one fixed-format observation, following
+ * its decode plan.
+ *
+ * \param metric_obj the metric object.
+ * \param plan the plan of the object.
+ * \param data the observation, at least plan->size bytes.
+ * \param measurement_entry output parameter to describe data value.
+ */
+static void dimutil_run_decode_plan(struct Metric_object *metric_obj, DimDecodePlan *plan,
+				    intu8 *data, DataEntry *measurement_entry)
+{
+	CompoundDataEntry *cmp_entry = &measurement_entry->u.compound;
+	int j;
+
+	cmp_entry->name = data_strcp(dimutil_get_metric_object_name(metric_obj));
+	cmp_entry->entries_count = plan->count;
+	cmp_entry->entries = calloc(plan->count, sizeof(DataEntry));
+
+	for (j = 0; j < plan->count; ++j) {
+		DimDecodeOp *op = &plan->ops[j];
+		void *field = (intu8 *) metric_obj + op->field;
+		DataEntry *entry = &cmp_entry->entries[j];
+		ByteStreamReader value;
+		int error = 0;
+
+		byte_stream_reader_init(&value, data + op->offset, op->width);
+
+		switch (op->type) {
+		case DIM_OP_INTU16:
+			*(intu16 *) field = read_intu16(&value, &error);
+			break;
+		case DIM_OP_INTU32:
+			*(intu32 *) field = read_intu32(&value, &error);
+			break;
+		case DIM_OP_SFLOAT:
+			*(SFLOAT_Type *) field = read_sfloat(&value, &error);
+			break;
+		case DIM_OP_FLOAT:
+			*(FLOAT_Type *) field = read_float(&value, &error);
+			break;
+		case DIM_OP_ABSOLUTE_TIME:
+			decode_absolutetime(&value, field, &error);
+			break;
+		case DIM_OP_GENERIC:
+			error = !dimutil_fill_metric_object_attr(metric_obj, op->attr_id,
+								 &value, entry);
+			break;
+		}
+
+		if (error) {
+			ERROR("ERROR filling attribute id %d", op->attr_id);
+		} else if (op->describe != NULL) {
+			op->describe(metric_obj, field, entry);
 		}
 	}
 }
@@ -1248,7 +1600,16 @@ void dimutil_update_mds_from_obs_scan_fixed(struct MDS *mds, ObservationScanFixe
 		CompoundDataEntry *cmp_entry = &measurement_entry->u.compound;
 
 		octet_string value = fixed_obs->obs_val_data;
-		ByteStreamReader *stream = byte_stream_reader_instance(value.value, value.length);
+		DimDecodePlan *plan = dimutil_get_decode_plan(metric_obj);
+
+		if (plan != NULL && value.length >= plan->size) {
+			dimutil_run_decode_plan(metric_obj, plan, value.value, measurement_entry);
+			return;
+		}
+
+		// short observation, decode attribute by attribute
+		ByteStreamReader stream;
+		byte_stream_reader_init(&stream, value.value, value.length);
 
 		switch (metric_obj->choice) {
 		case METRIC_NUMERIC: {
@@ -1262,7 +1623,7 @@ void dimutil_update_mds_from_obs_scan_fixed(struct MDS *mds, ObservationScanFixe
 			for (j = 0; j < attr_list_size; ++j) {
 				result = dimutil_fill_numeric_attr(&(metric_obj->u.numeric),
 								   val_map.value[j].attribute_id,
-								   stream, &(cmp_entry->entries[j]));
+								   &stream, &(cmp_entry->entries[j]));
 
 				if (result == 0) {
 					ERROR("ERROR filling numeric attr");
@@ -1282,7 +1643,7 @@ void dimutil_update_mds_from_obs_scan_fixed(struct MDS *mds, ObservationScanFixe
 			for (j = 0; j < attr_list_size; ++j) {
 				result = dimutil_fill_enumeration_attr(&(metric_obj->u.enumeration),
 								       val_map.value[j].attribute_id,
-								       stream,
+								       &stream,
 								       &(cmp_entry->entries[j]));
 
 				if (result == 0) {
@@ -1303,7 +1664,7 @@ void dimutil_update_mds_from_obs_scan_fixed(struct MDS *mds, ObservationScanFixe
 			for (j = 0; j < attr_list_size; ++j) {
 				result = dimutil_fill_rtsa_attr(&(metric_obj->u.rtsa),
 								val_map.value[j].attribute_id,
-								stream,  &(cmp_entry->entries[j]));
+								&stream,  &(cmp_entry->entries[j]));
 
 				if (result == 0) {
 					ERROR("ERROR filling rtsa attr");
@@ -1312,8 +1673,6 @@ void dimutil_update_mds_from_obs_scan_fixed(struct MDS *mds, ObservationScanFixe
 		}
 		break;
 		}
-
-		free(stream);
 	}
 }
 
@@ -1337,10 +1696,35 @@ void dimutil_update_mds_from_grouped_observations(struct MDS *mds, ByteStreamRea
 
 	struct MDS_object *obj = mds_get_object_by_handle(mds, val_map_entry->obj_handle);
 	AttrValMap *val_map = &val_map_entry->attr_val_map;
+	int error = 0;
+	int k;
 
 	measurement_entry->choice = COMPOUND_DATA_ENTRY;
 	data_meta_set_handle(measurement_entry, val_map_entry->obj_handle);
 
+	if (obj == NULL || obj->choice != MDS_OBJ_METRIC) {
+		ERROR("grouped observation of unknown metric %d",
+			val_map_entry->obj_handle);
+
+		// values of other objects follow, keep stream aligned
+		for (k = 0; k < val_map->count; k++) {
+			read_intu8_slice(stream, val_map->value[k].attribute_len, &error);
+		}
+
+		return;
+	}
+
+	// scanner map is usually the object's own, whose plan applies
+	DimDecodePlan *plan = dimutil_get_decode_plan(&obj->u.metric);
+
+	if (plan != NULL && stream->unread_bytes >= plan->size &&
+	    dimutil_decode_plan_matches(plan, val_map)) {
+		intu8 *data = read_intu8_slice(stream, plan->size, &error);
+
+		dimutil_run_decode_plan(&obj->u.metric, plan, data, measurement_entry);
+		return;
+	}
+
 	CompoundDataEntry *cmp_entry = &measurement_entry->u.compound;
 	cmp_entry->entries_count = val_map->count;
 	cmp_entry->entries = calloc(val_map->count, sizeof(DataEntry));
@@ -1355,8 +1739,6 @@ void dimutil_update_mds_from_grouped_observations(struct MDS *mds, ByteStreamRea
 		}
 	}
 
-	int k;
-
 	for (k = 0; k < val_map->count; k++) {
 		switch (obj->u.metric.choice) {
 		case METRIC_NUMERIC: {
@@ -1397,4 +1779,366 @@ void dimutil_update_mds_from_grouped_observations(struct MDS *mds, ByteStreamRea
 	}
 }
 
+
+/**
+ * Appends a record for one observed value, filling the fields that
+ * come from the Metric itself.
+ *
+ * \param list the observation list.
+ * \param metric the Metric holding the value.
+ * \param metric_id nomenclature code of the value.
+ *
+ * \return the new record, NULL if the list cannot grow.
+ */
+static ObservationRecord *dimutil_add_observation(ObservationList *list,
+		struct Metric *metric, int metric_id)
+{
+	ObservationRecord *record = observation_list_add(list);
+
+	if (record != NULL) {
+		record->metric_id = metric_id;
+		record->unit_code = metric->unit_code;
+		record->measurement_status = metric->measurement_status;
+	}
+
+	return record;
+}
+
+/**
+ * Returns the metric-id of the n-th value of a compound observation.
+ *
+ * \param metric the Metric holding the value.
+ * \param n value index.
+ *
+ * \return metric-id from Metric-Id-List, or the object's own metric-id.
+ */
+static int dimutil_get_compound_metric_id(struct Metric *metric, int n)
+{
+	if (n < metric->metric_id_list.count) {
+		return metric->metric_id_list.value[n];
+	}
+
+	return dimutil_get_metric_ids(metric);
+}
+
+/**
+ * Appends the records for an observed value attribute of a Numeric.
+ *
+ * \param numeric the Numeric, already updated with the observation.
+ * \param attr_id attribute that was reported.
+ * \param list the observation list.
+ */
+static void dimutil_add_numeric_observations(struct Numeric *numeric,
+		OID_Type attr_id, ObservationList *list)
+{
+	struct Metric *metric = &numeric->metric;
+	ObservationRecord *record;
+	int k;
+
+	switch (attr_id) {
+	case MDC_ATTR_NU_VAL_OBS_SIMP:
+		record = dimutil_add_observation(list, metric, dimutil_get_metric_ids(metric));
+		if (record != NULL)
+			record->u.float_value = numeric->simple_nu_observed_value;
+		break;
+	case MDC_ATTR_NU_VAL_OBS_BASIC:
+		record = dimutil_add_observation(list, metric, dimutil_get_metric_ids(metric));
+		if (record != NULL)
+			record->u.float_value = numeric->basic_nu_observed_value;
+		break;
+	case MDC_ATTR_NU_VAL_OBS:
+		record = dimutil_add_observation(list, metric,
+						 numeric->nu_observed_value.metric_id);
+		if (record != NULL) {
+			record->unit_code = numeric->nu_observed_value.unit_code;
+			record->measurement_status = numeric->nu_observed_value.state;
+			record->u.float_value = numeric->nu_observed_value.value;
+		}
+		break;
+	case MDC_ATTR_NU_CMPD_VAL_OBS_SIMP:
+		for (k = 0; k < numeric->compound_simple_nu_observed_value.count; ++k) {
+			record = dimutil_add_observation(list, metric,
+							 dimutil_get_compound_metric_id(metric, k));
+			if (record != NULL)
+				record->u.float_value = numeric->compound_simple_nu_observed_value.value[k];
+		}
+		break;
+	case MDC_ATTR_NU_CMPD_VAL_OBS_BASIC:
+		for (k = 0; k < numeric->compound_basic_nu_observed_value.count; ++k) {
+			record = dimutil_add_observation(list, metric,
+							 dimutil_get_compound_metric_id(metric, k));
+			if (record != NULL)
+				record->u.float_value = numeric->compound_basic_nu_observed_value.value[k];
+		}
+		break;
+	case MDC_ATTR_NU_CMPD_VAL_OBS:
+		for (k = 0; k < numeric->compound_nu_observed_value.count; ++k) {
+			NuObsValue *value = &numeric->compound_nu_observed_value.value[k];
+			record = dimutil_add_observation(list, metric, value->metric_id);
+			if (record != NULL) {
+				record->unit_code = value->unit_code;
+				record->measurement_status = value->state;
+				record->u.float_value = value->value;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * Appends the record for an observed value attribute of an Enumeration.
+ * Text values have no binary form and are left to the DataList.
+ *
+ * \param enumeration the Enumeration, already updated with the observation.
+ * \param attr_id attribute that was reported.
+ * \param list the observation list.
+ */
+static void dimutil_add_enumeration_observations(struct Enumeration *enumeration,
+		OID_Type attr_id, ObservationList *list)
+{
+	struct Metric *metric = &enumeration->metric;
+	ObservationRecord *record = NULL;
+	long long value = 0;
+
+	switch (attr_id) {
+	case MDC_ATTR_ENUM_OBS_VAL_SIMP_OID:
+		value = enumeration->enum_observed_value_simple_OID;
+		break;
+	case MDC_ATTR_ENUM_OBS_VAL_SIMP_BIT_STR:
+		value = enumeration->enum_observed_value_simple_bit_str;
+		break;
+	case MDC_ATTR_ENUM_OBS_VAL_BASIC_BIT_STR:
+		value = enumeration->enum_observed_value_basic_bit_str;
+		break;
+	case MDC_ATTR_VAL_ENUM_OBS: {
+		EnumVal *enum_val = &enumeration->enum_observed_value.value;
+
+		if (enum_val->choice == OBJ_ID_CHOSEN) {
+			value = enum_val->u.enum_obj_id;
+		} else if (enum_val->choice == BIT_STR_CHOSEN) {
+			value = enum_val->u.enum_bit_str;
+		} else {
+			return;
+		}
+
+		record = dimutil_add_observation(list, metric,
+						 enumeration->enum_observed_value.metric_id);
+		if (record != NULL)
+			record->measurement_status = enumeration->enum_observed_value.state;
+		break;
+	}
+	default:
+		return;
+	}
+
+	if (record == NULL) {
+		record = dimutil_add_observation(list, metric, dimutil_get_metric_ids(metric));
+	}
+
+	if (record != NULL) {
+		record->type = OBSERVATION_VALUE_INT;
+		record->u.int_value = value;
+	}
+}
+
+/**
+ * Appends the records for one reported attribute of a metric object.
+ *
+ * \param metric_obj the metric object, already updated with the observation.
+ * \param attr_id attribute that was reported.
+ * \param list the observation list.
+ *
+ * \return OBSERVATION_FLAG_* bit if attr_id is a time stamp, 0 otherwise.
+ */
+static int dimutil_add_metric_observations(struct Metric_object *metric_obj,
+		OID_Type attr_id, ObservationList *list)
+{
+	switch (attr_id) {
+	case MDC_ATTR_TIME_STAMP_ABS:
+		return OBSERVATION_FLAG_ABSOLUTE_TIME;
+	case MDC_ATTR_TIME_STAMP_REL:
+		return OBSERVATION_FLAG_RELATIVE_TIME;
+	default:
+		break;
+	}
+
+	if (metric_obj->choice == METRIC_NUMERIC) {
+		dimutil_add_numeric_observations(&metric_obj->u.numeric, attr_id, list);
+	} else if (metric_obj->choice == METRIC_ENUM) {
+		dimutil_add_enumeration_observations(&metric_obj->u.enumeration,
+						     attr_id, list);
+	}
+
+	return 0;
+}
+
+/**
+ * Stamps the records appended for one observation with the object
+ * handle and the time stamps.
+ *
+ * \param metric_obj the metric object, already updated with the observation.
+ * \param handle the object handle.
+ * \param flags OBSERVATION_FLAG_* time stamps reported with the observation.
+ * \param list the observation list.
+ * \param first index of the first record of the observation.
+ */
+static void dimutil_finish_observations(struct Metric_object *metric_obj,
+		ASN1_HANDLE handle, int flags, ObservationList *list, int first)
+{
+	struct Metric *metric = dimutil_get_metric(metric_obj);
+	ObservationTime absolute_time;
+	int i;
+
+	if (metric == NULL) {
+		return;
+	}
+
+	AbsoluteTime *time = &metric->absolute_time_stamp;
+
+	absolute_time.year = date_util_convert_bcd_to_number(time->century) * 100
+			     + date_util_convert_bcd_to_number(time->year);
+	absolute_time.month = date_util_convert_bcd_to_number(time->month);
+	absolute_time.day = date_util_convert_bcd_to_number(time->day);
+	absolute_time.hour = date_util_convert_bcd_to_number(time->hour);
+	absolute_time.minute = date_util_convert_bcd_to_number(time->minute);
+	absolute_time.second = date_util_convert_bcd_to_number(time->second);
+	absolute_time.sec_fractions = date_util_convert_bcd_to_number(time->sec_fractions);
+
+	for (i = first; i < list->count; ++i) {
+		list->records[i].handle = handle;
+		list->records[i].flags |= flags;
+		list->records[i].relative_time = metric->relative_time_stamp;
+		list->records[i].absolute_time = absolute_time;
+	}
+}
+
+/**
+ * Returns the metric object with the given handle.
+ *
+ * \param mds the MDS.
+ * \param handle object handle.
+ *
+ * \return the metric object, NULL if handle is not a metric.
+ */
+static struct Metric_object *dimutil_get_metric_object(struct MDS *mds, ASN1_HANDLE handle)
+{
+	struct MDS_object *object = mds_get_object_by_handle(mds, handle);
+
+	if (object != NULL && object->choice == MDS_OBJ_METRIC) {
+		return &object->u.metric;
+	}
+
+	return NULL;
+}
+
+/**
+ * Appends the observed values of a var-format observation, already
+ * applied to the MDS, to an observation list.
+ *
+ * \param mds the MDS.
+ * \param var_obs the observation.
+ * \param list the observation list.
+ */
+void dimutil_add_obs_scan_observations(struct MDS *mds, ObservationScan *var_obs,
+				       ObservationList *list)
+{
+	struct Metric_object *metric_obj = dimutil_get_metric_object(mds, var_obs->obj_handle);
+	int first = list->count;
+	int flags = 0;
+	int j;
+
+	if (metric_obj == NULL) {
+		return;
+	}
+
+	for (j = 0; j < var_obs->attributes.count; ++j) {
+		flags |= dimutil_add_metric_observations(metric_obj,
+				var_obs->attributes.value[j].attribute_id, list);
+	}
+
+	dimutil_finish_observations(metric_obj, var_obs->obj_handle, flags, list, first);
+}
+
+/**
+ * Appends the observed values of an attribute value map, already
+ * applied to the object, to an observation list.
+ *
+ * \param metric_obj the metric object.
+ * \param handle the object handle.
+ * \param val_map the attributes that were reported.
+ * \param list the observation list.
+ */
+static void dimutil_add_val_map_observations(struct Metric_object *metric_obj,
+		ASN1_HANDLE handle, AttrValMap *val_map, ObservationList *list)
+{
+	int first = list->count;
+	int flags = 0;
+	int j;
+
+	for (j = 0; j < val_map->count; ++j) {
+		flags |= dimutil_add_metric_observations(metric_obj,
+				val_map->value[j].attribute_id, list);
+	}
+
+	dimutil_finish_observations(metric_obj, handle, flags, list, first);
+}
+
+/**
+ * Appends the observed values of a fixed-format observation, already
+ * applied to the MDS, to an observation list.
+ *
+ * \param mds the MDS.
+ * \param fixed_obs the observation.
+ * \param list the observation list.
+ */
+void dimutil_add_obs_scan_fixed_observations(struct MDS *mds, ObservationScanFixed *fixed_obs,
+		ObservationList *list)
+{
+	struct Metric_object *metric_obj = dimutil_get_metric_object(mds, fixed_obs->obj_handle);
+	struct Metric *metric = metric_obj != NULL ? dimutil_get_metric(metric_obj) : NULL;
+
+	if (metric != NULL) {
+		dimutil_add_val_map_observations(metric_obj, fixed_obs->obj_handle,
+						 &metric->attribute_value_map, list);
+	}
+}
+
+/**
+ * Appends the observed values of one object of a grouped-format
+ * observation, already applied to the MDS, to an observation list.
+ *
+ * \param mds the MDS.
+ * \param val_map_entry the object and attributes that were reported.
+ * \param list the observation list.
+ */
+void dimutil_add_grouped_observations(struct MDS *mds, HandleAttrValMapEntry *val_map_entry,
+				      ObservationList *list)
+{
+	struct Metric_object *metric_obj = dimutil_get_metric_object(mds, val_map_entry->obj_handle);
+
+	if (metric_obj != NULL) {
+		dimutil_add_val_map_observations(metric_obj, val_map_entry->obj_handle,
+						 &val_map_entry->attr_val_map, list);
+	}
+}
+
+/**
+ * Marks the records from index first on as reported for a person.
+ *
+ * \param list the observation list.
+ * \param first index of the first record.
+ * \param person_id the person id.
+ */
+void dimutil_set_observations_person_id(ObservationList *list, int first, intu16 person_id)
+{
+	int i;
+
+	for (i = first; i < list->count; ++i) {
+		list->records[i].person_id = person_id;
+		list->records[i].flags |= OBSERVATION_FLAG_PERSON_ID;
+	}
+}
+
 /** @} */
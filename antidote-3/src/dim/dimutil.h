@@ -42,6 +42,82 @@
 #include "asn1/phd_types.h"
 #include "util/bytelib.h"
 
+struct Metric_object;
+
+/**
+ * How a DimDecodeOp decodes its value
+ */
+typedef enum {
+	DIM_OP_GENERIC = 0,
+	DIM_OP_INTU16,
+	DIM_OP_INTU32,
+	DIM_OP_SFLOAT,
+	DIM_OP_FLOAT,
+	DIM_OP_ABSOLUTE_TIME
+} DimDecodeOpType;
+
+/**
+ * Describes a value stored by a DimDecodeOp in a DataEntry
+ */
+typedef void (*dim_describe_function)(struct Metric_object *metric_obj, void *field,
+				      DataEntry *data_entry);
+
+/**
+ * One attribute of a fixed-format observation
+ */
+typedef struct DimDecodeOp {
+	/**
+	 * Attribute id
+	 */
+	OID_Type attr_id;
+
+	/**
+	 * Position of the value inside the observation
+	 */
+	intu16 offset;
+
+	/**
+	 * Length of the value
+	 */
+	intu16 width;
+
+	/**
+	 * Decoding of the value, DIM_OP_GENERIC goes through
+	 * dimutil_fill_*_attr()
+	 */
+	DimDecodeOpType type;
+
+	/**
+	 * Offset of the target field inside struct Metric_object
+	 */
+	size_t field;
+
+	/**
+	 * Fills the DataEntry of the value, unused for DIM_OP_GENERIC
+	 */
+	dim_describe_function describe;
+} DimDecodeOp;
+
+/**
+ * Decode plan of a metric object, compiled from its Attribute-Value-Map.
+ * Allocated as a single block, released with free().
+ */
+typedef struct DimDecodePlan {
+	/**
+	 * Length of a fixed-format observation
+	 */
+	intu32 size;
+
+	/**
+	 * Number of ops, one per attribute
+	 */
+	int count;
+
+	/**
+	 * Ops in observation order
+	 */
+	DimDecodeOp *ops;
+} DimDecodePlan;
 
 int dimutil_fill_metric_attr(struct Metric *metric, OID_Type attr_id,
 			     ByteStreamReader *stream, DataEntry *data_entry);
@@ -64,6 +140,8 @@ int dimutil_fill_peri_scanner_attr(struct PeriCfgScanner *peri_scanner,
 int dimutil_fill_epi_scanner_attr(struct EpiCfgScanner *epi_scanner,
 				  OID_Type attr_id, ByteStreamReader *stream, DataEntry *data_entry);
 
+void dimutil_compile_decode_plan(struct Metric_object *metric_obj);
+
 void dimutil_update_mds_from_obs_scan(struct MDS *mds, ObservationScan *var_obs,
 				      DataEntry *data_entry);
 
@@ -74,4 +152,15 @@ void dimutil_update_mds_from_grouped_observations(struct MDS *mds, ByteStreamRea
 		HandleAttrValMapEntry *val_map_entry,
 		DataEntry *measurement_entry);
 
+void dimutil_add_obs_scan_observations(struct MDS *mds, ObservationScan *var_obs,
+				       ObservationList *list);
+
+void dimutil_add_obs_scan_fixed_observations(struct MDS *mds, ObservationScanFixed *fixed_obs,
+		ObservationList *list);
+
+void dimutil_add_grouped_observations(struct MDS *mds, HandleAttrValMapEntry *val_map_entry,
+				      ObservationList *list);
+
+void dimutil_set_observations_person_id(ObservationList *list, int first, intu16 person_id);
+
 #endif /* DIMUTIL_H_ */
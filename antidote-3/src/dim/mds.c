@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
 #include "mds.h"
 #include "dimutil.h"
 #include "nomenclature.h"
@@ -66,6 +67,16 @@
  * @{
  */
 
+/**
+ * Configuration templates in use or cached
+ */
+static MDSTemplate *mds_templates = NULL;
+
+/**
+ * Protects mds_templates and template reference counts
+ */
+static pthread_mutex_t mds_templates_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * Time out (seconds) release MDS constant
  */
@@ -86,6 +97,13 @@ static const intu32 MDS_TO_GET = 3;
  */
 // static const intu32 MDS_TO_INTER_SERVICE = 3;
 
+/**
+ * Initial size of objects list and minimum size of handle table
+ */
+#define MDS_OBJECTS_MIN_CAPACITY 16
+
+static void mds_build_handle_table(MDS *mds);
+
 /**
  * Returns a new instance of an MDS object, with an empty object list.
  *
@@ -469,225 +487,629 @@ Request *mds_get_pmstore(Context *ctx, int handle, service_request_callback requ
 }
 
 /**
- * This function configure the MDS structure using agent sent data which
- * provides information about the supported measurement capabilities
- * of the agent.
+ * Frees the attributes of an MDS object.
  *
- * After configuration steps the Manager is ready to execute operational mode
+ * \param object the object.
+ */
+void mds_destroy_object(struct MDS_object *object)
+{
+	if (object->choice == MDS_OBJ_PMSTORE) {
+		pmstore_destroy(&(object->u.pmstore));
+	} else if (object->choice == MDS_OBJ_METRIC) {
+
+		switch (object->u.metric.choice) {
+		case METRIC_NUMERIC:
+			numeric_destroy(&(object->u.metric.u.numeric));
+			break;
+		case METRIC_ENUM:
+			enumeration_destroy(&(object->u.metric.u.enumeration));
+			break;
+		case METRIC_RTSA:
+			rtsa_destroy(&(object->u.metric.u.rtsa));
+			break;
+		default:
+			break;
+		}
+
+	} else if (object->choice == MDS_OBJ_SCANNER) {
+		switch (object->u.scanner.choice) {
+		case EPI_CFG_SCANNER:
+			epi_cfg_scanner_destroy(&(object->u.scanner.u.epi_cfg_scanner));
+			break;
+		case PERI_CFG_SCANNER:
+			peri_cfg_scanner_destroy(&(object->u.scanner.u.peri_cfg_scanner));
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+/**
+ * Builds an MDS object from its configuration.
  *
- * \param ctx context Operating Context
- * \param config_obj_list Configuration object list
- * \param manager Manager flag
+ * \param cfgObj the configuration object.
+ * \param object output, the object built.
+ *
+ * \return 1 if the object was built, 0 if its class is not supported.
  */
-void mds_configure_operating(Context *ctx, ConfigObjectList *config_obj_list,
-				int manager)
+static int mds_build_object(ConfigObject *cfgObj, struct MDS_object *object)
 {
-	int obj_list_size = config_obj_list->count;
-	int attr_list_size = 0;
-	int i;
+	int attr_list_size = cfgObj->attributes.count;
 	int j;
 
-	MDS *mds  = ctx->mds;
+	switch (cfgObj->obj_class) {
+	case MDC_MOC_VMO_METRIC:
+		// superclass, should not be used
+		WARNING("MDC_MOC_VMO_METRIC in config");
+		break;
+	case MDC_MOC_VMO_METRIC_NU: {
+		object->choice = MDS_OBJ_METRIC;
+		struct Metric_object *metric_obj = &(object->u.metric);
+		metric_obj->choice = METRIC_NUMERIC;
+		object->obj_handle = cfgObj->obj_handle;
+
+		struct Metric *metric = metric_instance();
+		struct Numeric *numeric = numeric_instance(metric);
+
+		metric_obj->u.numeric = *numeric;
+
+		free(numeric);
+		free(metric);
+		numeric = NULL;
+		metric = NULL;
+
+		for (j = 0; j < attr_list_size; ++j) {
+			ByteStreamReader *stream = byte_stream_reader_instance(cfgObj->attributes.value[j].attribute_value.value,
+						   cfgObj->attributes.value[j].attribute_value.length);
+
+			dimutil_fill_numeric_attr(&(object->u.metric.u.numeric),
+						  cfgObj->attributes.value[j].attribute_id,
+						  stream, NULL);
+			free(stream);
+		}
 
-	for (i = 0; i < obj_list_size; ++i) {
-		struct MDS_object object;
+		object->u.metric.u.numeric.metric.handle = cfgObj->obj_handle;
+		return 1;
+	}
+	case MDC_MOC_VMO_METRIC_ENUM: {
+		object->choice = MDS_OBJ_METRIC;
+		struct Metric_object *metric_obj = &(object->u.metric);
+		metric_obj->choice = METRIC_ENUM;
+		object->obj_handle = cfgObj->obj_handle;
 
-		ConfigObject *cfgObj = &(config_obj_list->value[i]);
-		attr_list_size = cfgObj->attributes.count;
+		struct Metric *metric = metric_instance();
+		struct Enumeration *enumeration = enumeration_instance(metric);
 
-		switch (cfgObj->obj_class) {
-		case MDC_MOC_VMO_METRIC:
-			// superclass, should not be used
-			WARNING("MDC_MOC_VMO_METRIC in config");
-			break;
-		case MDC_MOC_VMO_METRIC_NU: {
-			object.choice = MDS_OBJ_METRIC;
-			struct Metric_object *metric_obj = &(object.u.metric);
-			metric_obj->choice = METRIC_NUMERIC;
-			object.obj_handle = cfgObj->obj_handle;
+		metric_obj->u.enumeration = *enumeration;
+
+		free(enumeration);
+		free(metric);
+		enumeration = NULL;
+		metric = NULL;
+
+		for (j = 0; j < attr_list_size; ++j) {
+			ByteStreamReader *stream = byte_stream_reader_instance(cfgObj->attributes.value[j].attribute_value.value,
+						   cfgObj->attributes.value[j].attribute_value.length);
+
+			dimutil_fill_enumeration_attr(&(object->u.metric.u.enumeration),
+						      cfgObj->attributes.value[j].attribute_id,
+						      stream, NULL);
+			free(stream);
+		}
+
+		object->u.metric.u.enumeration.metric.handle = cfgObj->obj_handle;
+		return 1;
+	}
+	case MDC_MOC_VMO_METRIC_SA_RT: {
+		object->choice = MDS_OBJ_METRIC;
+		struct Metric_object *metric_obj = &(object->u.metric);
+		metric_obj->choice = METRIC_RTSA;
+		object->obj_handle = cfgObj->obj_handle;
+
+		struct Metric *metric = metric_instance();
+		struct RTSA *rtsa = rtsa_instance(metric);
+
+		metric_obj->u.rtsa = *rtsa;
+
+		free(rtsa);
+		free(metric);
+		rtsa = NULL;
+		metric = NULL;
+
+		for (j = 0; j < attr_list_size; ++j) {
+			ByteStreamReader *stream = byte_stream_reader_instance(cfgObj->attributes.value[j].attribute_value.value,
+							cfgObj->attributes.value[j].attribute_value.length);
+			dimutil_fill_rtsa_attr(&(object->u.metric.u.rtsa),
+					cfgObj->attributes.value[j].attribute_id,
+					stream, NULL);
+			free(stream);
+		}
+		object->u.metric.u.rtsa.metric.handle = cfgObj->obj_handle;
+		return 1;
+	}
+	case MDC_MOC_VMO_PMSTORE: {
+		object->obj_handle = cfgObj->obj_handle;
+		object->choice = MDS_OBJ_PMSTORE;
 
+		{
 			struct Metric *metric = metric_instance();
-			struct Numeric *numeric = numeric_instance(metric);
+			struct PMStore *store = pmstore_instance();
 
-			metric_obj->u.numeric = *numeric;
+			object->u.pmstore = *store;
 
-			free(numeric);
+			free(store);
 			free(metric);
-			numeric = NULL;
-			metric = NULL;
+		}
 
-			for (j = 0; j < attr_list_size; ++j) {
-				ByteStreamReader *stream = byte_stream_reader_instance(cfgObj->attributes.value[j].attribute_value.value,
-							   cfgObj->attributes.value[j].attribute_value.length);
+		object->u.pmstore.handle = cfgObj->obj_handle;
 
-				dimutil_fill_numeric_attr(&(object.u.metric.u.numeric),
-							  cfgObj->attributes.value[j].attribute_id,
-							  stream, NULL);
-				free(stream);
-			}
+		for (j = 0; j < attr_list_size; ++j) {
+			ByteStreamReader *stream = byte_stream_reader_instance(
+					cfgObj->attributes.value[j].attribute_value.value,
+					cfgObj->attributes.value[j].attribute_value.length);
+			pmstore_set_attribute(&(object->u.pmstore),
+					      cfgObj->attributes.value[j].attribute_id,
+					      stream);
+			free(stream);
+		}
 
-			object.u.metric.u.numeric.metric.handle = cfgObj->obj_handle;
-			mds_add_object(mds, object);
-			break;
+		return 1;
+	}
+	case MDC_MOC_SCAN:
+		// superclass, should not be used
+		WARNING("MDC_MOC_SCAN in config");
+		break;
+	case MDC_MOC_SCAN_CFG:
+		// superclass, should not be used
+		WARNING("MDC_MOC_SCAN_CFG in config");
+		break;
+	case MDC_MOC_SCAN_CFG_EPI: {
+		object->choice = MDS_OBJ_SCANNER;
+		object->obj_handle = cfgObj->obj_handle;
+
+		struct Scanner *scanner = scanner_instance(cfgObj->obj_handle, os_disabled);
+		struct CfgScanner *cfg_scanner = cfg_scanner_instance(scanner, unconfirmed);
+		struct EpiCfgScanner *epi_cfg_scanner = epi_cfg_scanner_instance(cfg_scanner);
+
+		struct Scanner_object *scanner_obj = &(object->u.scanner);
+		scanner_obj->choice = EPI_CFG_SCANNER;
+		scanner_obj->u.epi_cfg_scanner = *epi_cfg_scanner;
+
+		free(scanner);
+		free(cfg_scanner);
+		free(epi_cfg_scanner);
+
+		for (j = 0; j < attr_list_size; ++j) {
+			ByteStreamReader *stream = byte_stream_reader_instance(cfgObj->attributes.value[j].attribute_value.value,
+						   cfgObj->attributes.value[j].attribute_value.length);
+			dimutil_fill_epi_scanner_attr(&(object->u.scanner.u.epi_cfg_scanner),
+						      cfgObj->attributes.value[j].attribute_id,
+						      stream, NULL);
+			free(stream);
 		}
-		case MDC_MOC_VMO_METRIC_ENUM: {
-			object.choice = MDS_OBJ_METRIC;
-			struct Metric_object *metric_obj = &(object.u.metric);
-			metric_obj->choice = METRIC_ENUM;
-			object.obj_handle = cfgObj->obj_handle;
 
-			struct Metric *metric = metric_instance();
-			struct Enumeration *enumeration = enumeration_instance(metric);
+		return 1;
+	}
+	case MDC_MOC_SCAN_CFG_PERI: {
+		object->choice = MDS_OBJ_SCANNER;
+		object->obj_handle = cfgObj->obj_handle;
+
+		struct Scanner *scanner = scanner_instance(cfgObj->obj_handle, os_disabled);
+		struct CfgScanner *cfg_scanner = cfg_scanner_instance(scanner, unconfirmed);
+		struct PeriCfgScanner *peri_cfg_scanner = peri_cfg_scanner_instance(cfg_scanner);
+
+		struct Scanner_object *scanner_obj = &(object->u.scanner);
+		scanner_obj->choice = PERI_CFG_SCANNER;
+		scanner_obj->u.peri_cfg_scanner = *peri_cfg_scanner;
+
+		free(scanner);
+		free(cfg_scanner);
+		free(peri_cfg_scanner);
+
+		for (j = 0; j < attr_list_size; ++j) {
+			ByteStreamReader *stream = byte_stream_reader_instance(cfgObj->attributes.value[j].attribute_value.value,
+						   cfgObj->attributes.value[j].attribute_value.length);
+			dimutil_fill_peri_scanner_attr(&(object->u.scanner.u.peri_cfg_scanner),
+						       cfgObj->attributes.value[j].attribute_id,
+						       stream, NULL);
+			free(stream);
+		}
 
-			metric_obj->u.enumeration = *enumeration;
+		return 1;
+	}
+	default:
+		WARNING("Unknown obj class in config: %d", cfgObj->obj_class);
+		break;
+	}
 
-			free(enumeration);
-			free(metric);
-			enumeration = NULL;
-			metric = NULL;
+	return 0;
+}
 
-			for (j = 0; j < attr_list_size; ++j) {
-				ByteStreamReader *stream = byte_stream_reader_instance(cfgObj->attributes.value[j].attribute_value.value,
-							   cfgObj->attributes.value[j].attribute_value.length);
+/**
+ * Gives a new MDS object the static attributes of a template object.
+ * Dynamic attributes start empty and stay private to the new object,
+ * which must be freed with mds_destroy_object().
+ *
+ * \param object output, the object.
+ * \param shared the template object.
+ */
+void mds_share_metric_object(struct MDS_object *object,
+			     struct MDS_object *shared)
+{
+	*object = *shared;
+
+	switch (object->u.metric.choice) {
+	case METRIC_NUMERIC: {
+		struct Numeric *numeric = &(object->u.metric.u.numeric);
+		memset(&numeric->compound_simple_nu_observed_value, 0,
+		       sizeof(SimpleNuObsValueCmp));
+		memset(&numeric->compound_basic_nu_observed_value, 0,
+		       sizeof(BasicNuObsValueCmp));
+		memset(&numeric->compound_nu_observed_value, 0,
+		       sizeof(NuObsValueCmp));
+		numeric->metric.shared_config = 1;
+		break;
+	}
+	case METRIC_ENUM: {
+		struct Enumeration *enumeration = &(object->u.metric.u.enumeration);
+		memset(&enumeration->enum_observed_value, 0, sizeof(EnumObsValue));
+		memset(&enumeration->enum_observed_value_simple_str, 0,
+		       sizeof(EnumPrintableString));
+		enumeration->metric.shared_config = 1;
+		break;
+	}
+	case METRIC_RTSA: {
+		struct RTSA *rtsa = &(object->u.metric.u.rtsa);
+		memset(&rtsa->simple_sa_observed_value, 0, sizeof(octet_string));
+		rtsa->metric.shared_config = 1;
+		break;
+	}
+	default:
+		break;
+	}
+}
 
-				dimutil_fill_enumeration_attr(&(object.u.metric.u.enumeration),
-							      cfgObj->attributes.value[j].attribute_id,
-							      stream, NULL);
-				free(stream);
-			}
+/**
+ * Checks whether objects of a class can come from a template.
+ *
+ * \param obj_class the object class.
+ *
+ * \return 1 for metric classes, 0 otherwise.
+ */
+static int mds_is_template_class(OID_Type obj_class)
+{
+	return obj_class == MDC_MOC_VMO_METRIC_NU ||
+	       obj_class == MDC_MOC_VMO_METRIC_ENUM ||
+	       obj_class == MDC_MOC_VMO_METRIC_SA_RT;
+}
 
-			object.u.metric.u.enumeration.metric.handle = cfgObj->obj_handle;
-			mds_add_object(mds, object);
+/**
+ * Checks whether a template object stands for a configuration object.
+ *
+ * \param object the template object.
+ * \param cfgObj the configuration object.
+ *
+ * \return 1 if handle and class match, 0 otherwise.
+ */
+static int mds_template_object_matches(struct MDS_object *object, ConfigObject *cfgObj)
+{
+	if (object->obj_handle != cfgObj->obj_handle) {
+		return 0;
+	}
 
-			break;
-		}
-		case MDC_MOC_VMO_METRIC_SA_RT: {
-			object.choice = MDS_OBJ_METRIC;
-			struct Metric_object *metric_obj = &(object.u.metric);
-			metric_obj->choice = METRIC_RTSA;
-			object.obj_handle = cfgObj->obj_handle;
+	switch (object->u.metric.choice) {
+	case METRIC_NUMERIC:
+		return cfgObj->obj_class == MDC_MOC_VMO_METRIC_NU;
+	case METRIC_ENUM:
+		return cfgObj->obj_class == MDC_MOC_VMO_METRIC_ENUM;
+	case METRIC_RTSA:
+		return cfgObj->obj_class == MDC_MOC_VMO_METRIC_SA_RT;
+	default:
+		return 0;
+	}
+}
 
-			struct Metric *metric = metric_instance();
-			struct RTSA *rtsa = rtsa_instance(metric);
+/**
+ * Checks whether a template was built for a configuration.
+ *
+ * \param config_template the template.
+ * \param config_id the configuration id.
+ * \param system_id agent System-Id, only compared for extended configurations.
+ *
+ * \return 1 if the template matches, 0 otherwise.
+ */
+static int mds_template_matches(MDSTemplate *config_template, ConfigId config_id,
+				octet_string *system_id)
+{
+	if (config_template->config_id != config_id) {
+		return 0;
+	}
 
-			metric_obj->u.rtsa = *rtsa;
+	if (std_configurations_is_supported_standard(config_id)) {
+		return 1;
+	}
 
-			free(rtsa);
-			free(metric);
-			rtsa = NULL;
-			metric = NULL;
-
-			for (j = 0; j < attr_list_size; ++j) {
-				ByteStreamReader *stream = byte_stream_reader_instance(cfgObj->attributes.value[j].attribute_value.value,
-								cfgObj->attributes.value[j].attribute_value.length);
-				dimutil_fill_rtsa_attr(&(object.u.metric.u.rtsa),
-						cfgObj->attributes.value[j].attribute_id,
-						stream, NULL);
-				free(stream);
-			}
-			object.u.metric.u.rtsa.metric.handle = cfgObj->obj_handle;
-			mds_add_object(mds, object);
-			break;
+	return config_template->system_id.length == system_id->length &&
+	       memcmp(config_template->system_id.value, system_id->value,
+		      system_id->length) == 0;
+}
+
+/**
+ * Builds the metric objects of a configuration into a new template.
+ *
+ * \param config_id the configuration id.
+ * \param system_id agent System-Id.
+ * \param config_obj_list the configuration.
+ *
+ * \return the template, with a reference for the caller; NULL on error.
+ */
+static MDSTemplate *mds_template_new(ConfigId config_id, octet_string *system_id,
+				     ConfigObjectList *config_obj_list)
+{
+	MDSTemplate *config_template = calloc(1, sizeof(MDSTemplate));
+	int i;
+
+	if (config_template == NULL) {
+		return NULL;
+	}
+
+	config_template->config_id = config_id;
+	config_template->refcount = 1;
+	config_template->objects = calloc(config_obj_list->count + 1,
+					  sizeof(struct MDS_object));
+
+	if (!std_configurations_is_supported_standard(config_id) &&
+	    system_id->length > 0) {
+		config_template->system_id.value = malloc(system_id->length);
+		config_template->system_id.length = system_id->length;
+		memcpy(config_template->system_id.value, system_id->value,
+		       system_id->length);
+	}
+
+	for (i = 0; i < config_obj_list->count; ++i) {
+		ConfigObject *cfgObj = &(config_obj_list->value[i]);
+		struct MDS_object *object =
+			&(config_template->objects[config_template->objects_count]);
+
+		if (mds_is_template_class(cfgObj->obj_class) &&
+		    mds_build_object(cfgObj, object)) {
+			dimutil_compile_decode_plan(&(object->u.metric));
+			config_template->objects_count++;
 		}
-		case MDC_MOC_VMO_PMSTORE: {
-			object.obj_handle = cfgObj->obj_handle;
-			object.choice = MDS_OBJ_PMSTORE;
+	}
 
-			{
-				struct Metric *metric = metric_instance();
-				struct PMStore *store = pmstore_instance();
+	return config_template;
+}
 
-				object.u.pmstore = *store;
+/**
+ * Frees a template and its objects.
+ *
+ * \param config_template the template.
+ */
+static void mds_template_destroy(MDSTemplate *config_template)
+{
+	int i;
 
-				free(store);
-				free(metric);
-			}
+	for (i = 0; i < config_template->objects_count; ++i) {
+		mds_destroy_object(&(config_template->objects[i]));
+	}
 
-			object.u.pmstore.handle = cfgObj->obj_handle;
+	free(config_template->objects);
+	del_octet_string(&config_template->system_id);
+	free(config_template);
+}
 
-			for (j = 0; j < attr_list_size; ++j) {
-				ByteStreamReader *stream = byte_stream_reader_instance(
-						cfgObj->attributes.value[j].attribute_value.value,
-						cfgObj->attributes.value[j].attribute_value.length);
-				pmstore_set_attribute(&(object.u.pmstore),
-						      cfgObj->attributes.value[j].attribute_id,
-						      stream);
-				free(stream);
-			}
+/**
+ * Looks up a cached template. Must be called with
+ * mds_templates_mutex held.
+ *
+ * \param config_id the configuration id.
+ * \param system_id agent System-Id.
+ *
+ * \return the template, or NULL if not cached.
+ */
+static MDSTemplate *mds_template_find(ConfigId config_id, octet_string *system_id)
+{
+	MDSTemplate *config_template;
 
-			mds_add_object(mds, object);
+	for (config_template = mds_templates; config_template != NULL;
+	     config_template = config_template->next) {
+		if (mds_template_matches(config_template, config_id, system_id)) {
 			break;
 		}
-		case MDC_MOC_SCAN:
-			// superclass, should not be used
-			WARNING("MDC_MOC_SCAN in config");
-			break;
-		case MDC_MOC_SCAN_CFG:
-			// superclass, should not be used
-			WARNING("MDC_MOC_SCAN_CFG in config");
-			break;
-		case MDC_MOC_SCAN_CFG_EPI: {
-			object.choice = MDS_OBJ_SCANNER;
-			object.obj_handle = cfgObj->obj_handle;
-
-			struct Scanner *scanner = scanner_instance(cfgObj->obj_handle, os_disabled);
-			struct CfgScanner *cfg_scanner = cfg_scanner_instance(scanner, unconfirmed);
-			struct EpiCfgScanner *epi_cfg_scanner = epi_cfg_scanner_instance(cfg_scanner);
-
-			struct Scanner_object *scanner_obj = &(object.u.scanner);
-			scanner_obj->choice = EPI_CFG_SCANNER;
-			scanner_obj->u.epi_cfg_scanner = *epi_cfg_scanner;
-
-			free(scanner);
-			free(cfg_scanner);
-			free(epi_cfg_scanner);
-
-			for (j = 0; j < attr_list_size; ++j) {
-				ByteStreamReader *stream = byte_stream_reader_instance(cfgObj->attributes.value[j].attribute_value.value,
-							   cfgObj->attributes.value[j].attribute_value.length);
-				dimutil_fill_epi_scanner_attr(&(object.u.scanner.u.epi_cfg_scanner),
-							      cfgObj->attributes.value[j].attribute_id,
-							      stream, NULL);
-				free(stream);
+	}
+
+	return config_template;
+}
+
+/**
+ * Returns the shared template of a configuration, building it on first
+ * use. Standard configurations share one template for every agent;
+ * extended configurations have one per agent System-Id.
+ *
+ * \param config_id the configuration id.
+ * \param system_id agent System-Id.
+ * \param config_obj_list the configuration, used if template must be built.
+ *
+ * \return the template, release with mds_template_release(); NULL on error.
+ */
+MDSTemplate *mds_template_acquire(ConfigId config_id, octet_string *system_id,
+				  ConfigObjectList *config_obj_list)
+{
+	MDSTemplate *config_template;
+	MDSTemplate *built;
+
+	pthread_mutex_lock(&mds_templates_mutex);
+
+	config_template = mds_template_find(config_id, system_id);
+
+	if (config_template != NULL) {
+		config_template->refcount++;
+	}
+
+	pthread_mutex_unlock(&mds_templates_mutex);
+
+	if (config_template != NULL) {
+		return config_template;
+	}
+
+	// built without the lock, so associations with other
+	// configurations are not held back by this one
+	built = mds_template_new(config_id, system_id, config_obj_list);
+
+	if (built == NULL) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&mds_templates_mutex);
+
+	config_template = mds_template_find(config_id, system_id);
+
+	if (config_template == NULL) {
+		// the cache keeps a reference of its own
+		config_template = built;
+		config_template->next = mds_templates;
+		mds_templates = config_template;
+		built = NULL;
+	}
+
+	config_template->refcount++;
+
+	pthread_mutex_unlock(&mds_templates_mutex);
+
+	if (built != NULL) {
+		// another thread cached the same configuration first
+		mds_template_destroy(built);
+	}
+
+	return config_template;
+}
+
+/**
+ * Drops a reference to a template, freeing it when no MDS uses it
+ * and it is no longer cached.
+ *
+ * \param config_template the template, may be NULL.
+ */
+void mds_template_release(MDSTemplate *config_template)
+{
+	if (config_template == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&mds_templates_mutex);
+
+	if (--config_template->refcount == 0) {
+		mds_template_destroy(config_template);
+	}
+
+	pthread_mutex_unlock(&mds_templates_mutex);
+}
+
+/**
+ * Removes templates from the cache. MDS instances using them keep
+ * them alive until destroyed.
+ *
+ * \param config_id configuration id of the template to remove.
+ * \param system_id agent System-Id; if NULL, all templates are removed.
+ */
+void mds_template_invalidate(ConfigId config_id, octet_string *system_id)
+{
+	MDSTemplate **link = &mds_templates;
+
+	pthread_mutex_lock(&mds_templates_mutex);
+
+	while (*link != NULL) {
+		MDSTemplate *config_template = *link;
+
+		if (system_id == NULL ||
+		    mds_template_matches(config_template, config_id, system_id)) {
+			*link = config_template->next;
+
+			if (--config_template->refcount == 0) {
+				mds_template_destroy(config_template);
 			}
+		} else {
+			link = &config_template->next;
+		}
+	}
+
+	pthread_mutex_unlock(&mds_templates_mutex);
+}
 
+/**
+ * This function configure the MDS structure using agent sent data which
+ * provides information about the supported measurement capabilities
+ * of the agent.
+ *
+ * On the manager side, metric objects share their static attributes
+ * with every other MDS using the same configuration (see
+ * mds_template_acquire()); only observed values are private.
+ *
+ * After configuration steps the Manager is ready to execute operational mode
+ *
+ * \param ctx context Operating Context
+ * \param config_obj_list Configuration object list, freed by this function
+ * \param manager Manager flag
+ */
+void mds_configure_operating(Context *ctx, ConfigObjectList *config_obj_list,
+				int manager)
+{
+	mds_configure_operating_shared(ctx, config_obj_list, manager);
+
+	del_configobjectlist(config_obj_list);
+	config_obj_list = NULL;
+}
+
+/**
+ * Same as mds_configure_operating(), for a configuration object list
+ * that is shared (e.g. a standard configuration). The list is only
+ * read and still belongs to the caller.
+ *
+ * \param ctx context Operating Context
+ * \param config_obj_list Configuration object list
+ * \param manager Manager flag
+ */
+void mds_configure_operating_shared(Context *ctx, ConfigObjectList *config_obj_list,
+				    int manager)
+{
+	int obj_list_size = config_obj_list->count;
+	MDSTemplate *config_template = NULL;
+	int shared = 0;
+	int i;
+
+	MDS *mds  = ctx->mds;
+
+	if (manager) {
+		config_template = mds_template_acquire(mds->dev_configuration_id,
+						       &mds->system_id, config_obj_list);
+	}
+
+	for (i = 0; i < obj_list_size; ++i) {
+		struct MDS_object object;
+
+		ConfigObject *cfgObj = &(config_obj_list->value[i]);
+
+		if (config_template != NULL && shared < config_template->objects_count &&
+		    mds_template_object_matches(&(config_template->objects[shared]), cfgObj)) {
+			mds_share_metric_object(&object, &(config_template->objects[shared++]));
 			mds_add_object(mds, object);
-			break;
-		}
-		case MDC_MOC_SCAN_CFG_PERI: {
-			object.choice = MDS_OBJ_SCANNER;
-			object.obj_handle = cfgObj->obj_handle;
-
-			struct Scanner *scanner = scanner_instance(cfgObj->obj_handle, os_disabled);
-			struct CfgScanner *cfg_scanner = cfg_scanner_instance(scanner, unconfirmed);
-			struct PeriCfgScanner *peri_cfg_scanner = peri_cfg_scanner_instance(cfg_scanner);
-
-			struct Scanner_object *scanner_obj = &(object.u.scanner);
-			scanner_obj->choice = PERI_CFG_SCANNER;
-			scanner_obj->u.peri_cfg_scanner = *peri_cfg_scanner;
-
-			free(scanner);
-			free(cfg_scanner);
-			free(peri_cfg_scanner);
-
-			for (j = 0; j < attr_list_size; ++j) {
-				ByteStreamReader *stream = byte_stream_reader_instance(cfgObj->attributes.value[j].attribute_value.value,
-							   cfgObj->attributes.value[j].attribute_value.length);
-				dimutil_fill_peri_scanner_attr(&(object.u.scanner.u.peri_cfg_scanner),
-							       cfgObj->attributes.value[j].attribute_id,
-							       stream, NULL);
-				free(stream);
+		} else if (mds_build_object(cfgObj, &object)) {
+			if (object.choice == MDS_OBJ_METRIC) {
+				dimutil_compile_decode_plan(&(object.u.metric));
 			}
 
 			mds_add_object(mds, object);
-			break;
-		}
-		default:
-			WARNING("Unknown obj class in config: %d", cfgObj->obj_class);
-			break;
 		}
 	}
 
+	mds_template_release(mds->config_template);
+	mds->config_template = config_template;
+
+	// objects are complete, index them
+	mds_build_handle_table(mds);
+
 	service_init(ctx);
 
 	if (manager) {
@@ -696,9 +1118,6 @@ void mds_configure_operating(Context *ctx, ConfigObjectList *config_obj_list,
 
 		manager_notify_evt_device_available(ctx, list);
 	}
-
-	del_configobjectlist(config_obj_list);
-	config_obj_list = NULL;
 }
 
 /**
@@ -798,10 +1217,11 @@ DataList *mds_populate_configuration(MDS *mds)
 	}
 
 	ConfigObjectList *config;
+	int shared = std_configurations_is_supported_standard(mds->dev_configuration_id);
 
-	// gets a copy of config attributes
-	if (std_configurations_is_supported_standard(mds->dev_configuration_id)) {
-		config = std_configurations_get_configuration_attributes(
+	// gets a copy of config attributes, standard ones are shared
+	if (shared) {
+		config = std_configurations_get_shared_configuration(
 								mds->dev_configuration_id);
 	} else {
 		config = ext_configurations_get_configuration_attributes(&mds->system_id,
@@ -825,8 +1245,10 @@ DataList *mds_populate_configuration(MDS *mds)
 		mds_populate_configuration_attributes(cfgobj->obj_class, name, atts, entry);
 	}
 
-	del_configobjectlist(config);
-	free(config);
+	if (!shared) {
+		del_configobjectlist(config);
+		free(config);
+	}
 
 	return list;
 }
@@ -883,25 +1305,95 @@ void mds_populate_attributes(MDS *mds, DataEntry *entry)
  */
 void mds_add_object(MDS *mds, struct MDS_object object)
 {
-	// test if there is not elements in the list
-	if (mds->objects_list_count == 0 && mds != NULL) {
-		mds->objects_list = malloc(sizeof(struct MDS_object));
-		memset(mds->objects_list, 0, sizeof(struct MDS_object));
-
-	} else { // change the list size
-		mds->objects_list = realloc(mds->objects_list,
-					    sizeof(struct MDS_object)
-					    * (mds->objects_list_count + 1));
-		memset(mds->objects_list+mds->objects_list_count, 0, sizeof(struct MDS_object));
-
-		if (mds->objects_list == NULL) {
+	if (mds == NULL) {
+		return;
+	}
+
+	// change the list size, doubling it so configuration is linear
+	if (mds->objects_list_count == mds->objects_list_capacity) {
+		int capacity = mds->objects_list_capacity * 2;
+
+		if (capacity < MDS_OBJECTS_MIN_CAPACITY) {
+			capacity = MDS_OBJECTS_MIN_CAPACITY;
+		}
+
+		struct MDS_object *list = realloc(mds->objects_list,
+						  sizeof(struct MDS_object) * capacity);
+
+		if (list == NULL) {
 			ERROR("ERROR");
+			return;
 		}
+
+		mds->objects_list = list;
+		mds->objects_list_capacity = capacity;
 	}
 
 	// add element to list
 	mds->objects_list[mds->objects_list_count] = object;
 	mds->objects_list_count += 1;
+
+	// handle table is built again on next lookup
+	free(mds->handle_table);
+	mds->handle_table = NULL;
+	mds->handle_table_size = 0;
+}
+
+/**
+ * Slot of handle_table where the search for a handle starts.
+ *
+ * \param mds the mds
+ * \param obj_handle object handle
+ * \return slot index
+ */
+static int mds_handle_slot(MDS *mds, ASN1_HANDLE obj_handle)
+{
+	// multiplicative hash, high bits folded in so that handles
+	// differing only in high bits do not collide
+	intu32 hash = obj_handle * 2654435761u;
+
+	return (hash ^ (hash >> 16)) & (mds->handle_table_size - 1);
+}
+
+/**
+ * Builds the handle table that indexes objects_list, so objects are
+ * found by handle in constant time. If two objects share a handle,
+ * the first one is indexed, as a linear search would find.
+ *
+ * \param mds the mds
+ */
+static void mds_build_handle_table(MDS *mds)
+{
+	int size = MDS_OBJECTS_MIN_CAPACITY;
+	int i;
+
+	// at most half full, keeps probe sequences short
+	while (size < mds->objects_list_count * 2) {
+		size *= 2;
+	}
+
+	free(mds->handle_table);
+	mds->handle_table = calloc(size, sizeof(int));
+	mds->handle_table_size = mds->handle_table != NULL ? size : 0;
+
+	if (mds->handle_table == NULL) {
+		ERROR("mds: cannot build handle table");
+		return;
+	}
+
+	for (i = 0; i < mds->objects_list_count; ++i) {
+		ASN1_HANDLE obj_handle = mds->objects_list[i].obj_handle;
+		int slot = mds_handle_slot(mds, obj_handle);
+
+		while (mds->handle_table[slot] != 0 &&
+		       mds->objects_list[mds->handle_table[slot] - 1].obj_handle != obj_handle) {
+			slot = (slot + 1) & (size - 1);
+		}
+
+		if (mds->handle_table[slot] == 0) {
+			mds->handle_table[slot] = i + 1;
+		}
+	}
 }
 
 /**
@@ -918,17 +1410,37 @@ void mds_add_object(MDS *mds, struct MDS_object object)
  */
 struct MDS_object *mds_get_object_by_handle(MDS *mds, ASN1_HANDLE obj_handle)
 {
-	int object_list_size = 0;
 	int i;
 
-	if (mds != NULL) {
-		object_list_size = mds->objects_list_count;
+	if (mds == NULL || mds->objects_list_count == 0) {
+		return NULL;
+	}
+
+	if (mds->handle_table == NULL) {
+		mds_build_handle_table(mds);
+	}
+
+	if (mds->handle_table == NULL) {
+		// no memory for the table, fall back to linear search
+		for (i = 0; i < mds->objects_list_count; ++i) {
+			if (mds->objects_list[i].obj_handle == obj_handle) {
+				return &(mds->objects_list[i]);
+			}
+		}
+
+		return NULL;
 	}
 
-	for (i = 0; i < object_list_size; ++i) {
-		if (mds->objects_list[i].obj_handle == obj_handle) {
-			return &(mds->objects_list[i]);
+	i = mds_handle_slot(mds, obj_handle);
+
+	while (mds->handle_table[i] != 0) {
+		struct MDS_object *object = &(mds->objects_list[mds->handle_table[i] - 1]);
+
+		if (object->obj_handle == obj_handle) {
+			return object;
 		}
+
+		i = (i + 1) & (mds->handle_table_size - 1);
 	}
 
 	return NULL;
@@ -950,17 +1462,27 @@ void mds_event_report_dynamic_data_update_var(Context *ctx, ScanReportInfoVar *i
 {
 	int info_size = info_var->obs_scan_var.count;
 	DataList *data_list = data_list_new(info_size);
+	ObservationList observations = {0, 0, NULL};
+	int wants_observations = manager_wants_observations();
 
-	if (data_list != NULL && info_size > 0) {
+	if (data_list != NULL) {
 		int i;
 
 		for (i = 0; i < info_size; ++i) {
 			dimutil_update_mds_from_obs_scan(ctx->mds,
 						&info_var->obs_scan_var.value[i],
 						&data_list->values[i]);
+
+			if (wants_observations) {
+				dimutil_add_obs_scan_observations(ctx->mds,
+						&info_var->obs_scan_var.value[i],
+						&observations);
+			}
 		}
 
 		manager_notify_evt_measurement_data_updated(ctx, data_list);
+		manager_notify_evt_observations_received(ctx, &observations);
+		observation_list_clear(&observations);
 	}
 }
 
@@ -985,15 +1507,25 @@ void mds_event_report_dynamic_data_update_fixed(Context *ctx, ScanReportInfoFixe
 
 	int info_size = info_fixed->obs_scan_fixed.count;
 	DataList *data_list = data_list_new(info_size);
+	ObservationList observations = {0, 0, NULL};
+	int wants_observations = manager_wants_observations();
 
-	if (data_list != NULL && info_size > 0) {
+	if (data_list != NULL) {
 		int i;
 
 		for (i = 0; i < info_size; ++i) {
 			dimutil_update_mds_from_obs_scan_fixed(ctx->mds, &info_fixed->obs_scan_fixed.value[i], &data_list->values[i]);
+
+			if (wants_observations) {
+				dimutil_add_obs_scan_fixed_observations(ctx->mds,
+						&info_fixed->obs_scan_fixed.value[i],
+						&observations);
+			}
 		}
 
 		manager_notify_evt_measurement_data_updated(ctx, data_list);
+		manager_notify_evt_observations_received(ctx, &observations);
+		observation_list_clear(&observations);
 	}
 }
 
@@ -1008,26 +1540,50 @@ void mds_event_report_dynamic_data_update_mp_var(Context *ctx,
 		ScanReportInfoMPVar *info_mp_var)
 {
 	int info_mp_list_size = info_mp_var->scan_per_var.count;
+	ObservationList observations = {0, 0, NULL};
+	int wants_observations = manager_wants_observations();
+	int entry_count = 0;
+	int k = 0;
 	int i;
 
+	// one list for all persons
+	for (i = 0; i < info_mp_list_size; ++i) {
+		entry_count += info_mp_var->scan_per_var.value[i].obs_scan_var.count;
+	}
+
+	DataList *data_list = data_list_new(entry_count);
+
 	for (i = 0; i < info_mp_list_size; ++i) {
 		int info_size = info_mp_var->scan_per_var.value[i].obs_scan_var.count;
-		DataList *data_list = data_list_new(info_size);
+		int first = observations.count;
 
-		if (data_list != NULL && info_size > 0) {
+		if (data_list != NULL) {
 			int j;
 
 			for (j = 0; j < info_size; ++j) {
-				data_meta_set_personal_id(&data_list->values[j],
+				DataEntry *entry = &data_list->values[k++];
+
+				data_meta_set_personal_id(entry,
 							  info_mp_var->scan_per_var.value[i].person_id);
 
 				dimutil_update_mds_from_obs_scan(ctx->mds, &info_mp_var->scan_per_var.value[i].obs_scan_var.value[j],
-								 &data_list->values[j]);
+								 entry);
+
+				if (wants_observations) {
+					dimutil_add_obs_scan_observations(ctx->mds,
+							&info_mp_var->scan_per_var.value[i].obs_scan_var.value[j],
+							&observations);
+				}
 			}
 
-			manager_notify_evt_measurement_data_updated(ctx, data_list);
+			dimutil_set_observations_person_id(&observations, first,
+							   info_mp_var->scan_per_var.value[i].person_id);
 		}
 	}
+
+	manager_notify_evt_measurement_data_updated(ctx, data_list);
+	manager_notify_evt_observations_received(ctx, &observations);
+	observation_list_clear(&observations);
 }
 
 /**
@@ -1041,27 +1597,51 @@ void mds_event_report_dynamic_data_update_mp_fixed(Context *ctx,
 		ScanReportInfoMPFixed *info_mp_fixed)
 {
 	int info_fixed_list_size = info_mp_fixed->scan_per_fixed.count;
+	ObservationList observations = {0, 0, NULL};
+	int wants_observations = manager_wants_observations();
+	int entry_count = 0;
+	int k = 0;
 	int i;
 
+	// one list for all persons
+	for (i = 0; i < info_fixed_list_size; ++i) {
+		entry_count += info_mp_fixed->scan_per_fixed.value[i].obs_scan_fix.count;
+	}
+
+	DataList *data_list = data_list_new(entry_count);
+
 	for (i = 0; i < info_fixed_list_size; ++i) {
 		int info_size = info_mp_fixed->scan_per_fixed.value[i].obs_scan_fix.count;
-		DataList *data_list = data_list_new(info_size);
+		int first = observations.count;
 
-		if (data_list != NULL && info_size > 0) {
+		if (data_list != NULL) {
 			int j;
 
 			for (j = 0; j < info_size; ++j) {
-				data_meta_set_personal_id(&data_list->values[j],
+				DataEntry *entry = &data_list->values[k++];
+
+				data_meta_set_personal_id(entry,
 							  info_mp_fixed->scan_per_fixed.value[i].person_id);
 
 				dimutil_update_mds_from_obs_scan_fixed(ctx->mds,
 								       &info_mp_fixed->scan_per_fixed.value[i].obs_scan_fix.value[j],
-								       &data_list->values[j]);
+								       entry);
+
+				if (wants_observations) {
+					dimutil_add_obs_scan_fixed_observations(ctx->mds,
+							&info_mp_fixed->scan_per_fixed.value[i].obs_scan_fix.value[j],
+							&observations);
+				}
 			}
 
-			manager_notify_evt_measurement_data_updated(ctx, data_list);
+			dimutil_set_observations_person_id(&observations, first,
+							   info_mp_fixed->scan_per_fixed.value[i].person_id);
 		}
 	}
+
+	manager_notify_evt_measurement_data_updated(ctx, data_list);
+	manager_notify_evt_observations_received(ctx, &observations);
+	observation_list_clear(&observations);
 }
 
 /**
@@ -1515,43 +2095,19 @@ void mds_destroy(MDS *mds)
 
 		if (mds->objects_list != NULL) {
 			for (i = 0; i < mds->objects_list_count; ++i) {
-				if (mds->objects_list[i].choice == MDS_OBJ_PMSTORE) {
-					pmstore_destroy(
-						&(mds->objects_list[i].u.pmstore));
-				} else if (mds->objects_list[i].choice == MDS_OBJ_METRIC) {
-
-					switch (mds->objects_list[i].u.metric.choice) {
-					case METRIC_NUMERIC:
-						numeric_destroy(&(mds->objects_list[i].u.metric.u.numeric));
-						break;
-					case METRIC_ENUM:
-						enumeration_destroy(&(mds->objects_list[i].u.metric.u.enumeration));
-						break;
-					case METRIC_RTSA:
-						rtsa_destroy(&(mds->objects_list[i].u.metric.u.rtsa));
-						break;
-					default:
-						break;
-					}
-
-				} else if (mds->objects_list[i].choice == MDS_OBJ_SCANNER) {
-					switch (mds->objects_list[i].u.scanner.choice) {
-					case EPI_CFG_SCANNER:
-						epi_cfg_scanner_destroy(&(mds->objects_list[i].u.scanner.u.epi_cfg_scanner));
-						break;
-					case PERI_CFG_SCANNER:
-						peri_cfg_scanner_destroy(&(mds->objects_list[i].u.scanner.u.peri_cfg_scanner));
-						break;
-					default:
-						break;
-					}
-				}
+				mds_destroy_object(&(mds->objects_list[i]));
 			}
 
 			free(mds->objects_list);
 			mds->objects_list = NULL;
 		}
 
+		free(mds->handle_table);
+		mds->handle_table = NULL;
+
+		mds_template_release(mds->config_template);
+		mds->config_template = NULL;
+
 		del_octet_string(&mds->system_id);
 		del_productionspec(&mds->production_specification);
 		del_systemmodel(&mds->system_model);
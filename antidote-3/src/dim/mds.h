@@ -280,6 +280,28 @@ typedef struct MDS {
  	 */
 	int objects_list_count;
 
+	/**
+	 * Allocated size of objects_list
+ 	 */
+	int objects_list_capacity;
+
+	/**
+	 * Index of objects_list by handle (open addressing); each slot
+	 * holds an object position + 1, or 0 if free. NULL until built.
+ 	 */
+	int *handle_table;
+
+	/**
+	 * Number of slots of handle_table, a power of two
+ 	 */
+	int handle_table_size;
+
+	/**
+	 * Template whose objects lend their static attributes to
+	 * objects_list, NULL if objects are fully private
+	 */
+	struct MDSTemplate *config_template;
+
 	/**
 	 * Count of PM-Store objects among children
  	 */
@@ -350,6 +372,43 @@ struct MDS_object {
 	} u;
 };
 
+/**
+ * Metric objects of a configuration, built once and shared by every
+ * MDS configured with it. Immutable while referenced.
+ */
+typedef struct MDSTemplate {
+	/**
+	 * Configuration id
+	 */
+	ConfigId config_id;
+
+	/**
+	 * Agent System-Id for extended configurations, empty for
+	 * standard ones
+	 */
+	octet_string system_id;
+
+	/**
+	 * Metric objects, in configuration order
+	 */
+	struct MDS_object *objects;
+
+	/**
+	 * Number of objects
+	 */
+	int objects_count;
+
+	/**
+	 * MDS instances using the template, plus one while cached
+	 */
+	int refcount;
+
+	/**
+	 * Next cached template
+	 */
+	struct MDSTemplate *next;
+} MDSTemplate;
+
 /**
  * MDS data offered by agent application
  */
@@ -400,6 +459,21 @@ Request *mds_get_pmstore(Context *ctx, int handle, service_request_callback requ
 
 void mds_configure_operating(Context *ctx, ConfigObjectList *config_obj_list, int manager);
 
+void mds_configure_operating_shared(Context *ctx, ConfigObjectList *config_obj_list,
+				    int manager);
+
+MDSTemplate *mds_template_acquire(ConfigId config_id, octet_string *system_id,
+				  ConfigObjectList *config_obj_list);
+
+void mds_template_release(MDSTemplate *config_template);
+
+void mds_template_invalidate(ConfigId config_id, octet_string *system_id);
+
+void mds_share_metric_object(struct MDS_object *object,
+			     struct MDS_object *shared);
+
+void mds_destroy_object(struct MDS_object *object);
+
 void mds_populate_attributes(MDS *mds, DataEntry *mds_entry);
 
 DataList *mds_populate_configuration(MDS *mds);
@@ -29,6 +29,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include "metric.h"
 #include "nomenclature.h"
 #include "src/communication/parser/struct_cleaner.h"
@@ -62,6 +63,63 @@ struct Metric *metric_instance()
 	return metric;
 }
 
+/**
+ * Copies an array borrowed from a configuration template.
+ *
+ * \param value the array, may be NULL.
+ * \param size size of the array in bytes.
+ *
+ * \return a private copy, NULL if value is NULL.
+ */
+static void *metric_copy_shared(const void *value, size_t size)
+{
+	void *copy = NULL;
+
+	if (value != NULL) {
+		copy = malloc(size);
+
+		if (copy != NULL) {
+			memcpy(copy, value, size);
+		}
+	}
+
+	return copy;
+}
+
+/**
+ * Gives the Metric private copies of the static attributes it
+ * borrows from a configuration template, so they can be changed or
+ * freed. Does nothing if the Metric does not borrow them.
+ *
+ * \param metric the Metric.
+ */
+void metric_unshare(struct Metric *metric)
+{
+	if (metric == NULL || !metric->shared_config) {
+		return;
+	}
+
+	metric->supplemental_types.value = metric_copy_shared(
+			metric->supplemental_types.value,
+			metric->supplemental_types.count * sizeof(TYPE));
+	metric->metric_id_list.value = metric_copy_shared(
+			metric->metric_id_list.value,
+			metric->metric_id_list.count * sizeof(OID_Type));
+	metric->attribute_value_map.value = metric_copy_shared(
+			metric->attribute_value_map.value,
+			metric->attribute_value_map.count * sizeof(AttrValMapEntry));
+	metric->label_string.value = metric_copy_shared(
+			metric->label_string.value,
+			metric->label_string.length);
+	metric->unit_label_string.value = metric_copy_shared(
+			metric->unit_label_string.value,
+			metric->unit_label_string.length);
+
+	// compiled again on demand
+	metric->decode_plan = NULL;
+	metric->shared_config = 0;
+}
+
 /**
  * Deallocates a pointer to a Metric struct.
  *
@@ -70,6 +128,17 @@ struct Metric *metric_instance()
 void metric_destroy(struct Metric *metric)
 {
 	if (metric != NULL) {
+		if (metric->shared_config) {
+			// owned by the configuration template
+			memset(&metric->supplemental_types, 0, sizeof(SupplementalTypeList));
+			memset(&metric->metric_id_list, 0, sizeof(MetricIdList));
+			memset(&metric->attribute_value_map, 0, sizeof(AttrValMap));
+			memset(&metric->label_string, 0, sizeof(octet_string));
+			memset(&metric->unit_label_string, 0, sizeof(octet_string));
+			metric->decode_plan = NULL;
+			metric->shared_config = 0;
+		}
+
 		del_type(&metric->type);
 		del_supplementaltypelist(&metric->supplemental_types);
 		del_metricspecsmall(&metric->metric_spec_small);
@@ -80,6 +149,8 @@ void metric_destroy(struct Metric *metric)
 		del_octet_string(&metric->unit_label_string);
 		del_absolutetime(&metric->absolute_time_stamp);
 		del_highresrelativetime(&metric->hi_res_time_stamp);
+		free(metric->decode_plan);
+		metric->decode_plan = NULL;
 	}
 }
 
@@ -205,10 +205,26 @@ struct Metric {
 	 * Indicates that the metric_id_partition attribute is being used
 	 */
 	int use_metric_id_partition_field;
+
+	/**
+	 * Decode plan compiled from attribute_value_map, NULL until
+	 * compiled (see dimutil_compile_decode_plan())
+	 */
+	struct DimDecodePlan *decode_plan;
+
+	/**
+	 * Indicates that supplemental_types, metric_id_list,
+	 * attribute_value_map, label_string, unit_label_string and
+	 * decode_plan are borrowed from a shared configuration template
+	 * (see metric_unshare())
+	 */
+	int shared_config;
 };
 
 struct Metric *metric_instance();
 
+void metric_unshare(struct Metric *metric);
+
 void metric_destroy(struct Metric *metric);
 
 int metric_get_nomenclature_code();
@@ -118,18 +118,27 @@ void peri_cfg_scanner_event_report_buf_scan_report_var(Context *ctx,
 		ScanReportInfoVar *report_info)
 {
 	int info_size = report_info->obs_scan_var.count;
+	DataList *data_list = data_list_new(info_size);
+	ObservationList observations = {0, 0, NULL};
+	int wants_observations = manager_wants_observations();
 
 	int i;
 
 	for (i = 0; i < info_size; ++i) {
-		DataList *data_list = data_list_new(1);
-
 		if (data_list != NULL) {
 			dimutil_update_mds_from_obs_scan(ctx->mds, &report_info->obs_scan_var.value[i],
-							 &data_list->values[0]);
-			manager_notify_evt_measurement_data_updated(ctx, data_list);
+							 &data_list->values[i]);
+		}
+
+		if (wants_observations) {
+			dimutil_add_obs_scan_observations(ctx->mds, &report_info->obs_scan_var.value[i],
+							  &observations);
 		}
 	}
+
+	manager_notify_evt_measurement_data_updated(ctx, data_list);
+	manager_notify_evt_observations_received(ctx, &observations);
+	observation_list_clear(&observations);
 }
 
 /**
@@ -145,17 +154,26 @@ void peri_cfg_scanner_event_report_buf_scan_report_fixed(Context *ctx,
 		ScanReportInfoFixed *report_info)
 {
 	int info_size = report_info->obs_scan_fixed.count;
+	DataList *data_list = data_list_new(info_size);
+	ObservationList observations = {0, 0, NULL};
+	int wants_observations = manager_wants_observations();
 
 	int i;
 
 	for (i = 0; i < info_size; ++i) {
-		DataList *data_list = data_list_new(1);
-
 		if (data_list != NULL) {
-			dimutil_update_mds_from_obs_scan_fixed(ctx->mds, &report_info->obs_scan_fixed.value[i], &data_list->values[0]);
-			manager_notify_evt_measurement_data_updated(ctx, data_list);
+			dimutil_update_mds_from_obs_scan_fixed(ctx->mds, &report_info->obs_scan_fixed.value[i], &data_list->values[i]);
+		}
+
+		if (wants_observations) {
+			dimutil_add_obs_scan_fixed_observations(ctx->mds, &report_info->obs_scan_fixed.value[i],
+								&observations);
 		}
 	}
+
+	manager_notify_evt_measurement_data_updated(ctx, data_list);
+	manager_notify_evt_observations_received(ctx, &observations);
+	observation_list_clear(&observations);
 }
 
 /**
@@ -173,6 +191,11 @@ void peri_cfg_scanner_event_report_buf_scan_report_grouped(Context *ctx,
 		ScanReportInfoGrouped *report_info)
 {
 	HandleAttrValMap *attr_map = &self->scanner.scanner.scan_handle_attr_val_map;
+	DataList *data_list = data_list_new(report_info->obs_scan_grouped.count *
+					    attr_map->count);
+	ObservationList observations = {0, 0, NULL};
+	int wants_observations = manager_wants_observations();
+	int k = 0;
 
 	int i;
 
@@ -183,16 +206,22 @@ void peri_cfg_scanner_event_report_buf_scan_report_grouped(Context *ctx,
 		int j;
 
 		for (j = 0; j < attr_map->count; j++) {
-			DataList *data_list = data_list_new(1);
-
 			if (data_list != NULL) {
-				dimutil_update_mds_from_grouped_observations(ctx->mds, stream, &attr_map->value[j], &data_list->values[0]);
-				manager_notify_evt_measurement_data_updated(ctx, data_list);
+				dimutil_update_mds_from_grouped_observations(ctx->mds, stream, &attr_map->value[j], &data_list->values[k++]);
+
+				if (wants_observations) {
+					dimutil_add_grouped_observations(ctx->mds, &attr_map->value[j],
+									 &observations);
+				}
 			}
 		}
 
 		free(stream);
 	}
+
+	manager_notify_evt_measurement_data_updated(ctx, data_list);
+	manager_notify_evt_observations_received(ctx, &observations);
+	observation_list_clear(&observations);
 }
 
 /**
@@ -208,27 +237,50 @@ void peri_cfg_scanner_event_report_buf_scan_report_mp_var(Context *ctx,
 		ScanReportInfoMPVar *report_info)
 {
 	int info_mp_list_size = report_info->scan_per_var.count;
+	ObservationList observations = {0, 0, NULL};
+	int wants_observations = manager_wants_observations();
+	int entry_count = 0;
+	int k = 0;
 	int i;
 
+	for (i = 0; i < info_mp_list_size; ++i) {
+		entry_count += report_info->scan_per_var.value[i].obs_scan_var.count;
+	}
+
+	DataList *data_list = data_list_new(entry_count);
+
 	for (i = 0; i < info_mp_list_size; ++i) {
 		int info_size = report_info->scan_per_var.value[i].obs_scan_var.count;
+		int first = observations.count;
 
 		int j;
 
 		for (j = 0; j < info_size; ++j) {
-			DataList *data_list = data_list_new(1);
-
 			if (data_list != NULL) {
-				data_meta_set_personal_id(&data_list->values[0],
+				DataEntry *entry = &data_list->values[k++];
+
+				data_meta_set_personal_id(entry,
 							  report_info->scan_per_var.value[i].person_id);
 
 				dimutil_update_mds_from_obs_scan(ctx->mds,
 								 &report_info->scan_per_var.value[i].obs_scan_var.value[j],
-								 &data_list->values[0]);
-				manager_notify_evt_measurement_data_updated(ctx, data_list);
+								 entry);
+
+				if (wants_observations) {
+					dimutil_add_obs_scan_observations(ctx->mds,
+							&report_info->scan_per_var.value[i].obs_scan_var.value[j],
+							&observations);
+				}
 			}
 		}
+
+		dimutil_set_observations_person_id(&observations, first,
+						   report_info->scan_per_var.value[i].person_id);
 	}
+
+	manager_notify_evt_measurement_data_updated(ctx, data_list);
+	manager_notify_evt_observations_received(ctx, &observations);
+	observation_list_clear(&observations);
 }
 
 /**
@@ -245,27 +297,50 @@ void peri_cfg_scanner_event_report_buf_scan_report_mp_fixed(Context *ctx,
 {
 
 	int info_fixed_list_size = report_info->scan_per_fixed.count;
+	ObservationList observations = {0, 0, NULL};
+	int wants_observations = manager_wants_observations();
+	int entry_count = 0;
+	int k = 0;
 	int i;
 
+	for (i = 0; i < info_fixed_list_size; ++i) {
+		entry_count += report_info->scan_per_fixed.value[i].obs_scan_fix.count;
+	}
+
+	DataList *data_list = data_list_new(entry_count);
+
 	for (i = 0; i < info_fixed_list_size; ++i) {
 		int info_size = report_info->scan_per_fixed.value[i].obs_scan_fix.count;
+		int first = observations.count;
 
 		int j;
 
 		for (j = 0; j < info_size; ++j) {
-			DataList *data_list = data_list_new(1);
-
 			if (data_list != NULL) {
-				data_meta_set_personal_id(&data_list->values[0],
+				DataEntry *entry = &data_list->values[k++];
+
+				data_meta_set_personal_id(entry,
 							  report_info->scan_per_fixed.value[i].person_id);
 
 				dimutil_update_mds_from_obs_scan_fixed(ctx->mds,
 								       &report_info->scan_per_fixed.value[i].obs_scan_fix.value[j],
-								       &data_list->values[0]);
-				manager_notify_evt_measurement_data_updated(ctx, data_list);
+								       entry);
+
+				if (wants_observations) {
+					dimutil_add_obs_scan_fixed_observations(ctx->mds,
+							&report_info->scan_per_fixed.value[i].obs_scan_fix.value[j],
+							&observations);
+				}
 			}
 		}
+
+		dimutil_set_observations_person_id(&observations, first,
+						   report_info->scan_per_fixed.value[i].person_id);
 	}
+
+	manager_notify_evt_measurement_data_updated(ctx, data_list);
+	manager_notify_evt_observations_received(ctx, &observations);
+	observation_list_clear(&observations);
 }
 
 /**
@@ -282,28 +357,43 @@ void peri_cfg_scanner_event_report_buf_scan_report_mp_grouped(Context *ctx,
 {
 	HandleAttrValMap *attr_map = &self->scanner.scanner.scan_handle_attr_val_map;
 	int info_grouped_list_size = report_info->scan_per_grouped.count;
+	DataList *data_list = data_list_new(info_grouped_list_size * attr_map->count);
+	ObservationList observations = {0, 0, NULL};
+	int wants_observations = manager_wants_observations();
+	int k = 0;
 	int i;
 
 	for (i = 0; i < info_grouped_list_size; ++i) {
 		ObservationScanGrouped *data = &report_info->scan_per_grouped.value[i].obs_scan_grouped;
 		ByteStreamReader *stream = byte_stream_reader_instance(data->value, data->length);
+		int first = observations.count;
 
 		int j;
 
 		for (j = 0; j < attr_map->count; j++) {
-			DataList *data_list = data_list_new(attr_map->count);
-
 			if (data_list != NULL) {
-				data_meta_set_personal_id(&data_list->values[0],
+				DataEntry *entry = &data_list->values[k++];
+
+				data_meta_set_personal_id(entry,
 							  report_info->scan_per_grouped.value[i].person_id);
 
-				dimutil_update_mds_from_grouped_observations(ctx->mds, stream, &attr_map->value[j], &data_list->values[0]);
-				manager_notify_evt_measurement_data_updated(ctx, data_list);
+				dimutil_update_mds_from_grouped_observations(ctx->mds, stream, &attr_map->value[j], entry);
+
+				if (wants_observations) {
+					dimutil_add_grouped_observations(ctx->mds, &attr_map->value[j],
+									 &observations);
+				}
 			}
 		}
 
+		dimutil_set_observations_person_id(&observations, first,
+						   report_info->scan_per_grouped.value[i].person_id);
 		free(stream);
 	}
+
+	manager_notify_evt_measurement_data_updated(ctx, data_list);
+	manager_notify_evt_observations_received(ctx, &observations);
+	observation_list_clear(&observations);
 }
 
 /**
@@ -67,8 +67,6 @@ struct PMSegment *pmsegment_instance(InstNumber instance_number)
 
 	segment->instance_number = instance_number;
 	segment->dim.id = pmsegment_get_nomenclature_code();
-	segment->fixed_segment_data.value = NULL;
-	segment->fixed_segment_data.length = 0;
 	segment->segment_usage_count = 0;
 	segment->empiric_usage_count = 0;
 	return segment;
@@ -82,11 +80,10 @@ struct PMSegment *pmsegment_instance(InstNumber instance_number)
  */
 void pmsegment_remove_all_entries(struct PMSegment *pm_segment)
 {
-	if (pm_segment->fixed_segment_data.value != NULL) {
+	if (pm_segment->fixed_segment_data.first != NULL) {
 		pm_segment->segment_usage_count = 0;
 		pm_segment->empiric_usage_count = 0;
-		free(pm_segment->fixed_segment_data.value);
-		pm_segment->fixed_segment_data.value = NULL;
+		chunkbuff_clear(&pm_segment->fixed_segment_data);
 	}
 }
 
@@ -112,7 +109,7 @@ void pmsegment_destroy(struct PMSegment *pm_segment)
 		del_octet_string(&pm_segment->segment_label);
 		del_absolutetimeadjust(&pm_segment->date_and_time_adjustment);
 		del_segmentstatistics(&pm_segment->segment_statistics);
-		del_octet_string(&pm_segment->fixed_segment_data);
+		chunkbuff_clear(&pm_segment->fixed_segment_data);
 	}
 }
 
@@ -35,6 +35,7 @@
 #include "asn1/phd_types.h"
 #include "nomenclature.h"
 #include "dim.h"
+#include "src/util/chunkbuff.h"
 
 /**
  * \brief An instance of the PM-segment class represents a
@@ -150,6 +151,13 @@ struct PMSegment {
 	 */
 	intu32 empiric_usage_count;
 
+	/**
+	 * Number of entries already delivered to the application
+	 * when segment data is streamed in batches.
+	 *
+	 */
+	intu32 delivered_count;
+
 	/**
 	 * This attribute defines the array for reporting minimum,
 	 * mean, maximum statistics for each element to be tagged.
@@ -162,12 +170,13 @@ struct PMSegment {
 	/**
 	 * This attribute defines the segment data transferred as an
 	 * array of entries in a format as specified in the PM-Segment-Entry-Map
-	 * attribute.
+	 * attribute. Data is kept in chunks as it arrives in
+	 * Segment Data Events.
 	 *
 	 * Qualifier: Mandatory
 	 *
 	 */
-	octet_string fixed_segment_data;
+	ChunkBuffer fixed_segment_data;
 
 	/**
 	 * This informational timeout attribute defines the minimum
@@ -32,6 +32,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "pmstore.h"
 #include "pmstore_req.h"
 #include "src/api/api_definitions.h"
@@ -79,6 +81,101 @@
  */
 // static const intu32 PM_STORE_TO_CONFIRM_SET = 3;
 
+/**
+ * Maximum number of entries delivered in one batch when
+ * segment data is streamed
+ */
+#define PMSTORE_SEGMENT_BATCH_SIZE 256
+
+/**
+ * Minimum number of entries given to each thread when a
+ * segment is decoded in parallel
+ */
+#define PMSTORE_PARALLEL_MIN_ENTRIES 1024
+
+/**
+ * Maximum number of threads decoding one segment, including
+ * the calling thread
+ */
+#define PMSTORE_PARALLEL_MAX_WORKERS 16
+
+/**
+ * Range of segment entries decoded by one thread
+ */
+typedef struct PMStoreDecodeTask {
+	/**
+	 * Next task waiting in decode pool queue
+	 */
+	struct PMStoreDecodeTask *next;
+
+	/**
+	 * Whether range was decoded, protected by decode_pool_mutex
+	 */
+	int finished;
+
+	/**
+	 * The segment
+	 */
+	struct PMSegment *segment;
+
+	/**
+	 * Private copies of the metric objects in entry map,
+	 * NULL where the handle has no metric object
+	 */
+	struct MDS_object **objects;
+
+	/**
+	 * Position of first entry in segment data
+	 */
+	ChunkBufferCursor cursor;
+
+	/**
+	 * Preallocated slots for the decoded entries
+	 */
+	DataEntry *entries;
+
+	/**
+	 * Number of entries in range
+	 */
+	int count;
+
+	/**
+	 * Number of entries properly decoded
+	 */
+	int decoded;
+} PMStoreDecodeTask;
+
+/**
+ * Starts decode pool only once
+ */
+static pthread_once_t decode_pool_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Number of decode pool threads, fixed when pool starts
+ */
+static int decode_pool_size = 0;
+
+/**
+ * Protects decode pool queue and task completion
+ */
+static pthread_mutex_t decode_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Signals that tasks were queued
+ */
+static pthread_cond_t decode_pool_work = PTHREAD_COND_INITIALIZER;
+
+/**
+ * Signals that a task was finished
+ */
+static pthread_cond_t decode_pool_done = PTHREAD_COND_INITIALIZER;
+
+/**
+ * Queue of tasks waiting for a decode pool thread
+ */
+static PMStoreDecodeTask *decode_pool_head = NULL;
+static PMStoreDecodeTask *decode_pool_tail = NULL;
+
 static int pmstore_fill_segment_attr(struct PMSegment *pm_segment,
 					OID_Type attr_id,
 					ByteStreamReader *stream);
@@ -91,6 +188,10 @@ static void decode_fixed_segment_data(Context *ctx, struct PMStore *pmstore,
 					struct PMSegment *pmsegment,
 					int last);
 
+static int stream_fixed_segment_data(Context *ctx, struct PMStore *pmstore,
+					struct PMSegment *pmsegment,
+					int last);
+
 /**
  * Returns one instance of the PMStore structure.
  * The attributes must be defined through direct assignments, including
@@ -645,9 +746,8 @@ int pmstore_segment_data_event(Context *ctx, struct PMStore *pm_store,
 
 	if (first) {
 		pmsegment->empiric_usage_count = 0;
-		free(pmsegment->fixed_segment_data.value);
-		pmsegment->fixed_segment_data.value = NULL;
-		pmsegment->fixed_segment_data.length = 0;
+		pmsegment->delivered_count = 0;
+		chunkbuff_clear(&pmsegment->fixed_segment_data);
 	}
 
 	// It is correct to expect segments to come in order
@@ -657,18 +757,19 @@ int pmstore_segment_data_event(Context *ctx, struct PMStore *pm_store,
 		return 0;
 	}
 
+	if (!chunkbuff_append(&pmsegment->fixed_segment_data,
+			      event.segm_data_event_entries.value,
+			      event.segm_data_event_entries.length)) {
+		DEBUG("PM-Segment data event: cannot store segment part");
+		return 0;
+	}
+
 	pmsegment->empiric_usage_count = event.segm_data_event_descr.segm_evt_entry_index +
 					event.segm_data_event_descr.segm_evt_entry_count;
 
-	int offset = pmsegment->fixed_segment_data.length;
-	pmsegment->fixed_segment_data.length += event.segm_data_event_entries.length;
-
-	pmsegment->fixed_segment_data.value = realloc(pmsegment->fixed_segment_data.value,
-		  				      pmsegment->fixed_segment_data.length);
-
-	memcpy(&(pmsegment->fixed_segment_data.value[offset]),
-	       	event.segm_data_event_entries.value,
-		event.segm_data_event_entries.length);
+	if (manager_wants_segment_data_batches()) {
+		return stream_fixed_segment_data(ctx, pm_store, pmsegment, last);
+	}
 
 	if (last) {
 		DEBUG("Decoding PM-Segment data...");
@@ -1063,15 +1164,50 @@ int pmstore_set_attribute(struct PMStore *pmstore, OID_Type attr_id, ByteStreamR
 }
 
 /**
- * Scan a segment of index segment_index, decode segment data and generate xml
+ * Computes the size of a segment entry from the entry map
+ *
+ * \param entry_map the PM-segment entry map.
+ *
+ * \return entry size in bytes
+ */
+static intu32 pmstore_segment_entry_size(PmSegmentEntryMap *entry_map)
+{
+	intu32 size = 0;
+	int j;
+	int k;
+
+	if (entry_map->segm_entry_header & SEG_ELEM_HDR_ABSOLUTE_TIME)
+		size += 8;
+	if (entry_map->segm_entry_header & SEG_ELEM_HDR_RELATIVE_TIME)
+		size += 4;
+	if (entry_map->segm_entry_header & SEG_ELEM_HDR_HIRES_RELATIVE_TIME)
+		size += 8;
+
+	for (j = 0; j < entry_map->segm_entry_elem_list.count; ++j) {
+		AttrValMap *val_map = &entry_map->segm_entry_elem_list.value[j].attr_val_map;
+
+		for (k = 0; k < val_map->count; ++k) {
+			size += val_map->value[k].attribute_len;
+		}
+	}
+
+	return size;
+}
+
+/**
+ * Decodes one segment entry
  *
- * \param pmstore the PMStore.
  * \param segment the PMSegment
- * \param segm_data_entry output parameter to describe data value.
+ * \param objects the metric objects of entry map elements, which
+ *        receive the decoded values.
+ * \param stream the entry data.
+ * \param data_entry output parameter to describe entry.
+ *
+ * \return \b 1 if entry is properly decoded, \b 0 otherwise.
  */
-static void pmstore_populate_all_attributes(struct MDS *mds, struct PMStore *pmstore,
-						struct PMSegment *segment, 
-						DataEntry *segm_data_entry)
+static int pmstore_populate_entry(struct PMSegment *segment,
+				  struct MDS_object **objects,
+				  ByteStreamReader *stream, DataEntry *data_entry)
 {
 	int error = 0;
 
@@ -1079,221 +1215,563 @@ static void pmstore_populate_all_attributes(struct MDS *mds, struct PMStore *pms
 	RelativeTime rel_time; // length 4
 	HighResRelativeTime hires_rel_time;	// 8
 
-	int entry_count = segment->empiric_usage_count;
+	data_entry->choice = COMPOUND_DATA_ENTRY;
+	data_entry->u.compound.name = data_strcp("Segment-Entry");
+	data_entry->u.compound.entries_count = 2;
+	data_entry->u.compound.entries = calloc(2, sizeof(DataEntry));
 
-	segm_data_entry->choice = COMPOUND_DATA_ENTRY;
-	segm_data_entry->u.compound.name = data_strcp("PM-Segment");
-	segm_data_entry->u.compound.entries_count = entry_count;
-	segm_data_entry->u.compound.entries = calloc(entry_count, sizeof(DataEntry));
+	int hdr_abs_time = segment->pm_segment_entry_map.segm_entry_header &
+				SEG_ELEM_HDR_ABSOLUTE_TIME;
+	int hdr_rel_time = segment->pm_segment_entry_map.segm_entry_header &
+				SEG_ELEM_HDR_RELATIVE_TIME;
+	int hdr_hirel_time = segment->pm_segment_entry_map.segm_entry_header &
+				SEG_ELEM_HDR_HIRES_RELATIVE_TIME;
+	int k = 0;
+	int n = 0;
 
-	ByteStreamReader *stream = byte_stream_reader_instance(segment->fixed_segment_data.value,
-							       segment->fixed_segment_data.length);
-	//  stream length double-checked at the end of every iteration
-	int offset = 0;
+	if ((hdr_abs_time + hdr_rel_time + hdr_hirel_time) !=
+			segment->pm_segment_entry_map.segm_entry_header) {
+		// Unknown bit in header, we can't determine
+		// header's length
+		DEBUG("Bad PM-Segment data: unknown header bit in %x",
+			segment->pm_segment_entry_map.segm_entry_header);
+		return 0;
+	}
 
-	int i;
+	if (hdr_abs_time)
+		++n;
+	if (hdr_rel_time)
+		++n;
+	if (hdr_hirel_time)
+		++n;
 
-	for (i = 0; i < entry_count; ++i) {
-		DataEntry *data_entry = &segm_data_entry->u.compound.entries[i];
-		data_entry->choice = COMPOUND_DATA_ENTRY;
-		data_entry->u.compound.name = data_strcp("Segment-Entry");
-		data_entry->u.compound.entries_count = 2;
-		data_entry->u.compound.entries = calloc(2, sizeof(DataEntry));
-
-		int hdr_abs_time = segment->pm_segment_entry_map.segm_entry_header &
-					SEG_ELEM_HDR_ABSOLUTE_TIME;
-		int hdr_rel_time = segment->pm_segment_entry_map.segm_entry_header &
-					SEG_ELEM_HDR_RELATIVE_TIME;
-		int hdr_hirel_time = segment->pm_segment_entry_map.segm_entry_header &
-					SEG_ELEM_HDR_HIRES_RELATIVE_TIME;
-		int k = 0;
-		int n = 0;
-
-		if ((hdr_abs_time + hdr_rel_time + hdr_hirel_time) !=
-				segment->pm_segment_entry_map.segm_entry_header) {
-			// Unknown bit in header, we can't determine
-			// header's length
-			DEBUG("Bad PM-Segment data: unknown header bit in %x",
-				segment->pm_segment_entry_map.segm_entry_header);
-			segm_data_entry->u.compound.entries_count = i;
+	DataEntry *header_data_entry = &data_entry->u.compound.entries[0];
+	header_data_entry->choice = COMPOUND_DATA_ENTRY;
+	header_data_entry->u.compound.name = data_strcp("Segm-Entry-Header");
+	header_data_entry->u.compound.entries_count = n;
+	header_data_entry->u.compound.entries = calloc(n, sizeof(DataEntry));
+
+	DataEntry *header_item;
+
+	if (hdr_abs_time) {
+		decode_absolutetime(stream, &abs_time, &error);
+		if (error) {
+			DEBUG("Bad PM-Segment data: absolute time");
+			return 0;
+		}
+ 		header_item = &header_data_entry->u.compound.entries[k++];
+		data_set_absolute_time(header_item, "Segment-Absolute-Time", &abs_time);
+	}
+
+	if (hdr_rel_time) {
+		rel_time = read_intu32(stream, &error);
+		if (error) {
+			DEBUG("Bad PM-Segment data: reltime");
+			return 0;
+		}
+ 		header_item = &header_data_entry->u.compound.entries[k++];
+		data_set_intu32(header_item, "Segment-Relative-Time", &rel_time);
+	}
+
+	if (hdr_hirel_time) {
+		decode_highresrelativetime(stream, &hires_rel_time, &error);
+		if (error) {
+			DEBUG("Bad PM-Segment data: highresreltime");
+			return 0;
+		}
+ 		header_item = &header_data_entry->u.compound.entries[k++];
+		data_set_high_res_relative_time(header_item, "Segment-Hires-Relative-Time",
+						&hires_rel_time);
+	}
+
+	PmSegmentEntryMap entry_map;
+	entry_map = segment->pm_segment_entry_map;
+	int info_size = entry_map.segm_entry_elem_list.count;
+
+	struct Metric_object *metric_obj = NULL;
+
+	DataEntry *objs_data_entry = &data_entry->u.compound.entries[1];
+	objs_data_entry->choice = COMPOUND_DATA_ENTRY;
+	objs_data_entry->u.compound.name = data_strcp("Segm-Entry-Elem-List");
+	objs_data_entry->u.compound.entries_count = info_size;
+	objs_data_entry->u.compound.entries = calloc(info_size, sizeof(DataEntry));
+
+	int j;
+	int ok = 1;
+
+	for (j = 0; j < info_size; ++j) {
+		ASN1_HANDLE handle = entry_map.segm_entry_elem_list.value[j].handle;
+		AttrValMap val_map = entry_map.segm_entry_elem_list.value[j].attr_val_map;
+		int attr_count = val_map.count;
+
+		if (!objects[j]) {
+			ok = 0;
 			break;
 		}
 
-		if (hdr_abs_time)
-			++n;
-		if (hdr_rel_time)
-			++n;
-		if (hdr_hirel_time)
-			++n;
+		metric_obj = &(objects[j]->u.metric);
 
-		DataEntry *header_data_entry = &data_entry->u.compound.entries[0];
-		header_data_entry->choice = COMPOUND_DATA_ENTRY;
-		header_data_entry->u.compound.name = data_strcp("Segm-Entry-Header");
-		header_data_entry->u.compound.entries_count = n;
-		header_data_entry->u.compound.entries = calloc(n, sizeof(DataEntry));
+		DataEntry *obj_data_entry = &objs_data_entry->u.compound.entries[j];
+		obj_data_entry->choice = COMPOUND_DATA_ENTRY;
+		obj_data_entry->u.compound.entries_count = attr_count;
+		obj_data_entry->u.compound.entries = calloc(attr_count, sizeof(DataEntry));
+		data_meta_set_handle(obj_data_entry, handle);
 
-		DataEntry *header_item;
+		if (metric_obj->choice == METRIC_NUMERIC) {
+			obj_data_entry->u.compound.name = data_strcp("Numeric");
+		} else if (metric_obj->choice == METRIC_ENUM) {
+			obj_data_entry->u.compound.name = data_strcp("Enumeration");
+		} else {
+			obj_data_entry->u.compound.name = data_strcp("RT-SA");
+		}
 
-		if (hdr_abs_time) {
-			offset += 8;
-			decode_absolutetime(stream, &abs_time, &error);
-			if (error) {
-				DEBUG("Bad PM-Segment data: absolute time");
-				segm_data_entry->u.compound.entries_count = i;
-				break;
+		int k;
+		struct Metric *metric = NULL;
+
+		for (k = 0; k < attr_count; ++k) {
+			DataEntry *entry = &obj_data_entry->u.compound.entries[k];
+
+			int len = val_map.value[k].attribute_len;
+
+			switch (metric_obj->choice) {
+			case METRIC_NUMERIC: {
+				metric = &metric_obj->u.numeric.metric;
+				dimutil_fill_numeric_attr(&(metric_obj->u.numeric),
+							  val_map.value[k].attribute_id,
+							  stream, entry);
 			}
- 			header_item = &header_data_entry->u.compound.entries[k++];
-			data_set_absolute_time(header_item, "Segment-Absolute-Time", &abs_time);
-		}
+			break;
+			case METRIC_ENUM: {
+				metric = &metric_obj->u.enumeration.metric;
+				int err = dimutil_fill_enumeration_attr(
+							&(metric_obj->u.enumeration),
+							val_map.value[k].attribute_id,
+							stream, entry);
 
-		if (hdr_rel_time) {
-			offset += 4;
-			rel_time = read_intu32(stream, &error);
-			if (error) {
-				DEBUG("Bad PM-Segment data: reltime");
-				segm_data_entry->u.compound.entries_count = i;
-				break;
+				if (err == 0) {
+					ERROR("PM-Store Metric enum");
+					ok = 0;
+				}
+			}
+			break;
+			case METRIC_RTSA: {
+				metric = &metric_obj->u.rtsa.metric;
+				dimutil_fill_rtsa_attr(&(metric_obj->u.rtsa),
+						       val_map.value[k].attribute_id,
+						       stream, entry);
+			}
+			break;
+			default: {
+				// unknown type
+				DEBUG("segment data: jumping %d", metric_obj->choice);
+				while (--len >= 0) {
+					int error = 0;
+					read_intu8(stream, &error);
+				}
+			}
 			}
- 			header_item = &header_data_entry->u.compound.entries[k++];
-			data_set_intu32(header_item, "Segment-Relative-Time", &rel_time);
 		}
 
-		if (hdr_hirel_time) {
-			offset += 8;
-			decode_highresrelativetime(stream, &hires_rel_time, &error);
-			if (error) {
-				DEBUG("Bad PM-Segment data: highresreltime");
-				segm_data_entry->u.compound.entries_count = i;
-				break;
-			}
- 			header_item = &header_data_entry->u.compound.entries[k++];
-			data_set_high_res_relative_time(header_item, "Segment-Hires-Relative-Time",
-							&hires_rel_time);
+		data_set_meta_att(obj_data_entry, data_strcp("metric-id"),
+				  intu16_2str((intu16) metric->metric_id));
+
+		data_set_meta_att(obj_data_entry, data_strcp("partition-SCADA-code"),
+				  intu16_2str((intu16) metric->type.code));
+	}
+
+	return ok;
+}
+
+/**
+ * Looks up the metric objects of entry map elements
+ *
+ * \param mds the MDS.
+ * \param entry_map the entry map.
+ * \param objects output, one object per element, NULL if element
+ *        handle has no metric object.
+ */
+static void pmstore_get_entry_objects(struct MDS *mds, PmSegmentEntryMap *entry_map,
+				      struct MDS_object **objects)
+{
+	int j;
+
+	for (j = 0; j < entry_map->segm_entry_elem_list.count; ++j) {
+		ASN1_HANDLE handle = entry_map->segm_entry_elem_list.value[j].handle;
+		struct MDS_object *object = mds_get_object_by_handle(mds, handle);
+
+		if (object != NULL && object->choice == MDS_OBJ_METRIC) {
+			objects[j] = object;
+		} else {
+			objects[j] = NULL;
 		}
+	}
+}
 
-		PmSegmentEntryMap entry_map;
-		entry_map = segment->pm_segment_entry_map;
-		int info_size = entry_map.segm_entry_elem_list.count;
+/**
+ * Decodes consecutive segment entries into preallocated slots.
+ * Decoding stops at the first entry that cannot be decoded.
+ *
+ * \param segment the PMSegment
+ * \param objects the metric objects of entry map elements.
+ * \param cursor position of first entry in segment data.
+ * \param entries output, one slot per entry.
+ * \param entry_count number of entries to decode.
+ *
+ * \return number of entries properly decoded
+ */
+static int pmstore_decode_entries(struct PMSegment *segment,
+				  struct MDS_object **objects,
+				  ChunkBufferCursor *cursor, DataEntry *entries,
+				  int entry_count)
+{
+	// entries may cross chunk boundaries, those are copied to scratch
+	intu32 entry_size = pmstore_segment_entry_size(&segment->pm_segment_entry_map);
+	intu8 *scratch = malloc(entry_size);
+	ByteStreamReader stream;
 
-		struct Metric_object *metric_obj = NULL;
-		struct MDS_object *object = NULL;
+	int i;
 
-		DataEntry *objs_data_entry = &data_entry->u.compound.entries[1];
-		objs_data_entry->choice = COMPOUND_DATA_ENTRY;
-		objs_data_entry->u.compound.name = data_strcp("Segm-Entry-Elem-List");
-		objs_data_entry->u.compound.entries_count = info_size;
-		objs_data_entry->u.compound.entries = calloc(info_size, sizeof(DataEntry));
+	for (i = 0; i < entry_count; ++i) {
+		DataEntry *data_entry = &entries[i];
+		intu8 *entry_data = chunkbuff_read(cursor, entry_size, scratch);
 
-		int j;
-		int ok = 1;
+		if (entry_data == NULL) {
+			DEBUG("PM-Segment buffer overrun");
+			break;
+		}
 
-		for (j = 0; j < info_size; ++j) {
-			ASN1_HANDLE handle = entry_map.segm_entry_elem_list.value[j].handle;
-			AttrValMap val_map = entry_map.segm_entry_elem_list.value[j].attr_val_map;
-			int attr_count = val_map.count;
+		byte_stream_reader_init(&stream, entry_data, entry_size);
 
-			object = mds_get_object_by_handle(mds, handle);
+		if (!pmstore_populate_entry(segment, objects, &stream, data_entry)) {
+			DEBUG("PM-Segment: problem to decode item %d", i);
+			data_entry_del(data_entry);
+			break;
+		}
+	}
 
-			if (!object) {
-				ok = 0;
-				break;
-			}
+	free(scratch);
 
-			if (object->choice != MDS_OBJ_METRIC) {
-				ok = 0;
-				break;
-			}
+	return i;
+}
 
-			metric_obj = &(object->u.metric);
-			
-			if (!metric_obj) {
-				ok = 0;
-				break;
-			}
+/**
+ * Decodes the range of a task and marks it finished
+ *
+ * \param task the task.
+ */
+static void pmstore_decode_task(PMStoreDecodeTask *task)
+{
+	task->decoded = pmstore_decode_entries(task->segment, task->objects,
+					       &task->cursor, task->entries,
+					       task->count);
+
+	pthread_mutex_lock(&decode_pool_mutex);
+	task->finished = 1;
+	pthread_cond_broadcast(&decode_pool_done);
+	pthread_mutex_unlock(&decode_pool_mutex);
+}
+
+/**
+ * Takes the oldest queued task. Must be called with
+ * decode_pool_mutex held.
+ *
+ * \return the task, or NULL if queue is empty.
+ */
+static PMStoreDecodeTask *pmstore_decode_pool_take()
+{
+	PMStoreDecodeTask *task = decode_pool_head;
+
+	if (task != NULL) {
+		decode_pool_head = task->next;
+
+		if (decode_pool_head == NULL) {
+			decode_pool_tail = NULL;
+		}
+	}
+
+	return task;
+}
+
+/**
+ * Thread body of decode pool
+ *
+ * \param arg unused.
+ *
+ * \return never returns
+ */
+static void *pmstore_decode_pool_run(void *arg)
+{
+	while (1) {
+		PMStoreDecodeTask *task;
+
+		pthread_mutex_lock(&decode_pool_mutex);
+
+		while ((task = pmstore_decode_pool_take()) == NULL) {
+			pthread_cond_wait(&decode_pool_work, &decode_pool_mutex);
+		}
+
+		pthread_mutex_unlock(&decode_pool_mutex);
+
+		pmstore_decode_task(task);
+	}
+
+	return NULL;
+}
+
+/**
+ * Starts decode pool threads, one per online processor besides the
+ * calling thread, which decodes a range as well. Threads are shared
+ * by all contexts and live as long as the process.
+ */
+static void pmstore_decode_pool_start()
+{
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	int size = cpus > PMSTORE_PARALLEL_MAX_WORKERS ?
+		   PMSTORE_PARALLEL_MAX_WORKERS - 1 : cpus - 1;
+	pthread_attr_t attr;
+	pthread_t thread;
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+	while (decode_pool_size < size &&
+	       pthread_create(&thread, &attr, pmstore_decode_pool_run, NULL) == 0) {
+		++decode_pool_size;
+	}
+
+	pthread_attr_destroy(&attr);
+
+	DEBUG("PM-Segment: %d decode pool threads", decode_pool_size);
+}
 
-			DataEntry *obj_data_entry = &objs_data_entry->u.compound.entries[j];
-			obj_data_entry->choice = COMPOUND_DATA_ENTRY;
-			obj_data_entry->u.compound.entries_count = attr_count;
-			obj_data_entry->u.compound.entries = calloc(attr_count, sizeof(DataEntry));
-			data_meta_set_handle(obj_data_entry, handle);
-
-			if (metric_obj->choice == METRIC_NUMERIC) {
-				obj_data_entry->u.compound.name = data_strcp("Numeric");
-			} else if (metric_obj->choice == METRIC_ENUM) {
-				obj_data_entry->u.compound.name = data_strcp("Enumeration");
-			} else {
-				obj_data_entry->u.compound.name = data_strcp("RT-SA");
+/**
+ * Tells how many threads should decode a number of entries
+ *
+ * \param entry_count number of entries.
+ *
+ * \return number of threads, 1 if entries are decoded sequentially.
+ */
+static int pmstore_decode_worker_count(int entry_count)
+{
+	int workers = entry_count / PMSTORE_PARALLEL_MIN_ENTRIES;
+
+	if (workers < 2) {
+		return 1;
+	}
+
+	pthread_once(&decode_pool_once, pmstore_decode_pool_start);
+
+	if (workers > decode_pool_size + 1) {
+		workers = decode_pool_size + 1;
+	}
+
+	return workers;
+}
+
+/**
+ * Decodes consecutive segment entries splitting them in ranges, one
+ * per thread. The calling thread decodes the last range and then helps
+ * the decode pool until all ranges are done, so concurrent segments
+ * share the pool without waiting on each other. Entries have fixed
+ * size, so each range starts at a known offset and each entry has its
+ * own slot. Threads decode into private
+ * copies of the metric objects; afterwards the last entry is decoded
+ * again into the MDS objects, which end up as in sequential decoding.
+ *
+ * \param segment the PMSegment
+ * \param objects the metric objects of entry map elements.
+ * \param cursor position of first entry in segment data.
+ * \param entries output, one slot per entry.
+ * \param entry_count number of entries to decode.
+ * \param workers number of threads.
+ *
+ * \return number of entries properly decoded
+ */
+static int pmstore_decode_entries_parallel(struct PMSegment *segment,
+					   struct MDS_object **objects,
+					   ChunkBufferCursor *cursor,
+					   DataEntry *entries, int entry_count,
+					   int workers)
+{
+	PmSegmentEntryMap *entry_map = &segment->pm_segment_entry_map;
+	int info_size = entry_map->segm_entry_elem_list.count;
+	intu32 entry_size = pmstore_segment_entry_size(entry_map);
+	PMStoreDecodeTask *tasks = calloc(workers, sizeof(PMStoreDecodeTask));
+	struct MDS_object *copies = calloc(workers * info_size + 1,
+					   sizeof(struct MDS_object));
+	ChunkBufferCursor start = *cursor;
+	int first = 0;
+	int decoded = 0;
+	int complete = 1;
+	int i;
+	int j;
+
+	for (i = 0; i < workers; ++i) {
+		PMStoreDecodeTask *task = &tasks[i];
+
+		task->segment = segment;
+		task->objects = calloc(info_size + 1, sizeof(struct MDS_object *));
+		task->entries = &entries[first];
+		task->count = entry_count / workers + (i < entry_count % workers);
+		task->cursor = *cursor;
+
+		for (j = 0; j < info_size; ++j) {
+			if (objects[j] != NULL) {
+				task->objects[j] = &copies[i * info_size + j];
+				mds_share_metric_object(task->objects[j], objects[j]);
 			}
+		}
 
-			int k;
-			struct Metric *metric = NULL;
+		if (!chunkbuff_skip(cursor, task->count * entry_size)) {
+			// data ends inside this range, following ranges
+			// find the buffer exhausted
+			chunkbuff_skip(cursor, cursor->remaining);
+		}
 
-			for (k = 0; k < attr_count; ++k) {
-				DataEntry *entry = &obj_data_entry->u.compound.entries[k];
+		first += task->count;
+	}
 
-				int len = val_map.value[k].attribute_len;
-				offset += len;
+	// calling thread decodes last range
+	pthread_mutex_lock(&decode_pool_mutex);
 
-				switch (metric_obj->choice) {
-				case METRIC_NUMERIC: {
-					metric = &metric_obj->u.numeric.metric;
-					dimutil_fill_numeric_attr(&(metric_obj->u.numeric),
-								  val_map.value[k].attribute_id,
-								  stream, entry);
-				}
-				break;
-				case METRIC_ENUM: {
-					metric = &metric_obj->u.enumeration.metric;
-					int err = dimutil_fill_enumeration_attr(
-								&(metric_obj->u.enumeration),
-								val_map.value[k].attribute_id,
-								stream, entry);
-
-					if (err == 0) {
-						ERROR("PM-Store Metric enum");
-						ok = 0;
-					}
-				}
-				break;
-				case METRIC_RTSA: {
-					metric = &metric_obj->u.rtsa.metric;
-					dimutil_fill_rtsa_attr(&(metric_obj->u.rtsa),
-							       val_map.value[k].attribute_id,
-							       stream, entry);
-				}
-				break;
-				default: {
-					// unknown type
-					DEBUG("segment data: jumping %d", metric_obj->choice);
-					while (--len >= 0) {
-						int error = 0;
-						read_intu8(stream, &error);
-					}
-				}
-				}
+	for (i = 0; i < workers - 1; ++i) {
+		if (decode_pool_tail != NULL) {
+			decode_pool_tail->next = &tasks[i];
+		} else {
+			decode_pool_head = &tasks[i];
+		}
+
+		decode_pool_tail = &tasks[i];
+	}
+
+	pthread_cond_broadcast(&decode_pool_work);
+	pthread_mutex_unlock(&decode_pool_mutex);
+
+	pmstore_decode_task(&tasks[workers - 1]);
+
+	pthread_mutex_lock(&decode_pool_mutex);
+
+	for (i = 0; i < workers - 1; ++i) {
+		while (!tasks[i].finished) {
+			PMStoreDecodeTask *task = pmstore_decode_pool_take();
+
+			if (task == NULL) {
+				pthread_cond_wait(&decode_pool_done, &decode_pool_mutex);
+				continue;
 			}
 
-			data_set_meta_att(obj_data_entry, data_strcp("metric-id"),
-					  intu16_2str((intu16) metric->metric_id));
+			// queued tasks of any segment are run while waiting
+			pthread_mutex_unlock(&decode_pool_mutex);
+			pmstore_decode_task(task);
+			pthread_mutex_lock(&decode_pool_mutex);
+		}
+	}
+
+	pthread_mutex_unlock(&decode_pool_mutex);
+
+	for (i = 0; i < workers; ++i) {
+		PMStoreDecodeTask *task = &tasks[i];
 
-			data_set_meta_att(obj_data_entry, data_strcp("partition-SCADA-code"),
-					  intu16_2str((intu16) metric->type.code));
+		if (complete) {
+			decoded += task->decoded;
+			complete = task->decoded == task->count;
+			*cursor = task->cursor;
+		} else {
+			// entries after a failed one are dropped, as in
+			// sequential decoding
+			for (j = 0; j < task->decoded; ++j) {
+				data_entry_del(&task->entries[j]);
+			}
 		}
 
-		if (!ok) {
-			DEBUG("PM-Segment: problem to decode item %d", i);
-			segm_data_entry->u.compound.entries_count = i;
-			break;
+		for (j = 0; j < info_size; ++j) {
+			if (task->objects[j] != NULL) {
+				mds_destroy_object(task->objects[j]);
+			}
 		}
 
-		if (offset > segment->fixed_segment_data.length) {
-			DEBUG("PM-Segment buffer overrun");
-			segm_data_entry->u.compound.entries_count = i;
-			break;
+		free(task->objects);
+	}
+
+	if (decoded > 0) {
+		DataEntry last_entry;
+
+		memset(&last_entry, 0, sizeof(DataEntry));
+		chunkbuff_skip(&start, (decoded - 1) * entry_size);
+		if (pmstore_decode_entries(segment, objects, &start, &last_entry, 1)) {
+			data_entry_del(&last_entry);
 		}
 	}
 
-	free(stream);
+	free(copies);
+	free(tasks);
+
+	return decoded;
+}
+
+/**
+ * Decodes consecutive segment entries into a compound data entry.
+ * Large ranges are decoded by several threads.
+ *
+ * \param mds the MDS.
+ * \param segment the PMSegment
+ * \param cursor position of first entry in segment data.
+ * \param entry_count number of entries to decode.
+ * \param segm_data_entry output parameter to describe data value.
+ *
+ * \return number of entries properly decoded
+ */
+static int pmstore_populate_entries(struct MDS *mds, struct PMSegment *segment,
+				    ChunkBufferCursor *cursor, int entry_count,
+				    DataEntry *segm_data_entry)
+{
+	PmSegmentEntryMap *entry_map = &segment->pm_segment_entry_map;
+	struct MDS_object **objects;
+	int workers = pmstore_decode_worker_count(entry_count);
+	int decoded;
+
+	segm_data_entry->choice = COMPOUND_DATA_ENTRY;
+	segm_data_entry->u.compound.name = data_strcp("PM-Segment");
+	segm_data_entry->u.compound.entries_count = entry_count;
+	segm_data_entry->u.compound.entries = calloc(entry_count, sizeof(DataEntry));
+
+	objects = calloc(entry_map->segm_entry_elem_list.count + 1,
+			 sizeof(struct MDS_object *));
+	pmstore_get_entry_objects(mds, entry_map, objects);
+
+	if (workers > 1) {
+		decoded = pmstore_decode_entries_parallel(segment, objects, cursor,
+							  segm_data_entry->u.compound.entries,
+							  entry_count, workers);
+	} else {
+		decoded = pmstore_decode_entries(segment, objects, cursor,
+						 segm_data_entry->u.compound.entries,
+						 entry_count);
+	}
+
+	segm_data_entry->u.compound.entries_count = decoded;
+	free(objects);
+
+	return decoded;
+}
+
+/**
+ * Scan a segment of index segment_index, decode segment data and generate xml
+ *
+ * \param mds the MDS.
+ * \param pmstore the PMStore.
+ * \param segment the PMSegment
+ * \param segm_data_entry output parameter to describe data value.
+ */
+static void pmstore_populate_all_attributes(struct MDS *mds, struct PMStore *pmstore,
+						struct PMSegment *segment, 
+						DataEntry *segm_data_entry)
+{
+	ChunkBufferCursor cursor;
+
+	chunkbuff_cursor_init(&segment->fixed_segment_data, &cursor);
+	pmstore_populate_entries(mds, segment, &cursor, segment->empiric_usage_count,
+				 segm_data_entry);
 }
 
 /**
@@ -1318,6 +1796,86 @@ static void decode_fixed_segment_data(Context *ctx, struct PMStore *pmstore,
 	}
 }
 
+/**
+ * Delivers the complete entries received so far in batches, so they
+ * need not be kept until the segment is complete. A partial entry is
+ * kept for the next Segment Data Event.
+ *
+ * \param ctx
+ * \param pmstore the PMStore.
+ * \param segment the PMSegment
+ * \param last tells whether this is the last part of segment
+ *
+ * \return \b 1 if ok, \b 0 if segment data cannot be decoded
+ */
+static int stream_fixed_segment_data(Context *ctx, struct PMStore *pmstore,
+					struct PMSegment *segment, int last)
+{
+	ChunkBuffer *data = &segment->fixed_segment_data;
+	intu32 entry_size = pmstore_segment_entry_size(&segment->pm_segment_entry_map);
+	ChunkBufferCursor cursor;
+	int ok = 1;
+	int last_sent = 0;
+
+	if (entry_size == 0) {
+		DEBUG("PM-Segment data: empty entry map");
+		chunkbuff_clear(data);
+		return 0;
+	}
+
+	chunkbuff_cursor_init(data, &cursor);
+
+	while (ok && (cursor.remaining >= entry_size || (last && !last_sent))) {
+		int count = cursor.remaining / entry_size;
+
+		if (count > PMSTORE_SEGMENT_BATCH_SIZE) {
+			count = PMSTORE_SEGMENT_BATCH_SIZE;
+		}
+
+		DataList *list = data_list_new(1);
+		int decoded = pmstore_populate_entries(ctx->mds, segment, &cursor,
+						       count, &list->values[0]);
+		intu32 first_entry = segment->delivered_count;
+
+		segment->delivered_count += decoded;
+		ok = decoded == count;
+		last_sent = !ok || (last && cursor.remaining < entry_size);
+
+		// listener may resume before returning that it is behind
+		pmstore->segment_data_resumed = 0;
+
+		if (!manager_notify_evt_segment_data_batch(ctx, pmstore->handle,
+							   segment->instance_number,
+							   first_entry, last_sent, list)
+		    && !pmstore->segment_data_resumed) {
+			pmstore->segment_data_behind = 1;
+		}
+	}
+
+	if (!ok || last || cursor.remaining == 0) {
+		if (cursor.remaining > 0) {
+			DEBUG("PM-Segment data: %d bytes left over", cursor.remaining);
+		}
+
+		chunkbuff_clear(data);
+		return ok;
+	}
+
+	intu32 tail_size = cursor.remaining;
+	intu8 *tail = malloc(tail_size);
+	intu8 *tail_data = chunkbuff_read(&cursor, tail_size, tail);
+
+	if (tail_data != tail) {
+		memcpy(tail, tail_data, tail_size);
+	}
+
+	chunkbuff_clear(data);
+	chunkbuff_append(data, tail, tail_size);
+	free(tail);
+
+	return 1;
+}
+
 
 /**
  * Finalizes and deallocate the given PMStore.
@@ -1433,7 +1991,7 @@ static void data_set_segment_stat_entry(struct MDS *mds,
 	ByteStreamReader *stream = byte_stream_reader_instance(data->value,
 							       data->length);
 	//  stream length double-checked at the end of every iteration
-	int offset = 0;
+	intu32 offset = 0;
 
 	/*
 	int hdr_abs_time = segment->pm_segment_entry_map.segm_entry_header &
@@ -40,6 +40,37 @@
 #include "api/api_definitions.h"
 
 
+/**
+ * \brief Segment Data Event confirmation held back while the
+ * application is behind on streamed PM-Segment data.
+ */
+typedef struct PMStoreHeldConfirm {
+	/**
+	 * Tells whether a confirmation is waiting
+	 */
+	int pending;
+
+	/**
+	 * Invoke id of the event report
+	 */
+	InvokeIDType invoke_id;
+
+	/**
+	 * Event time of the event report
+	 */
+	RelativeTime current_time;
+
+	/**
+	 * Event type of the event report
+	 */
+	OID_Type event_type;
+
+	/**
+	 * Result to be sent
+	 */
+	SegmentDataResult result;
+} PMStoreHeldConfirm;
+
 /**
  * \brief The PMStore is an struct defining attributes that are common
  * to compose PMStore object classes.
@@ -159,6 +190,23 @@ struct PMStore {
 	 * List of PM-Segments belonging to this PM-Store
 	 */
 	struct PMSegment **segm_list;
+
+	/**
+	 * Set when a listener is behind on streamed segment data;
+	 * Segment Data Events are not confirmed until it resumes.
+	 */
+	int segment_data_behind;
+
+	/**
+	 * Set when the application resumes while a batch is being
+	 * delivered, so that batch cannot leave segment_data_behind set
+	 */
+	int segment_data_resumed;
+
+	/**
+	 * Confirmation held back while segment_data_behind is set
+	 */
+	PMStoreHeldConfirm held_confirm;
 };
 
 struct PMStore *pmstore_instance();
@@ -29,10 +29,17 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include "rtsa.h"
 #include "nomenclature.h"
 #include "src/communication/parser/struct_cleaner.h"
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /**
  * \defgroup METRIC_RTSA RealTime-SA
  * \ingroup ObjectClasses
@@ -146,6 +153,170 @@ int rtsa_get_nomenclature_code()
 	return MDC_MOC_VMO_METRIC_SA_RT;
 }
 
+/**
+ * Sign-extends the lower bits of a sample.
+ *
+ * \param sample the raw sample.
+ * \param bits sample size in bits.
+ *
+ * \return the signed sample value.
+ */
+static int32 rtsa_sign_extend(intu32 sample, int bits)
+{
+	if (bits >= 32) {
+		return (int32) sample;
+	}
+
+	intu32 sign = 1u << (bits - 1);
+	sample &= (sign << 1) - 1;
+	return (int32) (sample ^ sign) - (int32) sign;
+}
+
+/**
+ * Applies y = a * x + b to samples unpacked in place as 32-bit
+ * integers, leaving floats in the same storage. SSE2 or AVX is used
+ * when the compiler targets it, the remainder goes through the scalar
+ * loop.
+ *
+ * \param buffer samples, int32 on input and float on output.
+ * \param count number of samples.
+ * \param a scale factor.
+ * \param b offset.
+ */
+static void rtsa_scale_samples(float *buffer, int count, float a, float b)
+{
+	int i = 0;
+
+#if defined(__AVX__)
+	__m256 va = _mm256_set1_ps(a);
+	__m256 vb = _mm256_set1_ps(b);
+
+	for (; i + 8 <= count; i += 8) {
+		__m256i x = _mm256_loadu_si256((__m256i *) (buffer + i));
+		__m256 y = _mm256_cvtepi32_ps(x);
+		_mm256_storeu_ps(buffer + i, _mm256_add_ps(_mm256_mul_ps(y, va), vb));
+	}
+#elif defined(__SSE2__)
+	__m128 va = _mm_set1_ps(a);
+	__m128 vb = _mm_set1_ps(b);
+
+	for (; i + 4 <= count; i += 4) {
+		__m128i x = _mm_loadu_si128((__m128i *) (buffer + i));
+		__m128 y = _mm_cvtepi32_ps(x);
+		_mm_storeu_ps(buffer + i, _mm_add_ps(_mm_mul_ps(y, va), vb));
+	}
+#endif
+
+	for (; i < count; i++) {
+		int32 x;
+		memcpy(&x, buffer + i, sizeof(x));
+		buffer[i] = (float) x * a + b;
+	}
+}
+
+/**
+ * Decodes the Simple-Sa-Observed-Value samples into actual values,
+ * using Sa-Specification to unpack them and the
+ * Scale-and-Range-Specification matching the sample size to scale them.
+ *
+ * \param rtsa the METRIC_RTSA holding the samples.
+ * \param count returns the number of samples.
+ *
+ * \return newly allocated array of count values (caller frees), or NULL
+ *  if the sample size is not supported or there are no samples.
+ */
+float *rtsa_get_samples(struct RTSA *rtsa, int *count)
+{
+	SampleType *type = &rtsa->sa_specification.sample_type;
+	int bits = type->sample_size;
+	int is_signed = type->significant_bits ==
+			SAMPLE_TYPE_SIGNIFICANT_BITS_SIGNED_SAMPLES;
+	intu32 mask = 0xFFFFFFFFu;
+	double lower_abs, upper_abs, lower_scaled, upper_scaled;
+	int width, i;
+
+	*count = 0;
+
+	switch (bits) {
+	case 8:
+		lower_abs = rtsa->scale_and_range_specification_8.lower_absolute_value;
+		upper_abs = rtsa->scale_and_range_specification_8.upper_absolute_value;
+		lower_scaled = rtsa->scale_and_range_specification_8.lower_scaled_value;
+		upper_scaled = rtsa->scale_and_range_specification_8.upper_scaled_value;
+		break;
+	case 16:
+		lower_abs = rtsa->scale_and_range_specification_16.lower_absolute_value;
+		upper_abs = rtsa->scale_and_range_specification_16.upper_absolute_value;
+		lower_scaled = rtsa->scale_and_range_specification_16.lower_scaled_value;
+		upper_scaled = rtsa->scale_and_range_specification_16.upper_scaled_value;
+		break;
+	case 32:
+		lower_abs = rtsa->scale_and_range_specification_32.lower_absolute_value;
+		upper_abs = rtsa->scale_and_range_specification_32.upper_absolute_value;
+		lower_scaled = rtsa->scale_and_range_specification_32.lower_scaled_value;
+		upper_scaled = rtsa->scale_and_range_specification_32.upper_scaled_value;
+		break;
+	default:
+		return NULL;
+	}
+
+	if (is_signed) {
+		lower_scaled = rtsa_sign_extend((intu32) lower_scaled, bits);
+		upper_scaled = rtsa_sign_extend((intu32) upper_scaled, bits);
+	} else if (type->significant_bits > 0 && type->significant_bits < bits) {
+		mask = (1u << type->significant_bits) - 1;
+	}
+
+	width = bits / 8;
+	int total = rtsa->simple_sa_observed_value.length / width;
+	intu8 *data = rtsa->simple_sa_observed_value.value;
+
+	if (total <= 0 || data == NULL) {
+		return NULL;
+	}
+
+	float *samples = malloc(total * sizeof(float));
+
+	if (samples == NULL) {
+		return NULL;
+	}
+
+	double a = 1.0;
+	double b = 0.0;
+
+	if (upper_scaled != lower_scaled) {
+		a = (upper_abs - lower_abs) / (upper_scaled - lower_scaled);
+		b = lower_abs - lower_scaled * a;
+	}
+
+	for (i = 0; i < total; ++i) {
+		intu8 *p = data + i * width;
+		intu32 raw = 0;
+		int k;
+
+		for (k = 0; k < width; ++k) {
+			raw = (raw << 8) | p[k];
+		}
+
+		if (!is_signed && bits == 32) {
+			// does not fit int32, convert right away
+			samples[i] = (float) ((raw & mask) * a + b);
+			continue;
+		}
+
+		int32 x = is_signed ? rtsa_sign_extend(raw, bits)
+				      : (int32) (raw & mask);
+		memcpy(samples + i, &x, sizeof(x));
+	}
+
+	if (is_signed || bits < 32) {
+		rtsa_scale_samples(samples, total, (float) a, (float) b);
+	}
+
+	*count = total;
+	return samples;
+}
+
 /**
  * Deallocates a pointer to a METRIC_RTSA struct.
  *
@@ -135,6 +135,8 @@ struct RTSA *rtsa_instance_spec32(struct Metric *metric,
 
 int rtsa_get_nomenclature_code();
 
+float *rtsa_get_samples(struct RTSA *rtsa, int *count);
+
 void rtsa_destroy(struct RTSA *rtsa);
 
 #endif /* RTSA_H_ */
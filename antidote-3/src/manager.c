@@ -92,8 +92,12 @@
 #include "src/communication/plugin/plugin.h"
 #include "src/communication/common/communication.h"
 #include "src/communication/common/context_manager.h"
+#include "src/dim/mds.h"
+#include "src/util/chunkbuff.h"
+#include "src/communication/common/scheduler.h"
 #include "src/communication/common/extconfigurations.h"
 #include "src/communication/manager/manager_configuring.h"
+#include "src/communication/manager/manager_operating.h"
 #include "src/communication/common/stdconfigurations.h"
 #include "src/specializations/blood_pressure_monitor.h"
 #include "src/specializations/pulse_oximeter.h"
@@ -204,6 +208,9 @@ void manager_finalize()
 	manager_remove_all_listeners();
 	ext_configurations_destroy();
 	std_configurations_destroy();
+	// drop all cached configuration templates
+	mds_template_invalidate(0, NULL);
+	chunkbuff_pool_release();
 	communication_finalize();
 }
 
@@ -366,9 +373,11 @@ int manager_notify_evt_device_disconnected(Context *ctx, const char *addr)
  * Notifies 'measurement data updated'  event.
  * This function should be visible to source layer of events.
  * This function must be called in a thread safe communication context.
+ * Event report handlers gather the data of a whole scan report in one
+ * list; an empty list is not notified.
  *
  * @param ctx
- * @param data_list with the measured data.
+ * @param data_list with the measured data, deleted by this function.
  * @return 1 if any listener catches the notification, 0 if not
  */
 int manager_notify_evt_measurement_data_updated(Context *ctx, DataList *data_list)
@@ -376,6 +385,11 @@ int manager_notify_evt_measurement_data_updated(Context *ctx, DataList *data_lis
 	int ret_val = 0;
 	int i;
 
+	if (data_list == NULL || data_list->size == 0) {
+		data_list_del(data_list);
+		return 0;
+	}
+
 	for (i = 0; i < manager_listener_count; i++) {
 		ManagerListener *l = &manager_listener_list[i];
 
@@ -390,6 +404,55 @@ int manager_notify_evt_measurement_data_updated(Context *ctx, DataList *data_lis
 
 }
 
+/**
+ * Checks whether any listener takes observations in binary form, so
+ * event report handlers can skip building them.
+ *
+ * @return 1 if some listener has observations_received, 0 if not
+ */
+int manager_wants_observations()
+{
+	int i;
+
+	for (i = 0; i < manager_listener_count; i++) {
+		if (manager_listener_list[i].observations_received != NULL) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Notifies 'observations received'  event.
+ * This function should be visible to source layer of events.
+ * This function must be called in a thread safe communication context.
+ *
+ * @param ctx
+ * @param list observations of one event report. Ownership is kept by caller.
+ * @return 1 if any listener catches the notification, 0 if not
+ */
+int manager_notify_evt_observations_received(Context *ctx, ObservationList *list)
+{
+	int ret_val = 0;
+	int i;
+
+	if (list->count == 0) {
+		return 0;
+	}
+
+	for (i = 0; i < manager_listener_count; i++) {
+		ManagerListener *l = &manager_listener_list[i];
+
+		if (l->observations_received != NULL) {
+			(l->observations_received)(ctx, list);
+			ret_val = 1;
+		}
+	}
+
+	return ret_val;
+}
+
 /**
  * Notifies 'segment data xfer'  event.
  * This function should be visible to source layer of events.
@@ -425,6 +488,58 @@ int manager_notify_evt_segment_data(Context *ctx, int handle, int instnumber,
 	return ret_val;
 }
 
+/**
+ * Checks whether any listener takes PM-Segment data in batches, so
+ * segment data can be delivered as it arrives.
+ *
+ * @return 1 if some listener has segment_data_batch_received, 0 if not
+ */
+int manager_wants_segment_data_batches()
+{
+	int i;
+
+	for (i = 0; i < manager_listener_count; i++) {
+		if (manager_listener_list[i].segment_data_batch_received != NULL) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Notifies 'segment data batch' event.
+ * This function should be visible to source layer of events.
+ * This function must be called in a thread safe communication context.
+ *
+ * @param ctx
+ * @param handle PM-Store handle
+ * @param instnumber PM-Segment instance number
+ * @param first_entry index of first entry in batch
+ * @param last 1 if batch ends the segment
+ * @param data_list batch of entries. Ownership is passed to listeners.
+ * @return 0 if some listener is behind, 1 otherwise
+ */
+int manager_notify_evt_segment_data_batch(Context *ctx, int handle, int instnumber,
+					intu32 first_entry, int last, DataList *data_list)
+{
+	int ret_val = 1;
+	int i;
+
+	for (i = 0; i < manager_listener_count; i++) {
+		ManagerListener *l = &manager_listener_list[i];
+
+		if (l && l->segment_data_batch_received) {
+			if (!(l->segment_data_batch_received)(ctx, handle, instnumber,
+							      first_entry, last, data_list)) {
+				ret_val = 0;
+			}
+		}
+	}
+
+	return ret_val;
+}
+
 /**
  * Notifies 'communication timeout'  event.
  * This function should be visible to source layer of events.
@@ -480,6 +595,34 @@ void manager_stop()
 	}
 }
 
+/**
+ * Runs input processing of contexts on a pool of worker threads,
+ * instead of one connection loop per context. Only plug-ins that
+ * notify input to the stack (e.g. epoll TCP) use the workers.
+ * Workers are stopped by manager_stop().
+ *
+ * @param workers number of worker threads, 0 for one per processor
+ * @return 1 if operation succeeds, 0 otherwise
+ */
+int manager_start_workers(int workers)
+{
+	return scheduler_start(workers);
+}
+
+/**
+ * Sets how many confirmed requests the manager keeps on the wire
+ * per agent. With more than one, e.g. MDS attributes, PM-store and
+ * segment info requests are sent back to back, each with its own
+ * timeout, and responses may arrive in any order. Applies to agents
+ * associated from now on.
+ *
+ * @param max_outstanding from 1 (one at a time, the default) to 16
+ */
+void manager_set_max_outstanding_requests(int max_outstanding)
+{
+	service_set_default_max_outstanding(max_outstanding);
+}
+
 /**
  * Runs connection loop over communication layer.
  * This function must run after 'manager_start()' operation if
@@ -763,6 +906,33 @@ Request *manager_request_get_segment_data(ContextId id,
 	return NULL;
 }
 
+/**
+ * Resumes delivery of PM-Segment data after a
+ * segment_data_batch_received listener reported it was behind.
+ * The held Segment Data Event confirmation is sent to the agent.
+ *
+ * May be called from any thread. It may also be called from within
+ * segment_data_batch_received, which already holds the context;
+ * the batch being delivered is then not held back, whatever the
+ * listener returns.
+ *
+ * @param id context id
+ * @param handle PM-Store handle
+ */
+void manager_resume_segment_data(ContextId id, int handle)
+{
+	Context *ctx = context_get_and_lock(id);
+
+	if (ctx != NULL) {
+		// thread-safe block - start
+
+		operating_resume_segment_data(ctx, handle);
+
+		context_unlock(ctx);
+		// thread-safe block - end
+	}
+}
+
 /**
  * Requests clear segments data
  *
@@ -72,6 +72,21 @@ typedef struct ManagerListener {
  	* Called when peer disconnects
  	*/
 	int (*device_disconnected)(Context *ctx, const char *addr);
+	/**
+	 *  Called with the observed values of each event report in binary
+	 *  form. The list is owned by the stack and valid during the call only.
+	 */
+	void (*observations_received)(Context *ctx, ObservationList *list);
+	/**
+	 *  Called with each batch of PM-Segment entries as soon as they
+	 *  are received, instead of segment_data_received for the whole
+	 *  segment. DataList ownership is passed to the caller. Returning
+	 *  0 means the application is behind; the agent is then not
+	 *  confirmed until manager_resume_segment_data() is called, from
+	 *  any thread or from this callback.
+	 */
+	int (*segment_data_batch_received)(Context *ctx, int handle, int instnumber,
+					   intu32 first_entry, int last, DataList *list);
 } ManagerListener;
 
 #define MANAGER_LISTENER_EMPTY {\
@@ -81,7 +96,9 @@ typedef struct ManagerListener {
 			.device_disconnected = NULL,\
 			.device_available = NULL,\
 			.device_unavailable = NULL,\
-			.timeout = NULL\
+			.timeout = NULL,\
+			.observations_received = NULL,\
+			.segment_data_batch_received = NULL\
 			}
 
 void manager_init(CommunicationPlugin **plugins);
@@ -92,6 +109,10 @@ void manager_start();
 
 void manager_stop();
 
+int manager_start_workers(int workers);
+
+void manager_set_max_outstanding_requests(int max_outstanding);
+
 void manager_connection_loop(ContextId context_id);
 
 int manager_add_listener(ManagerListener listener);
@@ -120,6 +141,8 @@ Request *manager_request_clear_segment(ContextId id, int handle, int instnumber,
 
 Request *manager_request_clear_segments(ContextId id, int handle, service_request_callback callback);
 
+void manager_resume_segment_data(ContextId id, int handle);
+
 Request *manager_set_time(ContextId id, time_t time, service_request_callback callback);
 
 DataList *manager_get_configuration(ContextId id);
@@ -47,9 +47,18 @@ int manager_notify_evt_device_unavailable(Context *ctx);
 
 int manager_notify_evt_measurement_data_updated(Context *ctx, DataList *data_list);
 
+int manager_wants_observations();
+
+int manager_notify_evt_observations_received(Context *ctx, ObservationList *list);
+
 int manager_notify_evt_timeout(Context *ctx);
 
 int manager_notify_evt_segment_data(Context *ctx, int handle, int instnumber,
 					DataList *data_list);
 
+int manager_wants_segment_data_batches();
+
+int manager_notify_evt_segment_data_batch(Context *ctx, int handle, int instnumber,
+					intu32 first_entry, int last, DataList *data_list);
+
 #endif /* MAINAPP_H_ */
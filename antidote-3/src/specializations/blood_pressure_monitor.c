@@ -297,23 +297,39 @@ static ConfigObjectList *blood_pressure_monitor_get_config_ID02BC()
 	return std_object_list;
 }
 
+  /**
+  * Encodes the event report layout once, see blood_pressure_populate_event_report().
+  */
+
+static EventReportTemplate *blood_pressure_create_event_report_template()
+{
+	EventReportTemplate *tmpl =
+		event_report_template_new(ROIV_CMIP_CONFIRMED_EVENT_REPORT_CHOSEN);
+
+	event_report_template_add_observation(tmpl, 1);
+	event_report_template_add_sfloat_cmp(tmpl, 0, 3);
+	event_report_template_add_absolute_time(tmpl);
+
+	event_report_template_add_observation(tmpl, 2);
+	event_report_template_add_sfloat(tmpl, 3);
+	event_report_template_add_absolute_time(tmpl);
+
+	event_report_template_finish(tmpl);
+
+	return tmpl;
+}
+
  /**
   * Populates an event report APDU.
   */
 
-static DATA_apdu *blood_pressure_populate_event_report(void *edata)
+static DATA_apdu *blood_pressure_populate_event_report(struct StdConfiguration *config,
+							void *edata)
 {
-	DATA_apdu *data;
-	EventReportArgumentSimple evt;
-	ScanReportInfoFixed scan;
-	ObservationScanFixedList scan_fixed;
-	ObservationScanFixed measure[2];
 	AbsoluteTime nu_time;
-	BasicNuObsValueCmp nu_pressure;
-	BasicNuObsValue nu_pulse_rate;
+	FLOAT_Type values[4];
 	struct blood_pressure_event_report_data *evtdata;
 
-	data = calloc(sizeof(DATA_apdu), 1);
 	evtdata = (struct blood_pressure_event_report_data*) edata;
 
 	nu_time = date_util_create_absolute_time(evtdata->century * 100 + evtdata->year,
@@ -324,68 +340,12 @@ static DATA_apdu *blood_pressure_populate_event_report(void *edata)
 						evtdata->second,
 						evtdata->sec_fractions);
 
-	nu_pressure.count = 0x03;
-	nu_pressure.length = 0x06;
-	nu_pressure.value = calloc(sizeof(BasicNuObsValue), 3);
-	nu_pressure.value[0] = evtdata->systolic;
-	nu_pressure.value[1] = evtdata->diastolic;
-	nu_pressure.value[2] = evtdata->mean;
-	nu_pulse_rate = evtdata->pulse_rate;
-
-	// will be filled afterwards by service_* function
-	data->invoke_id = 0xffff;
-
-	data->message.choice = ROIV_CMIP_CONFIRMED_EVENT_REPORT_CHOSEN;
-	data->message.length = 54;
-
-	evt.obj_handle = 0;
-	evt.event_time = 0xFFFFFFFF;
-	evt.event_type = MDC_NOTI_SCAN_REPORT_FIXED;
-	evt.event_info.length = 44;
-
-	scan.data_req_id = 0xF000;
-	scan.scan_report_no = 0;
-
-	scan_fixed.count = 2;
-	scan_fixed.length = 36;
-	scan_fixed.value = measure;
-
-	measure[0].obj_handle = 1;
-	measure[0].obs_val_data.length = 18;
-	ByteStreamWriter *writer0 = byte_stream_writer_instance(
-			measure[0].obs_val_data.length);
-
-	encode_basicnuobsvaluecmp(writer0, &nu_pressure);
-	encode_absolutetime(writer0, &nu_time);
-
-	measure[1].obj_handle = 2;
-	measure[1].obs_val_data.length = 10;
-	ByteStreamWriter *writer1 = byte_stream_writer_instance(
-			measure[1].obs_val_data.length);
-
-	encode_basicnuobsvalue(writer1, &nu_pulse_rate);
-	encode_absolutetime(writer1, &nu_time);
-
-	measure[0].obs_val_data.value = writer0->buffer;
-	measure[1].obs_val_data.value = writer1->buffer;
-
-	scan.obs_scan_fixed = scan_fixed;
-
-	ByteStreamWriter *scan_writer = byte_stream_writer_instance(
-			evt.event_info.length);
-
-	encode_scanreportinfofixed(scan_writer, &scan);
-
-	del_byte_stream_writer(writer0, 1);
-	del_byte_stream_writer(writer1, 1);
-	del_basicnuobsvaluecmp(&nu_pressure);
-
-	evt.event_info.value = scan_writer->buffer;
-	data->message.u.roiv_cmipEventReport = evt;
-
-	del_byte_stream_writer(scan_writer, 0);
+	values[0] = evtdata->systolic;
+	values[1] = evtdata->diastolic;
+	values[2] = evtdata->mean;
+	values[3] = evtdata->pulse_rate;
 
-	return data;
+	return event_report_template_fill(config->event_report_template, values, &nu_time);
 }
 
 /**
@@ -403,6 +363,7 @@ struct StdConfiguration *blood_pressure_monitor_create_std_config_ID02BC()
 	result->dev_config_id = 0x02BC;
 	result->configure_action = &blood_pressure_monitor_get_config_ID02BC;
 	result->event_report = &blood_pressure_populate_event_report;
+	result->event_report_template = blood_pressure_create_event_report_template();
 	return result;
 }
 
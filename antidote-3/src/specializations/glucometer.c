@@ -111,22 +111,34 @@ static ConfigObjectList *glucometer_get_config_ID06A4()
 	return std_object_list;
 }
 
+/**
+ * Encodes the event report layout once, see glucometer_populate_event_report().
+ */
+static EventReportTemplate *glucometer_create_event_report_template()
+{
+	EventReportTemplate *tmpl =
+		event_report_template_new(ROIV_CMIP_CONFIRMED_EVENT_REPORT_CHOSEN);
+
+	event_report_template_add_observation(tmpl, 1);
+	event_report_template_add_sfloat(tmpl, 0);
+	event_report_template_add_absolute_time(tmpl);
+
+	event_report_template_finish(tmpl);
+
+	return tmpl;
+}
+
 /**
  * Populates an event report APDU. 
  */
 
-static DATA_apdu *glucometer_populate_event_report(void *edata)
+static DATA_apdu *glucometer_populate_event_report(struct StdConfiguration *config,
+						   void *edata)
 {
-	DATA_apdu *data;
-	EventReportArgumentSimple evt;
-	ScanReportInfoFixed scan;
-	ObservationScanFixedList scan_fixed;
-	ObservationScanFixed measure[1];
 	AbsoluteTime nu_time;
-	FLOAT_Type nu_capillary_whole_blood;
+	FLOAT_Type values[1];
 	struct glucometer_event_report_data *evtdata;
 
-	data = calloc(sizeof(DATA_apdu), 1);
 	evtdata = (struct glucometer_event_report_data*) edata;
 
 	nu_time = date_util_create_absolute_time(evtdata->century * 100 + evtdata->year,
@@ -137,51 +149,9 @@ static DATA_apdu *glucometer_populate_event_report(void *edata)
 						evtdata->second,
 						evtdata->sec_fractions);
 
-	nu_capillary_whole_blood = evtdata->capillary_whole_blood;
-
-	// will be filled afterwards by service_* function
-	data->invoke_id = 0xffff;
-
-	data->message.choice = ROIV_CMIP_CONFIRMED_EVENT_REPORT_CHOSEN;
-	data->message.length = 34;
-
-	evt.obj_handle = 0;
-	evt.event_time = 0xFFFFFFFF;
-	evt.event_type = MDC_NOTI_SCAN_REPORT_FIXED;
-	evt.event_info.length = 24;
-
-	scan.data_req_id = 0xF000;
-	scan.scan_report_no = 0;
-
-	scan_fixed.count = 1;
-	scan_fixed.length = 16;
-	scan_fixed.value = measure;
-
-	measure[0].obj_handle = 1;
-	measure[0].obs_val_data.length = 10;
-	ByteStreamWriter *writer0 = byte_stream_writer_instance(measure[0].obs_val_data.length);
-
-	encode_basicnuobsvalue(writer0, &nu_capillary_whole_blood);
-	encode_absolutetime(writer0, &nu_time);
-	
-	measure[0].obs_val_data.value = writer0->buffer;
-
-
-	scan.obs_scan_fixed = scan_fixed;
-
-	ByteStreamWriter *scan_writer = byte_stream_writer_instance(evt.event_info.length);
-
-	encode_scanreportinfofixed(scan_writer, &scan);
-
-	del_byte_stream_writer(writer0, 1);
-
-
-	evt.event_info.value = scan_writer->buffer;
-	data->message.u.roiv_cmipEventReport = evt;
-
-	del_byte_stream_writer(scan_writer, 0);
+	values[0] = evtdata->capillary_whole_blood;
 
-	return data;
+	return event_report_template_fill(config->event_report_template, values, &nu_time);
 }
 
 
@@ -199,6 +169,7 @@ struct StdConfiguration *glucometer_create_std_config_ID06A4()
 	result->dev_config_id = 0x06A4;
 	result->configure_action = &glucometer_get_config_ID06A4;
 	result->event_report = &glucometer_populate_event_report;
+	result->event_report_template = glucometer_create_event_report_template();
 	return result;
 }
 
@@ -339,23 +339,37 @@ static ConfigObjectList *pulse_oximeter_get_config_ID0191()
 	return std_object_list;
 }
 
+/**
+ * Encodes the event report layout once, see pulse_oximeter_populate_event_report().
+ */
+static EventReportTemplate *pulse_oximeter_create_event_report_template()
+{
+	EventReportTemplate *tmpl = event_report_template_new(ROIV_CMIP_EVENT_REPORT_CHOSEN);
+
+	event_report_template_add_observation(tmpl, 1);
+	event_report_template_add_sfloat(tmpl, 0);
+	event_report_template_add_absolute_time(tmpl);
+
+	event_report_template_add_observation(tmpl, 10);
+	event_report_template_add_sfloat(tmpl, 1);
+	event_report_template_add_absolute_time(tmpl);
+
+	event_report_template_finish(tmpl);
+
+	return tmpl;
+}
+
 /**
  * Populates an event report APDU. 
  */
 
-static DATA_apdu *pulse_oximeter_populate_event_report(void *edata)
+static DATA_apdu *pulse_oximeter_populate_event_report(struct StdConfiguration *config,
+							void *edata)
 {
-	DATA_apdu *data;
-	EventReportArgumentSimple evt;
-	ScanReportInfoFixed scan;
-	ObservationScanFixedList scan_fixed;
-	ObservationScanFixed measure[2];
 	AbsoluteTime nu_time;
-	BasicNuObsValue nu_oximetry;
-	BasicNuObsValue nu_beats;
+	FLOAT_Type values[2];
 	struct oximeter_event_report_data *evtdata;
 
-	data = calloc(sizeof(DATA_apdu), 1);
 	evtdata = (struct oximeter_event_report_data*) edata;
 
 	nu_time = date_util_create_absolute_time(evtdata->century * 100 + evtdata->year,
@@ -366,60 +380,10 @@ static DATA_apdu *pulse_oximeter_populate_event_report(void *edata)
 						evtdata->second,
 						evtdata->sec_fractions);
 
-	nu_oximetry = evtdata->oximetry;
-	nu_beats = evtdata->beats;
-
-	// will be filled afterwards by service_* function
-	data->invoke_id = 0xffff;
-
-	// data->message.choice = ROIV_CMIP_CONFIRMED_EVENT_REPORT_CHOSEN;
-	data->message.choice = ROIV_CMIP_EVENT_REPORT_CHOSEN;
-	data->message.length = 46;
-
-	evt.obj_handle = 0;
-	evt.event_time = 0xFFFFFFFF;
-	evt.event_type = MDC_NOTI_SCAN_REPORT_FIXED;
-	evt.event_info.length = 36;
-
-	scan.data_req_id = 0xF000;
-	scan.scan_report_no = 0;
-
-	scan_fixed.count = 2;
-	scan_fixed.length = 28;
-	scan_fixed.value = measure;
-
-	measure[0].obj_handle = 1;
-	measure[0].obs_val_data.length = 10;
-	ByteStreamWriter *writer0 = byte_stream_writer_instance(measure[0].obs_val_data.length);
-
-	encode_basicnuobsvalue(writer0, &nu_oximetry);
-	encode_absolutetime(writer0, &nu_time);
-
-	measure[1].obj_handle = 10;
-	measure[1].obs_val_data.length = 10;
-	ByteStreamWriter *writer1 = byte_stream_writer_instance(measure[1].obs_val_data.length);
-
-	encode_basicnuobsvalue(writer1, &nu_beats);
-	encode_absolutetime(writer1, &nu_time);
-	
-	measure[0].obs_val_data.value = writer0->buffer;
-	measure[1].obs_val_data.value = writer1->buffer;
-
-	scan.obs_scan_fixed = scan_fixed;
-
-	ByteStreamWriter *scan_writer = byte_stream_writer_instance(evt.event_info.length);
-
-	encode_scanreportinfofixed(scan_writer, &scan);
-
-	del_byte_stream_writer(writer0, 1);
-	del_byte_stream_writer(writer1, 1);
-
-	evt.event_info.value = scan_writer->buffer;
-	data->message.u.roiv_cmipEventReport = evt;
-
-	del_byte_stream_writer(scan_writer, 0);
+	values[0] = evtdata->oximetry;
+	values[1] = evtdata->beats;
 
-	return data;
+	return event_report_template_fill(config->event_report_template, values, &nu_time);
 }
 
 
@@ -437,6 +401,7 @@ struct StdConfiguration *pulse_oximeter_create_std_config_ID0190()
 	result->dev_config_id = 0x0190;
 	result->configure_action = &pulse_oximeter_get_config_ID0190;
 	result->event_report = &pulse_oximeter_populate_event_report;
+	result->event_report_template = pulse_oximeter_create_event_report_template();
 	return result;
 }
 
@@ -454,6 +419,7 @@ struct StdConfiguration *pulse_oximeter_create_std_config_ID0191()
 	result->dev_config_id = 0x0191;
 	result->configure_action = &pulse_oximeter_get_config_ID0191;
 	result->event_report = &pulse_oximeter_populate_event_report;
+	result->event_report_template = pulse_oximeter_create_event_report_template();
 	return result;
 }
 
@@ -155,23 +155,41 @@ static ConfigObjectList *weighting_scale_get_config_ID05DC()
 
 	return std_object_list;
 }
+/**
+ * Encodes the event report layout once, see weight_scale_populate_event_report().
+ */
+static EventReportTemplate *weight_scale_create_event_report_template()
+{
+	EventReportTemplate *tmpl =
+		event_report_template_new(ROIV_CMIP_CONFIRMED_EVENT_REPORT_CHOSEN);
+	int i;
+
+	for (i = 0; i < 2; ++i) {
+		event_report_template_add_observation(tmpl, 1);
+		event_report_template_add_float(tmpl, 0);
+		event_report_template_add_absolute_time(tmpl);
+
+		event_report_template_add_observation(tmpl, 3);
+		event_report_template_add_float(tmpl, 1);
+		event_report_template_add_absolute_time(tmpl);
+	}
+
+	event_report_template_finish(tmpl);
+
+	return tmpl;
+}
+
 /**
  * Populates an event report APDU.
  */
 
-static DATA_apdu *weight_scale_populate_event_report(void *edata)
+static DATA_apdu *weight_scale_populate_event_report(struct StdConfiguration *config,
+						     void *edata)
 {
-	DATA_apdu *data;
-	EventReportArgumentSimple evt;
-	ScanReportInfoFixed scan;
-	ObservationScanFixedList scan_fixed;
-	ObservationScanFixed measure[4];
 	AbsoluteTime nu_time;
-	FLOAT_Type nu_weight;
-	FLOAT_Type nu_bmi;
+	FLOAT_Type values[2];
 	struct weightscale_event_report_data *evtdata;
 
-	data = calloc(sizeof(DATA_apdu), 1);
 	evtdata = (struct weightscale_event_report_data*) edata;
 
 	nu_time = date_util_create_absolute_time(evtdata->century * 100 + evtdata->year,
@@ -182,77 +200,10 @@ static DATA_apdu *weight_scale_populate_event_report(void *edata)
 						evtdata->second,
 						evtdata->sec_fractions);
 
-	nu_weight = evtdata->weight;
-	nu_bmi = evtdata->bmi;
-
-	// will be filled afterwards by service_* function
-	data->invoke_id = 0xffff;
-
-	data->message.choice = ROIV_CMIP_CONFIRMED_EVENT_REPORT_CHOSEN;
-	data->message.length = 82;
-
-	evt.obj_handle = 0;
-	evt.event_time = 0xFFFFFFFF;
-	evt.event_type = MDC_NOTI_SCAN_REPORT_FIXED;
-	evt.event_info.length = 72;
-
-	scan.data_req_id = 0xF000;
-	scan.scan_report_no = 0;
-
-	scan_fixed.count = 4;
-	scan_fixed.length = 64;
-	scan_fixed.value = measure;
-
-	measure[0].obj_handle = 1;
-	measure[0].obs_val_data.length = 12;
-	ByteStreamWriter *writer0 = byte_stream_writer_instance(measure[0].obs_val_data.length);
-
-	write_float(writer0, nu_weight);
-	encode_absolutetime(writer0, &nu_time);
-
-	measure[1].obj_handle = 3;
-	measure[1].obs_val_data.length = 12;
-	ByteStreamWriter *writer1 = byte_stream_writer_instance(measure[1].obs_val_data.length);
-
-	write_float(writer1, nu_bmi);
-	encode_absolutetime(writer1, &nu_time);
-
-	measure[2].obj_handle = 1;
-	measure[2].obs_val_data.length = 12;
-	ByteStreamWriter *writer2 = byte_stream_writer_instance(measure[2].obs_val_data.length);
-
-	write_float(writer2, nu_weight);
-	encode_absolutetime(writer2, &nu_time);
-
-	measure[3].obj_handle = 3;
-	measure[3].obs_val_data.length = 12;
-	ByteStreamWriter *writer3 = byte_stream_writer_instance(measure[3].obs_val_data.length);
-
-	write_float(writer3, nu_bmi);
-	encode_absolutetime(writer3, &nu_time);
-
-	measure[0].obs_val_data.value = writer0->buffer;
-	measure[1].obs_val_data.value = writer1->buffer;
-	measure[2].obs_val_data.value = writer2->buffer;
-	measure[3].obs_val_data.value = writer3->buffer;
-
-	scan.obs_scan_fixed = scan_fixed;
-
-	ByteStreamWriter *scan_writer = byte_stream_writer_instance(evt.event_info.length);
-
-	encode_scanreportinfofixed(scan_writer, &scan);
-
-	del_byte_stream_writer(writer0, 1);
-	del_byte_stream_writer(writer1, 1);
-	del_byte_stream_writer(writer2, 1);
-	del_byte_stream_writer(writer3, 1);
-
-	evt.event_info.value = scan_writer->buffer;
-	data->message.u.roiv_cmipEventReport = evt;
-
-	del_byte_stream_writer(scan_writer, 0);
+	values[0] = evtdata->weight;
+	values[1] = evtdata->bmi;
 
-	return data;
+	return event_report_template_fill(config->event_report_template, values, &nu_time);
 }
 
 /**
@@ -270,6 +221,7 @@ struct StdConfiguration *weighting_scale_create_std_config_ID05DC()
 	result->dev_config_id = 0x05DC;
 	result->configure_action = &weighting_scale_get_config_ID05DC;
 	result->event_report = &weight_scale_populate_event_report;
+	result->event_report_template = weight_scale_create_event_report_template();
 	return result;
 }
 
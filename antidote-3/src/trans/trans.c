@@ -1,4 +1,5 @@
 #include <string.h>
+#include <pthread.h>
 #include <src/util/linkedlist.h>
 #include <src/util/log.h>
 #include <src/communication/common/context_manager.h>
@@ -70,6 +71,11 @@ static unsigned long long int new_context = INITIAL_TRANS_CONTEXT;
  */
 static LinkedList *_devices = NULL;
 
+/**
+ * Protects list of known transcoded devices and context ID generator
+ */
+static pthread_mutex_t devices_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /**
  * Returns the list of loaded transcodings plugins
  * @return list of transcoding plugins
@@ -113,10 +119,10 @@ static int search_by_addr(void *parg, void *pelement)
  */
 static TransDevice *get_device_by_addr(char *lladdr)
 {
-	gil_lock();
+	pthread_mutex_lock(&devices_mutex);
 	TransDevice *dev = llist_search_first(devices(), lladdr,
 						search_by_addr);
-	gil_unlock();
+	pthread_mutex_unlock(&devices_mutex);
 	return dev;
 }
 
@@ -147,10 +153,10 @@ static int search_by_context(void *parg, void *pelement)
  */
 static TransDevice *get_device_by_context(ContextId id)
 {
-	gil_lock();
+	pthread_mutex_lock(&devices_mutex);
 	TransDevice *dev = llist_search_first(devices(), &id,
 						search_by_context);
-	gil_unlock();
+	pthread_mutex_unlock(&devices_mutex);
 	return dev;
 }
 
@@ -182,15 +188,15 @@ ContextId trans_context_get(char *lladdr, TransPlugin *plugin)
 		ERROR("Transcoding comm plugin not loaded");
 	} else if (plugin) {
 		dev = malloc(sizeof(TransDevice));
+		dev->lladdr = strdup(lladdr);
+		dev->plugin = plugin;
+		pthread_mutex_lock(&devices_mutex);
 		ContextId c = {communication_plugin_id(trans_comm_plugin),
 				new_context++};
 		new_context++;
 		dev->context = c;
-		dev->lladdr = strdup(lladdr);
-		dev->plugin = plugin;
-		gil_lock();
 		llist_add(devices(), dev);
-		gil_unlock();
+		pthread_mutex_unlock(&devices_mutex);
 		return dev->context;
 	} else {
 		ERROR("Trans context w/ unknown plugin");
@@ -5,11 +5,16 @@ include $(CLEAR_VARS)
 LOCAL_CFLAGS:= -Wall
 LOCAL_C_INCLUDES := $(LOCAL_PATH) $(LOCAL_PATH)/.. $(LOCAL_PATH)/../..
 
-LOCAL_SRC_FILES = bytelib.c \
+LOCAL_SRC_FILES = arena.c \
+                    bytelib.c \
+                    chunkbuff.c \
                     dateutil.c \
                     ioutil.c \
                     linkedlist.c \
-                    strbuff.c
+                    rxbuff.c \
+                    txpool.c \
+                    strbuff.c \
+                    timerwheel.c
 
 LOCAL_MODULE:= libantidoteutil
 LOCAL_MODULE_TAGS := debug eng
@@ -0,0 +1,180 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file arena.c
+ * \brief Bump allocator.
+ *
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ */
+
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include "src/util/log.h"
+
+/**
+ * \addtogroup Utility
+ *
+ * Bump allocator for data that dies all at once, e.g. the structures
+ * decoded from a received APDU. After a reset the arena keeps a single
+ * chunk big enough for everything allocated before, so in steady state
+ * allocation touches no heap at all.
+ *
+ * @{
+ */
+
+/**
+ * Alignment of every allocation
+ */
+#define ARENA_ALIGN 8
+
+/**
+ * Size of the first chunk
+ */
+static const size_t ARENA_MIN_CHUNK = 4096;
+
+/**
+ * Header size, rounded up to keep chunk data aligned
+ */
+#define ARENA_HEADER ((sizeof(ArenaChunk) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1))
+
+/**
+ * Adds a chunk able to hold at least size bytes
+ *
+ * @param arena arena
+ * @param size bytes needed
+ * @return new chunk, NULL if cannot allocate it
+ */
+static ArenaChunk *arena_add_chunk(Arena *arena, size_t size)
+{
+	size_t chunk_size = ARENA_MIN_CHUNK;
+
+	if (arena->chunks != NULL) {
+		// grow geometrically, so large APDUs need few chunks
+		chunk_size = arena->chunks->size * 2;
+	}
+
+	if (chunk_size < size) {
+		chunk_size = size;
+	}
+
+	ArenaChunk *chunk = malloc(ARENA_HEADER + chunk_size);
+
+	if (chunk == NULL) {
+		ERROR("arena: cannot allocate %lu bytes", (unsigned long) chunk_size);
+		return NULL;
+	}
+
+	chunk->size = chunk_size;
+	chunk->used = 0;
+	chunk->next = arena->chunks;
+	arena->chunks = chunk;
+
+	return chunk;
+}
+
+/**
+ * Creates an empty arena. Memory is allocated on first use.
+ *
+ * @return arena, NULL if cannot create one
+ */
+Arena *arena_new()
+{
+	return calloc(1, sizeof(Arena));
+}
+
+/**
+ * Destroys arena and everything allocated from it
+ *
+ * @param arena arena
+ */
+void arena_del(Arena *arena)
+{
+	if (arena == NULL) {
+		return;
+	}
+
+	while (arena->chunks != NULL) {
+		ArenaChunk *chunk = arena->chunks;
+		arena->chunks = chunk->next;
+		free(chunk);
+	}
+
+	free(arena);
+}
+
+/**
+ * Allocates zero-filled memory from arena
+ *
+ * @param arena arena
+ * @param size number of bytes
+ * @return memory aligned to 8 bytes, NULL if cannot allocate it
+ */
+void *arena_alloc(Arena *arena, size_t size)
+{
+	ArenaChunk *chunk = arena->chunks;
+
+	size = (size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+
+	if (chunk == NULL || chunk->size - chunk->used < size) {
+		chunk = arena_add_chunk(arena, size);
+
+		if (chunk == NULL) {
+			return NULL;
+		}
+	}
+
+	void *p = (char *) chunk + ARENA_HEADER + chunk->used;
+	chunk->used += size;
+	arena->total += size;
+
+	memset(p, 0, size);
+
+	return p;
+}
+
+/**
+ * Releases everything allocated from arena at once. If more than one
+ * chunk was needed, they are replaced by a single chunk that holds
+ * all of it.
+ *
+ * @param arena arena
+ */
+void arena_reset(Arena *arena)
+{
+	if (arena->chunks != NULL && arena->chunks->next != NULL) {
+		size_t total = arena->total;
+
+		while (arena->chunks != NULL) {
+			ArenaChunk *chunk = arena->chunks;
+			arena->chunks = chunk->next;
+			free(chunk);
+		}
+
+		arena_add_chunk(arena, total);
+	} else if (arena->chunks != NULL) {
+		arena->chunks->used = 0;
+	}
+
+	arena->total = 0;
+}
+
+/** @} */
@@ -0,0 +1,77 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file arena.h
+ * \brief Bump allocator header.
+ *
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+
+/**
+ * Block of memory handed out by an arena
+ */
+typedef struct ArenaChunk {
+	/**
+	 * Next (older) chunk
+	 */
+	struct ArenaChunk *next;
+
+	/**
+	 * Usable bytes in chunk
+	 */
+	size_t size;
+
+	/**
+	 * Bytes already handed out
+	 */
+	size_t used;
+} ArenaChunk;
+
+/**
+ * Bump allocator. Allocations are never freed one by one; the whole
+ * arena is released at once with arena_reset() or arena_del().
+ */
+typedef struct Arena {
+	/**
+	 * Chunk being filled, followed by older chunks
+	 */
+	ArenaChunk *chunks;
+
+	/**
+	 * Bytes handed out since last reset
+	 */
+	size_t total;
+} Arena;
+
+Arena *arena_new();
+
+void arena_del(Arena *arena);
+
+void *arena_alloc(Arena *arena, size_t size);
+
+void arena_reset(Arena *arena);
+
+#endif /* ARENA_H_ */
@@ -110,6 +110,48 @@ int round(double number)
 
 static const double reserved_float_values[5] = {INFINITY, NAN, NAN, NAN, -INFINITY};
 
+/* 10 ** exponent, indexed by the raw (two's complement) FLOAT exponent octet */
+static const double float_exponent_values[256] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+	1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+	1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22, 1e23,
+	1e24, 1e25, 1e26, 1e27, 1e28, 1e29, 1e30, 1e31,
+	1e32, 1e33, 1e34, 1e35, 1e36, 1e37, 1e38, 1e39,
+	1e40, 1e41, 1e42, 1e43, 1e44, 1e45, 1e46, 1e47,
+	1e48, 1e49, 1e50, 1e51, 1e52, 1e53, 1e54, 1e55,
+	1e56, 1e57, 1e58, 1e59, 1e60, 1e61, 1e62, 1e63,
+	1e64, 1e65, 1e66, 1e67, 1e68, 1e69, 1e70, 1e71,
+	1e72, 1e73, 1e74, 1e75, 1e76, 1e77, 1e78, 1e79,
+	1e80, 1e81, 1e82, 1e83, 1e84, 1e85, 1e86, 1e87,
+	1e88, 1e89, 1e90, 1e91, 1e92, 1e93, 1e94, 1e95,
+	1e96, 1e97, 1e98, 1e99, 1e100, 1e101, 1e102, 1e103,
+	1e104, 1e105, 1e106, 1e107, 1e108, 1e109, 1e110, 1e111,
+	1e112, 1e113, 1e114, 1e115, 1e116, 1e117, 1e118, 1e119,
+	1e120, 1e121, 1e122, 1e123, 1e124, 1e125, 1e126, 1e127,
+	1e-128, 1e-127, 1e-126, 1e-125, 1e-124, 1e-123, 1e-122, 1e-121,
+	1e-120, 1e-119, 1e-118, 1e-117, 1e-116, 1e-115, 1e-114, 1e-113,
+	1e-112, 1e-111, 1e-110, 1e-109, 1e-108, 1e-107, 1e-106, 1e-105,
+	1e-104, 1e-103, 1e-102, 1e-101, 1e-100, 1e-99, 1e-98, 1e-97,
+	1e-96, 1e-95, 1e-94, 1e-93, 1e-92, 1e-91, 1e-90, 1e-89,
+	1e-88, 1e-87, 1e-86, 1e-85, 1e-84, 1e-83, 1e-82, 1e-81,
+	1e-80, 1e-79, 1e-78, 1e-77, 1e-76, 1e-75, 1e-74, 1e-73,
+	1e-72, 1e-71, 1e-70, 1e-69, 1e-68, 1e-67, 1e-66, 1e-65,
+	1e-64, 1e-63, 1e-62, 1e-61, 1e-60, 1e-59, 1e-58, 1e-57,
+	1e-56, 1e-55, 1e-54, 1e-53, 1e-52, 1e-51, 1e-50, 1e-49,
+	1e-48, 1e-47, 1e-46, 1e-45, 1e-44, 1e-43, 1e-42, 1e-41,
+	1e-40, 1e-39, 1e-38, 1e-37, 1e-36, 1e-35, 1e-34, 1e-33,
+	1e-32, 1e-31, 1e-30, 1e-29, 1e-28, 1e-27, 1e-26, 1e-25,
+	1e-24, 1e-23, 1e-22, 1e-21, 1e-20, 1e-19, 1e-18, 1e-17,
+	1e-16, 1e-15, 1e-14, 1e-13, 1e-12, 1e-11, 1e-10, 1e-9,
+	1e-8, 1e-7, 1e-6, 1e-5, 1e-4, 1e-3, 1e-2, 1e-1,
+};
+
+/* 10 ** exponent, indexed by the raw (two's complement) SFLOAT exponent nibble */
+static const double sfloat_exponent_values[16] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+	1e-8, 1e-7, 1e-6, 1e-5, 1e-4, 1e-3, 1e-2, 1e-1,
+};
+
 /**
  * Bytelib constructor.
  *
@@ -131,6 +173,21 @@ ByteStreamReader *byte_stream_reader_instance(intu8 *buffer, intu32 size)
 	return stream;
 }
 
+/**
+ * Initializes a ByteStreamReader that lives in caller storage,
+ * e.g. on stack, avoiding the allocation of byte_stream_reader_instance().
+ *
+ * @param stream ByteStreamReader to be initialized
+ * @param buffer Input data array
+ * @param size Input data array size
+ */
+void byte_stream_reader_init(ByteStreamReader *stream, intu8 *buffer, intu32 size)
+{
+	stream->buffer_cur = buffer;
+	stream->buffer = buffer;
+	stream->unread_bytes = buffer != NULL ? size : 0;
+}
+
 /**
  * Consumes an intu8 from data.
  *
@@ -182,6 +239,35 @@ void read_intu8_many(ByteStreamReader *stream, intu8 *buf, int len, int *error)
 	}
 }
 
+/**
+ * Consumes a number of intu8's from data without copying them.
+ *
+ * @param stream The current ByteStreamReader.
+ * @param len The exact number of bytes that are to be consumed
+ * @param error A reference to a boolean to hold the error code.
+ * @return pointer to the bytes inside stream buffer, valid as long
+ * as the buffer is, or NULL on error.
+ */
+intu8 *read_intu8_slice(ByteStreamReader *stream, int len, int *error)
+{
+	intu8 *ret = NULL;
+
+	if (stream && stream->unread_bytes >= (unsigned) len) {
+		ret = stream->buffer_cur;
+		stream->buffer_cur += len;
+		stream->unread_bytes -= len;
+	} else {
+		if (error) {
+			*error = 1;
+		}
+
+		ERROR("read_intu8_slice")
+		;
+	}
+
+	return ret;
+}
+
 /**
  * Consumes an intu16 from data, rearranging it to the proper endianism.
  *
@@ -237,6 +323,26 @@ intu32 read_intu32(ByteStreamReader *stream, int *error)
 	return ret;
 }
 
+/**
+ * Converts a FLOAT word, already in host order, as described in MDER Annex F.6.
+ *
+ * @param int_data FLOAT word.
+ * @return float Converted float.
+ */
+static inline FLOAT_Type float_from_intu32(intu32 int_data)
+{
+	intu32 mantissa = int_data & 0xFFFFFF;
+
+	if (mantissa >= (intu32) FIRST_RESERVED_VALUE &&
+					mantissa <= MDER_NEGATIVE_INFINITY) {
+		return reserved_float_values[mantissa - FIRST_RESERVED_VALUE];
+	}
+
+	int32 value = mantissa >= 0x800000 ? (int32) mantissa - 0x1000000 : (int32) mantissa;
+
+	return value * float_exponent_values[int_data >> 24];
+}
+
 /**
  * Consumes an intu32 from data, and calculates the float as described in MDER Annex F.6.
  *
@@ -250,21 +356,41 @@ FLOAT_Type read_float(ByteStreamReader *stream, int *error)
 	if (*error)
 		return 0;
 
-	int32 mantissa = int_data & 0xFFFFFF;
-	int8 expoent = int_data >> 24;
-	double output = 0;
+	return float_from_intu32(int_data);
+}
 
-	if (mantissa >= FIRST_RESERVED_VALUE &&
-					mantissa <= MDER_NEGATIVE_INFINITY) {
-		output = reserved_float_values[mantissa - FIRST_RESERVED_VALUE];
-	} else {
-		if (mantissa >= 0x800000) {
-			mantissa = -((0xFFFFFF + 1) - mantissa);
+/**
+ * Consumes count FLOATs from data in one pass, as described in MDER Annex F.6.
+ * Produces the same values as calling read_float() count times, but checks
+ * the stream bounds only once.
+ *
+ * @param stream The current ByteStreamReader.
+ * @param values Output array with room for count values.
+ * @param count Number of FLOATs to consume.
+ * @param error Error feedback
+ */
+void read_float_many(ByteStreamReader *stream, FLOAT_Type *values, int count, int *error)
+{
+	if (!stream || count < 0 || stream->unread_bytes / 4 < (unsigned) count) {
+		if (error) {
+			*error = 1;
 		}
-		output = (mantissa * pow(10.0f, expoent));
+
+		ERROR("read_float_many");
+		return;
 	}
 
-	return output;
+	const intu8 *data = stream->buffer_cur;
+	int i;
+
+	for (i = 0; i < count; ++i, data += 4) {
+		intu32 int_data = ((intu32) data[0] << 24) | ((intu32) data[1] << 16) |
+				  ((intu32) data[2] << 8) | data[3];
+		values[i] = float_from_intu32(int_data);
+	}
+
+	stream->buffer_cur += 4 * count;
+	stream->unread_bytes -= 4 * count;
 }
 
 /* round number n to d decimal points */
@@ -273,6 +399,27 @@ inline double fround(double n, int d)
 	return floor(n * pow(10.0f, d) + 0.5f) / pow(10.0f, d);
 }
 
+/**
+ * Converts an SFLOAT word, already in host order, as described in MDER Annex F.7.
+ *
+ * @param int_data SFLOAT word.
+ * @return float Converted float.
+ */
+static inline SFLOAT_Type sfloat_from_intu16(intu16 int_data)
+{
+	intu16 mantissa = int_data & 0x0FFF;
+
+	if (mantissa >= FIRST_S_RESERVED_VALUE &&
+					mantissa <= MDER_S_NEGATIVE_INFINITY) {
+		return reserved_float_values[mantissa - FIRST_S_RESERVED_VALUE];
+	}
+
+	int value = mantissa >= 0x0800 ? mantissa - 0x1000 : mantissa;
+
+	// SFLOAT results have always been rounded to float precision
+	return (float) (value * sfloat_exponent_values[int_data >> 12]);
+}
+
 /**
  * Consumes an intu16 from data, and calculates the sfloat as described in MDER Annex F.7.
  *
@@ -286,31 +433,41 @@ SFLOAT_Type read_sfloat(ByteStreamReader *stream, int *error)
 	if (*error)
 		return 0;
 
-	intu16 mantissa = int_data & 0x0FFF;
-	int8 expoent = int_data >> 12;
+	return sfloat_from_intu16(int_data);
+}
+
+/**
+ * Consumes count SFLOATs from data in one pass, as described in MDER Annex F.7.
+ * Produces the same values as calling read_sfloat() count times, but checks
+ * the stream bounds only once.
+ *
+ * @param stream The current ByteStreamReader.
+ * @param values Output array with room for count values.
+ * @param count Number of SFLOATs to consume.
+ * @param error Error feedback
+ */
+void read_sfloat_many(ByteStreamReader *stream, SFLOAT_Type *values, int count, int *error)
+{
+	if (!stream || count < 0 || stream->unread_bytes / 2 < (unsigned) count) {
+		if (error) {
+			*error = 1;
+		}
 
-	if (expoent >= 0x0008) {
-		expoent = -((0x000F + 1) - expoent);
+		ERROR("read_sfloat_many");
+		return;
 	}
 
-	float output = 0;
+	const intu8 *data = stream->buffer_cur;
+	int i;
 
-	if (mantissa >= FIRST_S_RESERVED_VALUE && mantissa
-	    <= MDER_S_NEGATIVE_INFINITY) {
-		output = reserved_float_values[mantissa
-					       - FIRST_S_RESERVED_VALUE];
-	} else {
-		if (mantissa >= 0x0800) {
-			mantissa = -((0x0FFF + 1) - mantissa);
-		}
-		double magnitude = pow(10.0f, expoent);
-		output = (mantissa * magnitude);
+	for (i = 0; i < count; ++i, data += 2) {
+		values[i] = sfloat_from_intu16(((intu16) data[0] << 8) | data[1]);
 	}
 
-	return output;
+	stream->buffer_cur += 2 * count;
+	stream->unread_bytes -= 2 * count;
 }
 
-
 /**
  * ByteStreamWriter constructor.
  *
@@ -341,6 +498,36 @@ ByteStreamWriter *open_stream_writer(intu32 hint)
 	return stream;
 }
 
+/**
+ * Initializes a ByteStreamWriter that lives in caller storage,
+ * writing into a fixed buffer that is not owned by the writer.
+ *
+ * @param stream The writer to initialize.
+ * @param buffer Output data array.
+ * @param size Output data array size.
+ */
+void byte_stream_writer_init(ByteStreamWriter *stream, intu8 *buffer, intu32 size)
+{
+	stream->buffer = buffer;
+	stream->size = 0;
+	stream->buffer_size = size;
+	stream->open = 0;
+	stream->counting = 0;
+}
+
+/**
+ * Initializes a ByteStreamWriter that lives in caller storage and only
+ * counts the octets written to it. Running an encoder against it gives
+ * the encoded size without storing anything.
+ *
+ * @param stream The writer to initialize.
+ */
+void byte_stream_counter_init(ByteStreamWriter *stream)
+{
+	byte_stream_writer_init(stream, NULL, 0);
+	stream->counting = 1;
+}
+
 
 /**
  * Checks stream size and extends if necessary (if it iso open)
@@ -350,6 +537,10 @@ ByteStreamWriter *open_stream_writer(intu32 hint)
  */
 static int check_writer(ByteStreamWriter *stream, int need)
 {
+	if (stream->counting) {
+		return 1;
+	}
+
 	if ((signed) (stream->size + need) <= stream->buffer_size) {
 		return 1;
 	}
@@ -379,7 +570,8 @@ static int check_writer(ByteStreamWriter *stream, int need)
 intu32 write_intu8(ByteStreamWriter *stream, intu8 data)
 {
 	if (check_writer(stream, 1)) {
-		*(stream->buffer + stream->size) = data;
+		if (!stream->counting)
+			*(stream->buffer + stream->size) = data;
 		stream->size++;
 		return 1; // true
 	} else {
@@ -401,7 +593,8 @@ intu32 write_intu8(ByteStreamWriter *stream, intu8 data)
 intu32 write_intu8_many(ByteStreamWriter *stream, intu8 *data, int len, int *error)
 {
 	if (check_writer(stream, len)) {
-		memcpy(stream->buffer + stream->size, data, len);
+		if (!stream->counting)
+			memcpy(stream->buffer + stream->size, data, len);
 		stream->size += len;
 		*error = 0;
 		return len; 
@@ -424,7 +617,8 @@ intu32 write_intu16(ByteStreamWriter *stream, intu16 data)
 {
 	if (check_writer(stream, 2)) {
 		data = htons(data);
-		memcpy(stream->buffer + stream->size, &data, 2);
+		if (!stream->counting)
+			memcpy(stream->buffer + stream->size, &data, 2);
 		stream->size += 2;
 		return 2; // true
 	} else {
@@ -445,7 +639,8 @@ intu32 reserve_intu16(ByteStreamWriter *stream, int* position)
 	if (check_writer(stream, 2)) {
 		*position = stream->size;
 		int zero = 0;
-		memcpy(stream->buffer + stream->size, &zero, 2);
+		if (!stream->counting)
+			memcpy(stream->buffer + stream->size, &zero, 2);
 		stream->size += 2;
 		return 2; // true
 	} else {
@@ -463,6 +658,9 @@ intu32 reserve_intu16(ByteStreamWriter *stream, int* position)
  */
 void commit_intu16(ByteStreamWriter *stream, int position, intu16 data)
 {
+	if (stream->counting)
+		return;
+
 	data = htons(data);
 	memcpy(stream->buffer + position, &data, 2);
 }
@@ -478,7 +676,8 @@ intu32 write_intu32(ByteStreamWriter *stream, intu32 data)
 {
 	if (check_writer(stream, 4)) {
 		data = htonl(data);
-		memcpy(stream->buffer + stream->size, &data, 4);
+		if (!stream->counting)
+			memcpy(stream->buffer + stream->size, &data, 4);
 		stream->size += 4;
 		return 4; // true
 	} else {
@@ -498,7 +697,7 @@ intu32 write_sfloat(ByteStreamWriter *stream, SFLOAT_Type data)
 {
 	intu16 result = MDER_S_NaN;
 
-	if (isnan(data)) {
+	if (stream->counting || isnan(data)) {
 		goto finally;
 	} else if (data > MDER_SFLOAT_MAX) {
 		result = MDER_S_POSITIVE_INFINITY;
@@ -573,7 +772,7 @@ intu32 write_float(ByteStreamWriter *stream, FLOAT_Type data)
 {
 	intu32 result = MDER_NaN;
 
-	if (isnan(data)) {
+	if (stream->counting || isnan(data)) {
 		goto finally;
 	} else if (data > MDER_FLOAT_MAX) {
 		result = MDER_POSITIVE_INFINITY;
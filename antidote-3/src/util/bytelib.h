@@ -74,26 +74,43 @@ typedef struct ByteStreamWriter {
 	intu8 *buffer;
 	int buffer_size;
 	int open;
+
+	/**
+	 * Only counts octets, nothing is stored (see byte_stream_counter_init())
+	 */
+	int counting;
 } ByteStreamWriter;
 
 ByteStreamReader *byte_stream_reader_instance(intu8 *stream, intu32 size);
 
+void byte_stream_reader_init(ByteStreamReader *stream, intu8 *buffer, intu32 size);
+
 intu8 read_intu8(ByteStreamReader *stream, int *error);
 
 void read_intu8_many(ByteStreamReader *stream, intu8 *buf, int len, int *error);
 
+intu8 *read_intu8_slice(ByteStreamReader *stream, int len, int *error);
+
 intu16 read_intu16(ByteStreamReader *stream, int *error);
 
 intu32 read_intu32(ByteStreamReader *stream, int *error);
 
 FLOAT_Type read_float(ByteStreamReader *stream, int *error);
 
+void read_float_many(ByteStreamReader *stream, FLOAT_Type *values, int count, int *error);
+
 SFLOAT_Type read_sfloat(ByteStreamReader *stream, int *error);
 
+void read_sfloat_many(ByteStreamReader *stream, SFLOAT_Type *values, int count, int *error);
+
 ByteStreamWriter *byte_stream_writer_instance(intu32 size);
 
 ByteStreamWriter *open_stream_writer(intu32 hint);
 
+void byte_stream_writer_init(ByteStreamWriter *stream, intu8 *buffer, intu32 size);
+
+void byte_stream_counter_init(ByteStreamWriter *stream);
+
 intu32 write_intu8(ByteStreamWriter *stream, intu8 data);
 
 intu32 write_intu8_many(ByteStreamWriter *stream, intu8 *data, int len, int *error);
@@ -0,0 +1,297 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file chunkbuff.c
+ * \brief Chunked byte buffer.
+ *
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ */
+
+#include "chunkbuff.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "src/util/log.h"
+
+/**
+ * \addtogroup Utility
+ *
+ * Byte buffer for data received in many pieces, e.g. PM-segment entries
+ * delivered by a sequence of Segment Data Events. Data is appended to
+ * fixed-size chunks, so large buffers are never reallocated or copied,
+ * and freed chunks are kept in a pool for the next buffer.
+ *
+ * @{
+ */
+
+/**
+ * Maximum number of free chunks kept in pool
+ */
+#define CHUNKBUFF_POOL_MAX 256
+
+/**
+ * Free chunks
+ */
+static BufferChunk *chunk_pool = NULL;
+
+/**
+ * Number of free chunks
+ */
+static int chunk_pool_count = 0;
+
+/**
+ * Protects chunk pool
+ */
+static pthread_mutex_t chunk_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Takes an empty chunk from pool, or allocates a new one
+ *
+ * @return chunk, NULL if cannot allocate it
+ */
+static BufferChunk *chunkbuff_chunk_new()
+{
+	BufferChunk *chunk;
+
+	pthread_mutex_lock(&chunk_pool_mutex);
+	chunk = chunk_pool;
+
+	if (chunk != NULL) {
+		chunk_pool = chunk->next;
+		--chunk_pool_count;
+	}
+
+	pthread_mutex_unlock(&chunk_pool_mutex);
+
+	if (chunk == NULL) {
+		chunk = malloc(sizeof(BufferChunk));
+
+		if (chunk == NULL) {
+			ERROR("chunkbuff: cannot allocate chunk");
+			return NULL;
+		}
+	}
+
+	chunk->next = NULL;
+	chunk->used = 0;
+
+	return chunk;
+}
+
+/**
+ * Appends data to buffer
+ *
+ * @param buff chunked buffer
+ * @param data data to be copied
+ * @param length number of bytes
+ * @return 1 if ok, 0 if cannot allocate memory
+ */
+int chunkbuff_append(ChunkBuffer *buff, intu8 *data, intu32 length)
+{
+	while (length > 0) {
+		BufferChunk *chunk = buff->last;
+
+		if (chunk == NULL || chunk->used == CHUNKBUFF_CHUNK_SIZE) {
+			chunk = chunkbuff_chunk_new();
+
+			if (chunk == NULL) {
+				return 0;
+			}
+
+			if (buff->last != NULL) {
+				buff->last->next = chunk;
+			} else {
+				buff->first = chunk;
+			}
+
+			buff->last = chunk;
+		}
+
+		intu32 count = CHUNKBUFF_CHUNK_SIZE - chunk->used;
+
+		if (count > length) {
+			count = length;
+		}
+
+		memcpy(chunk->data + chunk->used, data, count);
+		chunk->used += count;
+		buff->length += count;
+		data += count;
+		length -= count;
+	}
+
+	return 1;
+}
+
+/**
+ * Empties buffer, giving its chunks back to pool
+ *
+ * @param buff chunked buffer
+ */
+void chunkbuff_clear(ChunkBuffer *buff)
+{
+	BufferChunk *chunk = buff->first;
+
+	pthread_mutex_lock(&chunk_pool_mutex);
+
+	while (chunk != NULL) {
+		BufferChunk *next = chunk->next;
+
+		if (chunk_pool_count < CHUNKBUFF_POOL_MAX) {
+			chunk->next = chunk_pool;
+			chunk_pool = chunk;
+			++chunk_pool_count;
+		} else {
+			free(chunk);
+		}
+
+		chunk = next;
+	}
+
+	pthread_mutex_unlock(&chunk_pool_mutex);
+
+	buff->first = NULL;
+	buff->last = NULL;
+	buff->length = 0;
+}
+
+/**
+ * Places cursor at the beginning of buffer
+ *
+ * @param buff chunked buffer
+ * @param cursor cursor
+ */
+void chunkbuff_cursor_init(ChunkBuffer *buff, ChunkBufferCursor *cursor)
+{
+	cursor->chunk = buff->first;
+	cursor->offset = 0;
+	cursor->remaining = buff->length;
+}
+
+/**
+ * Reads the next bytes of buffer as a contiguous block. Data inside
+ * a single chunk is returned in place; data crossing chunk boundaries
+ * is copied to scratch.
+ *
+ * @param cursor cursor, advanced past the data
+ * @param length number of bytes
+ * @param scratch caller storage of at least length bytes
+ * @return pointer to data, NULL if buffer has less than length bytes left
+ */
+intu8 *chunkbuff_read(ChunkBufferCursor *cursor, intu32 length, intu8 *scratch)
+{
+	intu8 *result;
+	intu32 copied = 0;
+
+	if (length > cursor->remaining) {
+		return NULL;
+	} else if (length == 0) {
+		return scratch;
+	}
+
+	cursor->remaining -= length;
+
+	if (cursor->offset == cursor->chunk->used && cursor->chunk->next != NULL) {
+		cursor->chunk = cursor->chunk->next;
+		cursor->offset = 0;
+	}
+
+	if (cursor->chunk->used - cursor->offset >= length) {
+		result = cursor->chunk->data + cursor->offset;
+		cursor->offset += length;
+		return result;
+	}
+
+	while (copied < length) {
+		intu32 count = cursor->chunk->used - cursor->offset;
+
+		if (count == 0) {
+			cursor->chunk = cursor->chunk->next;
+			cursor->offset = 0;
+			continue;
+		}
+
+		if (count > length - copied) {
+			count = length - copied;
+		}
+
+		memcpy(scratch + copied, cursor->chunk->data + cursor->offset, count);
+		cursor->offset += count;
+		copied += count;
+	}
+
+	return scratch;
+}
+
+/**
+ * Advances cursor without reading data
+ *
+ * @param cursor cursor
+ * @param length number of bytes to skip
+ * @return 1 if ok, 0 if buffer has less than length bytes left
+ */
+int chunkbuff_skip(ChunkBufferCursor *cursor, intu32 length)
+{
+	if (length > cursor->remaining) {
+		return 0;
+	}
+
+	cursor->remaining -= length;
+
+	while (length > 0) {
+		intu32 count = cursor->chunk->used - cursor->offset;
+
+		if (count == 0) {
+			cursor->chunk = cursor->chunk->next;
+			cursor->offset = 0;
+			continue;
+		}
+
+		if (count > length) {
+			count = length;
+		}
+
+		cursor->offset += count;
+		length -= count;
+	}
+
+	return 1;
+}
+
+/**
+ * Frees chunks kept in pool
+ */
+void chunkbuff_pool_release()
+{
+	pthread_mutex_lock(&chunk_pool_mutex);
+
+	while (chunk_pool != NULL) {
+		BufferChunk *chunk = chunk_pool;
+		chunk_pool = chunk->next;
+		free(chunk);
+	}
+
+	chunk_pool_count = 0;
+
+	pthread_mutex_unlock(&chunk_pool_mutex);
+}
+
+/** @} */
@@ -0,0 +1,112 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file chunkbuff.h
+ * \brief Chunked byte buffer.
+ *
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ */
+
+#ifndef CHUNKBUFF_H_
+#define CHUNKBUFF_H_
+
+#include "src/asn1/phd_types.h"
+
+/**
+ * Usable bytes in each chunk
+ */
+#define CHUNKBUFF_CHUNK_SIZE 4096
+
+/**
+ * Fixed-size block of a chunked buffer
+ */
+typedef struct BufferChunk {
+	/**
+	 * Next chunk
+	 */
+	struct BufferChunk *next;
+
+	/**
+	 * Bytes filled in chunk
+	 */
+	intu32 used;
+
+	/**
+	 * Chunk storage
+	 */
+	intu8 data[CHUNKBUFF_CHUNK_SIZE];
+} BufferChunk;
+
+/**
+ * Byte buffer made of a list of fixed-size chunks. Appending never
+ * moves data already stored, and chunks are recycled through a pool
+ * shared by all buffers.
+ */
+typedef struct ChunkBuffer {
+	/**
+	 * First chunk, NULL if buffer is empty
+	 */
+	BufferChunk *first;
+
+	/**
+	 * Chunk being filled
+	 */
+	BufferChunk *last;
+
+	/**
+	 * Total bytes stored
+	 */
+	intu32 length;
+} ChunkBuffer;
+
+/**
+ * Read position in a chunked buffer
+ */
+typedef struct ChunkBufferCursor {
+	/**
+	 * Chunk holding next byte
+	 */
+	BufferChunk *chunk;
+
+	/**
+	 * Offset of next byte in chunk
+	 */
+	intu32 offset;
+
+	/**
+	 * Bytes not read yet
+	 */
+	intu32 remaining;
+} ChunkBufferCursor;
+
+int chunkbuff_append(ChunkBuffer *buff, intu8 *data, intu32 length);
+
+void chunkbuff_clear(ChunkBuffer *buff);
+
+void chunkbuff_cursor_init(ChunkBuffer *buff, ChunkBufferCursor *cursor);
+
+intu8 *chunkbuff_read(ChunkBufferCursor *cursor, intu32 length, intu8 *scratch);
+
+int chunkbuff_skip(ChunkBufferCursor *cursor, intu32 length);
+
+void chunkbuff_pool_release();
+
+#endif /* CHUNKBUFF_H_ */
@@ -32,6 +32,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include "ioutil.h"
@@ -105,6 +108,62 @@ intu8 *ioutil_buffer_from_file(const char *file_path,
 	return buffer;
 }
 
+/**
+ *  Maps the file content into memory, read-only. If the file does
+ *  not exist or is empty, this function returns \b NULL. The
+ *  mapping must be released by ioutil_unmap_file().
+ *
+ *  \param file_path the file path.
+ *  \param buffer_size the length of mapped content.
+ *
+ *  \return the mapped file content.
+ */
+intu8 *ioutil_map_file(const char *file_path, unsigned long *buffer_size)
+{
+	struct stat st;
+	void *buffer;
+	int fd;
+
+	*buffer_size = 0;
+
+	fd = open(file_path, O_RDONLY);
+
+	if (fd < 0) {
+		ERROR("Unable to open file %s", file_path);
+		return NULL;
+	}
+
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return NULL;
+	}
+
+	buffer = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (buffer == MAP_FAILED) {
+		ERROR("Unable to map file %s", file_path);
+		return NULL;
+	}
+
+	*buffer_size = st.st_size;
+
+	return buffer;
+}
+
+/**
+ *  Releases content mapped by ioutil_map_file().
+ *
+ *  \param buffer the mapped content, may be \b NULL.
+ *  \param buffer_size the length of mapped content.
+ */
+void ioutil_unmap_file(intu8 *buffer, unsigned long buffer_size)
+{
+	if (buffer != NULL) {
+		munmap(buffer, buffer_size);
+	}
+}
+
 /**
  *  Saves a string into a file. This function return success code (\b 0) whether
  *  operation is properly performed. If it is possible to open/create
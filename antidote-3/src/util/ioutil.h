@@ -37,6 +37,10 @@
 intu8 *ioutil_buffer_from_file(const char *file_path,
 			       unsigned long *buffer_size);
 
+intu8 *ioutil_map_file(const char *file_path, unsigned long *buffer_size);
+
+void ioutil_unmap_file(intu8 *buffer, unsigned long buffer_size);
+
 int ioutil_buffer_to_file(const char *file_path,
 			  unsigned long buffer_size, unsigned char *buffer, int append);
 
@@ -0,0 +1,239 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file rxbuff.c
+ * \brief APDU reception buffer.
+ *
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ */
+
+#include "rxbuff.h"
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include "src/util/log.h"
+
+/**
+ * \addtogroup Utility
+ *
+ * Reception buffer for stream transports. Data is read directly into
+ * the buffer, APDUs are framed in place and handed to the stack
+ * without copying. The buffer is only compacted or grown while no
+ * APDU is lent, so lent streams always stay valid.
+ *
+ * @{
+ */
+
+/**
+ * Size of the APDU header (choice + length)
+ */
+#define RXBUFF_HEADER_SIZE 4
+
+/**
+ * Minimum free space offered to each read
+ */
+static const int RXBUFF_MIN_READ = 4096;
+
+/**
+ * Size of the APDU starting at the first pending byte,
+ * or 0 if the header was not received yet.
+ *
+ * @param rx reception buffer
+ * @return APDU size including header
+ */
+static int rxbuff_frame_size(RxBuffer *rx)
+{
+	if (rx->end - rx->start < RXBUFF_HEADER_SIZE) {
+		return 0;
+	}
+
+	intu8 *header = rx->data + rx->start;
+
+	return (header[2] << 8 | header[3]) + RXBUFF_HEADER_SIZE;
+}
+
+/**
+ * Makes room for the next read, compacting or growing the buffer
+ * when no APDU is lent.
+ *
+ * @param rx reception buffer
+ * @return 1 if there is free space, 0 if not
+ */
+static int rxbuff_reserve(RxBuffer *rx)
+{
+	int pending = rx->end - rx->start;
+	int wanted = RXBUFF_MIN_READ;
+	int frame_size = rxbuff_frame_size(rx);
+
+	if (frame_size - pending > wanted) {
+		// room for the rest of a large APDU in a single read
+		wanted = frame_size - pending;
+	}
+
+	if (rx->capacity - rx->end >= wanted) {
+		return 1;
+	}
+
+	if (rx->lent) {
+		// data cannot move now, use whatever is left
+		return rx->capacity > rx->end;
+	}
+
+	if (rx->start > 0) {
+		memmove(rx->data, rx->data + rx->start, pending);
+		rx->start = 0;
+		rx->end = pending;
+	}
+
+	if (rx->capacity - rx->end >= wanted) {
+		return 1;
+	}
+
+	intu8 *data = realloc(rx->data, rx->end + wanted);
+
+	if (data == NULL) {
+		ERROR("rxbuff: cannot grow buffer to %d", rx->end + wanted);
+		return rx->capacity > rx->end;
+	}
+
+	rx->data = data;
+	rx->capacity = rx->end + wanted;
+
+	return 1;
+}
+
+/**
+ * Creates an empty reception buffer. Storage is allocated on
+ * first read.
+ *
+ * @return reception buffer, NULL if cannot create one
+ */
+RxBuffer *rxbuff_new()
+{
+	return calloc(1, sizeof(RxBuffer));
+}
+
+/**
+ * Destroys reception buffer
+ *
+ * @param rx reception buffer
+ */
+void rxbuff_del(RxBuffer *rx)
+{
+	if (rx) {
+		free(rx->data);
+		free(rx);
+	}
+}
+
+/**
+ * Discards all pending data. Storage is kept, so a stream
+ * that is still lent remains valid until released.
+ *
+ * @param rx reception buffer
+ */
+void rxbuff_clear(RxBuffer *rx)
+{
+	rx->start = 0;
+	rx->end = 0;
+}
+
+/**
+ * Reads available data from file descriptor into buffer
+ *
+ * @param rx reception buffer
+ * @param fd file descriptor
+ * @return number of bytes read, or read() error/EOF result
+ */
+int rxbuff_read(RxBuffer *rx, int fd)
+{
+	if (!rxbuff_reserve(rx)) {
+		errno = ENOBUFS;
+		return -1;
+	}
+
+	int bytes_read = read(fd, rx->data + rx->end, rx->capacity - rx->end);
+
+	if (bytes_read > 0) {
+		rx->end += bytes_read;
+	}
+
+	return bytes_read;
+}
+
+/**
+ * Checks whether a complete APDU is buffered
+ *
+ * @param rx reception buffer
+ * @return 1 if rxbuff_get_apdu() would succeed
+ */
+int rxbuff_has_apdu(RxBuffer *rx)
+{
+	int frame_size = rxbuff_frame_size(rx);
+
+	return !rx->lent && frame_size > 0 && rx->end - rx->start >= frame_size;
+}
+
+/**
+ * Frames the next complete APDU in place
+ *
+ * @param rx reception buffer
+ * @return stream pointing into buffer, or NULL if APDU is incomplete
+ */
+ByteStreamReader *rxbuff_get_apdu(RxBuffer *rx)
+{
+	if (!rxbuff_has_apdu(rx)) {
+		return NULL;
+	}
+
+	int frame_size = rxbuff_frame_size(rx);
+
+	rx->stream.buffer = rx->data + rx->start;
+	rx->stream.buffer_cur = rx->stream.buffer;
+	rx->stream.unread_bytes = frame_size;
+
+	rx->start += frame_size;
+	rx->lent = 1;
+
+	return &rx->stream;
+}
+
+/**
+ * Gives back the stream obtained from rxbuff_get_apdu()
+ *
+ * @param rx reception buffer
+ * @param stream lent stream
+ */
+void rxbuff_release_apdu(RxBuffer *rx, ByteStreamReader *stream)
+{
+	if (stream != &rx->stream) {
+		return;
+	}
+
+	rx->lent = 0;
+
+	if (rx->start == rx->end) {
+		rxbuff_clear(rx);
+	}
+}
+
+/** @} */
@@ -0,0 +1,79 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file rxbuff.h
+ * \brief APDU reception buffer header.
+ *
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ */
+
+#ifndef RXBUFF_H_
+#define RXBUFF_H_
+
+#include "src/util/bytelib.h"
+
+/**
+ * Per-connection reception buffer. Bytes are read straight into it
+ * and complete APDUs are framed in place; the stream handed to the
+ * stack points into the buffer and must be given back with
+ * rxbuff_release_apdu() before the buffer can be compacted again.
+ */
+typedef struct RxBuffer {
+	/**
+	 * Buffer storage
+	 */
+	intu8 *data;
+
+	/**
+	 * Allocated size of data
+	 */
+	int capacity;
+
+	/**
+	 * Offset of the first byte not handed out yet
+	 */
+	int start;
+
+	/**
+	 * Offset one past the last received byte
+	 */
+	int end;
+
+	/**
+	 * Non-zero while stream is lent to the stack
+	 */
+	int lent;
+
+	/**
+	 * Stream lent to the stack
+	 */
+	ByteStreamReader stream;
+} RxBuffer;
+
+RxBuffer *rxbuff_new();
+void rxbuff_del(RxBuffer *rx);
+void rxbuff_clear(RxBuffer *rx);
+int rxbuff_read(RxBuffer *rx, int fd);
+int rxbuff_has_apdu(RxBuffer *rx);
+ByteStreamReader *rxbuff_get_apdu(RxBuffer *rx);
+void rxbuff_release_apdu(RxBuffer *rx, ByteStreamReader *stream);
+
+#endif /* RXBUFF_H_ */
@@ -31,6 +31,8 @@
 #include "strbuff.h"
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
 #include "src/util/log.h"
 
 
@@ -40,6 +42,10 @@
  *  String buffer utilities aims to help string concatenation and memory allocation
  *  in a easy way to developer
  *
+ *  A string buffer may also write to a sink. Then its size is fixed and
+ *  its contents are handed to the sink whenever it fills up, so large
+ *  documents are produced with bounded memory.
+ *
  * @{
  */
 
@@ -110,6 +116,85 @@ StringBuffer *strbuff_new(int initial_size)
 	return sb;
 }
 
+/**
+ * Create a string buffer that writes to a sink
+ *
+ * @param size size of buffer
+ * @param sink function that receives buffer contents
+ * @param sink_data data passed to sink
+ *
+ * @return sb string buffer, NULL if cannot create one
+ */
+StringBuffer *strbuff_new_sink(int size, strbuff_sink sink, void *sink_data)
+{
+	StringBuffer *sb = strbuff_new(size);
+
+	if (sb != NULL) {
+		sb->sink = sink;
+		sb->sink_data = sink_data;
+	}
+
+	return sb;
+}
+
+/**
+ * Writes buffer contents to its sink and empties buffer. Once
+ * the sink fails, all further writes fail.
+ *
+ * @param sb string buffer
+ * @return 1 if succeeds, 0 if not
+ */
+int strbuff_flush(StringBuffer *sb)
+{
+	if (sb == NULL || sb->error) {
+		return 0;
+	}
+
+	if (sb->sink == NULL || sb->len == 0) {
+		return 1;
+	}
+
+	if (!sb->sink(sb->sink_data, sb->str, sb->len)) {
+		sb->error = 1;
+		return 0;
+	}
+
+	sb->len = 0;
+	sb->str[0] = '\0';
+	return 1;
+}
+
+/**
+ * Concatenates the string with a buffer that writes to a sink
+ *
+ * @param sb string buffer
+ * @param str string to append
+ * @param len number of chars of string to append
+ *
+ * @return 1 if succeeds, 0 if not
+ */
+static int strbuff_sink_ncat(StringBuffer *sb, char *str, int len)
+{
+	if (sb->len + len + 1 > sb->size && !strbuff_flush(sb)) {
+		return 0;
+	}
+
+	if (len + 1 > sb->size) {
+		// does not fit in buffer, goes straight to sink
+		if (!sb->sink(sb->sink_data, str, len)) {
+			sb->error = 1;
+			return 0;
+		}
+
+		return 1;
+	}
+
+	memcpy(sb->str + sb->len, str, len);
+	sb->len += len;
+	sb->str[sb->len] = '\0';
+	return 1;
+}
+
 /**
  * Concatenates the string with buffer
  * @param sb string buffer
@@ -120,7 +205,15 @@ StringBuffer *strbuff_new(int initial_size)
  */
 static int strbuff_ncat(StringBuffer *sb, char *str, int len)
 {
-	if (sb == NULL || str == NULL || !strbuff_alloc(sb, len)) {
+	if (sb == NULL || str == NULL) {
+		return 0;
+	}
+
+	if (sb->sink != NULL) {
+		return strbuff_sink_ncat(sb, str, len);
+	}
+
+	if (!strbuff_alloc(sb, len)) {
 		return 0;
 	}
 
@@ -163,6 +256,34 @@ void strbuff_del(StringBuffer *sb)
 	}
 }
 
+/**
+ * Sink that writes to a file descriptor
+ *
+ * @param fd pointer to file descriptor
+ * @param str characters to write
+ * @param len number of characters
+ * @return 1 if succeeds, 0 if not
+ */
+int strbuff_fd_sink(void *fd, const char *str, int len)
+{
+	while (len > 0) {
+		ssize_t written = write(*((int *) fd), str, len);
+
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			ERROR("strbuff: write failed: %s", strerror(errno));
+			return 0;
+		}
+
+		str += written;
+		len -= written;
+	}
+
+	return 1;
+}
 
 static inline char *xmlescapec(char *orig, char *s, char c, char *repl, int repl_len)
 {
@@ -31,17 +31,39 @@
 #ifndef STRBUFF_H_
 #define STRBUFF_H_
 
+/**
+ * Buffer size of string buffers that write to a sink
+ */
+#define STRBUFF_SINK_SIZE 4096
+
+/**
+ * Receives the contents of a string buffer as it fills up
+ *
+ * @param sink_data data given with the sink
+ * @param str characters, not null-terminated
+ * @param len number of characters
+ * @return 1 if succeeds, 0 if not
+ */
+typedef int (*strbuff_sink)(void *sink_data, const char *str, int len);
+
 typedef struct StringBuffer {
 	char *str;
 	int size;
 	int len;
+	strbuff_sink sink;
+	void *sink_data;
+	int error;
 } StringBuffer;
 
 StringBuffer *strbuff_new(int initial_size);
+StringBuffer *strbuff_new_sink(int size, strbuff_sink sink, void *sink_data);
 int strbuff_cat(StringBuffer *buf, char *str);
 int strbuff_xcat(StringBuffer *buf, char *str);
+int strbuff_flush(StringBuffer *sb);
 void strbuff_del(StringBuffer *sb);
 
+int strbuff_fd_sink(void *fd, const char *str, int len);
+
 
 
 #endif /* STRBUFF_H_ */
@@ -0,0 +1,174 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file timerwheel.c
+ * \brief Hashed timer wheel.
+ *
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ */
+
+#include "timerwheel.h"
+#include <stdlib.h>
+
+/**
+ * \addtogroup Utility
+ *
+ * Timer wheel keeps armed timers in slots indexed by expiration
+ * tick. It has no notion of time or threads; the owner tells the
+ * current tick and serializes access.
+ *
+ * @{
+ */
+
+/**
+ * Slot index mask
+ */
+#define TWHEEL_MASK (TWHEEL_SLOTS - 1)
+
+/**
+ * Initializes an empty wheel
+ *
+ * @param wheel timer wheel
+ * @param now current tick
+ */
+void twheel_init(TimerWheel *wheel, unsigned long long now)
+{
+	int i;
+
+	for (i = 0; i < TWHEEL_SLOTS; ++i) {
+		wheel->slots[i].next = &wheel->slots[i];
+		wheel->slots[i].prev = &wheel->slots[i];
+	}
+
+	wheel->now = now;
+	wheel->count = 0;
+}
+
+/**
+ * Arms entry. Entries already expired fire on next tick.
+ *
+ * @param wheel timer wheel
+ * @param entry entry, must not be armed
+ * @param expires absolute tick of expiration
+ */
+void twheel_add(TimerWheel *wheel, TimerWheelEntry *entry,
+		unsigned long long expires)
+{
+	if (expires <= wheel->now) {
+		expires = wheel->now + 1;
+	}
+
+	TimerWheelEntry *head = &wheel->slots[expires & TWHEEL_MASK];
+
+	entry->expires = expires;
+	entry->next = head;
+	entry->prev = head->prev;
+	head->prev->next = entry;
+	head->prev = entry;
+	entry->pending = 1;
+
+	++wheel->count;
+}
+
+/**
+ * Disarms entry. Does nothing if entry is not armed.
+ *
+ * @param wheel timer wheel
+ * @param entry entry
+ */
+void twheel_remove(TimerWheel *wheel, TimerWheelEntry *entry)
+{
+	if (!entry->pending) {
+		return;
+	}
+
+	entry->prev->next = entry->next;
+	entry->next->prev = entry->prev;
+	entry->next = NULL;
+	entry->prev = NULL;
+	entry->pending = 0;
+
+	--wheel->count;
+}
+
+/**
+ * Advances wheel up to current tick and takes out one expired entry.
+ * Must be called until it returns NULL.
+ *
+ * @param wheel timer wheel
+ * @param now current tick
+ * @return expired (and disarmed) entry, or NULL if there is none
+ */
+TimerWheelEntry *twheel_expire(TimerWheel *wheel, unsigned long long now)
+{
+	while (1) {
+		TimerWheelEntry *head = &wheel->slots[wheel->now & TWHEEL_MASK];
+		TimerWheelEntry *entry;
+
+		for (entry = head->next; entry != head; entry = entry->next) {
+			if (entry->expires <= wheel->now) {
+				twheel_remove(wheel, entry);
+				return entry;
+			}
+		}
+
+		if (wheel->now >= now) {
+			return NULL;
+		}
+
+		if (wheel->count == 0) {
+			// nothing to visit on the way
+			wheel->now = now;
+			return NULL;
+		}
+
+		++wheel->now;
+	}
+}
+
+/**
+ * Ticks until the first non-empty slot. Entries in that slot may
+ * still have revolutions to go, so this is a lower bound for sleeping.
+ *
+ * @param wheel timer wheel
+ * @return ticks to wait, or -1 if wheel is empty
+ */
+long long twheel_next(TimerWheel *wheel)
+{
+	long long ticks;
+
+	if (wheel->count == 0) {
+		return -1;
+	}
+
+	for (ticks = 1; ticks < TWHEEL_SLOTS; ++ticks) {
+		TimerWheelEntry *head =
+			&wheel->slots[(wheel->now + ticks) & TWHEEL_MASK];
+
+		if (head->next != head) {
+			return ticks;
+		}
+	}
+
+	return TWHEEL_SLOTS;
+}
+
+/** @} */
@@ -0,0 +1,97 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file timerwheel.h
+ * \brief Hashed timer wheel header.
+ *
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ */
+
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+/**
+ * Number of wheel slots (must be a power of 2). With 1 ms ticks a
+ * revolution lasts about 4 seconds; longer timers stay in their slot
+ * for more revolutions.
+ */
+#define TWHEEL_SLOTS 4096
+
+/**
+ * Timer armed in a wheel. It is meant to be embedded in the
+ * structure that owns the timer, so arming needs no allocation.
+ */
+typedef struct TimerWheelEntry {
+	/**
+	 * Next entry in slot
+	 */
+	struct TimerWheelEntry *next;
+
+	/**
+	 * Previous entry in slot
+	 */
+	struct TimerWheelEntry *prev;
+
+	/**
+	 * Absolute tick of expiration
+	 */
+	unsigned long long expires;
+
+	/**
+	 * Non-zero while armed in a wheel
+	 */
+	int pending;
+
+	/**
+	 * Owner data
+	 */
+	void *data;
+} TimerWheelEntry;
+
+/**
+ * Hashed timer wheel: each entry lives in the slot of its expiration
+ * tick, so arming and cancelling are O(1).
+ */
+typedef struct TimerWheel {
+	/**
+	 * Slot list heads (circular, the head itself is a sentinel)
+	 */
+	TimerWheelEntry slots[TWHEEL_SLOTS];
+
+	/**
+	 * Last processed tick
+	 */
+	unsigned long long now;
+
+	/**
+	 * Number of armed entries
+	 */
+	int count;
+} TimerWheel;
+
+void twheel_init(TimerWheel *wheel, unsigned long long now);
+void twheel_add(TimerWheel *wheel, TimerWheelEntry *entry,
+		unsigned long long expires);
+void twheel_remove(TimerWheel *wheel, TimerWheelEntry *entry);
+TimerWheelEntry *twheel_expire(TimerWheel *wheel, unsigned long long now);
+long long twheel_next(TimerWheel *wheel);
+
+#endif /* TIMERWHEEL_H_ */
@@ -0,0 +1,143 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file txpool.c
+ * \brief APDU transmission buffer pool.
+ *
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ */
+
+#include "txpool.h"
+#include <stdlib.h>
+#include "src/util/log.h"
+
+/**
+ * \addtogroup Utility
+ *
+ * Pool of output writers for encoding APDUs. The encoded size is
+ * known before a writer is taken, so buffers are grown at most once
+ * per APDU and never while encoding.
+ *
+ * @{
+ */
+
+/**
+ * Smallest buffer handed out, so short APDUs share one size class
+ */
+static const intu32 TXPOOL_MIN_SIZE = 256;
+
+/**
+ * Creates an empty writer pool
+ *
+ * @return the pool
+ */
+TxPool *txpool_new()
+{
+	return calloc(1, sizeof(TxPool));
+}
+
+/**
+ * Destroys the pool and its idle writers. Writers still taken
+ * must not be released afterwards.
+ *
+ * @param pool writer pool
+ */
+void txpool_del(TxPool *pool)
+{
+	if (pool) {
+		int i;
+
+		for (i = 0; i < pool->count; ++i) {
+			del_byte_stream_writer(pool->writers[i], 1);
+		}
+
+		free(pool);
+	}
+}
+
+/**
+ * Takes an empty writer with room for at least size octets
+ *
+ * @param pool writer pool
+ * @param size octets that will be written
+ * @return writer, to be given back with txpool_release(), or NULL if out of memory
+ */
+ByteStreamWriter *txpool_get(TxPool *pool, intu32 size)
+{
+	intu32 capacity = TXPOOL_MIN_SIZE;
+
+	while (capacity < size) {
+		capacity *= 2;
+	}
+
+	if (pool->count == 0) {
+		ByteStreamWriter *stream = byte_stream_writer_instance(capacity);
+
+		if (stream->buffer == NULL) {
+			ERROR("txpool: out of memory");
+			del_byte_stream_writer(stream, 1);
+			return NULL;
+		}
+
+		return stream;
+	}
+
+	ByteStreamWriter *stream = pool->writers[--pool->count];
+
+	if (stream->buffer_size < (int) size) {
+		intu8 *buffer = realloc(stream->buffer, capacity);
+
+		if (buffer == NULL) {
+			ERROR("txpool: out of memory");
+			del_byte_stream_writer(stream, 1);
+			return NULL;
+		}
+
+		stream->buffer = buffer;
+		stream->buffer_size = capacity;
+	}
+
+	stream->size = 0;
+
+	return stream;
+}
+
+/**
+ * Gives back a writer obtained from txpool_get(). Writers beyond
+ * TXPOOL_MAX_WRITERS are freed.
+ *
+ * @param pool writer pool
+ * @param stream writer
+ */
+void txpool_release(TxPool *pool, ByteStreamWriter *stream)
+{
+	if (stream == NULL) {
+		return;
+	}
+
+	if (pool->count < TXPOOL_MAX_WRITERS) {
+		pool->writers[pool->count++] = stream;
+	} else {
+		del_byte_stream_writer(stream, 1);
+	}
+}
+
+/** @} */
@@ -0,0 +1,61 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/**
+ * \file txpool.h
+ * \brief APDU transmission buffer pool header.
+ *
+ * Copyright (C) 2010 Signove Tecnologia Corporation.
+ * All rights reserved.
+ * Contact: Signove Tecnologia Corporation (contact@signove.com)
+ *
+ * $LICENSE_TEXT:BEGIN$
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation and appearing
+ * in the file LICENSE included in the packaging of this file; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ * $LICENSE_TEXT:END$
+ */
+
+
+#ifndef TXPOOL_H_
+#define TXPOOL_H_
+
+#include "src/util/bytelib.h"
+
+/**
+ * Number of idle writers kept by a pool
+ */
+#define TXPOOL_MAX_WRITERS 4
+
+/**
+ * Per-connection pool of output writers. Writers keep their buffers
+ * between APDUs, so sending only allocates until the buffers have
+ * grown to the connection's largest APDU.
+ */
+typedef struct TxPool {
+	/**
+	 * Idle writers
+	 */
+	ByteStreamWriter *writers[TXPOOL_MAX_WRITERS];
+
+	/**
+	 * Number of idle writers
+	 */
+	int count;
+} TxPool;
+
+TxPool *txpool_new();
+void txpool_del(TxPool *pool);
+ByteStreamWriter *txpool_get(TxPool *pool, intu32 size);
+void txpool_release(TxPool *pool, ByteStreamWriter *stream);
+
+#endif /* TXPOOL_H_ */
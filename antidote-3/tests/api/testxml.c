@@ -30,12 +30,17 @@
 #include "Basic.h"
 #include "src/util/strbuff.h"
 #include "src/api/xml_encoder.h"
+#include "src/api/json_encoder.h"
+#include "src/api/data_encoder.h"
+#include "src/api/data_list.h"
 #include "tests/functional_test_cases/test_functional.h"
 #include "testxml.h"
 #include "src/util/log.h"
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <float.h>
 
 int testxml_init_suite(void)
 {
@@ -54,6 +59,8 @@ void testxml_add_suite()
 
 	/* Add tests here - Start */
 	CU_add_test(suite, "test_xml_1", test_xml_1);
+	CU_add_test(suite, "test_xml_sink", test_xml_sink);
+	CU_add_test(suite, "test_xml_float_array_limits", test_xml_float_array_limits);
 	/* Add tests here - End */
 }
 
@@ -170,4 +177,131 @@ void test_xml_1()
 	DEBUG("test_xml_1");
 }
 
+static int sink_calls = 0;
+static int sink_max_len = 0;
+
+static int collect_sink(void *sink_data, const char *str, int len)
+{
+	StringBuffer *collected = sink_data;
+	char *copy = strndup(str, len);
+
+	++sink_calls;
+
+	if (len > sink_max_len) {
+		sink_max_len = len;
+	}
+
+	strbuff_cat(collected, copy);
+	free(copy);
+	return 1;
+}
+
+static int failing_sink(void *sink_data, const char *str, int len)
+{
+	++sink_calls;
+	return 0;
+}
+
+static DataList *new_large_data_list(int count)
+{
+	DataList *list = data_list_new(1);
+	DataEntry *cmp = &list->values[0];
+	intu32 value;
+	int i;
+
+	cmp->choice = COMPOUND_DATA_ENTRY;
+	cmp->u.compound.name = data_strcp("Large<&>");
+	cmp->u.compound.entries_count = count;
+	cmp->u.compound.entries = calloc(count, sizeof(DataEntry));
+
+	for (i = 0; i < count; ++i) {
+		value = i;
+		data_set_intu32(&cmp->u.compound.entries[i], "Value", &value);
+	}
+
+	return list;
+}
+
+void test_xml_sink()
+{
+	StringBuffer *collected;
+	StringBuffer *sb;
+	DataList *list;
+	char *doc;
+
+	// fixed-size buffer hands its contents to sink when full
+	collected = strbuff_new(1);
+	sink_calls = 0;
+	sink_max_len = 0;
+	sb = strbuff_new_sink(8, &collect_sink, collected);
+	strbuff_cat(sb, "abcde");
+	strbuff_cat(sb, "fghij");
+	strbuff_xcat(sb, "<&>");
+	strbuff_cat(sb, "longer than buffer");
+	CU_ASSERT_EQUAL(strbuff_flush(sb), 1);
+	CU_ASSERT_STRING_EQUAL(collected->str,
+			       "abcdefghij&lt;&amp;&gt;longer than buffer");
+	CU_ASSERT(sink_max_len <= 18);
+	strbuff_del(sb);
+	strbuff_del(collected);
+
+	list = new_large_data_list(5000);
+
+	// streamed documents equal the ones built in memory
+	collected = strbuff_new(1);
+	sink_calls = 0;
+	sink_max_len = 0;
+	doc = xml_encode_data_list(list);
+	CU_ASSERT_EQUAL(xml_encode_data_list_sink(list, &collect_sink, collected), 1);
+	CU_ASSERT_STRING_EQUAL(collected->str, doc);
+	CU_ASSERT(sink_calls > 1);
+	CU_ASSERT(sink_max_len <= STRBUFF_SINK_SIZE);
+	strbuff_del(collected);
+	free(doc);
+
+	collected = strbuff_new(1);
+	sink_calls = 0;
+	doc = json_encode_data_list(list);
+	CU_ASSERT_EQUAL(json_encode_data_list_sink(list, &collect_sink, collected), 1);
+	CU_ASSERT_STRING_EQUAL(collected->str, doc);
+	CU_ASSERT(sink_calls > 1);
+	strbuff_del(collected);
+	free(doc);
+
+	// sink failure stops encoding
+	sink_calls = 0;
+	CU_ASSERT_EQUAL(xml_encode_data_list_sink(list, &failing_sink, NULL), 0);
+	CU_ASSERT_EQUAL(sink_calls, 1);
+
+	data_list_del(list);
+}
+
+void test_xml_float_array_limits()
+{
+	DataList *list = data_list_new(1);
+	float *values = malloc(2 * sizeof(float));
+	char *doc;
+
+	// scale ranges come from the agent, samples may be any float
+	values[0] = FLT_MAX;
+	values[1] = -FLT_MAX;
+	data_set_float_array(&list->values[0], "Simple-Sa-Observed-Value", values, 2);
+
+	doc = xml_encode_data_list(list);
+	CU_ASSERT_PTR_NOT_NULL(strstr(doc, "<values>"
+				      "340282346638528859811704183484516925440.000000 "
+				      "-340282346638528859811704183484516925440.000000"
+				      "</values>"));
+	free(doc);
+
+	doc = json_encode_data_list(list);
+	CU_ASSERT_PTR_NOT_NULL(strstr(doc, "\"values\": ["
+				      "340282346638528859811704183484516925440.000000, "
+				      "-340282346638528859811704183484516925440.000000"
+				      "]"));
+	free(doc);
+
+	data_list_del(list);
+}
+
 #endif
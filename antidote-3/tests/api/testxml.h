@@ -34,6 +34,8 @@
 void testxml_add_suite(void);
 void testxml_test();
 void test_xml_1();
+void test_xml_sink();
+void test_xml_float_array_limits();
 
 #endif /* TEST_ENABLED */
 
@@ -35,11 +35,13 @@
 #include "src/util/bytelib.h"
 #include "src/communication/parser/encoder_ASN1.h"
 #include "src/util/ioutil.h"
+#include "src/util/txpool.h"
 #include "tests/functional_test_cases/test_functional.h"
 #include "testencoder.h"
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 static unsigned char *h212_buffer = NULL;
 static unsigned char *h222_buffer = NULL;
@@ -125,6 +127,9 @@ void testencoder_add_suite()
 
 	CU_add_test(suite, "test_encoder_data_apdu_rorj",
 		    test_encoder_data_apdu_rorj);
+
+	CU_add_test(suite, "test_encoder_sized_pooled_apdu",
+		    test_encoder_sized_pooled_apdu);
 	/* Add tests here - End */
 }
 
@@ -768,4 +773,62 @@ void test_encoder_data_apdu_roer(void)
 	del_byte_stream_writer(w, 1);
 }
 
+void test_encoder_sized_pooled_apdu()
+{
+	unsigned char *buffers[] = {h212_buffer, h222_buffer, h232_buffer,
+				    h242_buffer, h243_buffer};
+	unsigned long sizes[] = {h212_size, h222_size, h232_size,
+				 h242_size, h243_size};
+	TxPool *pool = txpool_new();
+	ByteStreamWriter *first = NULL;
+	intu8 *first_buffer = NULL;
+	int i;
+
+	for (i = 0; i < 5; ++i) {
+		ByteStreamReader *stream = byte_stream_reader_instance(buffers[i], sizes[i]);
+		APDU apdu;
+		int error = 0;
+
+		decode_apdu(stream, &apdu, &error);
+		CU_ASSERT_EQUAL(error, 0);
+
+		CU_ASSERT_EQUAL(encoded_size_apdu(&apdu), sizes[i]);
+
+		// one writer, reused for every APDU of this size class
+		ByteStreamWriter *writer = txpool_get(pool, sizes[i]);
+		CU_ASSERT_PTR_NOT_NULL(writer);
+
+		if (first == NULL) {
+			first = writer;
+			first_buffer = writer->buffer;
+		}
+
+		CU_ASSERT_PTR_EQUAL(writer, first);
+		CU_ASSERT_PTR_EQUAL(writer->buffer, first_buffer);
+		CU_ASSERT_EQUAL(writer->size, 0);
+
+		CU_ASSERT_EQUAL((unsigned long) encode_apdu(writer, &apdu), sizes[i]);
+		CU_ASSERT_EQUAL(writer->size, sizes[i]);
+		CU_ASSERT(memcmp(writer->buffer, buffers[i], sizes[i]) == 0);
+
+		txpool_release(pool, writer);
+		del_apdu(&apdu);
+		free(stream);
+	}
+
+	// writers taken at the same time are distinct, larger ones grow once
+	ByteStreamWriter *a = txpool_get(pool, 16);
+	ByteStreamWriter *b = txpool_get(pool, 4000);
+	CU_ASSERT(a != b);
+	CU_ASSERT(b->buffer_size >= 4000);
+	txpool_release(pool, a);
+	txpool_release(pool, b);
+
+	b = txpool_get(pool, 4000);
+	CU_ASSERT(b->buffer_size >= 4000);
+	txpool_release(pool, b);
+
+	txpool_del(pool);
+}
+
 #endif
@@ -43,6 +43,7 @@ void test_encoder_data_apdu_encoder_2();
 void test_encoder_data_apdu_encoder_3();
 void test_encoder_data_apdu_roer();
 void test_encoder_data_apdu_rorj();
+void test_encoder_sized_pooled_apdu();
 
 void test_enconder_byte_stream_writer();
 
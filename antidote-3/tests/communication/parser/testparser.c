@@ -35,6 +35,7 @@
 #include "src/communication/parser/encoder_ASN1.h"
 #include "src/communication/parser/struct_cleaner.h"
 #include "src/util/bytelib.h"
+#include "src/util/arena.h"
 #include "src/util/ioutil.h"
 #include "tests/functional_test_cases/test_functional.h"
 
@@ -42,6 +43,8 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
 
 
 int testparser_init_suite(void)
@@ -74,6 +77,10 @@ void testparser_add_suite()
 		    test_float_parser);
 	CU_add_test(suite, "test_parser_sfloat_parser",
 		    test_sfloat_parser);
+	CU_add_test(suite, "test_parser_float_many_parser",
+		    test_float_many_parser);
+	CU_add_test(suite, "test_parser_arena_apdu_parser",
+		    test_parser_arena_apdu_parser);
 
 	/* Add tests here - End */
 }
@@ -156,6 +163,50 @@ void test_parser_h211_apdu_parser()
 
 }
 
+void test_parser_arena_apdu_parser()
+{
+	int error = 0;
+	int i;
+	unsigned long buffer_size = 0;
+	unsigned char  *buffer = ioutil_buffer_from_file(apdu_H221, &buffer_size);
+
+	Arena *arena = arena_new();
+	CU_ASSERT_PTR_NOT_NULL(arena);
+
+	// Same APDU decoded twice, arena is reused after reset
+	for (i = 0; i < 2; ++i) {
+		ByteStreamReader *stream = byte_stream_reader_instance(buffer, buffer_size);
+		APDU apdu;
+
+		decode_apdu_arena(stream, &apdu, arena, &error);
+		CU_ASSERT_EQUAL(error, 0);
+
+		CU_ASSERT(apdu.choice == 0xe700);
+		CU_ASSERT(apdu.length == 112);
+
+		DATA_apdu *data_apdu = encode_get_data_apdu(&apdu.u.prst);
+		CU_ASSERT_EQUAL(data_apdu->invoke_id, 0x4321);
+		CU_ASSERT_EQUAL(data_apdu->message.u.roiv_cmipConfirmedEventReport.event_type, MDC_NOTI_CONFIG);
+		CU_ASSERT_EQUAL(data_apdu->message.u.roiv_cmipConfirmedEventReport.event_info.length, 94);
+		// event info is borrowed from the received buffer
+		CU_ASSERT_PTR_EQUAL(data_apdu->message.u.roiv_cmipConfirmedEventReport.event_info.value,
+				    buffer + 22);
+
+		// decoded tree lives in a single chunk of the arena
+		CU_ASSERT(arena->total > 0);
+		CU_ASSERT_PTR_NOT_NULL(arena->chunks);
+		CU_ASSERT_PTR_NULL(arena->chunks->next);
+
+		arena_reset(arena);
+		CU_ASSERT_EQUAL(arena->total, 0);
+
+		free(stream);
+	}
+
+	arena_del(arena);
+	free(buffer);
+}
+
 void test_parser_h221_apdu_parser()
 {
 	int error = 0;
@@ -751,4 +802,78 @@ void test_sfloat_parser()
 	free(stream);
 }
 
+void test_float_many_parser()
+{
+	static const intu32 mantissas[] = {0x000000, 0x000001, 0x0004D2, 0x12d687,
+					   0x7FFFFD, 0x7FFFFE, 0x7FFFFF, 0x800000,
+					   0x800001, 0x800002, 0x800003, 0xFFFFFF};
+	int mantissa_count = sizeof(mantissas) / sizeof(mantissas[0]);
+	int count = 256 * mantissa_count;
+	intu8 *data = malloc(4 * count);
+	FLOAT_Type *values = malloc(count * sizeof(FLOAT_Type));
+	ByteStreamReader stream;
+	int error = 0;
+	int i;
+
+	// every FLOAT exponent, including reserved mantissas
+	for (i = 0; i < count; ++i) {
+		intu32 word = ((intu32) (i / mantissa_count) << 24) | mantissas[i % mantissa_count];
+		data[4 * i] = word >> 24;
+		data[4 * i + 1] = word >> 16;
+		data[4 * i + 2] = word >> 8;
+		data[4 * i + 3] = word;
+	}
+
+	byte_stream_reader_init(&stream, data, 4 * count);
+	read_float_many(&stream, values, count, &error);
+	CU_ASSERT_EQUAL(error, 0);
+	CU_ASSERT_EQUAL(stream.unread_bytes, 0);
+
+	byte_stream_reader_init(&stream, data, 4 * count);
+
+	for (i = 0; i < count; ++i) {
+		FLOAT_Type value = read_float(&stream, &error);
+		CU_ASSERT_EQUAL(memcmp(&value, &values[i], sizeof(value)), 0);
+	}
+
+	free(values);
+	free(data);
+
+	// every SFLOAT word
+	count = 0x10000;
+	data = malloc(2 * count);
+	SFLOAT_Type *svalues = malloc(count * sizeof(SFLOAT_Type));
+
+	for (i = 0; i < count; ++i) {
+		data[2 * i] = i >> 8;
+		data[2 * i + 1] = i;
+	}
+
+	byte_stream_reader_init(&stream, data, 2 * count);
+	read_sfloat_many(&stream, svalues, count, &error);
+	CU_ASSERT_EQUAL(error, 0);
+
+	byte_stream_reader_init(&stream, data, 2 * count);
+
+	for (i = 0; i < count; ++i) {
+		SFLOAT_Type value = read_sfloat(&stream, &error);
+		CU_ASSERT_EQUAL(memcmp(&value, &svalues[i], sizeof(value)), 0);
+	}
+
+	CU_ASSERT_DOUBLE_EQUAL(svalues[0xF3CF], 97.5, 0.0001);
+	CU_ASSERT_DOUBLE_EQUAL(svalues[0xFFFE], -0.2, 0.0001);
+	CU_ASSERT(isnan(svalues[0x07FF]));
+	CU_ASSERT(isinf(svalues[0x07FE]) && svalues[0x07FE] > 0);
+	CU_ASSERT(isinf(svalues[0x0802]) && svalues[0x0802] < 0);
+
+	// truncated input is an error and consumes nothing
+	byte_stream_reader_init(&stream, data, 3);
+	read_sfloat_many(&stream, svalues, 2, &error);
+	CU_ASSERT_EQUAL(error, 1);
+	CU_ASSERT_EQUAL(stream.unread_bytes, 3);
+
+	free(svalues);
+	free(data);
+}
+
 #endif
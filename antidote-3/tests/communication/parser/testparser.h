@@ -38,6 +38,8 @@ void test_parser_h241_apdu_parser();
 void test_parser_h244_apdu_parser();
 void test_float_parser();
 void test_sfloat_parser();
+void test_float_many_parser();
+void test_parser_arena_apdu_parser();
 
 #endif /* TEST_ENABLED */
 
@@ -33,6 +33,7 @@
 #include "Basic.h"
 #include <stdio.h>
 
+static int context_count = 0;
 
 static int test_init_suite(void)
 {
@@ -56,34 +57,78 @@ void testctxmanager_add_suite()
 
 }
 
+static int count_contexts(Context *ctx)
+{
+	++context_count;
+	return 1;
+}
+
 void testctxmanager_test()
 {
 	// TODO check MDS and FSM destruction
-
-	/*
-	Context *c1 = context_create(1);
-	Context *c2 = context_create(2);
-	Context *c3 = context_create(3);
-
-	CU_ASSERT_EQUAL(c1, context_get(1));
-	CU_ASSERT_EQUAL(c2, context_get(2));
-	CU_ASSERT_EQUAL(c3, context_get(3));
-
-	context_remove(c1->id);
-	CU_ASSERT_PTR_NULL(context_get(1));
-
-	CU_ASSERT_EQUAL(c2, context_get(2));
-
-	context_remove(c2->id);
-	CU_ASSERT_PTR_NULL(context_get(2));
-
-	CU_ASSERT_EQUAL(c3, context_get(3));
-
-	context_remove(c3->id);
-	CU_ASSERT_PTR_NULL(context_get(3));
+	ContextId id1 = {1, 1};
+	ContextId id2 = {1, 2};
+	ContextId id3 = {2, 1};
+	int i;
+
+	Context *c1 = context_create(id1, MANAGER_CONTEXT);
+	Context *c2 = context_create(id2, MANAGER_CONTEXT);
+	Context *c3 = context_create(id3, MANAGER_CONTEXT);
+
+	CU_ASSERT_PTR_EQUAL(c1, context_get_and_lock(id1));
+	context_unlock(c1);
+	CU_ASSERT_PTR_EQUAL(c2, context_get_and_lock(id2));
+	context_unlock(c2);
+	CU_ASSERT_PTR_EQUAL(c3, context_get_and_lock(id3));
+	context_unlock(c3);
+
+	context_remove(id1);
+	CU_ASSERT_PTR_NULL(context_get_and_lock(id1));
+
+	CU_ASSERT_PTR_EQUAL(c2, context_get_and_lock(id2));
+	context_unlock(c2);
+
+	context_remove(id2);
+	CU_ASSERT_PTR_NULL(context_get_and_lock(id2));
+
+	CU_ASSERT_PTR_EQUAL(c3, context_get_and_lock(id3));
+	context_unlock(c3);
+
+	// reference keeps removed context alive until released
+	CU_ASSERT_PTR_EQUAL(c3, context_get(id3));
+	context_remove(id3);
+	CU_ASSERT_PTR_NULL(context_get(id3));
+	CU_ASSERT_EQUAL(c3->ref, 1);
+	context_release(c3);
+	c3 = context_create(id3, MANAGER_CONTEXT);
+
+	// more contexts than buckets, with connids carrying upper bits
+	for (i = 0; i < 1000; ++i) {
+		ContextId id = {1, ((unsigned long long) i << 32) | 7};
+		context_create(id, MANAGER_CONTEXT);
+	}
+
+	for (i = 0; i < 1000; ++i) {
+		ContextId id = {1, ((unsigned long long) i << 32) | 7};
+		Context *c = context_get_and_lock(id);
+		CU_ASSERT_PTR_NOT_NULL(c);
+
+		if (c) {
+			CU_ASSERT_EQUAL(c->id.connid, id.connid);
+			context_unlock(c);
+		}
+	}
+
+	context_count = 0;
+	context_iterate(&count_contexts);
+	CU_ASSERT_EQUAL(context_count, 1001);
 
 	context_remove_all();
-	*/
+	CU_ASSERT_PTR_NULL(context_get_and_lock(id3));
+
+	context_count = 0;
+	context_iterate(&count_contexts);
+	CU_ASSERT_EQUAL(context_count, 0);
 }
 
 
@@ -32,6 +32,7 @@
 #include "src/communication/parser/encoder_ASN1.h"
 #include "src/communication/parser/struct_cleaner.h"
 #include "src/communication/common/stdconfigurations.h"
+#include "src/dim/nomenclature.h"
 #include "src/specializations/blood_pressure_monitor.h"
 
 #include "src/specializations/pulse_oximeter.h"
@@ -41,6 +42,7 @@
 #include "testextconfiguration.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 int test_ext_configuration_init_suite(void)
 {
@@ -59,6 +61,10 @@ void testextconfiguration_add_suite()
 
 	/* Add tests here - Start */
 	CU_add_test(suite, "test_extconfiguration_persistent_config", test_extconfiguration_persistent_config);
+	CU_add_test(suite, "test_extconfiguration_cached_config", test_extconfiguration_cached_config);
+	CU_add_test(suite, "test_stdconfiguration_shared_config", test_stdconfiguration_shared_config);
+	CU_add_test(suite, "test_stdconfiguration_event_report_template",
+		    test_stdconfiguration_event_report_template);
 
 	/* Add tests here - End */
 }
@@ -276,6 +282,9 @@ void test_extconfiguration_persistent_config()
 
 	ext_configurations_destroy();
 
+	event_report_template_destroy(bp_std_config->event_report_template);
+	event_report_template_destroy(po_std_config->event_report_template);
+	event_report_template_destroy(glu_std_config->event_report_template);
 	free(bp_std_config);
 	free(po_std_config);
 	free(glu_std_config);
@@ -287,4 +296,164 @@ void test_extconfiguration_persistent_config()
 	free(glu_object_list);
 
 }
+
+void test_extconfiguration_cached_config()
+{
+	struct StdConfiguration *bp_std_config = blood_pressure_monitor_create_std_config_ID02BC();
+	ConfigObjectList *bp_object_list = bp_std_config->configure_action();
+
+	intu8 sys_id_buffer[] = {0x00, 0x22, 0x09, 0x22, 0x58, 0x08, 0x03, 0xcc};
+	octet_string sys_id;
+	sys_id.length = 8;
+	sys_id.value = sys_id_buffer;
+
+	ConfigObjectList *result;
+	int i;
+
+	ext_configurations_remove_all_configs();
+	ext_configurations_load_configurations();
+
+	// more configurations than the decoded cache holds
+	for (i = 0; i < 100; ++i) {
+		ext_configurations_register_conf(&sys_id, 0x4000 + i, bp_object_list);
+	}
+
+	for (i = 0; i < 100; ++i) {
+		CU_ASSERT(ext_configurations_is_supported_standard(&sys_id, 0x4000 + i));
+
+		result = ext_configurations_get_configuration_attributes(&sys_id, 0x4000 + i);
+		CU_ASSERT(result != NULL);
+
+		if (result == NULL) {
+			continue;
+		}
+
+		CU_ASSERT(result->count == bp_object_list->count);
+		CU_ASSERT(result->length == bp_object_list->length);
+		CU_ASSERT(result->value[0].attributes.count == bp_object_list->value[0].attributes.count);
+		CU_ASSERT(result->value[0].attributes.value[0].attribute_value.value !=
+			  bp_object_list->value[0].attributes.value[0].attribute_value.value);
+		del_configobjectlist(result);
+		free(result);
+	}
+
+	CU_ASSERT(!ext_configurations_is_supported_standard(&sys_id, 0x4000 + 100));
+
+	// cached copy is not affected by what the caller does with its copy
+	result = ext_configurations_get_configuration_attributes(&sys_id, 0x4063);
+	CU_ASSERT(result != NULL);
+	del_configobjectlist(result);
+	free(result);
+
+	result = ext_configurations_get_configuration_attributes(&sys_id, 0x4063);
+	CU_ASSERT(result != NULL);
+	CU_ASSERT(result->count == bp_object_list->count);
+	del_configobjectlist(result);
+	free(result);
+
+	// everything reaches the disk
+	ext_configurations_destroy();
+	ext_configurations_load_configurations();
+
+	for (i = 0; i < 100; ++i) {
+		result = ext_configurations_get_configuration_attributes(&sys_id, 0x4000 + i);
+		CU_ASSERT(result != NULL);
+
+		if (result != NULL) {
+			CU_ASSERT(result->length == bp_object_list->length);
+			del_configobjectlist(result);
+			free(result);
+		}
+	}
+
+	ext_configurations_remove_all_configs();
+
+	event_report_template_destroy(bp_std_config->event_report_template);
+	free(bp_std_config);
+	del_configobjectlist(bp_object_list);
+	free(bp_object_list);
+}
+void test_stdconfiguration_shared_config()
+{
+	struct StdConfiguration *po_std_config = pulse_oximeter_create_std_config_ID0190();
+	ConfigObjectList *built = po_std_config->configure_action();
+
+	std_configurations_register_conf(po_std_config);
+
+	// built once, same list for every caller
+	ConfigObjectList *shared = std_configurations_get_shared_configuration(0x0190);
+	CU_ASSERT_PTR_NOT_NULL(shared);
+	CU_ASSERT_PTR_EQUAL(shared, std_configurations_get_shared_configuration(0x0190));
+	CU_ASSERT_PTR_NULL(std_configurations_get_shared_configuration(0x02BC));
+
+	if (shared != NULL) {
+		ByteStreamWriter *shared_stream = byte_stream_writer_instance(shared->length + 4);
+		ByteStreamWriter *built_stream = byte_stream_writer_instance(built->length + 4);
+
+		encode_configobjectlist(shared_stream, shared);
+		encode_configobjectlist(built_stream, built);
+
+		CU_ASSERT_EQUAL(shared->count, built->count);
+		CU_ASSERT_EQUAL(shared_stream->size, built_stream->size);
+		CU_ASSERT(memcmp(shared_stream->buffer, built_stream->buffer,
+				 built_stream->size) == 0);
+
+		del_byte_stream_writer(shared_stream, 1);
+		del_byte_stream_writer(built_stream, 1);
+	}
+
+	// a copy still belongs to the caller
+	ConfigObjectList *copy = std_configurations_get_configuration_attributes(0x0190);
+	CU_ASSERT_PTR_NOT_NULL(copy);
+	CU_ASSERT(copy != shared);
+	del_configobjectlist(copy);
+	free(copy);
+
+	del_configobjectlist(built);
+	free(built);
+	std_configurations_destroy();
+}
+
+void test_stdconfiguration_event_report_template()
+{
+	// same octets the per-report encoders used to produce
+	intu8 expected[44] = {0xF0, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x24,
+			      0x00, 0x01, 0x00, 0x12, 0x00, 0x03, 0x00, 0x06,
+			      0x00, 0x78, 0x00, 0x50, 0xF3, 0xA5,
+			      0x20, 0x11, 0x12, 0x31, 0x23, 0x59, 0x58, 0x99,
+			      0x00, 0x02, 0x00, 0x0A, 0xFF, 0xE7,
+			      0x20, 0x11, 0x12, 0x31, 0x23, 0x59, 0x58, 0x99};
+	struct blood_pressure_event_report_data evtdata = {120, 80, 93.3, -2.5,
+							   20, 11, 12, 31, 23, 59, 58, 99};
+	struct StdConfiguration *bp_std_config = blood_pressure_monitor_create_std_config_ID02BC();
+
+	std_configurations_register_conf(bp_std_config);
+	CU_ASSERT_PTR_NOT_NULL(bp_std_config->event_report_template);
+
+	DATA_apdu *data = bp_std_config->event_report(bp_std_config, &evtdata);
+	EventReportArgumentSimple *evt = &data->message.u.roiv_cmipEventReport;
+
+	CU_ASSERT_EQUAL(data->invoke_id, 0xffff);
+	CU_ASSERT_EQUAL(data->message.choice, ROIV_CMIP_CONFIRMED_EVENT_REPORT_CHOSEN);
+	CU_ASSERT_EQUAL(data->message.length, 54);
+	CU_ASSERT_EQUAL(evt->event_type, MDC_NOTI_SCAN_REPORT_FIXED);
+	CU_ASSERT_EQUAL(evt->event_info.length, sizeof(expected));
+	CU_ASSERT(memcmp(evt->event_info.value, expected, sizeof(expected)) == 0);
+
+	// the template itself is left untouched by a report
+	evtdata.systolic = 110;
+	DATA_apdu *second = bp_std_config->event_report(bp_std_config, &evtdata);
+	Any *info = &second->message.u.roiv_cmipEventReport.event_info;
+	CU_ASSERT(memcmp(info->value, expected, 16) == 0);
+	CU_ASSERT_EQUAL(info->value[16], 0x00);
+	CU_ASSERT_EQUAL(info->value[17], 0x6E);
+	CU_ASSERT(memcmp(info->value + 18, expected + 18, sizeof(expected) - 18) == 0);
+
+	del_data_apdu(data);
+	free(data);
+	del_data_apdu(second);
+	free(second);
+	std_configurations_destroy();
+}
+
 #endif
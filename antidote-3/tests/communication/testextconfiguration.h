@@ -33,6 +33,9 @@
 
 void testextconfiguration_add_suite();
 void test_extconfiguration_persistent_config();
+void test_extconfiguration_cached_config();
+void test_stdconfiguration_shared_config();
+void test_stdconfiguration_event_report_template();
 
 #endif /* TEST_ENABLED */
 
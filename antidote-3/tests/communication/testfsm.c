@@ -91,9 +91,24 @@ void test_fsm()
 	fsm_process_evt(ctx, 3, NULL);
 	CU_ASSERT_EQUAL(fsm->state, 0);
 
+	// No rule for this event in current state
+	CU_ASSERT_EQUAL(fsm_process_evt(ctx, 2, NULL),
+			FSM_PROCESS_EVT_RESULT_NOT_PROCESSED);
+	CU_ASSERT_EQUAL(fsm->state, 0);
+
+	CU_ASSERT_EQUAL(fsm_process_evt(ctx, fsm_evt_size, NULL),
+			FSM_PROCESS_EVT_RESULT_NOT_PROCESSED);
+
 	fsm_set_manager_state_table(fsm);
 	CU_ASSERT_EQUAL(fsm->state, fsm_state_disconnected);
 
+	// Same rules share a single compiled table
+	FSM *other = fsm_instance();
+	fsm_set_manager_state_table(other);
+	CU_ASSERT_PTR_NOT_NULL(fsm->dispatch);
+	CU_ASSERT_PTR_EQUAL(fsm->dispatch, other->dispatch);
+	fsm_destroy(other);
+
 	context_remove(cid);
 }
 
@@ -60,6 +60,7 @@ void testservice_add_suite()
 
 	/* Add tests here - Start */
 	CU_add_test(suite, "test_service", test_service);
+	CU_add_test(suite, "test_service_pipelining", test_service_pipelining);
 
 	/* Add tests here - End */
 
@@ -76,6 +77,26 @@ void test_service_assert_request_retired(Context *ctx, InvokeIDType invoke_id)
 
 }
 
+APDU *test_service_new_get_apdu()
+{
+	APDU *apdu = calloc(1, sizeof(APDU));
+	apdu->choice = PRST_CHOSEN;
+	apdu->length = 14;
+	apdu->u.prst.length = 12;
+
+	DATA_apdu *data_apdu = calloc(1, sizeof(DATA_apdu));
+	data_apdu->invoke_id = 0;
+	data_apdu->message.choice = ROIV_CMIP_GET_CHOSEN;
+	data_apdu->message.length = 6;
+	data_apdu->message.u.roiv_cmipGet.obj_handle = 0;
+	data_apdu->message.u.roiv_cmipGet.attribute_id_list.count = 0;
+	data_apdu->message.u.roiv_cmipGet.attribute_id_list.length = 0;
+	data_apdu->message.u.roiv_cmipGet.attribute_id_list.value = NULL;
+
+	encode_set_data_apdu(&apdu->u.prst, data_apdu);
+	return apdu;
+}
+
 void test_service()
 {
 	manager_start();
@@ -87,22 +108,7 @@ void test_service()
 	int i = 0;
 
 	for (i = 0; i < size; ++i) {
-		APDU *apdu = calloc(1, sizeof(APDU));
-		apdu->choice = PRST_CHOSEN;
-		apdu->length = 14;
-		apdu->u.prst.length = 12;
-
-		DATA_apdu *data_apdu = calloc(1, sizeof(DATA_apdu));
-		data_apdu->invoke_id = 0;
-		data_apdu->message.choice = ROIV_CMIP_GET_CHOSEN;
-		data_apdu->message.length = 6;
-		data_apdu->message.u.roiv_cmipGet.obj_handle = 0;
-		data_apdu->message.u.roiv_cmipGet.attribute_id_list.count = 0;
-		data_apdu->message.u.roiv_cmipGet.attribute_id_list.length = 0;
-		data_apdu->message.u.roiv_cmipGet.attribute_id_list.value = NULL;
-
-		encode_set_data_apdu(&apdu->u.prst, data_apdu);
-		apdu_list[i] = apdu;
+		apdu_list[i] = test_service_new_get_apdu();
 	}
 
 	service_init(ctx);
@@ -168,5 +174,67 @@ void test_service()
 	manager_stop();
 }
 
+void test_service_pipelining()
+{
+	manager_start();
+
+	Context *ctx = context_get_and_lock(FUNC_TEST_SINGLE_CONTEXT);
+	timeout_callback no_timeout = NO_TIMEOUT;
+	DATA_apdu response_apdu;
+	Request *req[6];
+	int i;
+
+	service_init(ctx);
+	service_set_max_outstanding(ctx, 4);
+
+	for (i = 0; i < 6; ++i) {
+		req[i] = service_send_remote_operation_request(ctx,
+				test_service_new_get_apdu(), no_timeout, NULL);
+		CU_ASSERT_PTR_NOT_NULL(req[i]);
+	}
+
+	// only four requests on the wire
+	for (i = 0; i < 6; ++i) {
+		CU_ASSERT_EQUAL(req[i]->sent, i < 4);
+	}
+
+	CU_ASSERT_EQUAL(ctx->service->outstanding, 4);
+	CU_ASSERT_EQUAL(ctx->service->state, PROCESSING);
+
+	// out of order response makes room for next queued request
+	response_apdu.invoke_id = 2;
+	service_request_retired(ctx, &response_apdu);
+	CU_ASSERT_FALSE(service_is_id_valid(ctx, 2));
+	CU_ASSERT_TRUE(req[4]->sent);
+	CU_ASSERT_FALSE(req[5]->sent);
+	CU_ASSERT_EQUAL(service_get_current_invoke_id(ctx), 0);
+
+	// repeated response is ignored
+	service_request_retired(ctx, &response_apdu);
+	CU_ASSERT_EQUAL(ctx->service->outstanding, 4);
+
+	response_apdu.invoke_id = 0;
+	service_request_retired(ctx, &response_apdu);
+	CU_ASSERT_TRUE(req[5]->sent);
+	CU_ASSERT_EQUAL(service_get_current_invoke_id(ctx), 1);
+
+	response_apdu.invoke_id = 1;
+	service_request_retired(ctx, &response_apdu);
+	CU_ASSERT_EQUAL(service_get_current_invoke_id(ctx), 3);
+
+	for (i = 5; i >= 3; --i) {
+		response_apdu.invoke_id = i;
+		service_request_retired(ctx, &response_apdu);
+		CU_ASSERT_FALSE(service_is_id_valid(ctx, i));
+	}
+
+	CU_ASSERT_EQUAL(ctx->service->outstanding, 0);
+	CU_ASSERT_EQUAL(ctx->service->requests_count, 0);
+	CU_ASSERT_EQUAL(ctx->service->state, READY);
+
+	context_unlock(ctx);
+
+	manager_stop();
+}
 
 #endif
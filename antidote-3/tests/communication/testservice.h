@@ -35,6 +35,7 @@
 
 void testservice_add_suite();
 void test_service();
+void test_service_pipelining();
 
 #endif /* TEST_ENABLED */
 
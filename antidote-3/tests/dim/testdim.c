@@ -42,9 +42,17 @@
 #include "src/dim/pmsegment.h"
 #include "src/dim/enumeration.h"
 #include "src/dim/rtsa.h"
+#include "src/dim/dimutil.h"
+#include "src/api/data_encoder.h"
+#include "src/api/data_list.h"
+#include "src/api/xml_encoder.h"
+#include "src/util/bytelib.h"
+#include "src/manager_p.h"
+#include "src/communication/common/context.h"
 #include "testdim.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 int test_dim_init_suite(void)
 {
@@ -79,6 +87,15 @@ void testdim_add_suite()
 	CU_add_test(suite, "test_dim_metric_initialization",
 		    test_dim_metric_initialization);
 
+	CU_add_test(suite, "test_dim_fixed_decode_plan",
+		    test_dim_fixed_decode_plan);
+	CU_add_test(suite, "test_dim_rtsa_samples",
+		    test_dim_rtsa_samples);
+	CU_add_test(suite, "test_dim_observation_records",
+		    test_dim_observation_records);
+	CU_add_test(suite, "test_dim_scan_report_notifications",
+		    test_dim_scan_report_notifications);
+
 
 	/* Add tests here - End */
 
@@ -208,4 +225,314 @@ void test_dim_metric_initialization(void)
 	free(metric);
 }
 
+static struct MDS_object test_dim_numeric_object(ASN1_HANDLE handle)
+{
+	struct MDS_object object;
+	struct Metric *metric = metric_instance();
+	struct Numeric *numeric = numeric_instance(metric);
+	AttrValMap *val_map;
+
+	object.choice = MDS_OBJ_METRIC;
+	object.obj_handle = handle;
+	object.u.metric.choice = METRIC_NUMERIC;
+	object.u.metric.u.numeric = *numeric;
+	object.u.metric.u.numeric.metric.handle = handle;
+	object.u.metric.u.numeric.metric.unit_code = MDC_DIM_BEAT_PER_MIN;
+
+	val_map = &object.u.metric.u.numeric.metric.attribute_value_map;
+	val_map->count = 4;
+	val_map->length = 16;
+	val_map->value = calloc(4, sizeof(AttrValMapEntry));
+	val_map->value[0].attribute_id = MDC_ATTR_NU_VAL_OBS_BASIC;
+	val_map->value[0].attribute_len = 2;
+	val_map->value[1].attribute_id = MDC_ATTR_TIME_STAMP_ABS;
+	val_map->value[1].attribute_len = 8;
+	val_map->value[2].attribute_id = MDC_ATTR_MSMT_STAT;
+	val_map->value[2].attribute_len = 2;
+	// not decoded in place
+	val_map->value[3].attribute_id = MDC_ATTR_UNIT_CODE;
+	val_map->value[3].attribute_len = 2;
+
+	free(numeric);
+	free(metric);
+
+	return object;
+}
+
+void test_dim_fixed_decode_plan(void)
+{
+	intu8 data[] = {0x00, 0x50,
+			0x20, 0x07, 0x12, 0x06, 0x12, 0x10, 0x00, 0x00,
+			0x40, 0x00,
+			0x0A, 0xA0
+		       };
+	ObservationScanFixed obs = {7, {sizeof(data), data}};
+	MDS *mds = mds_create();
+	int j;
+
+	mds_add_object(mds, test_dim_numeric_object(7));
+
+	struct MDS_object *object = mds_get_object_by_handle(mds, 7);
+	struct Numeric *numeric = &object->u.metric.u.numeric;
+	dimutil_compile_decode_plan(&object->u.metric);
+
+	DimDecodePlan *plan = numeric->metric.decode_plan;
+	CU_ASSERT_PTR_NOT_NULL(plan);
+	CU_ASSERT_EQUAL(plan->count, 4);
+	CU_ASSERT_EQUAL(plan->size, sizeof(data));
+	CU_ASSERT_EQUAL(plan->ops[0].type, DIM_OP_SFLOAT);
+	CU_ASSERT_EQUAL(plan->ops[1].type, DIM_OP_ABSOLUTE_TIME);
+	CU_ASSERT_EQUAL(plan->ops[1].offset, 2);
+	CU_ASSERT_EQUAL(plan->ops[2].type, DIM_OP_INTU16);
+	CU_ASSERT_EQUAL(plan->ops[3].type, DIM_OP_GENERIC);
+
+	DataList *list = data_list_new(1);
+	dimutil_update_mds_from_obs_scan_fixed(mds, &obs, &list->values[0]);
+
+	CU_ASSERT_DOUBLE_EQUAL(numeric->basic_nu_observed_value, 80, 0.001);
+	CU_ASSERT_EQUAL(numeric->metric.absolute_time_stamp.year, 0x07);
+	CU_ASSERT_EQUAL(numeric->metric.absolute_time_stamp.minute, 0x10);
+	CU_ASSERT_EQUAL(numeric->metric.measurement_status, 0x4000);
+	CU_ASSERT_EQUAL(numeric->metric.unit_code, MDC_DIM_BEAT_PER_MIN);
+
+	// same DataEntry as decoding attribute by attribute
+	struct MDS_object reference = test_dim_numeric_object(7);
+	AttrValMap *val_map = &reference.u.metric.u.numeric.metric.attribute_value_map;
+	DataList *expected = data_list_new(1);
+	CompoundDataEntry *cmp_entry = &expected->values[0].u.compound;
+	ByteStreamReader stream;
+
+	byte_stream_reader_init(&stream, data, sizeof(data));
+	expected->values[0].choice = COMPOUND_DATA_ENTRY;
+	data_meta_set_handle(&expected->values[0], 7);
+	cmp_entry->name = data_strcp("Numeric");
+	cmp_entry->entries_count = val_map->count;
+	cmp_entry->entries = calloc(val_map->count, sizeof(DataEntry));
+
+	for (j = 0; j < val_map->count; ++j) {
+		dimutil_fill_numeric_attr(&reference.u.metric.u.numeric,
+					  val_map->value[j].attribute_id,
+					  &stream, &cmp_entry->entries[j]);
+	}
+
+	char *xml = xml_encode_data_list(list);
+	char *expected_xml = xml_encode_data_list(expected);
+	CU_ASSERT_STRING_EQUAL(xml, expected_xml);
+
+	// a new Attribute-Value-Map drops the plan
+	intu8 map[] = {0x00, 0x01, 0x00, 0x04, 0x09, 0x50, 0x00, 0x02};
+	byte_stream_reader_init(&stream, map, sizeof(map));
+	CU_ASSERT(dimutil_fill_numeric_attr(numeric, MDC_ATTR_ATTRIBUTE_VAL_MAP, &stream, NULL));
+	CU_ASSERT_PTR_NULL(numeric->metric.decode_plan);
+
+	free(xml);
+	free(expected_xml);
+	data_list_del(list);
+	data_list_del(expected);
+	numeric_destroy(&reference.u.metric.u.numeric);
+	mds_destroy(mds);
+}
+
+void test_dim_rtsa_samples(void)
+{
+	// -1000, 1000, 0, 500, -500, 100, 200, 300, 1
+	intu8 data[] = {0x00, 0x12,
+			0xFC, 0x18, 0x03, 0xE8, 0x00, 0x00, 0x01, 0xF4, 0xFE, 0x0C,
+			0x00, 0x64, 0x00, 0xC8, 0x01, 0x2C, 0x00, 0x01
+		       };
+	float expected[] = {-10, 10, 0, 5, -5, 1, 2, 3, 0.01};
+	struct RTSA rtsa;
+	ByteStreamReader stream;
+	int count;
+	int i;
+
+	memset(&rtsa, 0, sizeof(struct RTSA));
+	rtsa.sa_specification.array_size = 9;
+	rtsa.sa_specification.sample_type.sample_size = 16;
+	rtsa.sa_specification.sample_type.significant_bits =
+		SAMPLE_TYPE_SIGNIFICANT_BITS_SIGNED_SAMPLES;
+	rtsa.scale_and_range_specification_16.lower_absolute_value = -10;
+	rtsa.scale_and_range_specification_16.upper_absolute_value = 10;
+	rtsa.scale_and_range_specification_16.lower_scaled_value = 0xFC18;
+	rtsa.scale_and_range_specification_16.upper_scaled_value = 1000;
+
+	DataEntry entry;
+	memset(&entry, 0, sizeof(DataEntry));
+	byte_stream_reader_init(&stream, data, sizeof(data));
+	CU_ASSERT(dimutil_fill_rtsa_attr(&rtsa, MDC_ATTR_SIMP_SA_OBS_VAL,
+					 &stream, &entry));
+	CU_ASSERT_EQUAL(entry.choice, ARRAY_DATA_ENTRY);
+	CU_ASSERT_EQUAL(entry.u.array.count, 9);
+	CU_ASSERT_STRING_EQUAL(entry.u.array.type, APIDEF_TYPE_FLOAT);
+
+	for (i = 0; i < entry.u.array.count; ++i) {
+		CU_ASSERT_DOUBLE_EQUAL(entry.u.array.values[i], expected[i], 0.0001);
+	}
+
+	DataList *list = data_list_new(1);
+	list->values[0] = entry;
+	char *xml = xml_encode_data_list(list);
+	CU_ASSERT_PTR_NOT_NULL(strstr(xml, "<array><name>Simple-Sa-Observed-Value</name>"
+				      "<type>float</type><values>-10.000000 10.000000 "));
+	free(xml);
+	data_list_del(list);
+
+	// unsigned, 12 significant bits out of 16
+	rtsa.sa_specification.sample_type.significant_bits = 12;
+	rtsa.scale_and_range_specification_16.lower_absolute_value = 0;
+	rtsa.scale_and_range_specification_16.upper_absolute_value = 4095;
+	rtsa.scale_and_range_specification_16.lower_scaled_value = 0;
+	rtsa.scale_and_range_specification_16.upper_scaled_value = 4095;
+
+	float *samples = rtsa_get_samples(&rtsa, &count);
+	CU_ASSERT_PTR_NOT_NULL(samples);
+	CU_ASSERT_EQUAL(count, 9);
+	CU_ASSERT_DOUBLE_EQUAL(samples[0], 0xC18, 0.0001);
+	CU_ASSERT_DOUBLE_EQUAL(samples[1], 1000, 0.0001);
+	CU_ASSERT_DOUBLE_EQUAL(samples[4], 0xE0C, 0.0001);
+	free(samples);
+
+	// sample size without Scale-and-Range-Specification
+	rtsa.sa_specification.sample_type.sample_size = 12;
+	CU_ASSERT_PTR_NULL(rtsa_get_samples(&rtsa, &count));
+	CU_ASSERT_EQUAL(count, 0);
+
+	rtsa_destroy(&rtsa);
+}
+
+void test_dim_observation_records(void)
+{
+	intu8 data[] = {0x00, 0x50,
+			0x20, 0x07, 0x12, 0x06, 0x12, 0x10, 0x00, 0x00,
+			0x40, 0x00,
+			0x0A, 0xA0
+		       };
+	ObservationScanFixed obs = {7, {sizeof(data), data}};
+	ObservationList list = {0, 0, NULL};
+	MDS *mds = mds_create();
+
+	mds_add_object(mds, test_dim_numeric_object(7));
+
+	struct MDS_object *object = mds_get_object_by_handle(mds, 7);
+	object->u.metric.u.numeric.metric.type.code = MDC_TEMP_BODY;
+
+	DataList *data_list = data_list_new(1);
+	dimutil_update_mds_from_obs_scan_fixed(mds, &obs, &data_list->values[0]);
+	dimutil_add_obs_scan_fixed_observations(mds, &obs, &list);
+
+	CU_ASSERT_EQUAL(list.count, 1);
+	ObservationRecord *record = &list.records[0];
+	CU_ASSERT_EQUAL(record->handle, 7);
+	CU_ASSERT_EQUAL(record->metric_id, MDC_TEMP_BODY);
+	CU_ASSERT_EQUAL(record->unit_code, MDC_DIM_BEAT_PER_MIN);
+	CU_ASSERT_EQUAL(record->measurement_status, 0x4000);
+	CU_ASSERT_EQUAL(record->type, OBSERVATION_VALUE_FLOAT);
+	CU_ASSERT_DOUBLE_EQUAL(record->u.float_value, 80, 0.001);
+	CU_ASSERT_EQUAL(record->flags, OBSERVATION_FLAG_ABSOLUTE_TIME);
+	CU_ASSERT_EQUAL(record->absolute_time.year, 2007);
+	CU_ASSERT_EQUAL(record->absolute_time.month, 12);
+	CU_ASSERT_EQUAL(record->absolute_time.day, 6);
+	CU_ASSERT_EQUAL(record->absolute_time.hour, 12);
+	CU_ASSERT_EQUAL(record->absolute_time.minute, 10);
+
+	// records of a second person are appended after the first ones
+	dimutil_add_obs_scan_fixed_observations(mds, &obs, &list);
+	dimutil_set_observations_person_id(&list, 1, 2);
+	CU_ASSERT_EQUAL(list.count, 2);
+	CU_ASSERT_EQUAL(list.records[0].flags, OBSERVATION_FLAG_ABSOLUTE_TIME);
+	CU_ASSERT_EQUAL(list.records[1].flags,
+			OBSERVATION_FLAG_ABSOLUTE_TIME | OBSERVATION_FLAG_PERSON_ID);
+	CU_ASSERT_EQUAL(list.records[1].person_id, 2);
+
+	// unknown handles add nothing
+	obs.obj_handle = 8;
+	dimutil_add_obs_scan_fixed_observations(mds, &obs, &list);
+	CU_ASSERT_EQUAL(list.count, 2);
+
+	observation_list_clear(&list);
+	CU_ASSERT_EQUAL(list.count, 0);
+	CU_ASSERT_PTR_NULL(list.records);
+
+	data_list_del(data_list);
+	mds_destroy(mds);
+}
+
+static int notification_count = 0;
+static int notified_entries = 0;
+static int notified_person_ids = 0;
+
+static void count_measurement_data(Context *ctx, DataList *list)
+{
+	int i;
+
+	++notification_count;
+	notified_entries += list->size;
+
+	for (i = 0; i < list->size; ++i) {
+		MetaData *meta = &list->values[i].meta_data;
+
+		notified_person_ids += meta->size > 0 &&
+				       strcmp(meta->values[0].name, "personal-id") == 0;
+	}
+}
+
+void test_dim_scan_report_notifications(void)
+{
+	intu8 data[] = {0x00, 0x50,
+			0x20, 0x07, 0x12, 0x06, 0x12, 0x10, 0x00, 0x00,
+			0x40, 0x00,
+			0x0A, 0xA0
+		       };
+	ManagerListener listener = MANAGER_LISTENER_EMPTY;
+	MDS *mds = mds_create();
+	Context ctx;
+
+	memset(&ctx, 0, sizeof(Context));
+	ctx.mds = mds;
+	mds_add_object(mds, test_dim_numeric_object(7));
+
+	listener.measurement_data_updated = &count_measurement_data;
+	manager_add_listener(listener);
+
+	// two persons, two observations each
+	ObservationScanFixed obs[] = {{7, {sizeof(data), data}},
+				      {7, {sizeof(data), data}}};
+	ScanReportPerFixed persons[] = {{1, {2, 0, obs}}, {2, {2, 0, obs}}};
+	ScanReportInfoMPFixed mp_fixed = {0, 0, {2, 0, persons}};
+
+	mds_event_report_dynamic_data_update_mp_fixed(&ctx, &mp_fixed);
+	CU_ASSERT_EQUAL(notification_count, 1);
+	CU_ASSERT_EQUAL(notified_entries, 4);
+	CU_ASSERT_EQUAL(notified_person_ids, 4);
+
+	// three grouped observations of one object
+	struct MDS_object *object = mds_get_object_by_handle(mds, 7);
+	HandleAttrValMapEntry map_entry = {7,
+		object->u.metric.u.numeric.metric.attribute_value_map};
+	struct PeriCfgScanner scanner;
+	ObservationScanGrouped grouped[] = {{sizeof(data), data},
+					    {sizeof(data), data},
+					    {sizeof(data), data}};
+	ScanReportInfoGrouped report = {0, 0, {3, 0, grouped}};
+
+	memset(&scanner, 0, sizeof(struct PeriCfgScanner));
+	scanner.scanner.scanner.scan_handle_attr_val_map.count = 1;
+	scanner.scanner.scanner.scan_handle_attr_val_map.value = &map_entry;
+
+	notification_count = 0;
+	notified_entries = 0;
+	peri_cfg_scanner_event_report_buf_scan_report_grouped(&ctx, &scanner, &report);
+	CU_ASSERT_EQUAL(notification_count, 1);
+	CU_ASSERT_EQUAL(notified_entries, 3);
+
+	// nothing to report, no notification
+	report.obs_scan_grouped.count = 0;
+	notification_count = 0;
+	peri_cfg_scanner_event_report_buf_scan_report_grouped(&ctx, &scanner, &report);
+	CU_ASSERT_EQUAL(notification_count, 0);
+
+	manager_remove_all_listeners();
+	mds_destroy(mds);
+}
+
 #endif
@@ -43,4 +43,9 @@ void test_dim_scanner_initialization(void);
 
 void test_dim_metric_initialization(void);
 
+void test_dim_fixed_decode_plan(void);
+void test_dim_rtsa_samples(void);
+void test_dim_observation_records(void);
+void test_dim_scan_report_notifications(void);
+
 #endif
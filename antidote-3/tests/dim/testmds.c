@@ -30,8 +30,17 @@
 #include "Basic.h"
 #include "src/asn1/phd_types.h"
 #include "src/dim/mds.h"
+#include "src/dim/dimutil.h"
+#include "src/dim/metric.h"
+#include "src/dim/nomenclature.h"
+#include "src/dim/numeric.h"
+#include "src/communication/common/context.h"
+#include "src/communication/common/service.h"
+#include "src/communication/parser/struct_cleaner.h"
+#include "src/util/bytelib.h"
 #include "testmds.h"
 #include <stdlib.h>
+#include <string.h>
 
 int test_mds_init_suite(void)
 {
@@ -51,6 +60,10 @@ void testmds_add_suite()
 	/* Add tests here - Start */
 	CU_add_test(suite, "test_mds_is_supported_data_request",
 		    test_mds_is_supported_data_request);
+	CU_add_test(suite, "test_mds_get_object_by_handle",
+		    test_mds_get_object_by_handle);
+	CU_add_test(suite, "test_mds_shared_template",
+		    test_mds_shared_template);
 	/* Add tests here - End */
 
 }
@@ -89,4 +102,178 @@ void test_mds_is_supported_data_request(void)
 	mds_destroy(mds);
 }
 
+static void add_numeric(MDS *mds, ASN1_HANDLE handle)
+{
+	struct MDS_object object;
+	struct Metric *metric = metric_instance();
+	struct Numeric *numeric = numeric_instance(metric);
+
+	object.choice = MDS_OBJ_METRIC;
+	object.obj_handle = handle;
+	object.u.metric.choice = METRIC_NUMERIC;
+	object.u.metric.u.numeric = *numeric;
+	object.u.metric.u.numeric.metric.handle = handle;
+
+	free(numeric);
+	free(metric);
+
+	mds_add_object(mds, object);
+}
+
+void test_mds_get_object_by_handle(void)
+{
+	MDS *mds = mds_create();
+	int i;
+
+	CU_ASSERT_PTR_NULL(mds_get_object_by_handle(mds, 1));
+
+	// more objects than the initial table, sparse and colliding handles
+	for (i = 1; i <= 40; ++i) {
+		add_numeric(mds, i * 1024);
+	}
+
+	CU_ASSERT_EQUAL(mds->objects_list_count, 40);
+
+	for (i = 1; i <= 40; ++i) {
+		struct MDS_object *object = mds_get_object_by_handle(mds, i * 1024);
+		CU_ASSERT_PTR_NOT_NULL(object);
+		CU_ASSERT_PTR_EQUAL(object, &mds->objects_list[i - 1]);
+	}
+
+	CU_ASSERT_PTR_NOT_NULL(mds->handle_table);
+	CU_ASSERT_PTR_NULL(mds_get_object_by_handle(mds, 1));
+	CU_ASSERT_PTR_NULL(mds_get_object_by_handle(mds, 1025));
+
+	// adding an object drops the table, next lookup indexes it
+	add_numeric(mds, 3);
+	CU_ASSERT_PTR_NULL(mds->handle_table);
+	CU_ASSERT_PTR_EQUAL(mds_get_object_by_handle(mds, 3), &mds->objects_list[40]);
+	CU_ASSERT_PTR_EQUAL(mds_get_object_by_handle(mds, 1024), &mds->objects_list[0]);
+
+	mds_destroy(mds);
+}
+
+static intu8 *copy_bytes(const intu8 *bytes, int length)
+{
+	intu8 *copy = malloc(length);
+	memcpy(copy, bytes, length);
+	return copy;
+}
+
+static ConfigObjectList *new_numeric_config(ASN1_HANDLE handle)
+{
+	intu8 type[] = {0x00, 0x02, 0x4B, 0x5C};
+	intu8 val_map[] = {0x00, 0x01, 0x00, 0x04, 0x0A, 0x4C, 0x00, 0x02};
+	ConfigObjectList *list = calloc(1, sizeof(ConfigObjectList));
+	ConfigObject *object;
+
+	list->count = 1;
+	list->value = calloc(1, sizeof(ConfigObject));
+	object = &list->value[0];
+	object->obj_class = MDC_MOC_VMO_METRIC_NU;
+	object->obj_handle = handle;
+	object->attributes.count = 2;
+	object->attributes.value = calloc(2, sizeof(AVA_Type));
+	object->attributes.value[0].attribute_id = MDC_ATTR_ID_TYPE;
+	object->attributes.value[0].attribute_value.length = sizeof(type);
+	object->attributes.value[0].attribute_value.value = copy_bytes(type, sizeof(type));
+	object->attributes.value[1].attribute_id = MDC_ATTR_ATTRIBUTE_VAL_MAP;
+	object->attributes.value[1].attribute_value.length = sizeof(val_map);
+	object->attributes.value[1].attribute_value.value = copy_bytes(val_map, sizeof(val_map));
+
+	return list;
+}
+
+static struct Numeric *configure_numeric(Context *ctx, intu8 *system_id)
+{
+	ConfigObjectList *list = new_numeric_config(1);
+
+	memset(ctx, 0, sizeof(Context));
+	ctx->mds = mds_create();
+	ctx->mds->dev_configuration_id = 0x4000;
+	ctx->mds->system_id.length = 8;
+	ctx->mds->system_id.value = copy_bytes(system_id, 8);
+
+	mds_configure_operating(ctx, list, 1);
+	free(list);
+
+	return &mds_get_object_by_handle(ctx->mds, 1)->u.metric.u.numeric;
+}
+
+void test_mds_shared_template(void)
+{
+	intu8 system_id[] = {1, 2, 3, 4, 5, 6, 7, 8};
+	intu8 other_system_id[] = {8, 7, 6, 5, 4, 3, 2, 1};
+	intu8 value[] = {0x00, 0x50};
+	intu8 val_map[] = {0x00, 0x01, 0x00, 0x04, 0x09, 0x50, 0x00, 0x02};
+	ByteStreamReader stream;
+	Context ctx1;
+	Context ctx2;
+	Context ctx3;
+
+	struct Numeric *numeric1 = configure_numeric(&ctx1, system_id);
+	struct Numeric *numeric2 = configure_numeric(&ctx2, system_id);
+	struct Numeric *numeric3 = configure_numeric(&ctx3, other_system_id);
+	MDSTemplate *config_template = ctx1.mds->config_template;
+
+	// same extended configuration of the same agent, one template
+	CU_ASSERT_PTR_NOT_NULL(config_template);
+	CU_ASSERT_PTR_EQUAL(ctx2.mds->config_template, config_template);
+	CU_ASSERT_PTR_NOT_EQUAL(ctx3.mds->config_template, config_template);
+	CU_ASSERT_PTR_NOT_EQUAL(numeric3->metric.attribute_value_map.value,
+				numeric1->metric.attribute_value_map.value);
+	CU_ASSERT_EQUAL(config_template->refcount, 3);
+	CU_ASSERT_EQUAL(config_template->objects_count, 1);
+
+	CU_ASSERT(numeric1->metric.shared_config);
+	CU_ASSERT_EQUAL(numeric1->metric.type.code, 0x4B5C);
+	CU_ASSERT_PTR_EQUAL(numeric1->metric.attribute_value_map.value,
+			    numeric2->metric.attribute_value_map.value);
+	CU_ASSERT_PTR_NOT_NULL(numeric1->metric.decode_plan);
+	CU_ASSERT_PTR_EQUAL(numeric1->metric.decode_plan,
+			    numeric2->metric.decode_plan);
+
+	// observed values stay private and keep the object shared
+	byte_stream_reader_init(&stream, value, sizeof(value));
+	CU_ASSERT(dimutil_fill_numeric_attr(numeric1, MDC_ATTR_NU_VAL_OBS_BASIC,
+					    &stream, NULL));
+	CU_ASSERT_DOUBLE_EQUAL(numeric1->basic_nu_observed_value, 80, 0.001);
+	CU_ASSERT_DOUBLE_EQUAL(numeric2->basic_nu_observed_value, 0, 0.001);
+	CU_ASSERT(numeric1->metric.shared_config);
+
+	// changing a static attribute copies it first
+	byte_stream_reader_init(&stream, val_map, sizeof(val_map));
+	CU_ASSERT(dimutil_fill_numeric_attr(numeric2, MDC_ATTR_ATTRIBUTE_VAL_MAP,
+					    &stream, NULL));
+	CU_ASSERT_FALSE(numeric2->metric.shared_config);
+	CU_ASSERT_EQUAL(numeric2->metric.attribute_value_map.value[0].attribute_id, 0x0950);
+	CU_ASSERT_EQUAL(numeric1->metric.attribute_value_map.value[0].attribute_id,
+			MDC_ATTR_NU_VAL_OBS_BASIC);
+	CU_ASSERT_PTR_EQUAL(numeric1->metric.attribute_value_map.value,
+			    config_template->objects[0].u.metric.u.numeric.metric.attribute_value_map.value);
+
+	// invalidated templates live on while in use
+	mds_template_invalidate(0x4000, &ctx1.mds->system_id);
+	CU_ASSERT_EQUAL(config_template->refcount, 2);
+
+	ConfigObjectList *list = new_numeric_config(1);
+	MDSTemplate *rebuilt = mds_template_acquire(0x4000, &ctx1.mds->system_id, list);
+	CU_ASSERT_PTR_NOT_EQUAL(rebuilt, config_template);
+	mds_template_release(rebuilt);
+	del_configobjectlist(list);
+	free(list);
+
+	mds_destroy(ctx2.mds);
+	CU_ASSERT_EQUAL(config_template->refcount, 1);
+	CU_ASSERT_EQUAL(numeric1->metric.attribute_value_map.count, 1);
+	mds_destroy(ctx1.mds);
+	mds_destroy(ctx3.mds);
+
+	service_destroy(ctx1.service);
+	service_destroy(ctx2.service);
+	service_destroy(ctx3.service);
+
+	mds_template_invalidate(0, NULL);
+}
+
 #endif
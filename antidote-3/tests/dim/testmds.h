@@ -31,4 +31,8 @@ void testmds_add_suite(void);
 
 void test_mds_is_supported_data_request(void);
 
+void test_mds_get_object_by_handle(void);
+
+void test_mds_shared_template(void);
+
 #endif
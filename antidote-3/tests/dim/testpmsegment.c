@@ -30,6 +30,7 @@
 
 #include "testpmsegment.h"
 #include "Basic.h"
+#include "src/dim/pmsegment.h"
 #include <stdio.h>
 
 int testpmsegment_init_suite(void)
@@ -48,6 +49,7 @@ void testpmsegment_add_suite()
 
 	/* Add tests here - Start */
 	CU_add_test(suite, "test_pmsegment_test1", test_pmsegment_test1);
+	CU_add_test(suite, "test_pmsegment_chunked_data", test_pmsegment_chunked_data);
 
 	/* Add tests here - End */
 }
@@ -56,4 +58,71 @@ void test_pmsegment_test1(void)
 {
 }
 
+void test_pmsegment_chunked_data(void)
+{
+	struct PMSegment *segment = pmsegment_instance(1);
+	intu8 event_data[7 * 37];
+	intu8 scratch[7];
+	ChunkBufferCursor cursor;
+	int entries = 0;
+	int copied = 0;
+	int i;
+	int j;
+
+	// entries of 7 bytes, 37 entries per segment data event
+	while (entries < 3000) {
+		for (i = 0; i < 37; ++i) {
+			for (j = 0; j < 7; ++j) {
+				event_data[i * 7 + j] = (intu8) (entries + i + j);
+			}
+		}
+
+		CU_ASSERT_EQUAL(chunkbuff_append(&segment->fixed_segment_data,
+						 event_data, sizeof(event_data)), 1);
+		entries += 37;
+	}
+
+	CU_ASSERT_EQUAL(segment->fixed_segment_data.length, (intu32) entries * 7);
+	CU_ASSERT(segment->fixed_segment_data.first != segment->fixed_segment_data.last);
+
+	chunkbuff_cursor_init(&segment->fixed_segment_data, &cursor);
+
+	for (i = 0; i < entries; ++i) {
+		intu8 *entry = chunkbuff_read(&cursor, 7, scratch);
+		int ok = 1;
+
+		CU_ASSERT_PTR_NOT_NULL(entry);
+
+		if (entry == NULL) {
+			break;
+		}
+
+		for (j = 0; j < 7; ++j) {
+			ok &= entry[j] == (intu8) (i + j);
+		}
+
+		CU_ASSERT(ok);
+		copied += entry == scratch;
+	}
+
+	// only entries crossing a chunk boundary are copied
+	CU_ASSERT(copied > 0);
+	CU_ASSERT(copied <= (entries * 7) / CHUNKBUFF_CHUNK_SIZE);
+	CU_ASSERT_PTR_NULL(chunkbuff_read(&cursor, 1, scratch));
+
+	segment->empiric_usage_count = entries;
+	pmsegment_remove_all_entries(segment);
+	CU_ASSERT_EQUAL(segment->empiric_usage_count, 0);
+	CU_ASSERT_EQUAL(segment->fixed_segment_data.length, 0);
+	CU_ASSERT_PTR_NULL(segment->fixed_segment_data.first);
+
+	// chunks are reused
+	CU_ASSERT_EQUAL(chunkbuff_append(&segment->fixed_segment_data, event_data, 7), 1);
+	CU_ASSERT_EQUAL(segment->fixed_segment_data.length, 7);
+
+	pmsegment_destroy(segment);
+	free(segment);
+	chunkbuff_pool_release();
+}
+
 #endif
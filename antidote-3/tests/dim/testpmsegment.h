@@ -30,5 +30,6 @@
 
 void testpmsegment_add_suite(void);
 void test_pmsegment_test1(void);
+void test_pmsegment_chunked_data(void);
 
 #endif /* PMSEGMENT_H_ */
@@ -36,8 +36,17 @@
 #include "src/dim/pmstore.h"
 #include "src/dim/pmstore.h"
 #include "src/dim/pmsegment.h"
+#include "src/dim/mds.h"
+#include "src/dim/nomenclature.h"
+#include "src/communication/common/context.h"
+#include "src/api/data_list.h"
+#include "src/manager_p.h"
+#include "src/communication/common/fsm.h"
+#include "src/communication/manager/manager_operating.h"
 #include "testdateutil.h"
 #include "src/util/dateutil.h"
+#include <stdio.h>
+#include <string.h>
 
 int testpmstore_init_suite(void)
 {
@@ -61,6 +70,15 @@ void testpmstore_add_suite()
 	CU_add_test(suite, "test_pmstore_date_selection",
 		    test_pmstore_date_selection);
 
+	CU_add_test(suite, "test_pmstore_segment_data_event",
+		    test_pmstore_segment_data_event);
+
+	CU_add_test(suite, "test_pmstore_segment_data_large",
+		    test_pmstore_segment_data_large);
+
+	CU_add_test(suite, "test_pmstore_segment_data_stream",
+		    test_pmstore_segment_data_stream);
+
 	/* Add tests here - End */
 
 }
@@ -259,4 +277,324 @@ void test_pmstore_date_selection(void)
 
 }
 
+static DataList *received_segment_data = NULL;
+
+static void segment_data_received(Context *ctx, int handle, int instnumber,
+				  DataList *data_list)
+{
+	received_segment_data = data_list;
+}
+
+static int batch_count = 0;
+static int batch_entries = 0;
+static int batch_max = 0;
+static int batch_last = 0;
+static int batch_ok = 1;
+static int batch_resume = 0;
+
+static int segment_data_batch_received(Context *ctx, int handle, int instnumber,
+				       intu32 first_entry, int last, DataList *data_list)
+{
+	DataEntry *segm_entry = &data_list->values[0];
+	int i;
+
+	batch_ok &= handle == 10 && instnumber == 7;
+	batch_ok &= first_entry == (intu32) batch_entries;
+	batch_ok &= !batch_last;
+
+	for (i = 0; i < segm_entry->u.compound.entries_count; ++i) {
+		DataEntry *header = &segm_entry->u.compound.entries[i].u.compound.entries[0];
+		char rel_time[16];
+
+		sprintf(rel_time, "%d", batch_entries + i);
+		batch_ok &= strcmp(header->u.compound.entries[0].u.simple.value,
+				   rel_time) == 0;
+	}
+
+	if (segm_entry->u.compound.entries_count > batch_max) {
+		batch_max = segm_entry->u.compound.entries_count;
+	}
+
+	batch_entries += segm_entry->u.compound.entries_count;
+	batch_last = last;
+	data_list_del(data_list);
+
+	if (batch_resume) {
+		// application catches up before returning
+		operating_resume_segment_data(ctx, handle);
+		return 0;
+	}
+
+	// the first batch finds the application busy
+	return batch_count++ > 0;
+}
+
+/**
+ * Creates a MDS with a numeric (handle 1) and a PM-Store (handle 10)
+ * holding segment 7, whose entries have 6 bytes: relative time
+ * and basic numeric value
+ */
+static struct PMStore *new_segment_store(MDS *mds)
+{
+	struct Metric *metric = metric_instance();
+	struct Numeric *numeric = numeric_instance(metric);
+	struct PMStore *pmstore = pmstore_instance();
+	struct PMSegment *segment = pmsegment_instance(7);
+	struct MDS_object object;
+
+	object.choice = MDS_OBJ_METRIC;
+	object.obj_handle = 1;
+	object.u.metric.choice = METRIC_NUMERIC;
+	object.u.metric.u.numeric = *numeric;
+	object.u.metric.u.numeric.metric.handle = 1;
+	mds_add_object(mds, object);
+	free(numeric);
+	free(metric);
+
+	PmSegmentEntryMap *map = &segment->pm_segment_entry_map;
+	map->segm_entry_header = SEG_ELEM_HDR_RELATIVE_TIME;
+	map->segm_entry_elem_list.count = 1;
+	map->segm_entry_elem_list.length = 12;
+	map->segm_entry_elem_list.value = calloc(1, sizeof(SegmEntryElem));
+	map->segm_entry_elem_list.value[0].class_id = MDC_MOC_VMO_METRIC_NU;
+	map->segm_entry_elem_list.value[0].handle = 1;
+	map->segm_entry_elem_list.value[0].attr_val_map.count = 1;
+	map->segm_entry_elem_list.value[0].attr_val_map.length = 4;
+	map->segm_entry_elem_list.value[0].attr_val_map.value =
+		calloc(1, sizeof(AttrValMapEntry));
+	map->segm_entry_elem_list.value[0].attr_val_map.value[0].attribute_id =
+		MDC_ATTR_NU_VAL_OBS_BASIC;
+	map->segm_entry_elem_list.value[0].attr_val_map.value[0].attribute_len = 2;
+
+	pmstore->handle = 10;
+	pmstore_add_segment(pmstore, segment);
+
+	object.choice = MDS_OBJ_PMSTORE;
+	object.obj_handle = 10;
+	object.u.pmstore = *pmstore;
+	mds_add_object(mds, object);
+	free(pmstore);
+
+	return &mds_get_object_by_handle(mds, 10)->u.pmstore;
+}
+
+static void fill_segment_entries(intu8 *buffer, int first_entry, int count)
+{
+	int i;
+
+	for (i = 0; i < count; ++i) {
+		intu8 *entry = &buffer[i * 6];
+		intu32 rel_time = first_entry + i;
+
+		entry[0] = rel_time >> 24;
+		entry[1] = rel_time >> 16;
+		entry[2] = rel_time >> 8;
+		entry[3] = rel_time;
+		entry[4] = 0x00;
+		entry[5] = 0x05;
+	}
+}
+
+/**
+ * Sends bytes [start, end) of segment 7 data as one Segment Data Event
+ */
+static int send_segment_data(Context *ctx, struct PMStore *pmstore, intu8 *data,
+			     int start, int end, int total)
+{
+	SegmentDataEvent event;
+
+	event.segm_data_event_descr.segm_instance = 7;
+	event.segm_data_event_descr.segm_evt_entry_index = start / 6;
+	event.segm_data_event_descr.segm_evt_entry_count = end / 6 - start / 6;
+	event.segm_data_event_descr.segm_evt_status = 0;
+
+	if (start == 0) {
+		event.segm_data_event_descr.segm_evt_status |= SEVTSTA_FIRST_ENTRY;
+	}
+
+	if (end == total) {
+		event.segm_data_event_descr.segm_evt_status |= SEVTSTA_LAST_ENTRY;
+	}
+
+	event.segm_data_event_entries.length = end - start;
+	event.segm_data_event_entries.value = &data[start];
+
+	return pmstore_segment_data_event(ctx, pmstore, event);
+}
+
+void test_pmstore_segment_data_event(void)
+{
+	MDS *mds = mds_create();
+	struct PMStore *pmstore = new_segment_store(mds);
+	struct PMSegment *segment = pmstore->segm_list[0];
+	Context ctx;
+	ManagerListener listener = MANAGER_LISTENER_EMPTY;
+	int entry_count = 2000;
+	int total = entry_count * 6;
+	intu8 *data = malloc(total);
+	int i;
+
+	memset(&ctx, 0, sizeof(Context));
+	ctx.mds = mds;
+
+	// some entries cross chunk boundaries
+	fill_segment_entries(data, 0, entry_count);
+
+	listener.segment_data_received = &segment_data_received;
+	manager_add_listener(listener);
+
+	for (i = 0; i < total; i += 300) {
+		CU_ASSERT_EQUAL(send_segment_data(&ctx, pmstore, data, i, i + 300, total), 1);
+	}
+
+	CU_ASSERT_EQUAL(segment->fixed_segment_data.length, (intu32) total);
+	CU_ASSERT_PTR_NOT_NULL(received_segment_data);
+
+	if (received_segment_data != NULL) {
+		DataEntry *segm_entry = &received_segment_data->values[0];
+		int ok = 1;
+
+		CU_ASSERT_EQUAL(segm_entry->u.compound.entries_count, entry_count);
+
+		for (i = 0; i < segm_entry->u.compound.entries_count; ++i) {
+			DataEntry *entry = &segm_entry->u.compound.entries[i];
+			DataEntry *header = &entry->u.compound.entries[0];
+			DataEntry *elems = &entry->u.compound.entries[1];
+			char rel_time[16];
+
+			sprintf(rel_time, "%d", i);
+			ok &= header->u.compound.entries_count == 1;
+			ok &= strcmp(header->u.compound.entries[0].u.simple.value,
+				     rel_time) == 0;
+			ok &= elems->u.compound.entries_count == 1;
+		}
+
+		CU_ASSERT(ok);
+
+		data_list_del(received_segment_data);
+		received_segment_data = NULL;
+	}
+
+	manager_remove_all_listeners();
+	mds_destroy(mds);
+	free(data);
+}
+
+void test_pmstore_segment_data_large(void)
+{
+	MDS *mds = mds_create();
+	struct PMStore *pmstore = new_segment_store(mds);
+	ManagerListener listener = MANAGER_LISTENER_EMPTY;
+	Context ctx;
+	int entry_count = 20000;
+	int total = entry_count * 6;
+	intu8 *data = malloc(total);
+	int i;
+
+	memset(&ctx, 0, sizeof(Context));
+	ctx.mds = mds;
+
+	// large enough to be decoded by several threads
+	fill_segment_entries(data, 0, entry_count);
+	data[total - 1] = 0x09;
+
+	listener.segment_data_received = &segment_data_received;
+	manager_add_listener(listener);
+
+	for (i = 0; i < total; i += 6000) {
+		CU_ASSERT_EQUAL(send_segment_data(&ctx, pmstore, data, i, i + 6000, total), 1);
+	}
+
+	CU_ASSERT_PTR_NOT_NULL(received_segment_data);
+
+	if (received_segment_data != NULL) {
+		DataEntry *segm_entry = &received_segment_data->values[0];
+		int ok = 1;
+
+		CU_ASSERT_EQUAL(segm_entry->u.compound.entries_count, entry_count);
+
+		for (i = 0; i < segm_entry->u.compound.entries_count; ++i) {
+			DataEntry *entry = &segm_entry->u.compound.entries[i];
+			DataEntry *header = &entry->u.compound.entries[0];
+			DataEntry *elems = &entry->u.compound.entries[1];
+			char rel_time[16];
+
+			sprintf(rel_time, "%d", i);
+			ok &= strcmp(header->u.compound.entries[0].u.simple.value,
+				     rel_time) == 0;
+			ok &= elems->u.compound.entries_count == 1;
+		}
+
+		CU_ASSERT(ok);
+
+		data_list_del(received_segment_data);
+		received_segment_data = NULL;
+	}
+
+	// MDS object keeps value of last entry
+	struct MDS_object *object = mds_get_object_by_handle(mds, 1);
+	CU_ASSERT_EQUAL(object->u.metric.u.numeric.basic_nu_observed_value, 9);
+
+	manager_remove_all_listeners();
+	mds_destroy(mds);
+	free(data);
+}
+
+void test_pmstore_segment_data_stream(void)
+{
+	MDS *mds = mds_create();
+	struct PMStore *pmstore = new_segment_store(mds);
+	struct PMSegment *segment = pmstore->segm_list[0];
+	struct FSM fsm;
+	Context ctx;
+	ManagerListener listener = MANAGER_LISTENER_EMPTY;
+	int entry_count = 2000;
+	int total = entry_count * 6;
+	intu8 *data = malloc(total);
+	int i;
+
+	memset(&ctx, 0, sizeof(Context));
+	memset(&fsm, 0, sizeof(struct FSM));
+	fsm.state = fsm_state_unassociated;
+	ctx.mds = mds;
+	ctx.fsm = &fsm;
+
+	fill_segment_entries(data, 0, entry_count);
+
+	listener.segment_data_batch_received = &segment_data_batch_received;
+	manager_add_listener(listener);
+
+	// events split in the middle of entries, then one large event
+	for (i = 0; i < total / 2; i += 250) {
+		CU_ASSERT_EQUAL(send_segment_data(&ctx, pmstore, data, i, i + 250, total), 1);
+		CU_ASSERT(segment->fixed_segment_data.length < 6);
+	}
+
+	CU_ASSERT_EQUAL(batch_entries, total / 2 / 6);
+	CU_ASSERT_EQUAL(batch_last, 0);
+
+	// first batch found the application busy
+	CU_ASSERT_EQUAL(pmstore->segment_data_behind, 1);
+	pmstore->held_confirm.pending = 1;
+	operating_resume_segment_data(&ctx, 10);
+	CU_ASSERT_EQUAL(pmstore->segment_data_behind, 0);
+	CU_ASSERT_EQUAL(pmstore->held_confirm.pending, 0);
+
+	batch_resume = 1;
+	CU_ASSERT_EQUAL(send_segment_data(&ctx, pmstore, data, i, total, total), 1);
+	CU_ASSERT_EQUAL(pmstore->segment_data_behind, 0);
+	batch_resume = 0;
+
+	CU_ASSERT(batch_ok);
+	CU_ASSERT_EQUAL(batch_entries, entry_count);
+	CU_ASSERT_EQUAL(batch_last, 1);
+	CU_ASSERT(batch_max <= 256);
+	CU_ASSERT_EQUAL(segment->fixed_segment_data.length, 0);
+	CU_ASSERT_PTR_NULL(received_segment_data);
+
+	manager_remove_all_listeners();
+	mds_destroy(mds);
+	free(data);
+}
+
 #endif /* PMSTORE_C_ */
@@ -31,6 +31,9 @@
 void testpmstore_add_suite(void);
 void test_pmstore_add_and_clear_segment(void);
 void test_pmstore_date_selection(void);
+void test_pmstore_segment_data_event(void);
+void test_pmstore_segment_data_large(void);
+void test_pmstore_segment_data_stream(void);
 
 
 #endif /* PMSTORE_H_ */
@@ -33,6 +33,7 @@
 #include "testtimer.h"
 #include "functional_test_cases/test_functional.h"
 #include "src/communication/common/communication.h"
+#include "src/util/timerwheel.h"
 #include "src/util/log.h"
 
 
@@ -53,6 +54,7 @@ void testtimer_add_suite(void)
 
 	/* Add tests here - Start */
 	CU_add_test(suite, "test_timer", test_timer);
+	CU_add_test(suite, "test_timer_wheel", test_timer_wheel);
 
 	/* Add tests here - End */
 
@@ -98,5 +100,41 @@ void test_timer(void)
 	manager_stop();
 }
 
-#endif
+void test_timer_wheel(void)
+{
+	static TimerWheel wheel;
+	TimerWheelEntry a = {0};
+	TimerWheelEntry b = {0};
+	TimerWheelEntry c = {0};
+
+	twheel_init(&wheel, 1000);
+	CU_ASSERT_EQUAL(twheel_next(&wheel), -1);
+
+	twheel_add(&wheel, &a, 1010);
+	// more than one revolution away, same slot as a
+	twheel_add(&wheel, &b, 1010 + TWHEEL_SLOTS);
+	twheel_add(&wheel, &c, 1005);
+	CU_ASSERT_EQUAL(wheel.count, 3);
+	CU_ASSERT_EQUAL(twheel_next(&wheel), 5);
+
+	CU_ASSERT_PTR_NULL(twheel_expire(&wheel, 1004));
+	CU_ASSERT_PTR_EQUAL(twheel_expire(&wheel, 1005), &c);
+	CU_ASSERT_PTR_NULL(twheel_expire(&wheel, 1005));
+	CU_ASSERT_FALSE(c.pending);
+
+	twheel_remove(&wheel, &a);
+	CU_ASSERT_FALSE(a.pending);
+	CU_ASSERT_PTR_NULL(twheel_expire(&wheel, 1010));
+
+	// late wake up catches up with expired entries
+	CU_ASSERT_PTR_EQUAL(twheel_expire(&wheel, 20000), &b);
+	CU_ASSERT_PTR_NULL(twheel_expire(&wheel, 20000));
+	CU_ASSERT_EQUAL(wheel.count, 0);
+
+	// already expired entry fires on next tick
+	twheel_add(&wheel, &a, 10);
+	CU_ASSERT_PTR_NULL(twheel_expire(&wheel, 20000));
+	CU_ASSERT_PTR_EQUAL(twheel_expire(&wheel, 20001), &a);
+}
 
+#endif
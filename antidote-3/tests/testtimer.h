@@ -34,6 +34,7 @@
 void testtimer_add_suite(void);
 
 void test_timer(void);
+void test_timer_wheel(void);
 
 #endif /* TEST_ENABLED */
 